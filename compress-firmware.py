@@ -0,0 +1,30 @@
+Import ("env")
+
+import gzip
+import os
+
+# Gzip the firmware after every build (firmware.bin -> firmware.bin.gz)
+# The ESP8266 updater accepts gzip images, the boot loader decompresses them into place
+# The same .gz file is the artifact to upload to hawkbit
+
+def compress_firmware(source, target, env):
+    firmware = env.subst("$BUILD_DIR/${PROGNAME}.bin")
+    compressed = firmware + ".gz"
+
+    with open(firmware, "rb") as f:
+        image = f.read()
+
+    # mtime of 0 so the same image always gives the same artifact
+    with open(compressed, "wb") as f:
+        with gzip.GzipFile(filename="", mode="wb", compresslevel=9, fileobj=f, mtime=0) as g:
+            g.write(image)
+
+    print("Compressed %s: %d -> %d bytes (%d%%)" % (os.path.basename(compressed), len(image), os.path.getsize(compressed), (100 * os.path.getsize(compressed)) // len(image)))
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.bin", compress_firmware)
+
+# OTA uploads send the compressed image (ArduinoOTA writes it through the same updater)
+if env.GetProjectOption("upload_protocol", "") == "espota":
+    print("OTA upload uses the compressed firmware")
+    env.Replace(UPLOADCMD=env.get("UPLOADCMD", "").replace("$SOURCE", "${SOURCE}.gz"))
+    env.AddPreAction("upload", compress_firmware)
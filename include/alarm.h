@@ -46,13 +46,19 @@ typedef struct {
 
 /**
     Alarm module init.
-    Sets up the serial bus.
+    Sets up the serial bus, the panel messages are buffered from NVM when the first alarm message arrives.
 
     @param[in]     serialPort pointer to the serial port to be used for the alarm.
     @return        pointer to the serial port used for the alarm.
 */
 HardwareSerial* const alarmInit(HardwareSerial* const serialPort);
 
+/**
+    Alarm module re-init.
+    Buffers the panel messages from the RAM mirror (does not touch the serial bus).
+*/
+void alarmReinit(void);
+
 /**
     Fire the one shot on the alarm arm / disarm output.
 */
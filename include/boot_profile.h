@@ -0,0 +1,30 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+// Structure for boot profile data (one step)
+typedef struct {
+    const char*           stepName;
+    const char* const*    stepPtr;
+    const char*           durationName;
+    const unsigned long*  durationPtr;
+    const char*           cumulativeName;
+    const unsigned long*  cumulativePtr;
+} bootProfileData;
+
+
+/**
+    Mark the end of a boot step.
+    The step duration is the time since the previous step ended (or since boot for the first step).
+
+    @param[in]     stepName pointer to the step name (must be static).
+*/
+void bootProfileStep(const char * const stepName);
+
+/**
+    Transmit the boot profile.
+    Marks the time to the first MQTT connection as the final step.
+    Only transmits once per boot.
+*/
+void bootProfileTransmitBootMessage(void);
+
+#endif
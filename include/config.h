@@ -0,0 +1,44 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <ArduinoJson.h>
+
+#include "nvm_cfg.h"
+#include "config_cfg.h"
+
+// Bit for a NVM structure in a changed structures mask
+#define CONFIG_STRUCTURE_BIT(index)     (uint32_t(1) << (index))
+
+// Structure for configuration value data (one value in a config message)
+typedef struct {
+    const char*               valueName;
+    configFieldType           valueType;
+    const char*               valueStringPtr;
+    uint16_t                  valueNumber;
+} configValueData;
+
+// Structure for a re-init that applies a NVM structure change in place
+typedef struct {
+    const nvmSubConfigIndex   structure;
+    void                      (* const reinitFunction)(void);
+} configReinitEntry;
+
+
+/**
+    Apply changed NVM structures in place.
+    Calls the re-init of every module that buffers data from a changed structure.
+    The RAM mirror must already hold the new values (and updated CRC's).
+
+    @param[in]     changedStructures mask of changed structures (CONFIG_STRUCTURE_BIT).
+*/
+void configApply(const uint32_t changedStructures);
+
+/**
+    Handle a module config command.
+    Writes the "set" fields into the RAM mirror, commits once, reports the "get" and "set" fields and applies the changes in place.
+
+    @param[in]     docPtr pointer to the JSON document holding the command.
+*/
+void configCommand(JsonDocument * const docPtr);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef CONFIG_CFG_H
+#define CONFIG_CFG_H
+
+#include "nvm_cfg.h"
+
+// Maximum number of configuration fields
+#define CONFIG_FIELDS_MAX               (16)
+
+// Configuration field types
+typedef enum {
+    configTypeString,
+    configTypeUint8,
+    configTypeUint16
+} configFieldType;
+
+// Structure for a configuration field (a field in the NVM RAM mirror)
+typedef struct {
+    const char*               fieldName;
+    const configFieldType     fieldType;
+    const nvmSubConfigIndex   fieldStructure;
+    const size_t              fieldOffset;          // Offset into nvmCompleteStructure
+    const size_t              fieldSize;            // Size of the field in bytes (strings include the end of string character)
+    const uint16_t            fieldMaximum;         // Maximum value (numbers only)
+    const bool                fieldSecret;          // Field can be written but never read back
+} configField;
+
+
+/**
+    Set-up read only pointer to the configuration fields.
+    Shared with the offline NVM image tool (tools/nvm_image).
+
+    @param[in]     activeConfigFields pointer for the configuration fields.
+    @return        number of configuration fields.
+*/
+const uint32_t configGetFieldsPointerRO(const configField ** activeConfigFields);
+
+#endif
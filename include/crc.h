@@ -0,0 +1,43 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <Arduino.h>
+
+// Use this to benchmark crcCalculate against the CRC32 library at start-up
+//#define CRC_BENCHMARK
+
+
+// CRC datatype (32bit)
+typedef uint32_t crc_t;
+
+
+/**
+    Calculate the CRC32 (IEEE 802.3, same as the CRC32 library) of a block of data.
+    Table driven (slice-by-4, tables in flash).
+
+    @param[in]     dataPtr pointer to the data.
+    @param[in]     length length of the data in bytes.
+    @return        CRC of the data.
+*/
+crc_t crcCalculate(const void * const dataPtr, const size_t length);
+
+/**
+    Continue a CRC32 with the next block of data.
+    crcUpdate(crcCalculate(a), b) is the CRC of a followed by b, start with a CRC of 0 for the first block.
+
+    @param[in]     crc CRC of the data so far.
+    @param[in]     dataPtr pointer to the next block of data.
+    @param[in]     length length of the next block of data in bytes.
+    @return        CRC of the data so far including the next block.
+*/
+crc_t crcUpdate(const crc_t crc, const void * const dataPtr, const size_t length);
+
+#ifdef CRC_BENCHMARK
+/**
+    Benchmark crcCalculate against the CRC32 library.
+    Logs the time for both and whether the results match.
+*/
+void crcBenchmark(void);
+#endif
+
+#endif
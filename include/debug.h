@@ -1,6 +1,15 @@
 #ifndef DEBUG_H
 #define DEBUG_H
 
+#include "fixed_string.h"
+#include "utils.h"
+
+// Capacity of a debug message (characters excluding end of string)
+#define DEBUG_MESSAGE_SIZE  (128)
+
+// Size of the log header "[I0000000000ms] " (including end of string)
+#define DEBUG_LOG_HEADER_SIZE   (STRNLEN_INT(MAX_VALUE_32BIT_UNSIGNED_DEC) + 7)
+
 // Structure for storing esc code
 typedef struct {
   const char* code;
@@ -35,6 +44,9 @@ enum logLevel {
     error      = 2
 };
 
+// Debug message string (fixed capacity, no heap)
+typedef fixedString<DEBUG_MESSAGE_SIZE> debugString;
+
 // Set the pointer to the debug serial port
 HardwareSerial* const debugSetSerial(HardwareSerial* const serialPort);
 
@@ -42,12 +54,16 @@ HardwareSerial* const debugSetSerial(HardwareSerial* const serialPort);
 void escCodeTest(void);
 
 // Prints to the debug serial port
+void debugPrint(const char * const rawData, textColour rawDataColour);
 void debugPrint(String* const rawData, textColour rawDataColour);
 
 // Prints a line to the debug serial port
+void debugPrintln(const char * const rawData, textColour rawDataColour);
 void debugPrintln(String* const rawData, textColour rawDataColour);
 
 // Prints to the log
+void debugLog(const char * const message, logLevel level);
+void debugLog(const char * const message, const char * const module, logLevel level);
 void debugLog(String* const message, logLevel level);
 void debugLog(String* const message, const char * const module, logLevel level);
 
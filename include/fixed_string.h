@@ -0,0 +1,170 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/**
+    Fixed capacity string.
+    Storage is part of the object (stack or static), so building messages never touches the heap.
+    All operations truncate at the capacity and the contents are always terminated.
+*/
+template <size_t capacity>
+class fixedString {
+
+public:
+    fixedString(void) {
+        clear();
+    }
+
+    fixedString(const char * const text) {
+        clear();
+        append(text);
+    }
+
+    fixedString& operator=(const char * const text) {
+        clear();
+        return(append(text));
+    }
+
+    /**
+        Clear the string.
+    */
+    void clear(void) {
+        stringLength = 0;
+        stringTruncated = false;
+        buffer[0] = '\0';
+    }
+
+    /**
+        Append text to the string.
+
+        @param[in]     text pointer to the text to append (NULL is ignored).
+        @return        reference to the string.
+    */
+    fixedString& append(const char * const text) {
+
+        // Number of characters to copy
+        size_t copyLength;
+
+        if (text != NULL) {
+            copyLength = strnlen(text, (capacity - stringLength) + 1);
+
+            if (copyLength > (capacity - stringLength)) {
+                copyLength = capacity - stringLength;
+                stringTruncated = true;
+            }
+
+            memcpy(&buffer[stringLength], text, copyLength);
+            stringLength += copyLength;
+            buffer[stringLength] = '\0';
+        }
+
+        return(*this);
+    }
+
+    /**
+        Append formatted text to the string (printf style).
+
+        @param[in]     formatText pointer to the printf style format.
+        @return        reference to the string.
+    */
+    __attribute__ ((format (printf, 2, 3))) fixedString& appendf(const char * const formatText, ...) {
+
+        va_list arguments;
+
+        va_start(arguments, formatText);
+        appendv(formatText, arguments);
+        va_end(arguments);
+
+        return(*this);
+    }
+
+    /**
+        Replace the string with formatted text (printf style).
+
+        @param[in]     formatText pointer to the printf style format.
+        @return        reference to the string.
+    */
+    __attribute__ ((format (printf, 2, 3))) fixedString& format(const char * const formatText, ...) {
+
+        va_list arguments;
+
+        clear();
+
+        va_start(arguments, formatText);
+        appendv(formatText, arguments);
+        va_end(arguments);
+
+        return(*this);
+    }
+
+    /**
+        Pointer to the terminated string.
+    */
+    const char * c_str(void) const {
+        return(buffer);
+    }
+
+    /**
+        Length of the string (excluding the end of string character).
+    */
+    size_t length(void) const {
+        return(stringLength);
+    }
+
+    /**
+        Returns true when the string is empty.
+    */
+    bool isEmpty(void) const {
+        return(stringLength == 0);
+    }
+
+    /**
+        Returns true when text was lost because the capacity was reached.
+    */
+    bool truncated(void) const {
+        return(stringTruncated);
+    }
+
+    /**
+        Maximum number of characters the string can hold (excluding the end of string character).
+    */
+    static size_t maxLength(void) {
+        return(capacity);
+    }
+
+private:
+    /**
+        Append formatted text to the string from a variable argument list.
+
+        @param[in]     formatText pointer to the printf style format.
+        @param[in]     arguments variable argument list.
+    */
+    void appendv(const char * const formatText, va_list arguments) {
+
+        // Length the formatted text would have without truncation
+        int formattedLength = vsnprintf(&buffer[stringLength], (capacity - stringLength) + 1, formatText, arguments);
+
+        if (formattedLength > 0) {
+            if ((size_t)formattedLength > (capacity - stringLength)) {
+                stringLength = capacity;
+                stringTruncated = true;
+            }
+            else {
+                stringLength += formattedLength;
+            }
+        }
+
+        buffer[stringLength] = '\0';
+    }
+
+    char    buffer[capacity + 1];
+    size_t  stringLength;
+    bool    stringTruncated;
+};
+
+#endif
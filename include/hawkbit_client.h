@@ -4,6 +4,9 @@
 // Call rate for the cyclic taks (in mS)
 #define HAWKBIT_CLIENT_CYCLIC_RATE           (100)
 
+// Call rate for the download cyclic task (in mS)
+#define HAWKBIT_CLIENT_DOWNLOAD_RATE         (10)
+
 
 // Hawkbit state machine
 enum hawkbitClientStm {
@@ -13,6 +16,7 @@ enum hawkbitClientStm {
     stmHawkbitCancel,
     stmHawkbitCancelAck,
     stmHawkbitDeploy,
+    stmHawkbitDownload,
     stmHawkbitDeployAck,
     stmHawkbitWaitReboot,
     stmHawkbitConfig
@@ -36,4 +40,10 @@ void hawkbitClientStateMachine(void);
 */
 hawkbitClientStm hawkbitClientGetCurrentState(void);
 
+/**
+    Hawkbit download cyclic task.
+    Moves the download in progress on for up to HAWKBIT_DOWNLOAD_SLICE_MS per call (hawkbitDownloadSlice).
+*/
+void hawkbitClientDownloadCyclic(void);
+
 #endif
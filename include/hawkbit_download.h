@@ -0,0 +1,41 @@
+#ifndef HAWKBIT_DOWNLOAD_H
+#define HAWKBIT_DOWNLOAD_H
+
+#include <Client.h>
+
+// Size of a download chunk (the updater collects chunks and writes whole flash sectors)
+#define HAWKBIT_DOWNLOAD_CHUNK_SIZE     (1024)
+
+// Time for one download slice in mS (the rest of the system runs between slices)
+#define HAWKBIT_DOWNLOAD_SLICE_MS       (20)
+
+// Time without download data before the download fails in mS
+#define HAWKBIT_DOWNLOAD_TIMEOUT_MS     (15000)
+
+
+// Status of the download after a slice
+typedef enum {
+    hawkbitDownloadRunning      = 0,
+    hawkbitDownloadComplete     = 1,
+    hawkbitDownloadWriteError   = 2,
+    hawkbitDownloadClosed       = 3,
+    hawkbitDownloadTimeout      = 4
+} hawkbitDownloadStatus;
+
+
+/**
+    Start a download.
+    The updater must have been started with the image size.
+*/
+void hawkbitDownloadBegin(void);
+
+/**
+    Move the download on for up to HAWKBIT_DOWNLOAD_SLICE_MS.
+    Chunks are read from the client as they arrive and passed to the updater (which writes whole flash sectors).
+
+    @param[in]     client connection with the image (the response header has been read).
+    @return        status of the download (hawkbitDownloadRunning until the image is written or the download failed).
+*/
+hawkbitDownloadStatus hawkbitDownloadSlice(Client & client);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef HAWKBIT_POLL_H
+#define HAWKBIT_POLL_H
+
+#include <stdint.h>
+
+// Poll interval used until the server sends one (config.polling.sleep) in S
+#define HAWKBIT_POLL_SLEEP_DEFAULT_S    (300)
+
+// Limits for the poll interval sent by the server in S
+#define HAWKBIT_POLL_SLEEP_MIN_S        (10)
+#define HAWKBIT_POLL_SLEEP_MAX_S        (86400)
+
+// Poll interval while an action is active in S
+#define HAWKBIT_POLL_ACTIVE_S           (15)
+
+// Earliest first poll after init in S (the first poll is spread up to the default poll interval)
+#define HAWKBIT_POLL_FIRST_MIN_S        (15)
+
+// Random jitter applied to every poll interval in %
+#define HAWKBIT_POLL_JITTER_PERCENT     (10)
+
+// Backoff after failed polls, the interval doubles per failure up to the maximum (in S, never shorter than the server interval)
+#define HAWKBIT_POLL_BACKOFF_SHIFT_MAX  (6)
+#define HAWKBIT_POLL_BACKOFF_MAX_S      (3600)
+
+
+// Structure for the poll state
+typedef struct {
+    uint32_t                sleep;          // Poll interval from the server in S
+    uint32_t                errors;         // Consecutive failed polls (0 when the last poll succeeded)
+    bool                    actionActive;   // The last poll returned an action
+    bool                    firstPoll;      // No poll since init
+} hawkbitPollState;
+
+
+/**
+    Read the poll interval sent by the server.
+    The interval is "HH:MM:SS", it is limited to the HAWKBIT_POLL_SLEEP limits.
+
+    @param[in]     sleep pointer to the interval string (NULL when not sent).
+    @param[in]     pollSleep current poll interval in S.
+    @return        new poll interval in S (pollSleep when the server did not send a valid interval).
+*/
+uint32_t hawkbitPollParseSleep(const char * const sleep, const uint32_t pollSleep);
+
+/**
+    Get the time to the next poll.
+    Failed polls back off exponentially, an active action polls fast, otherwise the server interval is used.
+    Every interval gets random jitter so devices started together do not poll together.
+
+    @param[in]     pollStatePtr pointer to the poll state.
+    @return        time to the next poll in S.
+*/
+uint32_t hawkbitPollGetDelay(const hawkbitPollState * const pollStatePtr);
+
+#endif
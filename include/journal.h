@@ -0,0 +1,71 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "debug.h"
+
+// Structure for journal data (previous boot)
+typedef struct {
+    const char*           reasonName;
+    const char*           reasonPtr;
+    const char*           exceptionName;
+    const uint32_t*       exceptionPtr;
+    const char*           epcName;
+    const char*           epcPtr;
+    const char*           addressName;
+    const char*           addressPtr;
+    const char*           bootsName;
+    const uint32_t*       bootsPtr;
+    const char*           uptimeName;
+    const uint32_t*       uptimePtr;
+    const char*           heapName;
+    const uint32_t*       heapPtr;
+    const char*           taskName;
+    const char*           taskPtr;
+} journalData;
+
+// Structure for a journal log record (previous boot)
+typedef struct {
+    const char*           recordName;
+    const unsigned int*   recordPtr;
+    const char*           logName;
+    const char*           logPtr;
+} journalRecordData;
+
+
+/**
+    Journal init.
+    Loads the journal from the previous boot out of RTC memory and starts a new one.
+    Should be called early / first during init.
+*/
+void journalInit(void);
+
+/**
+    Add a log record to the journal.
+    Called from debugLog so the journal holds the last records before a reset.
+
+    @param[in]     level log level of the record.
+    @param[in]     module pointer to the module name (NULL when there is no module).
+    @param[in]     message pointer to the message.
+*/
+void journalRecord(const logLevel level, const char * const module, const char * const message);
+
+/**
+    Set the task that is executing.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void journalSetTask(const char * const taskName);
+
+/**
+    Snapshot the journal into RTC memory.
+    Call before any intentional reset.
+*/
+void journalSnapshot(void);
+
+/**
+    Transmit the journal from the previous boot.
+    Only transmits once per boot and only when there is something to report.
+*/
+void journalTransmitCrashMessage(void);
+
+#endif
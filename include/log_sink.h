@@ -0,0 +1,55 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include "debug.h"
+
+// Call rate for the cyclic taks (in mS)
+#define LOG_SINK_CYCLIC_RATE        (100)
+
+
+// Log sink transports
+enum logSinkTransports {
+    logSinkOff      = 0,
+    logSinkSyslog   = 1,
+    logSinkMqtt     = 2
+};
+
+// Structure for log sink data
+typedef struct {
+    const char*           logName;
+    const char*           logPtr;
+    const char*           droppedName;
+    const unsigned long*  droppedPtr;
+} logSinkData;
+
+
+/**
+    Log sink init.
+*/
+void logSinkInit(void);
+
+/**
+    Log sink re-init.
+    The syslog server follows the MQTT server so check it again after a configuration change.
+*/
+void logSinkReinit(void);
+
+/**
+    Add a formatted log record to the ring buffer.
+    Called from debugLog so the sink shares the debug formatting path.
+    When the ring buffer is full the lowest severity record is dropped.
+
+    @param[in]     level log level of the record.
+    @param[in]     header pointer to the formatted log header.
+    @param[in]     module pointer to the module name (NULL when there is no module).
+    @param[in]     message pointer to the message.
+*/
+void logSinkRecord(const logLevel level, const char * const header, const char * const module, const char * const message);
+
+/**
+    Cycle task for the log sink.
+    Transmits at most one batch per call so it never blocks the scheduler.
+*/
+void logSinkCyclicTask(void);
+
+#endif
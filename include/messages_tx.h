@@ -4,9 +4,14 @@
 #include "version.h"
 #include "runtime.h"
 #include "wifi.h"
+#include "wifi_supervisor.h"
 #include "alarm.h"
 #include "garage_door.h"
 #include "nvm.h"
+#include "log_sink.h"
+#include "journal.h"
+#include "boot_profile.h"
+#include "config.h"
 
 /**
     Transmit a version message.
@@ -23,8 +28,10 @@ void messsagesTxVersionMessage(const versionData * const versionDataStructurePtr
 
     @param[in]     runtimeDataStructurePtr pointer to the runtime data structure
     @param[in]     runtimeDataStructureSize size of the runtime data structure
+    @param[in]     runtimeStringDataStructurePtr pointer to the runtime string data structure
+    @param[in]     runtimeStringDataStructureSize size of the runtime string data structure
 */
-void messsagesTxRuntimeMessage(const runtimeData * const runtimeDataStructurePtr, const unsigned int * const runtimeDataStructureSize);
+void messsagesTxRuntimeMessage(const runtimeData * const runtimeDataStructurePtr, const unsigned int * const runtimeDataStructureSize, const runtimeStringData * const runtimeStringDataStructurePtr, const unsigned int * const runtimeStringDataStructureSize);
 
 /**
     Transmit a wifi message.
@@ -69,4 +76,54 @@ void messsagesTxNvmStatusMessage(const nvmData * const nvmDataStructurePtr);
 */
 void messsagesTxGarageStatusMessage(const garageDoorStatusData * const garageDoorStatusDataStructurePtr);
 
+/**
+    Transmit a wifi outage message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     wifiSupervisorDataStructurePtr pointer to the wifi supervisor data structure
+*/
+void messsagesTxWifiOutageMessage(const wifiSupervisorData * const wifiSupervisorDataStructurePtr);
+
+/**
+    Transmit a config values message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     configValueDataStructurePtr pointer to the config value data structure
+    @param[in]     configValueDataStructureSize size of the config value data structure
+*/
+void messsagesTxConfigMessage(const configValueData * const configValueDataStructurePtr, const unsigned int * const configValueDataStructureSize);
+
+/**
+    Transmit a log message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     logSinkDataStructurePtr pointer to the log sink data structure
+    @return        true when the message was published.
+*/
+bool messsagesTxLogMessage(const logSinkData * const logSinkDataStructurePtr);
+
+/**
+    Transmit a crash message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     journalDataStructurePtr pointer to the journal data structure
+*/
+void messsagesTxCrashMessage(const journalData * const journalDataStructurePtr);
+
+/**
+    Transmit a crash log record message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     journalRecordDataStructurePtr pointer to the journal record data structure
+*/
+void messsagesTxCrashRecordMessage(const journalRecordData * const journalRecordDataStructurePtr);
+
+/**
+    Transmit a boot profile message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     bootProfileDataStructurePtr pointer to the boot profile data structure
+*/
+void messsagesTxBootMessage(const bootProfileData * const bootProfileDataStructurePtr);
+
 #endif
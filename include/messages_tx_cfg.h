@@ -13,6 +13,21 @@
 // MQTT topic definition for module wifi
 #define MESSAGES_TX_MQTT_TOPIC_MODULE_WIFI        ("module wifi")
 
+// MQTT topic definition for module wifi outage
+#define MESSAGES_TX_MQTT_TOPIC_MODULE_WIFI_OUTAGE ("module wifi outage")
+
+// MQTT topic definition for module log
+#define MESSAGES_TX_MQTT_TOPIC_MODULE_LOG         ("module log")
+
+// MQTT topic definition for module crash
+#define MESSAGES_TX_MQTT_TOPIC_MODULE_CRASH       ("module crash")
+
+// MQTT topic definition for module boot
+#define MESSAGES_TX_MQTT_TOPIC_MODULE_BOOT        ("module boot")
+
+// MQTT topic definition for module config values
+#define MESSAGES_TX_MQTT_TOPIC_MODULE_CONFIG      ("module config values")
+
 // MQTT topic definition for alarm triggers
 #define MESSAGES_TX_MQTT_TOPIC_ALARM_STATUS       ("alarm status")
 
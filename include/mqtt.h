@@ -6,8 +6,15 @@
 */
 void mqttSetup(void);
 
+/**
+    MQTT re-init.
+    Picks up a new server, credentials or root topic by dropping the connection (mqttMessageLoop reconnects).
+*/
+void mqttReinit(void);
+
 /**
     MQTT client loop.
+    Sends the boot and crash messages once connected (own task, so never nested inside another send).
 */
 void mqttClientLoop(void);
 
@@ -24,7 +31,8 @@ void mqttMessageLoop(void);
 
     @param[in]     shortTopic pointer to the topic (short form without prefix and hostname)
     @param[in]     message pointer to the message
+    @return        true when the message was published.
 */
-void mqttMessageSendRaw(const char * const shortTopic, const char * const  message);
+bool mqttMessageSendRaw(const char * const shortTopic, const char * const  message);
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef NVM_H
 #define NVM_H
 
+#include "crc.h"
+
 // CRC size in number of bytes
 #define NVM_CRC_SIZE_BYTES          (sizeof(crc_t) / sizeof(uint8_t))
 
@@ -28,9 +30,24 @@
 // Default for NVM errors
 #define NVM_DATA_ERRORS_DEFAULT     (0)
 
+// Schema version of the original structure layouts
+#define NVM_SCHEMA_VERSION_INITIAL  (0)
+
+// Delay before the deferred structures are validated in the background (in mS)
+#define NVM_DEFERRED_DELAY          (5000)
+
+// Call rate of the background commit (in mS), one flash operation per call
+#define NVM_CYCLIC_RATE             (10)
+
+// Maximum number of callbacks waiting for the background commit
+#define NVM_COMMIT_CALLBACKS_MAX    (4)
 
-// CRC datatype (32bit)
-typedef uint32_t crc_t;
+// Bit for a NVM structure in a dirty structures mask
+#define NVM_STRUCTURE_BIT(index)    (uint32_t(1) << (index))
+
+
+// Callback when a background commit is complete
+typedef void (* nvmCommitCallback)(void);
 
 // NVM structure footer
 typedef struct {
@@ -53,14 +70,33 @@ typedef struct {
     const uint32_t          length;              // Length (in bytes) of the structure excluding the CRC
 
     const bool              rewriteWhenCorrupt;  // Allow defaults to be restored when NVM structure is corrupt
+
+    const uint8_t           schemaVersion;       // Schema version of the structure layout (increment when the layout changes and add a migration)
+
+    const bool              bootCritical;        // Validated during nvmInit (deferred structures are validated on first access or in the background)
 } nvmStructureConfig;
 
+// NVM structure migration (converts the data of an older schema version to the current schema version)
+typedef struct {
+    const uint32_t          index;               // Index of the NVM structure (nvmNumberOfTypes terminates the table)
+    const uint8_t           fromVersion;         // Schema version the migration converts from
+
+    // Migration function, new data is pre-filled with the ROM defaults (lengths exclude the CRC)
+    void                    (* const migrationFunction)(const uint8_t * const oldDataPtr, const uint32_t oldLength, uint8_t * const newDataPtr, const uint32_t newLength);
+} nvmMigrationConfig;
+
 // NVM data message
 typedef struct {
     nvmCoreData             core;
 
     uint32_t                bytesConsumed;
     uint32_t                structures;
+
+    uint32_t                commits;             // Commits that wrote to flash
+    uint32_t                commitsSkipped;      // Commits skipped (nothing differed from flash)
+    uint32_t                lastCommitBytes;     // Bytes changed by the last commit
+    uint32_t                lastCommitTime;      // Duration of the last commit (uS)
+    uint32_t                logSectors;          // Log sectors opened (flash sector erases)
 } nvmData;
 
 
@@ -72,22 +108,67 @@ void nvmClear(void);
 
 /**
     Update indexed RAM mirror structure CRC based on the current structure contents.
+    Marks the structure as dirty for the next commit.
   
     @param[in]     index index of the NVM structure the will have the CRC update.
 */
 void nvmUpdateRamMirrorCrcByIndex(uint32_t index);
 
 /**
-    Comitt the RAM mirror directly to NVM.
-    Before calling, make sure the appropiate structure CRC's have been updated.
-    This call is BLOCKING (writing the RAM mirrors to EEPROM).
+    Migration that keeps the old data when fields were only added to the end of a structure.
+    The added fields keep their ROM defaults.
+
+    @param[in]     oldDataPtr pointer to the old data.
+    @param[in]     oldLength length of the old data (excluding the CRC).
+    @param[out]    newDataPtr pointer to the new data (pre-filled with the ROM defaults).
+    @param[in]     newLength length of the new data (excluding the CRC).
+*/
+void nvmMigrateExtend(const uint8_t * const oldDataPtr, const uint32_t oldLength, uint8_t * const newDataPtr, const uint32_t newLength);
+
+/**
+    Comitt the dirty RAM mirror structures directly to NVM.
+    Only structures that differ from the stored contents are appended to the log, the flash is not touched when nothing differs.
+    Before calling, make sure the appropiate structure CRC's have been updated (this marks them dirty).
+    This call is BLOCKING (writing the RAM mirrors to the NVM log).
 */
 void nvmComittRamMirror(void);
 
+/**
+    Comitt the dirty RAM mirror structures to NVM in the background.
+    The dirty structures are taken now, the flash is written by nvmCyclicTask (one flash operation per call).
+    Use this at run time, nvmComittRamMirror is for boot.
+
+    @param[in]     callback function called when the commit is complete (NULL for none).
+*/
+void nvmComittRamMirrorAsync(const nvmCommitCallback callback);
+
+/**
+    NVM cyclic task.
+    Writes the next step of a background commit.
+*/
+void nvmCyclicTask(void);
+
+/**
+    Validate a deferred NVM structure before its first access.
+    Does nothing when the structure is already validated.
+    This call is BLOCKING (can start writing the RAM mirrors to the NVM log).
+
+    @param[in]     index index of the NVM structure.
+*/
+void nvmValidateStructure(const uint32_t index);
+
+/**
+    Validate all deferred NVM structures that have not been accessed yet.
+    Call from a background task shortly after start-up.
+    This call is BLOCKING (can start writing the RAM mirrors to the NVM log).
+*/
+void nvmValidateDeferred(void);
+
 /**
     Initialise the NVM module.
-    Include initialisation of the RAM mirrors and recovery to defaults where allowed.
-    This call is BLOCKING (reading / populating the RAM mirrors from EEPROM).
+    Include initialisation of the RAM mirrors and recovery to defaults where allowed (boot critical structures only).
+    The legacy EEPROM contents are imported when the NVM log is empty.
+    This call is BLOCKING (reading / populating the RAM mirrors from the NVM log).
 */
 void nvmInit(void);
 
@@ -24,6 +24,9 @@
 // Maximum length of a tennant
 #define NVM_MAX_LENGTH_TENNANT      (32)
 
+// Length of a BSSID
+#define NVM_LENGTH_BSSID            (6)
+
 
 // NVM subconfiguration index
 typedef enum {
@@ -34,6 +37,7 @@ typedef enum {
     nvmAlarmStruc    = 4,
     nvmHawkbitStruc  = 5,
     nvmExt1Struc     = 6, 
+    nvmWifiStruc     = 7,
 
     nvmNumberOfTypes
 } nvmSubConfigIndex;
@@ -97,6 +101,19 @@ typedef struct __attribute__ ((packed)) {
     nvmFooterCrc             footer;
 } nvmSubConfigExt1;
 
+// WiFi connection cache NVM structure
+typedef struct __attribute__ ((packed)) {
+    uint8_t                  valid;                                     // Cache holds a successful connection
+    uint8_t                  bssid[NVM_LENGTH_BSSID];                   // Access point BSSID
+    uint8_t                  channel;                                   // Access point channel
+    uint32_t                 ip;                                        // IP address
+    uint32_t                 gateway;                                   // Gateway address
+    uint32_t                 mask;                                      // Subnet mask
+    uint32_t                 dns;                                       // DNS server address
+
+    nvmFooterCrc             footer;
+} nvmSubConfigWifi;
+
 // Complete NVM structure
 typedef struct __attribute__ ((packed)) {
     nvmSubConfigNvm         nvm;                 // NVM settings
@@ -106,6 +123,7 @@ typedef struct __attribute__ ((packed)) {
     nvmSubConfigAlarm       alarm;               // Alarm settings
     nvmSubConfigHawkbit     hawkbit;             // Hawkbit settings
     nvmSubConfigExt1        ext1;                // Extensions 1 settings
+    nvmSubConfigWifi        wifi;                // WiFi connection cache
 } nvmCompleteStructure;
 
 
@@ -133,6 +151,14 @@ const uint32_t nvmGetRamMirrorPointerRO(const nvmCompleteStructure ** activeNvmR
 */
 const uint32_t nvmGetConfigPointerRO(const nvmStructureConfig ** activeNvmConfig);
 
+/**
+    Set-up read only pointer to the NVM migrations
+        
+    @param[in]     activeNvmMigrations pointer for the NVM migrations.
+    @return        size of the NVM migrations (including the terminating entry).
+*/
+const uint32_t nvmGetMigrationPointerRO(const nvmMigrationConfig ** activeNvmMigrations);
+
 /**
     Update named RAM mirror structure CRC based on the current structure contents.
   
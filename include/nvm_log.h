@@ -0,0 +1,86 @@
+#ifndef NVM_LOG_H
+#define NVM_LOG_H
+
+#include "nvm_cfg.h"
+
+// Number of flash sectors in the log (must be 3 or more, a snapshot is only lost after NVM_LOG_SECTORS - 2 interrupted snapshots)
+#define NVM_LOG_SECTORS             (4)
+
+
+/**
+    NVM log init.
+    Replays the records of all valid log sectors (oldest first) into the RAM mirror.
+    Records from an older schema version are migrated and rewritten in the current layout.
+    The log uses the last NVM_LOG_SECTORS sectors of the file system area (no file system is used).
+    This call is BLOCKING (reading the flash).
+
+    @param[out]    ramMirrorPtr pointer to the RAM mirror.
+    @return        true when the log holds data (RAM mirror populated).
+*/
+bool nvmLogInit(nvmCompleteStructure * const ramMirrorPtr);
+
+/**
+    Start writing the changed structures to the log.
+    Only structures that differ from the stored copy are taken (copied into the stored copy now), the flash is written by nvmLogWriteStep.
+    The stored generation of a changed structure is kept as the previous generation (when valid).
+    Can be called while a write is in progress, the changes are added to it.
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+    @param[in]     structures mask of structures to check (NVM_STRUCTURE_BIT).
+    @return        number of structure bytes to write (0 when nothing differed).
+*/
+uint32_t nvmLogWriteBegin(const nvmCompleteStructure * const ramMirrorPtr, const uint32_t structures);
+
+/**
+    Do one step of the write in progress: erase a sector, write one structure of a snapshot or append one changed structure.
+    Opens a new sector (with a snapshot of all structures) when the active sector is full.
+    This call is BLOCKING for one flash operation (a sector erase is the longest).
+
+    @return        true while the write has steps left.
+*/
+bool nvmLogWriteStep(void);
+
+/**
+    Write the changed structures to the log.
+    Same as nvmLogWriteBegin followed by nvmLogWriteStep until done (also finishes a write that was already in progress).
+    This call is BLOCKING (writing the flash).
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+    @param[in]     structures mask of structures to check (NVM_STRUCTURE_BIT).
+    @return        number of structure bytes written (0 when nothing differed).
+*/
+uint32_t nvmLogWrite(const nvmCompleteStructure * const ramMirrorPtr, const uint32_t structures);
+
+/**
+    Write a snapshot of all structures into a new sector.
+    Used to import the legacy EEPROM contents and to clear the NVM (the previous generation is discarded).
+    The sector is flagged as a reset, so the replay at the next start-up discards the older sectors (the clear is final).
+    Power lost before the sector header is written keeps the old contents, after it the snapshot (or the part written) is all that is left.
+    This call is BLOCKING (erasing and writing the flash).
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+*/
+void nvmLogWriteAll(const nvmCompleteStructure * const ramMirrorPtr);
+
+/**
+    Restore the previous generation of a structure into the RAM mirror.
+    The previous generation always has a valid CRC.
+    Records with an invalid record CRC (power lost while writing, flash damage) are skipped by the replay, the structure already
+    comes from the last good record. So this is only needed when a record is intact but the structure CRC in it is invalid
+    (the structure was already corrupt in the RAM mirror when it was committed).
+
+    @param[in]     index index of the NVM structure.
+    @param[out]    ramMirrorPtr pointer to the RAM mirror.
+    @return        true when there was a previous generation to restore.
+*/
+bool nvmLogRestorePrevious(const uint32_t index, nvmCompleteStructure * const ramMirrorPtr);
+
+/**
+    Get the sequence of the newest log sector.
+    Increments every time a sector is erased so indicates the flash wear.
+
+    @return        sequence of the newest log sector.
+*/
+uint32_t nvmLogGetSectorSequence(void);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef NVM_LOG_FORMAT_H
+#define NVM_LOG_FORMAT_H
+
+#include <Arduino.h>
+
+#include "crc.h"
+
+// Flash layout of the NVM log, shared by nvm_log.cpp and the nvm_image tool (dump-log)
+
+// Magic number marking a log sector
+#define NVM_LOG_MAGIC                   (uint32_t(0x4E564C47))
+
+// Contents of an erased flash word
+#define NVM_LOG_ERASED                  (uint32_t(0xFFFFFFFF))
+
+// Largest record payload (largest NVM structure including the CRC)
+#define NVM_LOG_PAYLOAD_MAX             (256)
+
+// Size rounded up to whole flash words
+#define NVM_LOG_ALIGN(size)             (((size) + 3) & ~uint32_t(3))
+
+// Sector flag for a reset: replay discards everything in the older sectors (clear or import)
+#define NVM_LOG_SECTOR_RESET            (uint32_t(0x00000001))
+
+// Record index flag for a previous generation (written by a snapshot, never becomes the stored generation)
+#define NVM_LOG_RECORD_PREVIOUS         (0x80)
+
+
+// Structure for a log sector header (CRC over the fields before it)
+typedef struct {
+    uint32_t                magic;              // Log sector magic number
+    uint32_t                sequence;           // Sector sequence (increments every time a sector is opened)
+    uint32_t                flags;              // Sector flags (NVM_LOG_SECTOR_RESET)
+    crc_t                   crc;                // CRC of the header
+} nvmLogSectorHeader;
+
+// Structure for a log record header (followed by the structure, padded to whole flash words)
+typedef struct {
+    uint8_t                 index;              // Structure index (nvmSubConfigIndex, NVM_LOG_RECORD_PREVIOUS for a previous generation)
+    uint8_t                 version;            // Schema version of the structure
+    uint16_t                length;             // Length of the structure including its CRC
+    uint32_t                sequence;           // Record sequence (version, increments with every record)
+    crc_t                   crc;                // CRC of the header (with this field 0) and the structure
+} nvmLogRecordHeader;
+
+static_assert((sizeof(nvmLogSectorHeader) % sizeof(uint32_t)) == 0, "nvmLogSectorHeader must be a whole number of flash words");
+static_assert((sizeof(nvmLogRecordHeader) % sizeof(uint32_t)) == 0, "nvmLogRecordHeader must be a whole number of flash words");
+
+#endif
@@ -36,6 +36,12 @@ void restCtrlImmediateHandle(resetCtrlTypes requestedReset);
 */
 void restCtrlInit(void);
 
+/**
+    Reset controller re-init.
+    Reloads the configuration from the RAM mirror without touching a reset in progress.
+*/
+void restCtrlReinit(void);
+
 /**
     Reset controller state machine.
 */
@@ -0,0 +1,30 @@
+#ifndef RTC_MEM_CFG_H
+#define RTC_MEM_CFG_H
+
+// RTC user memory is addressed in 4 byte blocks
+#define RTC_MEM_BLOCK_SIZE          (4)
+
+// Total RTC user memory in blocks (512 bytes)
+#define RTC_MEM_BLOCKS_TOTAL        (128)
+
+// Blocks reserved at the start of RTC user memory (used by eboot during OTA)
+#define RTC_MEM_BLOCKS_RESERVED     (32)
+
+// Journal offset in blocks
+#define RTC_MEM_OFFSET_JOURNAL      (RTC_MEM_BLOCKS_RESERVED)
+
+// Journal size in blocks
+#define RTC_MEM_BLOCKS_JOURNAL      (64)
+
+// WiFi connection cache offset in blocks
+#define RTC_MEM_OFFSET_WIFI         (RTC_MEM_OFFSET_JOURNAL + RTC_MEM_BLOCKS_JOURNAL)
+
+// WiFi connection cache size in blocks
+#define RTC_MEM_BLOCKS_WIFI         (8)
+
+// End of the allocated RTC user memory in blocks
+#define RTC_MEM_OFFSET_END          (RTC_MEM_OFFSET_WIFI + RTC_MEM_BLOCKS_WIFI)
+
+static_assert(RTC_MEM_OFFSET_END <= RTC_MEM_BLOCKS_TOTAL, "RTC user memory allocation exceeds the available RTC user memory");
+
+#endif
@@ -1,12 +1,21 @@
 #ifndef RUNTIME_H
 #define RUNTIME_H
 
+// Runtime value that is not known (left out of the runtime message)
+#define RUNTIME_NOT_AVAILABLE   (0xFFFFFFFF)
+
 // Structure for runtime data
 typedef struct {
   const char*           runtimeName;
   const unsigned long*  runtimeContents;
 } runtimeData;
 
+// Structure for runtime string data
+typedef struct {
+  const char*           runtimeName;
+  const char* const*    runtimeContents;
+} runtimeStringData;
+
 
 /**
     Measure average runtime.
@@ -20,6 +29,23 @@ void runtimeMeasureAverageuS(void);
 */
 void runtimeMeasurePeakuS(void);
 
+/**
+    Task start.
+    Called before each scheduler task executes to track the executing task.
+    Samples the heap left by the main loop since the previous task.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void runtimeTaskStart(const char * const taskName);
+
+/**
+    Task end.
+    Called after each scheduler task executes to sample the heap the task still holds.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void runtimeTaskEnd(const char * const taskName);
+
 /**
     Transmit a runtime message.
     No processing of the message here.
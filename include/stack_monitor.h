@@ -0,0 +1,53 @@
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+// Free stack when the stack was not painted (nothing is known)
+#define STACK_MONITOR_NOT_PAINTED   (0xFFFFFFFF)
+
+// Structure for a stack region
+typedef struct {
+  const char*           regionName;
+  uint32_t*             regionBottom;   // Lowest address (the stack grows down towards it)
+  uint32_t*             regionTop;      // Highest address (exclusive)
+} stackMonitorRegion;
+
+
+/**
+    Paint a stack region.
+    Every word from the bottom to the top of the region is filled with the paint pattern.
+
+    @param[in]     regionPtr pointer to the stack region.
+*/
+void stackMonitorPaintRegion(const stackMonitorRegion * const regionPtr);
+
+/**
+    Scan a painted stack region.
+
+    @param[in]     regionPtr pointer to the stack region.
+    @return        bytes from the bottom of the region that still hold the paint pattern.
+*/
+uint32_t stackMonitorScanRegion(const stackMonitorRegion * const regionPtr);
+
+/**
+    Stack monitor init.
+    Paints the unused part of the SYS stack, the core paints the cont stack.
+    Should be called early during init.
+*/
+void stackMonitorInit(void);
+
+/**
+    Minimum free cont stack since boot.
+
+    @return        free bytes.
+*/
+uint32_t stackMonitorContFree(void);
+
+/**
+    Minimum free SYS stack since boot.
+    Limited to the painted size (STACK_MONITOR_SYS_PAINT) when the stack never reached the painted area.
+
+    @return        free bytes or STACK_MONITOR_NOT_PAINTED when the SYS stack was not painted.
+*/
+uint32_t stackMonitorSysFree(void);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef STACK_MONITOR_CFG_H
+#define STACK_MONITOR_CFG_H
+
+// Bytes below the top of the SYS stack (or the cont context when it lives on the SYS stack) never painted
+#define STACK_MONITOR_SYS_RESERVE   (1024)
+
+// Maximum bytes painted from the bottom of the SYS stack
+#define STACK_MONITOR_SYS_PAINT     (2048)
+
+#endif
@@ -1,20 +1,43 @@
 #ifndef WIFI_H
 #define WIFI_H
 
+#include <ESP8266WiFi.h>
+
+// Call rate for the cyclic taks (in mS)
+#define WIFI_CYCLIC_RATE      (2000)
+
 // Structure for wifi data
 typedef struct {
-    const char*   ssidName;
-    const char*   ssidDataPtr;
-    const char*   ipAddressName;
-    const char*   ipAddressDataPtr;
-    const char*   gatewayAddressName;
-    const char*   gatewayAddressDataPtr;
-    const char*   subnetMaskName;
-    const char*   subnetMaskDataPtr;
-    const char*   macAddressName;
-    const char*   macAddressDataPtr;
-    const char*   rssiName;
-    const long*   rssiDataPtr;
+    const char*           ssidName;
+    const char*           ssidDataPtr;
+    const char*           ipAddressName;
+    const char*           ipAddressDataPtr;
+    const char*           gatewayAddressName;
+    const char*           gatewayAddressDataPtr;
+    const char*           subnetMaskName;
+    const char*           subnetMaskDataPtr;
+    const char*           macAddressName;
+    const char*           macAddressDataPtr;
+    const char*           rssiName;
+    const long*           rssiDataPtr;
+    const char*           rssiAverageName;
+    const long*           rssiAverageDataPtr;
+    const char*           rssiMinName;
+    const long*           rssiMinDataPtr;
+    const char*           rssiMaxName;
+    const long*           rssiMaxDataPtr;
+    const char*           rssiP10Name;
+    const long*           rssiP10DataPtr;
+    const char*           rssiP50Name;
+    const long*           rssiP50DataPtr;
+    const char*           rssiP90Name;
+    const long*           rssiP90DataPtr;
+    const char*           reconnectsName;
+    const uint32_t*       reconnectsDataPtr;
+    const char*           connectName;
+    const char* const*    connectDataPtr;
+    const char*           connectTimeName;
+    const unsigned long*  connectTimeDataPtr;
 } wifiData;
 
 // Host types
@@ -47,13 +70,28 @@ void wifiIdentifyModule(void);
 
 /**
     WiFi set-up and connect.
+    When the connection fails the configuration portal keeps running in the background (see wifiPortalLoop).
 */
 void setupWifi(void);
 
 /**
-    WiFi check and prints status to the console.
+    WiFi configuration portal loop.
+    Services the background configuration portal, call from the main loop (needs to be called often).
+*/
+void wifiPortalLoop(void);
+
+/**
+    Re-associate with the stored network.
+    Drops any BSSID lock and static IP from the WiFi cache so the SDK scans for the access point and DHCP runs.
+*/
+void wifiReassociate(void);
+
+/**
+    Returns string to explain wifi status return code.
+    @param[in]     status wifi status value to check.
+    @return        string explaining the wifi code.
 */
-void checkWifi(void);
+const char* wifiStatusToString(const wl_status_t status);
 
 /**
     Reset wifi settings.
@@ -65,6 +103,17 @@ void wifiReset(void);
 */
 bool wifiIsConnected(void);
 
+/**
+    Returns true when the configuration portal is active (the radio is serving the portal).
+*/
+bool wifiIsPortalActive(void);
+
+/**
+    WiFi cyclic task.
+    Refreshes the station details and the WiFi cache after a station event and samples the RSSI.
+*/
+void wifiCyclicTask(void);
+
 /**
     Transmit a wifi message.
     No processing of the message here.
@@ -0,0 +1,63 @@
+#ifndef WIFI_SUPERVISOR_H
+#define WIFI_SUPERVISOR_H
+
+// Call rate for the cyclic taks (in mS)
+#define WIFI_SUPERVISOR_CYCLIC_RATE      (500)
+
+
+// WiFi supervisor state machine
+enum wifiSupervisorStm {
+    stmWifiSupervisorConnected,
+    stmWifiSupervisorReconnect,
+    stmWifiSupervisorReassociate,
+    stmWifiSupervisorReboot
+};
+
+// Structure for wifi supervisor (outage) data
+typedef struct {
+    const char*           stateName;
+    const char* const*    statePtr;
+    const char*           outagesName;
+    const uint32_t*       outagesPtr;
+    const char*           outageName;
+    const uint32_t*       outagePtr;
+    const char*           lastOutageName;
+    const uint32_t*       lastOutagePtr;
+    const char*           longestOutageName;
+    const uint32_t*       longestOutagePtr;
+    const char*           totalOutageName;
+    const uint32_t*       totalOutagePtr;
+    const char*           reconnectsName;
+    const uint32_t*       reconnectsPtr;
+    const char*           reassociationsName;
+    const uint32_t*       reassociationsPtr;
+} wifiSupervisorData;
+
+
+/**
+    WiFi supervisor init.
+    Registers for the station events, call after setupWifi.
+*/
+void wifiSupervisorInit(void);
+
+/**
+    WiFi supervisor state machine.
+    Recovers the WiFi connection without blocking (reconnect, re-associate, then reboot once the outage budget is spent).
+    Paused while the configuration portal is active, the portal time does not count against the outage budget.
+*/
+void wifiSupervisorStateMachine(void);
+
+/**
+    Get the current state of the state machine.
+
+    @return        state machine state.
+*/
+wifiSupervisorStm wifiSupervisorGetState(void);
+
+/**
+    Transmit a wifi outage message.
+    No processing of the message here.
+*/
+void wifiSupervisorTransmitOutageMessage(void);
+
+#endif
@@ -110,6 +110,9 @@ static char alarmPanelStateMsgArmed[NVM_MAX_LENGTH_ADDRESS + sizeof(ALARM_PANEL_
 // Panel disarmed message buffered from NVM
 static char alarmPanelStateMsgDisarmed[NVM_MAX_LENGTH_ADDRESS + sizeof(ALARM_PANEL_TEXT_CMN_DISARM)];
 
+// Panel messages have been buffered from NVM (on the first alarm message, the alarm NVM structure is deferred)
+static bool alarmPanelMsgsBuffered = false;
+
 // Structure for all alarm state definitions
 static alarmStateMsgDefinitions alarmHomeStates[] = {{ALARM_DISARMED, "\x0c" "DISARMED " "\x1b\x1b\x13\x01\x1b\x1b"},
                                                      {ALARM_DISARMED, alarmPanelStateMsgDisarmed},
@@ -124,19 +127,18 @@ static char alarmMsgBuffer[ALARM_MSG_BUFFER];
 static HardwareSerial *alarmSerial;
 
 /**
-    Alarm module init.
-    Sets up the serial bus.
-
-    @param[in]     serialPort pointer to the serial port to be used for the alarm.
-    @return        pointer to the serial port used for the alarm.
+    Alarm module re-init.
+    Buffers the panel messages from the RAM mirror (does not touch the serial bus).
 */
-HardwareSerial* const alarmInit(HardwareSerial* const serialPort) {
+void alarmReinit(void) {
     // Pointer to the RAM mirror
     const nvmCompleteStructure * ramMirrorPtr;
 
     // Set-up pointer to RAM mirror
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
 
+    nvmValidateStructure(nvmAlarmStruc);
+
     // Buffer panel armed message from NVM (and append constant part of the string)
     strncpy(alarmPanelStateMsgArmed, ramMirrorPtr->alarm.homeAddress, sizeof(ramMirrorPtr->alarm.homeAddress));
     strncat(alarmPanelStateMsgArmed, ALARM_PANEL_TEXT_CMN_ARM, sizeof(ALARM_PANEL_TEXT_CMN_ARM));
@@ -145,6 +147,18 @@ HardwareSerial* const alarmInit(HardwareSerial* const serialPort) {
     strncpy(alarmPanelStateMsgDisarmed, ramMirrorPtr->alarm.homeAddress, sizeof(ramMirrorPtr->alarm.homeAddress));
     strncat(alarmPanelStateMsgDisarmed, ALARM_PANEL_TEXT_CMN_DISARM, sizeof(ALARM_PANEL_TEXT_CMN_DISARM));
 
+    alarmPanelMsgsBuffered = true;
+}
+
+/**
+    Alarm module init.
+    Sets up the serial bus, the panel messages are buffered from NVM when the first alarm message arrives.
+
+    @param[in]     serialPort pointer to the serial port to be used for the alarm.
+    @return        pointer to the serial port used for the alarm.
+*/
+HardwareSerial* const alarmInit(HardwareSerial* const serialPort) {
+
     // Set-up serial interface to the alarm
     alarmSerial = serialPort;
     alarmSerial->begin(ALARM_SERIAL_BAUD);
@@ -160,42 +174,37 @@ HardwareSerial* const alarmInit(HardwareSerial* const serialPort) {
 */
 static void alarmDetailedMessageDebug(char* const rawMessage) {
         // Debug message
-        String debugMessage;
+        debugString debugMessage;
 
-        // Temp storage for a hex char
-        char hexChar[2];
+        // Temp storage for a hex char and trailing space
+        char hexChar[4];
 
         // Print detailed message debug
-        debugMessage = String() + "Alarm Msg " + alarmRxMsgTotal + " Time:     ";
-        debugPrint(&debugMessage, brblack);    
-        debugMessage = String() + millis() + "ms";
-        debugPrintln(&debugMessage, white);
-
-        debugMessage = String() + "Alarm Msg " + alarmRxMsgTotal + " Length:   ";
-        debugPrint(&debugMessage, brblack);    
-        debugMessage = String() + strlen(rawMessage);
-        debugPrintln(&debugMessage, white);
-
-        debugMessage = String() + "Alarm Msg " + alarmRxMsgTotal + " Contents: ";
-        debugPrint(&debugMessage, brblack);    
-        debugMessage = String() + rawMessage;
-        debugPrint(&debugMessage, white);
-        debugMessage = String() + ".";
-        debugPrintln(&debugMessage, brblack);
-
-        debugMessage = String() + "Alarm Msg " + alarmRxMsgTotal + " Contents: ";
-        debugPrint(&debugMessage, brblack);    
+        debugMessage.format("Alarm Msg %lu Time:     ", alarmRxMsgTotal);
+        debugPrint(debugMessage.c_str(), brblack);    
+        debugMessage.format("%lums", millis());
+        debugPrintln(debugMessage.c_str(), white);
+
+        debugMessage.format("Alarm Msg %lu Length:   ", alarmRxMsgTotal);
+        debugPrint(debugMessage.c_str(), brblack);    
+        debugMessage.format("%u", (unsigned int)strlen(rawMessage));
+        debugPrintln(debugMessage.c_str(), white);
+
+        debugMessage.format("Alarm Msg %lu Contents: ", alarmRxMsgTotal);
+        debugPrint(debugMessage.c_str(), brblack);    
+        debugPrint(rawMessage, white);
+        debugPrintln(".", brblack);
+
+        debugMessage.format("Alarm Msg %lu Contents: ", alarmRxMsgTotal);
+        debugPrint(debugMessage.c_str(), brblack);    
 
         for (unsigned int i = 0; i < strlen(rawMessage); i++) {
             
-            sprintf(hexChar, "%.2X", rawMessage[i]);
-            
-            debugMessage = String() + hexChar + " ";
-            debugPrint(&debugMessage, white);   
+            snprintf(hexChar, sizeof(hexChar), "%.2X ", (unsigned char)rawMessage[i]);
+            debugPrint(hexChar, white);   
         }
         
-        debugMessage = "";
-        debugPrintln(&debugMessage, white);
+        debugPrintln("", white);
 }
 #endif
 
@@ -341,6 +350,12 @@ void alarmBackgroundLoop(void) {
         else if ((charRead == ALARM_MSG_END) && (alarmMsgBufferPopulationStarted == true)) {
             alarmMsgBufferPopulationStarted = false;
             alarmRxMsgTotal++;
+
+            // Buffer the panel messages from NVM on the first message (keeps the alarm NVM structure out of set-up)
+            if (alarmPanelMsgsBuffered == false) {
+                alarmReinit();
+            }
+
             alarmUpdateHome(alarmMsgBuffer);
         }
 
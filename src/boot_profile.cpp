@@ -0,0 +1,129 @@
+#include <Arduino.h>
+
+#include "boot_profile.h"
+
+#include "debug.h"
+#include "messages_tx.h"
+
+
+// Maximum number of boot steps recorded (including the first MQTT connection)
+#define BOOT_PROFILE_STEPS          (16)
+
+// Name of the final step (first MQTT connection)
+#define BOOT_PROFILE_STEP_MQTT      ("mqttConnected")
+
+// Name for the step
+#define BOOT_PROFILE_NAME_STEP      ("step")
+
+// Name for the step duration
+#define BOOT_PROFILE_NAME_DURATION  ("duration")
+
+// Name for the cumulative time since boot
+#define BOOT_PROFILE_NAME_CUMULATIVE ("cumulative")
+
+
+// Structure for a recorded boot step
+typedef struct {
+    const char*             name;
+    unsigned long           durationuS;
+    unsigned long           cumulativeuS;
+} bootProfileStepRecord;
+
+
+// Module name for debug messages
+static const char* bootProfileModuleName = "bootProfile";
+
+// Recorded boot steps
+static bootProfileStepRecord bootProfileSteps[BOOT_PROFILE_STEPS];
+
+// Number of recorded boot steps
+static unsigned int bootProfileStepCount = 0;
+
+// Boot profile has been transmitted
+static bool bootProfileTransmitted = false;
+
+// Step being transmitted
+static const char * bootProfileTxStep = "";
+
+// Duration of the step being transmitted (in uS)
+static unsigned long bootProfileTxDurationuS = 0;
+
+// Cumulative time of the step being transmitted (in uS)
+static unsigned long bootProfileTxCumulativeuS = 0;
+
+// Boot profile data
+static const bootProfileData bootProfileDataTable = {BOOT_PROFILE_NAME_STEP,        &bootProfileTxStep,
+                                                     BOOT_PROFILE_NAME_DURATION,    &bootProfileTxDurationuS,
+                                                     BOOT_PROFILE_NAME_CUMULATIVE,  &bootProfileTxCumulativeuS
+};
+
+
+/**
+    Record the end of a boot step.
+
+    @param[in]     stepName pointer to the step name (must be static).
+*/
+static void bootProfileRecordStep(const char * const stepName) {
+
+    // Snapshot the current time (in uS)
+    const unsigned long currentTimeuS = micros();
+
+    // End of the previous step (in uS)
+    unsigned long previousTimeuS = 0;
+
+    if (bootProfileStepCount < BOOT_PROFILE_STEPS) {
+
+        if (bootProfileStepCount > 0) {
+            previousTimeuS = bootProfileSteps[bootProfileStepCount - 1].cumulativeuS;
+        }
+
+        bootProfileSteps[bootProfileStepCount].name = stepName;
+        bootProfileSteps[bootProfileStepCount].durationuS = currentTimeuS - previousTimeuS;
+        bootProfileSteps[bootProfileStepCount].cumulativeuS = currentTimeuS;
+        bootProfileStepCount++;
+    }
+}
+
+/**
+    Mark the end of a boot step.
+    The step duration is the time since the previous step ended (or since boot for the first step).
+
+    @param[in]     stepName pointer to the step name (must be static).
+*/
+void bootProfileStep(const char * const stepName) {
+
+    // The last record is kept for the first MQTT connection
+    if ((bootProfileTransmitted == false) && (bootProfileStepCount < (BOOT_PROFILE_STEPS - 1))) {
+        bootProfileRecordStep(stepName);
+    }
+}
+
+/**
+    Transmit the boot profile.
+    Marks the time to the first MQTT connection as the final step.
+    Only transmits once per boot.
+*/
+void bootProfileTransmitBootMessage(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    if (bootProfileTransmitted == false) {
+        bootProfileRecordStep(BOOT_PROFILE_STEP_MQTT);
+
+        // Set first, transmitting can reconnect
+        bootProfileTransmitted = true;
+
+        debugMessage.format("%luus from boot to MQTT connected", bootProfileSteps[bootProfileStepCount - 1].cumulativeuS);
+        debugLog(debugMessage.c_str(), bootProfileModuleName, info);
+
+        // One message per step so each fits into a MQTT packet
+        for (unsigned int i = 0; i < bootProfileStepCount; i++) {
+            bootProfileTxStep = bootProfileSteps[i].name;
+            bootProfileTxDurationuS = bootProfileSteps[i].durationuS;
+            bootProfileTxCumulativeuS = bootProfileSteps[i].cumulativeuS;
+
+            messsagesTxBootMessage(&bootProfileDataTable);
+        }
+    }
+}
@@ -0,0 +1,344 @@
+#include <Arduino.h>
+
+#include "config.h"
+
+#include "utils.h"
+#include "debug.h"
+#include "messages_tx.h"
+#include "mqtt.h"
+#include "log_sink.h"
+#include "alarm.h"
+#include "reset_ctrl.h"
+#include "status_ctrl.h"
+#include "hawkbit_client.h"
+
+
+// Number of values in one config message (keeps the message inside the MQTT buffer)
+#define CONFIG_VALUES_PER_MESSAGE       (4)
+
+// Size of a string value buffer (largest string field plus end of string)
+#define CONFIG_VALUE_STRING_SIZE        (NVM_MAX_LENGTH_HTTP_TOKEN + 1)
+
+// JSON key for the fields to write
+#define CONFIG_JSON_SET                 ("set")
+
+// JSON key for the fields to read
+#define CONFIG_JSON_GET                 ("get")
+
+// JSON value to read all fields
+#define CONFIG_JSON_GET_ALL             ("*")
+
+
+// Module name for debug messages
+static const char* configModuleName = "config";
+
+// Values for a config message
+static configValueData configValues[CONFIG_VALUES_PER_MESSAGE];
+
+// String storage for the values in a config message (RAM mirror strings are not always terminated)
+static char configValueStrings[CONFIG_VALUES_PER_MESSAGE][CONFIG_VALUE_STRING_SIZE];
+
+// Re-init for each NVM structure, a structure can have more than one entry
+// Not listed: network (OTA password and WiFi AP password are only read at start-up)
+static const configReinitEntry configReinitTable[] = {{nvmMqttStruc,        mqttReinit},
+                                                      {nvmMqttStruc,        logSinkReinit},
+                                                      {nvmIOStruc,          statusCtrlInit},
+                                                      {nvmIOStruc,          restCtrlReinit},
+                                                      {nvmAlarmStruc,       alarmReinit},
+                                                      {nvmHawkbitStruc,     hawkbitClientInit}
+};
+
+
+// Local function definitions
+static int configFindField(const char * const name);
+static bool configSetField(const configField * const fieldPtr, const JsonVariant value, uint32_t * const changedStructuresPtr);
+static void configTransmitFields(const bool * const reportFields);
+static void configCommitComplete(void);
+
+
+/**
+    Find a configuration field by name.
+
+    @param[in]     name pointer to the field name.
+    @return        index of the field (-1 when not found).
+*/
+static int configFindField(const char * const name) {
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    int returnValue = -1;
+
+    for (unsigned int i = 0; (i < configFieldCount) && (name != NULL); i++) {
+        if (strcmp(name, configFields[i].fieldName) == 0) {
+            returnValue = i;
+            break;
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Write a configuration field into the RAM mirror.
+    Values are validated first (type, length and range), the RAM mirror is only written when the value changes.
+
+    @param[in]     fieldPtr pointer to the field.
+    @param[in]     value JSON value to write.
+    @param[out]    changedStructuresPtr pointer to the mask of changed structures (updated).
+    @return        true when the value was valid.
+*/
+static bool configSetField(const configField * const fieldPtr, const JsonVariant value, uint32_t * const changedStructuresPtr) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Address of the field in the RAM mirror
+    uint8_t * const fieldAddress = ((uint8_t *)ramMirrorPtr) + fieldPtr->fieldOffset;
+
+    // New contents of the field
+    uint8_t newContents[CONFIG_VALUE_STRING_SIZE];
+
+    // Text for string fields
+    const char * text;
+
+    // Number for number fields
+    unsigned long number;
+
+    // Number in the size of the field
+    uint8_t number8;
+    uint16_t number16;
+
+    bool returnValue = false;
+
+    memset(newContents, 0, sizeof(newContents));
+
+    switch(fieldPtr->fieldType) {
+
+        case(configTypeString):
+            text = value.as<const char*>();
+
+            // Must leave room for the end of string
+            if ((value.is<const char*>() == true) && (text != NULL) && (strlen(text) < fieldPtr->fieldSize)) {
+                memcpy(newContents, text, strlen(text));
+                returnValue = true;
+            }
+            break;
+
+        case(configTypeUint8):
+        case(configTypeUint16):
+            number = value.as<unsigned long>();
+
+            if ((value.is<unsigned long>() == true) && (number <= fieldPtr->fieldMaximum)) {
+                number8 = (uint8_t) number;
+                number16 = (uint16_t) number;
+                memcpy(newContents, (fieldPtr->fieldType == configTypeUint8) ? (const void *)&number8 : (const void *)&number16, fieldPtr->fieldSize);
+                returnValue = true;
+            }
+            break;
+    }
+
+    // Only touch the RAM mirror when the contents change
+    if ((returnValue == true) && (fieldPtr->fieldSize <= sizeof(newContents)) && (memcmp(fieldAddress, newContents, fieldPtr->fieldSize) != 0)) {
+        memcpy(fieldAddress, newContents, fieldPtr->fieldSize);
+        *changedStructuresPtr |= CONFIG_STRUCTURE_BIT(fieldPtr->fieldStructure);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Transmit the requested configuration fields.
+    Secret fields are never transmitted. Sends CONFIG_VALUES_PER_MESSAGE values per message.
+
+    @param[in]     reportFields pointer to the flags for the fields to report (one per field).
+*/
+static void configTransmitFields(const bool * const reportFields) {
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Address of the field in the RAM mirror
+    const uint8_t * fieldAddress;
+
+    // Number of values in the current message
+    unsigned int valueCount = 0;
+
+    // Number in the size of the field
+    uint8_t number8;
+    uint16_t number16;
+
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+
+        if ((reportFields[i] == true) && (configFields[i].fieldSecret == false)) {
+            fieldAddress = ((const uint8_t *)ramMirrorPtr) + configFields[i].fieldOffset;
+
+            configValues[valueCount].valueName = configFields[i].fieldName;
+            configValues[valueCount].valueType = configFields[i].fieldType;
+            configValues[valueCount].valueStringPtr = configValueStrings[valueCount];
+            configValues[valueCount].valueNumber = 0;
+
+            if (configFields[i].fieldType == configTypeString) {
+                memset(configValueStrings[valueCount], 0, CONFIG_VALUE_STRING_SIZE);
+                memcpy(configValueStrings[valueCount], fieldAddress, min(configFields[i].fieldSize, (size_t)(CONFIG_VALUE_STRING_SIZE - 1)));
+            }
+            else if (configFields[i].fieldType == configTypeUint8) {
+                memcpy(&number8, fieldAddress, sizeof(number8));
+                configValues[valueCount].valueNumber = number8;
+            }
+            else {
+                memcpy(&number16, fieldAddress, sizeof(number16));
+                configValues[valueCount].valueNumber = number16;
+            }
+
+            valueCount++;
+        }
+
+        // Message full or last field
+        if ((valueCount == CONFIG_VALUES_PER_MESSAGE) || ((valueCount > 0) && (i == (configFieldCount - 1)))) {
+            messsagesTxConfigMessage(configValues, &valueCount);
+            valueCount = 0;
+        }
+    }
+}
+
+/**
+    Background commit of the configuration changes complete.
+*/
+static void configCommitComplete(void) {
+    debugLog("Configuration changes committed to NVM.", configModuleName, info);
+}
+
+/**
+    Apply changed NVM structures in place.
+    Calls the re-init of every module that buffers data from a changed structure.
+    The RAM mirror must already hold the new values (and updated CRC's).
+
+    @param[in]     changedStructures mask of changed structures (CONFIG_STRUCTURE_BIT).
+*/
+void configApply(const uint32_t changedStructures) {
+
+    // Debug message
+    debugString debugMessage;
+
+    for (unsigned int i = 0; i < (sizeof(configReinitTable) / sizeof(configReinitTable[0])); i++) {
+        if ((changedStructures & CONFIG_STRUCTURE_BIT(configReinitTable[i].structure)) != 0) {
+            configReinitTable[i].reinitFunction();
+        }
+    }
+
+    if ((changedStructures & CONFIG_STRUCTURE_BIT(nvmNetworkStruc)) != 0) {
+        debugLog("Network settings apply after the next reboot.", configModuleName, warning);
+    }
+
+    debugMessage.format("Applied configuration changes (structures 0x%08lx)", (unsigned long)changedStructures);
+    debugLog(debugMessage.c_str(), configModuleName, info);
+}
+
+/**
+    Handle a module config command.
+    Writes the "set" fields into the RAM mirror, commits once, reports the "get" and "set" fields and applies the changes in place.
+
+    @param[in]     docPtr pointer to the JSON document holding the command.
+*/
+void configCommand(JsonDocument * const docPtr) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    // Fields to report
+    bool reportFields[CONFIG_FIELDS_MAX];
+
+    // Mask of changed structures
+    uint32_t changedStructures = 0;
+
+    // Index of a field
+    int fieldIndex;
+
+    // Fields to write
+    JsonObject setFields = (*docPtr)[CONFIG_JSON_SET].as<JsonObject>();
+
+    // Fields to read
+    JsonVariant getFields = (*docPtr)[CONFIG_JSON_GET];
+
+    // Fields of deferred NVM structures are read and written below
+    nvmValidateDeferred();
+
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+        reportFields[i] = false;
+    }
+
+    // Write all fields into the RAM mirror first
+    for (JsonPair setField : setFields) {
+        fieldIndex = configFindField(setField.key().c_str());
+
+        if ((fieldIndex >= 0) && (configSetField(&configFields[fieldIndex], setField.value(), &changedStructures) == true)) {
+            reportFields[fieldIndex] = true;
+        }
+        else {
+            debugMessage.format("Invalid config field %s", setField.key().c_str());
+            debugLog(debugMessage.c_str(), configModuleName, error);
+        }
+    }
+
+    // Read all fields
+    if ((getFields.is<const char*>() == true) && (strcmp(getFields.as<const char*>(), CONFIG_JSON_GET_ALL) == 0)) {
+        for (unsigned int i = 0; i < configFieldCount; i++) {
+            reportFields[i] = true;
+        }
+    }
+
+    // Read the listed fields
+    else {
+        for (JsonVariant getField : getFields.as<JsonArray>()) {
+            fieldIndex = configFindField(getField.as<const char*>());
+
+            if (fieldIndex >= 0) {
+                reportFields[fieldIndex] = true;
+            }
+            else {
+                debugMessage.format("Unknown config field %s", getField.as<const char*>());
+                debugLog(debugMessage.c_str(), configModuleName, error);
+            }
+        }
+    }
+
+    // Single commit for the whole batch
+    if (changedStructures != 0) {
+        for (unsigned int i = 0; i < nvmNumberOfTypes; i++) {
+            if ((changedStructures & CONFIG_STRUCTURE_BIT(i)) != 0) {
+                nvmUpdateRamMirrorCrcByIndex(i);
+            }
+        }
+
+        nvmComittRamMirrorAsync(configCommitComplete);
+    }
+
+    // Report before applying (applying can drop the MQTT connection)
+    configTransmitFields(reportFields);
+
+    if (changedStructures != 0) {
+        configApply(changedStructures);
+    }
+}
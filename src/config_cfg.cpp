@@ -0,0 +1,48 @@
+#include <Arduino.h>
+
+#include "config_cfg.h"
+#include "utils.h"
+
+
+// Offset of a field in nvmCompleteStructure
+#define CONFIG_FIELD_OFFSET(member)     (offsetof(nvmCompleteStructure, member))
+
+// Size of a field in nvmCompleteStructure
+#define CONFIG_FIELD_SIZE(member)       (sizeof(((nvmCompleteStructure *)0)->member))
+
+
+// Configuration fields (the NVM core data is not configurable)
+static const configField configFields[] = {{"otaPassword",             configTypeString,   nvmNetworkStruc,  CONFIG_FIELD_OFFSET(network.otaPassword),         CONFIG_FIELD_SIZE(network.otaPassword),         0,          true},
+                                           {"wifiAPPassword",          configTypeString,   nvmNetworkStruc,  CONFIG_FIELD_OFFSET(network.wifiAPPassword),      CONFIG_FIELD_SIZE(network.wifiAPPassword),      0,          true},
+                                           {"mqttServer",              configTypeString,   nvmMqttStruc,     CONFIG_FIELD_OFFSET(mqtt.mqttServer),             CONFIG_FIELD_SIZE(mqtt.mqttServer),             0,          false},
+                                           {"mqttUser",                configTypeString,   nvmMqttStruc,     CONFIG_FIELD_OFFSET(mqtt.mqttUser),               CONFIG_FIELD_SIZE(mqtt.mqttUser),               0,          false},
+                                           {"mqttPassword",            configTypeString,   nvmMqttStruc,     CONFIG_FIELD_OFFSET(mqtt.mqttPassword),           CONFIG_FIELD_SIZE(mqtt.mqttPassword),           0,          true},
+                                           {"mqttTopicRoot",           configTypeString,   nvmMqttStruc,     CONFIG_FIELD_OFFSET(mqtt.mqttTopicRoot),          CONFIG_FIELD_SIZE(mqtt.mqttTopicRoot),          0,          false},
+                                           {"ledBrightnessRunMode",    configTypeUint16,   nvmIOStruc,       CONFIG_FIELD_OFFSET(io.ledBrightnessRunMode),     CONFIG_FIELD_SIZE(io.ledBrightnessRunMode),     PWMRANGE,   false},
+                                           {"ledBrightnessConfigMode", configTypeUint16,   nvmIOStruc,       CONFIG_FIELD_OFFSET(io.ledBrightnessConfigMode),  CONFIG_FIELD_SIZE(io.ledBrightnessConfigMode),  PWMRANGE,   false},
+                                           {"resetSwitchEnabled",      configTypeUint8,    nvmIOStruc,       CONFIG_FIELD_OFFSET(io.resetSwitchEnabled),       CONFIG_FIELD_SIZE(io.resetSwitchEnabled),       ENABLED,    false},
+                                           {"homeAddress",             configTypeString,   nvmAlarmStruc,    CONFIG_FIELD_OFFSET(alarm.homeAddress),           CONFIG_FIELD_SIZE(alarm.homeAddress),           0,          false},
+                                           {"hawkbitServer",           configTypeString,   nvmHawkbitStruc,  CONFIG_FIELD_OFFSET(hawkbit.hawkbitServer),       CONFIG_FIELD_SIZE(hawkbit.hawkbitServer),       0,          false},
+                                           {"hawkbitToken",            configTypeString,   nvmHawkbitStruc,  CONFIG_FIELD_OFFSET(hawkbit.hawkbitToken),        CONFIG_FIELD_SIZE(hawkbit.hawkbitToken),        0,          true},
+                                           {"hawkbitTokenTypeIndex",   configTypeUint8,    nvmHawkbitStruc,  CONFIG_FIELD_OFFSET(hawkbit.hawkbitTokenTypeIndex), CONFIG_FIELD_SIZE(hawkbit.hawkbitTokenTypeIndex), 1,        false},
+                                           {"hawkbitTennant",          configTypeString,   nvmHawkbitStruc,  CONFIG_FIELD_OFFSET(hawkbit.hawkbitTennant),      CONFIG_FIELD_SIZE(hawkbit.hawkbitTennant),      0,          false}
+};
+
+// Number of configuration fields
+static const uint32_t configFieldCount = (sizeof(configFields) / sizeof(configFields[0]));
+
+// Make sure the fields fit in the report buffers
+static_assert((sizeof(configFields) / sizeof(configFields[0])) <= CONFIG_FIELDS_MAX, "Too many elements in <configFields>, increase CONFIG_FIELDS_MAX.");
+
+
+/**
+    Set-up read only pointer to the configuration fields.
+    Shared with the offline NVM image tool (tools/nvm_image).
+
+    @param[in]     activeConfigFields pointer for the configuration fields.
+    @return        number of configuration fields.
+*/
+const uint32_t configGetFieldsPointerRO(const configField ** activeConfigFields) {
+    *activeConfigFields = &configFields[0];
+    return(configFieldCount);
+}
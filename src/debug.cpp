@@ -3,6 +3,8 @@
 #include "debug.h"
 
 #include "utils.h"
+#include "log_sink.h"
+#include "journal.h"
 
 // esc code table
 static const escCode textColourEscCodes[] = {{"\u001b[0m",  "reset"},
@@ -43,12 +45,10 @@ HardwareSerial* const debugSetSerial(HardwareSerial* const serialPort) {
     Test esc code printing.
 */
 void escCodeTest(void) {
-    String message = "ESC code print test...";
-    debugPrintln(&message, reset);
+    debugPrintln("ESC code print test...", reset);
 
     for(unsigned int i = 0; i < (sizeof(textColourEscCodes)/sizeof(textColourEscCodes[0])); i++) {
-        //debugSerial->println(String() + textColourEscCodes[i].code + (String)i + ". " + textColourEscCodes[i].description + textColourEscCodes[textColour::reset].code);
-        debugSerial->println(String() + textColourEscCodes[i].code + i + ". " + textColourEscCodes[i].description + textColourEscCodes[textColour::reset].code);
+        debugSerial->printf("%s%u. %s%s\r\n", textColourEscCodes[i].code, i, textColourEscCodes[i].description, textColourEscCodes[textColour::reset].code);
     }
 }
 
@@ -58,58 +58,78 @@ void escCodeTest(void) {
     @param[in]     rawData pointer to the data to print.
     @param[in]     rawDataColour the colour to print the data in.
 */
-void debugPrint(String* const rawData, textColour rawDataColour) {
+void debugPrint(const char * const rawData, textColour rawDataColour) {
     #ifndef DEBUG_BW
-    debugSerial->print(String() + textColourEscCodes[rawDataColour].code + *rawData + textColourEscCodes[textColour::reset].code);
+    debugSerial->print(textColourEscCodes[rawDataColour].code);
+    debugSerial->print(rawData);
+    debugSerial->print(textColourEscCodes[textColour::reset].code);
     #else
-    debugSerial->print(*rawData);
+    debugSerial->print(rawData);
     #endif  
 }
 
+/**
+    Prints to the debug serial port.
+
+    @param[in]     rawData pointer to the data to print.
+    @param[in]     rawDataColour the colour to print the data in.
+*/
+void debugPrint(String* const rawData, textColour rawDataColour) {
+    debugPrint(rawData->c_str(), rawDataColour);
+}
+
 /**
     Prints a line to the debug serial port.
 
     @param[in]     rawData pointer to the data to print.
     @param[in]     rawDataColour the colour to print the data in.
 */
-void debugPrintln(String* const rawData, textColour rawDataColour) {
+void debugPrintln(const char * const rawData, textColour rawDataColour) {
     #ifndef DEBUG_BW
-    debugSerial->println(String() + textColourEscCodes[rawDataColour].code + *rawData + textColourEscCodes[textColour::reset].code);
+    debugSerial->print(textColourEscCodes[rawDataColour].code);
+    debugSerial->print(rawData);
+    debugSerial->println(textColourEscCodes[textColour::reset].code);
     #else
-    debugSerial->println(*rawData);
+    debugSerial->println(rawData);
     #endif
 }
 
 /**
-    Prints to the debug log header
+    Prints a line to the debug serial port.
 
-    @param[in]     level log level formatting to use for the header.
+    @param[in]     rawData pointer to the data to print.
+    @param[in]     rawDataColour the colour to print the data in.
 */
-static void debugLogHeader(logLevel level) {
-    
-    String header;
+void debugPrintln(String* const rawData, textColour rawDataColour) {
+    debugPrintln(rawData->c_str(), rawDataColour);
+}
 
-    char currentTime[STRNLEN_INT(MAX_VALUE_32BIT_UNSIGNED_DEC) + 1];
+/**
+    Prints to the debug log header.
+    The formatted header is also returned so it can be shared with the log sink.
 
-    // Format the current time string (keep it 10 digits so it is consistent)
-    snprintf(currentTime, sizeof(currentTime), "%10lu", millis());
+    @param[in]     level log level formatting to use for the header.
+    @param[out]    header pointer to the buffer for the formatted header.
+    @param[in]     headerSize size of the header buffer.
+*/
+static void debugLogHeader(logLevel level, char * const header, const size_t headerSize) {
 
-    // Print the header
+    // Format the header (keep the time 10 digits so it is consistent)
     switch(level) {
         case error:
-            header = String() + "[E" + currentTime + "ms] ";
-            debugPrint(&header, brred);
+            snprintf(header, headerSize, "[E%10lums] ", millis());
+            debugPrint(header, brred);
             break;
 
         case warning:
-            header = String() + "[W" + currentTime + "ms] ";
-            debugPrint(&header, bryellow); 
+            snprintf(header, headerSize, "[W%10lums] ", millis());
+            debugPrint(header, bryellow); 
             break;
 
         case info:
         default:
-            header = String() + "[I" + currentTime + "ms] ";
-            debugPrint(&header, brgreen); 
+            snprintf(header, headerSize, "[I%10lums] ", millis());
+            debugPrint(header, brgreen); 
             break;
     }
 }
@@ -120,13 +140,20 @@ static void debugLogHeader(logLevel level) {
     @param[in]     message pointer to the message to be printed.
     @param[in]     level log level formatting to use for the header.
 */
-void debugLog(String* const message, logLevel level) {    
+void debugLog(const char * const message, logLevel level) {    
     
+    // Formatted header
+    char header[DEBUG_LOG_HEADER_SIZE];
+
     // Print the header
-    debugLogHeader(level);
+    debugLogHeader(level, header, sizeof(header));
 
     // Print the remainder of the message
     debugPrintln(message, reset);        
+
+    // Pass the record to the log sink and journal
+    logSinkRecord(level, header, NULL, message);
+    journalRecord(level, NULL, message);
 }
 
 /**
@@ -136,16 +163,42 @@ void debugLog(String* const message, logLevel level) {
     @param[in]     module module printing to the log.
     @param[in]     level log level formatting to use for the header.
 */
-void debugLog(String* const message, const char * const module, logLevel level) {
+void debugLog(const char * const message, const char * const module, logLevel level) {
 
-    String header;
+    // Formatted header
+    char header[DEBUG_LOG_HEADER_SIZE];
 
     // Print the header
-    debugLogHeader(level);
+    debugLogHeader(level, header, sizeof(header));
     
-    header = String() + module + ": ";
-    debugPrint(&header, brwhite); 
+    debugPrint(module, brwhite); 
+    debugPrint(": ", brwhite); 
 
     // Print the remainder of the message
     debugPrintln(message, reset);
+
+    // Pass the record to the log sink and journal
+    logSinkRecord(level, header, module, message);
+    journalRecord(level, module, message);
+}
+
+/**
+    Prints to the log.
+
+    @param[in]     message pointer to the message to be printed.
+    @param[in]     level log level formatting to use for the header.
+*/
+void debugLog(String* const message, logLevel level) {
+    debugLog(message->c_str(), level);
+}
+
+/**
+    Prints to the log.
+
+    @param[in]     message pointer to the message to be printed.
+    @param[in]     module module printing to the log.
+    @param[in]     level log level formatting to use for the header.
+*/
+void debugLog(String* const message, const char * const module, logLevel level) {
+    debugLog(message->c_str(), module, level);
 }
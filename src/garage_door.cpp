@@ -50,11 +50,7 @@ static void garageDoorUpdateAjarString(void) {
 */
 void garageDoorInit(void) {
 
-    // Debug message
-    String debugMessage;
-    
-    debugMessage = String() + "Init";
-    debugLog(&debugMessage, garageDoorModuleName, info);
+    debugLog("Init", garageDoorModuleName, info);
     
     garageDoorUpdateAjarString();
 }
@@ -72,7 +68,7 @@ void garageDoorFireOneShot(void) {
 static void garageDoorAjarCheck(void) {   
     
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
     
     garageDoorAjarStates garageDoorAjarNextState;
 
@@ -94,8 +90,8 @@ static void garageDoorAjarCheck(void) {
         garageDoorAjarState = garageDoorAjarNextState;
         garageDoorUpdateAjarString();
 
-        debugMessage = String() + "Garage door ajar state changed to " + garageDoorAjarStateString + " (" + garageDoorAjarState + ")";
-        debugLog(&debugMessage, garageDoorModuleName, info);
+        debugMessage.format("Garage door ajar state changed to %s (%d)", garageDoorAjarStateString, (int)garageDoorAjarState);
+        debugLog(debugMessage.c_str(), garageDoorModuleName, info);
 
         garageDoorTransmitDoorStatusMessage();
     }
@@ -2,34 +2,88 @@
 #include <ESP8266HTTPClient.h>
 #include <ESP8266WiFi.h>
 #include <ArduinoJson.h>
-#include <ESP8266httpUpdate.h>
+#include <Updater.h>
 
 #include "hawkbit_client.h"
+#include "hawkbit_download.h"
+#include "hawkbit_poll.h"
 
 #include "utils.h"
 #include "debug.h"
+#include "fixed_string.h"
 #include "nvm_cfg.h"
 #include "reset_ctrl.h"
 #include "wifi.h"
 #include "version.h"
 
 
-// Two step process as defined in - https://arduino-esp8266.readthedocs.io/en/latest/ota_updates/readme.html
-// Stops bricking upon crash / power outage during update
-#define ATOMIC_FS_UPDATE
-
 // Set the module call interval
 #define MODULE_CALL_INTERVAL                HAWKBIT_CLIENT_CYCLIC_RATE
 
-// TODO: Fix this poll rate, way too fast
-// Time to stay in idle state in S
-#define HAWKBIT_CLIENT_IDLE_TIME_RST_S      (30)
+// Size of the JSON document (responses are filtered, only the fields used are kept)
+#define HAWKBIT_CLIENT_JSON_DOCUMENT_SIZE   (768)
+
+// Size of the JSON deserialisation filter
+#define HAWKBIT_CLIENT_JSON_FILTER_SIZE     (192)
+
+// Minimum time between deployment progress updates in mS
+#define HAWKBIT_CLIENT_PROGRESS_INTERVAL_MS (5000)
+
+// Attempts to send the final deployment status and time between attempts in S
+#define HAWKBIT_CLIENT_ACK_ATTEMPTS         (5)
+#define HAWKBIT_CLIENT_ACK_RETRY_S          (10)
+
+// Capacity of a server path / href
+#define HAWKBIT_CLIENT_URL_SIZE             (256)
+
+// Capacity of an action ID
+#define HAWKBIT_CLIENT_ID_SIZE              (32)
+
+// Capacity of an update result message
+#define HAWKBIT_CLIENT_RESULT_SIZE          (96)
+
+// Size of the serialised JSON payload for POST / PUT
+#define HAWKBIT_CLIENT_TX_PAYLOAD_SIZE      (512)
+
+// Capacity of a server host name
+#define HAWKBIT_CLIENT_HOST_SIZE            (64)
+
+// Default HTTP port
+#define HAWKBIT_CLIENT_HTTP_PORT            (80)
+
+// Filename extension of a gzip artifact
+#define HAWKBIT_CLIENT_GZIP_EXTENSION       (".gz")
+
+// Attempts for a HTTP request (a kept alive connection can be closed by the server, then one retry on a new connection)
+#define HAWKBIT_CLIENT_HTTP_ATTEMPTS        (2)
+
+
+// Server path / href string
+typedef fixedString<HAWKBIT_CLIENT_URL_SIZE> hawkbitClientUrlString;
+
+// Action ID string
+typedef fixedString<HAWKBIT_CLIENT_ID_SIZE> hawkbitClientIdString;
+
+// Update result string
+typedef fixedString<HAWKBIT_CLIENT_RESULT_SIZE> hawkbitClientResultString;
+
+// Server host name string
+typedef fixedString<HAWKBIT_CLIENT_HOST_SIZE> hawkbitClientHostString;
 
-// Size of the JSON document
-#define HAWKBIT_CLIENT_JSON_DOCUMENT_SIZE   (1024)
+// Structure for the deployment progress
+typedef struct {
+    uint32_t progress;          // Bytes written
+    uint32_t total;             // Bytes to write
+    bool pending;               // Changed since it was last sent
+    uint32_t lastSent;          // Time it was last sent (mS)
+} hawkbitClientProgressData;
 
-// Threshold % for sending programming status update
-#define HAWKBIT_CLIENT_THRESOLD_STATUS_SEND (6)
+// Structure for the connection statistics
+typedef struct {
+    uint32_t requests;          // HTTP requests sent
+    uint32_t connections;       // Connections set-up
+    uint32_t connectTime;       // Time setting up connections (mS)
+} hawkbitClientConnectionStats;
 
 
 // HTTP REST API types
@@ -57,6 +111,7 @@ static const char * hawkbitClientStateNames[] {
     "stmHawkbitCancel",
     "stmHawkbitCancelAck",
     "stmHawkbitDeploy",
+    "stmHawkbitDownload",
     "stmHawkbitDeployAck",
     "stmHawkbitWaitReboot",
     "stmHawkbitConfig"
@@ -80,33 +135,289 @@ static uint8_t hawkbitTokenTypeIndex;
 // JSON static document
 static StaticJsonDocument<HAWKBIT_CLIENT_JSON_DOCUMENT_SIZE> doc; 
 
+// JSON deserialisation filter (fields a state reads from its response)
+static StaticJsonDocument<HAWKBIT_CLIENT_JSON_FILTER_SIZE> hawkbitClientFilter;
+
 // Current state
 static hawkbitClientStm hawkbitClientCurrentState;
 
+// Client has been initialised (on the first state machine call, the hawkbit NVM structure is deferred)
+static bool hawkbitClientInitialised = false;
+
 // Hawkbit base server API path
-String hawkbitClientServerPathBase;
+static hawkbitClientUrlString hawkbitClientServerPathBase;
+
+// Feedback server path (shared, only used by the state machine: the progress in the download state and the acknowledge states, one state per call)
+static hawkbitClientUrlString hawkbitClientFeedbackPath;
+
+// Serialised JSON payload for POST / PUT
+static char hawkbitClientTxPayload[HAWKBIT_CLIENT_TX_PAYLOAD_SIZE];
+
+// Persistent wifi and http client (wifi must be defined first)
+static WiFiClient hawkbitClientWifi;
+static HTTPClient hawkbitClientHttpClient;
+
+// Host and port of the persistent connection
+static hawkbitClientHostString hawkbitClientConnectedHost;
+static uint16_t hawkbitClientConnectedPort;
+
+// Connection statistics (reset every poll, so cover a whole deployment)
+static hawkbitClientConnectionStats hawkbitClientStats;
+
+// Download wifi and http client (wifi must be defined first, the artifact server can differ from the API server)
+static WiFiClient hawkbitClientDownloadWifi;
+static HTTPClient hawkbitClientDownloadHttpClient;
+
+// Download in progress
+static bool hawkbitClientDownloadActive;
+
+// Time the download started (mS)
+static uint32_t hawkbitClientDownloadStart;
+
+// Deployment progress (set by the download, sent by the state machine)
+static hawkbitClientProgressData hawkbitClientProgress;
+
+// Result of the update, empty string on success OR string with failure message
+static hawkbitClientResultString hawkbitClientUpdateResult;
+
+// Poll state (server interval, failed polls, active action and first poll)
+static hawkbitPollState hawkbitClientPoll;
+
+
+/**
+    Read the poll interval sent by the server.
+
+    @param[in]     sleep pointer to the interval string (NULL when not sent).
+*/
+static void hawkbitClientSetPollSleep(const char * const sleep) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // New interval in S
+    const uint32_t pollSleep = hawkbitPollParseSleep(sleep, hawkbitClientPoll.sleep);
+
+    if (pollSleep != hawkbitClientPoll.sleep) {
+        hawkbitClientPoll.sleep = pollSleep;
+
+        debugMessage.format("Server poll interval %lus", (unsigned long)hawkbitClientPoll.sleep);
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
+    }
+}
+
+
+/**
+    Choose the artifact to download from a deployment chunk.
+    A gzip artifact (HAWKBIT_CLIENT_GZIP_EXTENSION) is preferred, the updater stores it compressed and the boot loader decompresses it.
+    Otherwise the first artifact is used.
+
+    @param[in]     artifacts the artifacts of the chunk.
+    @param[out]    hrefPtr pointer to the download href (empty when there are no artifacts).
+*/
+static void hawkbitClientGetArtifact(const JsonArray artifacts, hawkbitClientUrlString * const hrefPtr) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Length of the extension and the filename
+    const size_t extensionLength = strlen(HAWKBIT_CLIENT_GZIP_EXTENSION);
+    size_t filenameLength;
+
+    // Filename of the chosen artifact
+    const char * filename;
+
+    *hrefPtr = artifacts[0]["_links"]["download-http"]["href"] | "";
+    filename = artifacts[0]["filename"] | "";
+
+    for (JsonObject artifact : artifacts) {
+        const char * const artifactFilename = artifact["filename"] | "";
+        filenameLength = strlen(artifactFilename);
+
+        if ((filenameLength > extensionLength) && (strcmp(&artifactFilename[filenameLength - extensionLength], HAWKBIT_CLIENT_GZIP_EXTENSION) == 0)) {
+            *hrefPtr = artifact["_links"]["download-http"]["href"] | "";
+            filename = artifactFilename;
+            break;
+        }
+    }
+
+    debugMessage.format("Artifact %s", filename);
+    debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
+}
+
+
+/**
+    Set-up the JSON deserialisation filter for the response of a state.
+    Only the fields the state reads are kept in the document.
+
+    @param[in]     state state sending the GET.
+    @return        pointer to the filter.
+*/
+static const JsonDocument * hawkbitClientGetFilter(const hawkbitClientStm state) {
+
+    hawkbitClientFilter.clear();
+
+    switch(state) {
+
+        case(stmHawkbitPoll):
+            hawkbitClientFilter["config"]["polling"]["sleep"] = true;
+            hawkbitClientFilter["_links"]["cancelAction"]["href"] = true;
+            hawkbitClientFilter["_links"]["configData"]["href"] = true;
+            hawkbitClientFilter["_links"]["deploymentBase"]["href"] = true;
+            break;
+
+        case(stmHawkbitCancel):
+            hawkbitClientFilter["cancelAction"]["stopId"] = true;
+            break;
+
+        // Array filters apply to every element (every chunk and artifact keeps its download href)
+        case(stmHawkbitDeploy):
+            hawkbitClientFilter["id"] = true;
+            hawkbitClientFilter["deployment"]["chunks"][0]["artifacts"][0]["filename"] = true;
+            hawkbitClientFilter["deployment"]["chunks"][0]["artifacts"][0]["_links"]["download-http"]["href"] = true;
+            break;
+
+        // Keep everything
+        default:
+            hawkbitClientFilter.set(true);
+            break;
+    }
+
+    return(&hawkbitClientFilter);
+}
+
+
+/**
+    Get the host and port from a server path.
+    Only plain HTTP paths are supported ("http://host[:port]/...").
+
+    @param[in]     serverPath the full server / API path.
+    @param[out]    hostPtr pointer to the host name.
+    @param[out]    portPtr pointer to the port.
+    @return        bool as success / failure.
+*/
+static bool hawkbitClientParseServer(const char * const serverPath, hawkbitClientHostString * const hostPtr, uint16_t * const portPtr) {
+
+    // Scheme of the server path
+    static const char scheme[] = "http://";
+
+    // Start of the host and end of the host / port
+    const char * hostStart;
+    const char * hostEnd;
+
+    // Host name (without the port)
+    char host[HAWKBIT_CLIENT_HOST_SIZE];
+
+    if ((serverPath == NULL) || (strncmp(serverPath, scheme, strlen(scheme)) != 0)) {
+        return(false);
+    }
+
+    hostStart = serverPath + strlen(scheme);
+    hostEnd = hostStart + strcspn(hostStart, ":/");
+
+    if ((hostEnd == hostStart) || ((size_t)(hostEnd - hostStart) >= sizeof(host))) {
+        return(false);
+    }
+
+    memcpy(host, hostStart, hostEnd - hostStart);
+    host[hostEnd - hostStart] = '\0';
+
+    *hostPtr = host;
+    *portPtr = (*hostEnd == ':') ? (uint16_t) strtoul(hostEnd + 1, NULL, 10) : HAWKBIT_CLIENT_HTTP_PORT;
+
+    return(*portPtr != 0);
+}
+
+/**
+    Close the persistent connection.
+*/
+static void hawkbitClientDisconnect(void) {
+    hawkbitClientWifi.stop();
+    hawkbitClientConnectedHost.clear();
+    hawkbitClientConnectedPort = 0;
+}
+
+/**
+    Make sure the persistent connection is open to the server of a server path.
+    The open connection is kept when it goes to the same host and port, otherwise a new connection is set-up (and timed).
+
+    @param[in]     serverPath the full server / API path.
+    @param[out]    reusedPtr pointer to the flag set when the open connection was kept.
+    @return        bool as success / failure.
+*/
+static bool hawkbitClientConnect(const char * const serverPath, bool * const reusedPtr) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Host and port of the server path
+    hawkbitClientHostString host;
+    uint16_t port;
+
+    // Time the connection set-up started
+    uint32_t connectStart;
+
+    bool returnValue = false;
+
+    *reusedPtr = false;
+
+    if (hawkbitClientParseServer(serverPath, &host, &port) == false) {
+        debugMessage.format("Unsupported server path %s", serverPath);
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
+    }
+
+    // Same server and still open
+    else if ((hawkbitClientWifi.connected()) && (port == hawkbitClientConnectedPort) && (strcmp(host.c_str(), hawkbitClientConnectedHost.c_str()) == 0)) {
+        *reusedPtr = true;
+        returnValue = true;
+    }
+
+    // New connection
+    else {
+        hawkbitClientDisconnect();
+
+        connectStart = millis();
+        returnValue = (hawkbitClientWifi.connect(host.c_str(), port) != 0);
+
+        hawkbitClientStats.connections++;
+        hawkbitClientStats.connectTime += millis() - connectStart;
+
+        if (returnValue == true) {
+            hawkbitClientConnectedHost = host.c_str();
+            hawkbitClientConnectedPort = port;
+        }
+        else {
+            debugMessage.format("Connection to %s:%u failed", host.c_str(), port);
+            debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
+        }
+    }
+
+    return(returnValue);
+}
 
 
 /**
     Access a HTTP REST API.
         
+    GET responses are parsed straight from the HTTP stream, only the fields in the filter are kept.
+    Requests use the persistent connection (kept alive between requests to the same server).
+    When a kept alive connection fails the request is retried once on a new connection.
+
     @param[in]     serverPath the full server / API path.
     @param[in]     docPtr pointer to the JSON buffer.
     @param[in]     apiType API type (GET/POST/PUT).
+    @param[in]     filterPtr pointer to the JSON deserialisation filter (GET only, NULL for POST/PUT).
     @return        bool as success / failure.
 */
-static bool hawkbitClientHttp(const String serverPath, JsonDocument * const docPtr, const hawkbitClientHttpRestTypes apiType) {
+static bool hawkbitClientHttp(const char * const serverPath, JsonDocument * const docPtr, const hawkbitClientHttpRestTypes apiType, const JsonDocument * const filterPtr) {
 
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
-    // Wifi and http client (wifi must be defined first)
-    WiFiClient wifi;
-    HTTPClient http;
+    // Authorisation header
+    fixedString<sizeof(hawkbitClientToken) + 16> authorisation;
 
-    // Payloads for Tx and Rx (raw HTTP message after JSON)
-    String txPayload;
-    String rxPayload;
+    // Length of the serialised Tx payload
+    size_t txPayloadLength;
     
     // Response codes for HTTP and JSON requests
     int httpResponseCode = HTTP_CODE_OK;
@@ -115,56 +426,83 @@ static bool hawkbitClientHttp(const String serverPath, JsonDocument * const docP
     // Function return value
     bool returnValue = false;
 
-    // Start the HTTP request and set the authentication
-    http.begin(wifi, serverPath.c_str());
-    http.addHeader("Authorization", String() + hawkbitTokenTypes[hawkbitTokenTypeIndex] + " " + hawkbitClientToken);
+    // The open connection was kept for the request
+    bool reused = false;
+
+    // Set the authentication
+    authorisation.format("%s %s", hawkbitTokenTypes[hawkbitTokenTypeIndex], hawkbitClientToken);
 
     // Make sure apiType is within ranage
     if (apiType < hawkbitClientHttpRestTypesTotal) {
 
-        switch(apiType) {
-
-            case hawkbitClientHttpGET:
-                http.addHeader("Accept", "application/hal+json");
-                httpResponseCode = http.GET();
-                
-                if (httpResponseCode == HTTP_CODE_OK) {
-                    rxPayload = http.getString();
+        for (unsigned int attempt = 0; attempt < HAWKBIT_CLIENT_HTTP_ATTEMPTS; attempt++) {
 
-                    docPtr->clear();
-                    jsonResponse = deserializeJson(*docPtr, rxPayload);
-                }
+            if (hawkbitClientConnect(serverPath, &reused) == false) {
+                httpResponseCode = HTTPC_ERROR_CONNECTION_REFUSED;
                 break;
+            }
 
-            case hawkbitClientHttpPOST:
-                http.addHeader("Content-Type", "application/json;charset=UTF-8");
-                (void) serializeJson(*docPtr, txPayload);
-                httpResponseCode = http.POST(txPayload);
-                break;
+            // GET uses HTTP 1.0 so the response is never chunked (the stream is parsed directly)
+            // POST / PUT responses are not read so use HTTP 1.1
+            // useHTTP10 also sets reuse (off for HTTP 1.0) so set it again, every request asks for keep-alive
+            hawkbitClientHttpClient.useHTTP10(apiType == hawkbitClientHttpGET);
+            hawkbitClientHttpClient.setReuse(true);
+            hawkbitClientHttpClient.begin(hawkbitClientWifi, serverPath);
+            hawkbitClientHttpClient.addHeader("Authorization", authorisation.c_str());
 
-            case hawkbitClientHttpPUT:
-                http.addHeader("Content-Type", "application/json;charset=UTF-8");
-                (void) serializeJson(*docPtr, txPayload);
-                httpResponseCode = http.PUT(txPayload);
-                break;
+            hawkbitClientStats.requests++;
 
-            // The range check should prevent these requests from ever being requested
-            case hawkbitClientHttpRestTypesTotal:
-            default:
-                break;
+            switch(apiType) {
+
+                case hawkbitClientHttpGET:
+                    hawkbitClientHttpClient.addHeader("Accept", "application/hal+json");
+                    httpResponseCode = hawkbitClientHttpClient.GET();
+                
+                    if ((httpResponseCode == HTTP_CODE_OK) && (filterPtr != NULL)) {
+                        docPtr->clear();
+                        jsonResponse = deserializeJson(*docPtr, hawkbitClientHttpClient.getStream(), DeserializationOption::Filter(*filterPtr));
+                    }
+                    break;
+
+                case hawkbitClientHttpPOST:
+                    hawkbitClientHttpClient.addHeader("Content-Type", "application/json;charset=UTF-8");
+                    txPayloadLength = serializeJson(*docPtr, hawkbitClientTxPayload, sizeof(hawkbitClientTxPayload));
+                    httpResponseCode = hawkbitClientHttpClient.POST((uint8_t *)hawkbitClientTxPayload, txPayloadLength);
+                    break;
+
+                case hawkbitClientHttpPUT:
+                    hawkbitClientHttpClient.addHeader("Content-Type", "application/json;charset=UTF-8");
+                    txPayloadLength = serializeJson(*docPtr, hawkbitClientTxPayload, sizeof(hawkbitClientTxPayload));
+                    httpResponseCode = hawkbitClientHttpClient.PUT((uint8_t *)hawkbitClientTxPayload, txPayloadLength);
+                    break;
+
+                // The range check should prevent these requests from ever being requested
+                case hawkbitClientHttpRestTypesTotal:
+                default:
+                    break;
+            }
+
+            // Kept alive connection closed by the server, retry on a new connection
+            if ((httpResponseCode < 0) && (reused == true)) {
+                hawkbitClientHttpClient.end();
+                hawkbitClientDisconnect();
+                continue;
+            }
+
+            break;
         }
 
         // Construct a debug string for the http operation
-        debugMessage = String() + hawkbitClientHttpRestTypeNames[apiType] + " " + serverPath + ", returned " + httpResponseCode;
+        debugMessage.format("%s %s, returned %d", hawkbitClientHttpRestTypeNames[apiType], serverPath, httpResponseCode);
 
         // Positive HTTP response
         if (httpResponseCode == HTTP_CODE_OK) {
-            debugLog(&debugMessage, hawkbitClientModuleName, info);
+            debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
 
             // JSON deserialisation problem
             if (jsonResponse) {
-                debugMessage = String() + "JSON deserialisation failed with code " + jsonResponse.f_str();
-                debugLog(&debugMessage, hawkbitClientModuleName, warning);
+                debugMessage.format("JSON deserialisation failed with code %s", jsonResponse.c_str());
+                debugLog(debugMessage.c_str(), hawkbitClientModuleName, warning);
 
                 returnValue = false;
             }
@@ -175,174 +513,190 @@ static bool hawkbitClientHttp(const String serverPath, JsonDocument * const docP
         }
 
         else {
-            debugLog(&debugMessage, hawkbitClientModuleName, error);
+            debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
 
             returnValue = false;
         }
     }
 
-    http.end();
+    // Keeps the connection open when the server allows it
+    hawkbitClientHttpClient.end();
 
     return(returnValue);
 }
 
 
 /**
-    Update status for an update action.
-    Call to set Action ID and JSON doc pointer before calling in callback.
-        
+    Set the deployment progress.
+    Only records the progress, it is sent by hawkbitClientSendProgress from the state machine.
+
     @param[in]     progress the current progress of total.
     @param[in]     total the total to program.
-    @param[in]     newActionID the action ID being processed (leave "" if called from callback).
-    @param[in]     newDocPtr pointer to the JSON doc (leave NULL if called from the callback).
 */
-static void hawkbitClientUpdateProgress(unsigned int progress, unsigned int total, const String newActionID, JsonDocument * const newDocPtr) {
-            
-    // Debug strings
-    String debugMessage;
-    char percentageCompleteString[STRNLEN_INT(MAX_PERCENTAGE_STRING) + 1];    
-    
-    // Store the action ID (only gets updated while something is passed)
-    static String actionID;
+static void hawkbitClientSetProgress(const uint32_t progress, const uint32_t total) {
 
-    // Store the pointer to the JSON doc (only gets updated while something is passed)
-    static JsonDocument * docPtr;
+    if ((progress != hawkbitClientProgress.progress) || (total != hawkbitClientProgress.total)) {
+        hawkbitClientProgress.progress = progress;
+        hawkbitClientProgress.total = total;
+        hawkbitClientProgress.pending = true;
+    }
+}
 
-    // Threshold where a new http message is sent (so it doesnt get sent everytime this is called)
-    static unsigned int percentageCompleteThresholdSend = 0;
+/**
+    Send the deployment progress for an update action.
+    Sends at most once every HAWKBIT_CLIENT_PROGRESS_INTERVAL_MS and only when the progress changed.
 
-    // Percentage of the download complete 
-    unsigned int percentageComplete;
+    @param[in]     actionID the action ID being processed.
+    @param[in]     docPtr pointer to the JSON doc.
+*/
+static void hawkbitClientSendProgress(const char * const actionID, JsonDocument * const docPtr) {
 
-    // Update pointer if it is not NULL
-    if(newDocPtr != NULL) {
-        docPtr = newDocPtr;
-    }
+    // Debug message
+    debugString debugMessage;
+
+    // Progress details (char arrays so the JSON document takes a copy)
+    char progressDetails[2][48];
+
+    // Percentage of the download complete
+    unsigned int percentageComplete;
 
-    // Update action ID and reset the trigger to send threshold if it is not empty
-    if (!newActionID.isEmpty()) {
-        actionID = newActionID;
-        percentageCompleteThresholdSend = 0;
+    if ((hawkbitClientProgress.pending == false) || ((millis() - hawkbitClientProgress.lastSent) < HAWKBIT_CLIENT_PROGRESS_INTERVAL_MS)) {
+        return;
     }
 
     // Calculate the % complete
-    if ((progress == 0) || (total == 0)) {
+    if (hawkbitClientProgress.total == 0) {
         percentageComplete = 0;
     }
     else {
-        percentageComplete = (progress / (total / 100));
+        percentageComplete = (unsigned int)((hawkbitClientProgress.progress * 100ULL) / hawkbitClientProgress.total);
     }
 
-    // Threshold to send progress response met
-    if (percentageComplete >= percentageCompleteThresholdSend) {
-        
-        snprintf(percentageCompleteString, sizeof(percentageCompleteString), "%u%%", percentageComplete);
+    debugMessage.format("Updating software %u%%", percentageComplete);
+    debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
 
-        debugMessage = String() + "Updating software " + percentageCompleteString;
-        debugLog(&debugMessage, hawkbitClientModuleName, info);
+    snprintf(progressDetails[0], sizeof(progressDetails[0]), "Progress %u%%", percentageComplete);
+    snprintf(progressDetails[1], sizeof(progressDetails[1]), "%lu of %lubytes", (unsigned long)hawkbitClientProgress.progress, (unsigned long)hawkbitClientProgress.total);
 
-        // Prepare the JSON response and send
-        docPtr->clear();
-        (*docPtr)["id"] = actionID;
-        (*docPtr)["status"]["execution"] = "proceeding";
-        (*docPtr)["status"]["result"]["finished"] = "none"; 
-        (*docPtr)["status"]["details"][0] = String() + "Progress " + percentageCompleteString;
-        (*docPtr)["status"]["details"][1] = String() + progress + " of " + total + "bytes";
+    // Prepare the JSON response and send
+    docPtr->clear();
+    (*docPtr)["id"] = actionID;
+    (*docPtr)["status"]["execution"] = "proceeding";
+    (*docPtr)["status"]["result"]["finished"] = "none";
+    (*docPtr)["status"]["details"][0] = progressDetails[0];
+    (*docPtr)["status"]["details"][1] = progressDetails[1];
+
+    hawkbitClientFeedbackPath.format("%s/deploymentBase/%s/feedback", hawkbitClientServerPathBase.c_str(), actionID);
+    hawkbitClientHttp(hawkbitClientFeedbackPath.c_str(), docPtr, hawkbitClientHttpPOST, NULL);
+
+    // A failed update is not retried, the next one carries newer progress
+    hawkbitClientProgress.pending = false;
+    hawkbitClientProgress.lastSent = millis();
+}
 
-        hawkbitClientHttp(hawkbitClientServerPathBase + "/deploymentBase/" + actionID + "/feedback", docPtr, hawkbitClientHttpPOST);
 
-        // At the start and end of update the progress can sit at 0% or 100% respectively
-        // To stop 100% being transmitted repetitively first checl that the threshold is under 100% (i.e. approaching 100)
-        if (percentageCompleteThresholdSend < 100) {
-            
-            // Update the next threshold level to send at
-            percentageCompleteThresholdSend += HAWKBIT_CLIENT_THRESOLD_STATUS_SEND;
-        
-            // If the threshold has exceeded 100%, truncate it to 100%
-            if (percentageCompleteThresholdSend > 100) {
-                percentageCompleteThresholdSend = 100;
-            }
-        }
+/**
+    Start an update.
+    Requests the image and prepares the updater, the image is downloaded and written by hawkbitClientDownloadCyclic.
+    When the start fails the failure message is in hawkbitClientUpdateResult.
 
-        // If we are 100% or more, make the trigger threshold over 100% because it should never get there
-        else {
-            percentageCompleteThresholdSend = 200;
-        }      
+    @param[in]     updateImagePath the update image href.
+    @return        true when the download started.
+*/
+static bool hawkbitClientDownloadBegin(const char * const updateImagePath) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Authorisation header
+    fixedString<sizeof(hawkbitClientToken) + 16> authorisation;
+
+    // Response code for the HTTP request
+    int httpResponseCode;
+
+    // Size of the image
+    int imageSize;
+
+    hawkbitClientUpdateResult.clear();
+
+    // Nothing sent yet, the first progress goes straight away
+    memset(&hawkbitClientProgress, 0, sizeof(hawkbitClientProgress));
+    hawkbitClientProgress.lastSent = millis() - HAWKBIT_CLIENT_PROGRESS_INTERVAL_MS;
+
+    // HTTP 1.0 so the image is never chunked (the updater needs the size up front)
+    authorisation.format("%s %s", hawkbitTokenTypes[hawkbitTokenTypeIndex], hawkbitClientToken);
+    hawkbitClientDownloadHttpClient.useHTTP10(true);
+    hawkbitClientDownloadHttpClient.begin(hawkbitClientDownloadWifi, updateImagePath);
+    hawkbitClientDownloadHttpClient.addHeader("Authorization", authorisation.c_str());
+
+    httpResponseCode = hawkbitClientDownloadHttpClient.GET();
+    imageSize = hawkbitClientDownloadHttpClient.getSize();
+
+    if (httpResponseCode != HTTP_CODE_OK) {
+        hawkbitClientUpdateResult.format("Download failed, returned %d", httpResponseCode);
     }
-}
 
+    else if (imageSize <= 0) {
+        hawkbitClientUpdateResult = "Download has no size";
+    }
+
+    else if (Update.begin(imageSize) == false) {
+        hawkbitClientUpdateResult.format("Update begin error %u", Update.getError());
+    }
+
+    else {
+        hawkbitClientDownloadActive = true;
+        hawkbitClientDownloadStart = millis();
+        hawkbitDownloadBegin();
+
+        debugMessage.format("Downloading %d bytes from %s", imageSize, updateImagePath);
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
+    }
+
+    if (hawkbitClientDownloadActive == false) {
+        hawkbitClientDownloadHttpClient.end();
+
+        debugMessage.format("Update failed: %s", hawkbitClientUpdateResult.c_str());
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
+    }
+
+    return(hawkbitClientDownloadActive);
+}
 
 /**
-    Handle an update.
-        
-    @param[in]     updateImagePath the update image href.
-    @param[in]     actionID the action ID being processed.
-    @param[in]     newDocPtr pointer to the JSON doc.
-    @return        success is an empty string OR string with failure message.
+    Finish the download in progress.
+    Completes the update when the result is still empty, otherwise the update is abandoned.
 */
-static String hawkbitClientUpdateHandler(const String updateImagePath, const String actionID, JsonDocument * const docPtr) {
-
-    String returnValue;
+static void hawkbitClientDownloadEnd(void) {
 
     // Debug message
-    String debugMessage;
-
-    // Wifi client
-    WiFiClient wifi;
+    fixedString<HAWKBIT_CLIENT_RESULT_SIZE + 32> debugMessage;
 
-    // Update status
-    HTTPUpdateResult updateStatus;
+    // Time the download took in mS
+    const uint32_t downloadTime = millis() - hawkbitClientDownloadStart;
 
-    // Set up the update progress function
-    hawkbitClientUpdateProgress(0, 0, actionID, docPtr);
+    // Bytes written
+    const uint32_t downloadBytes = Update.progress();
 
-    // Call back for progress
-    ESPhttpUpdate.onProgress([](unsigned int progress, unsigned int total) {
-        hawkbitClientUpdateProgress(progress, total, "", NULL);
-    });
-    
-    // Stop the update process resetting after it completes, use the system standard reset
-    ESPhttpUpdate.rebootOnUpdate(false);
-
-    // TODO: How to set basic security in download - New versions of arudino lib have void ESP8266HTTPUpdate::setAuthorization(const String &auth)???
-    // TODO: Secure update
-    // TODO: MD5 hash check
-    // TODO: Consider FreeRTOS to better handle the blocking nature of the re-programming
-    // TODO: Consider how to handle IO / OS / MQQT while this is blocking
-    // TODO: Consider what could happen if second programming request comes via OTA (perhaps OTS should check if this has already processed a programming reqest - is in the Deployment states)
-
-    // Do the update
-    updateStatus = ESPhttpUpdate.update(wifi, updateImagePath);
-
-    // Set-up the return message / error info
-    switch (updateStatus) {
-      case HTTP_UPDATE_FAILED:        
-        returnValue = String() + "HTTP_UPDATE_FAILD Error " + ESPhttpUpdate.getLastError() + " (" + ESPhttpUpdate.getLastErrorString().c_str() + ")";
-        break;
-
-      case HTTP_UPDATE_NO_UPDATES:
-        returnValue = String() + "HTTP_UPDATE_NO_UPDATES";
-        break;
-
-      case HTTP_UPDATE_OK:
-        returnValue = "";
-        break;
+    // An incomplete update is abandoned by end()
+    if ((Update.end() == false) && (hawkbitClientUpdateResult.isEmpty())) {
+        hawkbitClientUpdateResult.format("Update end error %u", Update.getError());
     }
 
-    // If the return value is empty, success
-    if (returnValue.isEmpty()) {
-        debugMessage = String() + "Update completed successfully";
-        debugLog(&debugMessage, hawkbitClientModuleName, info);
-        
+    hawkbitClientDownloadHttpClient.end();
+    hawkbitClientDownloadActive = false;
+
+    // If the result is empty, success
+    if (hawkbitClientUpdateResult.isEmpty()) {
+        debugMessage.format("Update completed successfully, %lu bytes in %lums (%lu bytes/s)", (unsigned long)downloadBytes, (unsigned long)downloadTime, (unsigned long)((downloadBytes * 1000ULL) / ((downloadTime > 0) ? downloadTime : 1)));
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
     }
 
     // Otherwise error
     else {
-        debugMessage = String() + "Update failed: " + returnValue;
-        debugLog(&debugMessage, hawkbitClientModuleName, error);
+        debugMessage.format("Update failed: %s", hawkbitClientUpdateResult.c_str());
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
     }
-
-    return(returnValue);
 }
 
 
@@ -352,7 +706,7 @@ static String hawkbitClientUpdateHandler(const String updateImagePath, const Str
     @param[in]     serverPath pointer to the full server path for the PUT.
     @param[in]     docPtr pointer to the JSON doc.
 */
-void hawkbitClientConfigResponse(const String * const serverPath, JsonDocument * const docPtr) {
+void hawkbitClientConfigResponse(const char * const serverPath, JsonDocument * const docPtr) {
     
     // Version data
     const versionData * versionDataPtr;
@@ -382,7 +736,7 @@ void hawkbitClientConfigResponse(const String * const serverPath, JsonDocument *
     }
 
     // Send the response
-    hawkbitClientHttp(*serverPath, docPtr, hawkbitClientHttpPUT);
+    hawkbitClientHttp(serverPath, docPtr, hawkbitClientHttpPUT, NULL);
 }
 
 
@@ -392,7 +746,7 @@ void hawkbitClientConfigResponse(const String * const serverPath, JsonDocument *
 void hawkbitClientInit(void) {
 
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // Pointer to the RAM mirror
     const nvmCompleteStructure * ramMirrorPtr;
@@ -400,6 +754,8 @@ void hawkbitClientInit(void) {
     // Set-up pointer to RAM mirror
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
 
+    nvmValidateStructure(nvmHawkbitStruc);
+
     // TODO: How should local globals be accessed within this function?
 
     // Buffer parts of the RAM mirror
@@ -411,20 +767,38 @@ void hawkbitClientInit(void) {
         hawkbitTokenTypeIndex = 0;
 
         // Debug messsage for invalid token type
-        debugMessage = String() + "Invalid token type so assumed " +  hawkbitTokenTypes[hawkbitTokenTypeIndex]; 
-        debugLog(&debugMessage, hawkbitClientModuleName, error);
+        debugMessage.format("Invalid token type so assumed %s", hawkbitTokenTypes[hawkbitTokenTypeIndex]); 
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, error);
     }
 
     // Valid token type index
     else {
         // Debug messsage for valid token type
-        debugMessage = String() + "Loaded token type " +  hawkbitTokenTypes[hawkbitTokenTypeIndex]; 
-        debugLog(&debugMessage, hawkbitClientModuleName, info);
+        debugMessage.format("Loaded token type %s", hawkbitTokenTypes[hawkbitTokenTypeIndex]); 
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
     }
     
+    // Abandon a download in progress
+    if (hawkbitClientDownloadActive == true) {
+        hawkbitClientUpdateResult = "Download aborted";
+        hawkbitClientDownloadEnd();
+    }
+
+    // The server can change so start with a new connection
+    hawkbitClientHttpClient.end();
+    hawkbitClientDisconnect();
+
+    // Poll with the default interval until the server sends one
+    hawkbitClientPoll.sleep = HAWKBIT_POLL_SLEEP_DEFAULT_S;
+    hawkbitClientPoll.errors = 0;
+    hawkbitClientPoll.actionActive = false;
+    hawkbitClientPoll.firstPoll = true;
+
     hawkbitClientCurrentState = stmHawkbitRestart;
-    hawkbitClientServerPathBase = String() + "http://" + ramMirrorPtr->hawkbit.hawkbitServer + "/" + ramMirrorPtr->hawkbit.hawkbitTennant + "/controller/v1/" + getWiFiModuleDetails()->moduleHostName;
+    hawkbitClientServerPathBase.format("http://%s/%s/controller/v1/%s", ramMirrorPtr->hawkbit.hawkbitServer, ramMirrorPtr->hawkbit.hawkbitTennant, getWiFiModuleDetails()->moduleHostName);
     doc.clear();
+
+    hawkbitClientInitialised = true;
 }
 
 
@@ -434,33 +808,48 @@ void hawkbitClientInit(void) {
 void hawkbitClientStateMachine(void) {
     
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // State timer
     static uint32_t stateTimer;
 
+    // Time to the next poll in S
+    uint32_t pollDelay;
+
+    // Attempts to send the final deployment status
+    static uint32_t ackAttempts;
+
     // Next state
     hawkbitClientStm nextState = hawkbitClientCurrentState;
 
     // Action ID
-    static String actionID;
-
-    // Result from the update
-    static String updateResult;
+    static hawkbitClientIdString actionID;
 
     // Strings for hrefs
-    static String hrefCancel;
-    static String hrefConfig;
-    static String hrefDeployment;
+    static hawkbitClientUrlString hrefCancel;
+    static hawkbitClientUrlString hrefConfig;
+    static hawkbitClientUrlString hrefDeployment;
+    static hawkbitClientUrlString hrefDownload;
 
     // TODO: How should local globals be accessed within this function?
 
+    // Initialise on the first call (keeps the hawkbit NVM structure out of set-up)
+    if (hawkbitClientInitialised == false) {
+        hawkbitClientInit();
+    }
+
     // Handle the state machine
     switch(hawkbitClientCurrentState) {
         
         // Start here when the statemachine is reset
         case(stmHawkbitRestart):
-            stateTimer = SECS_TO_CALLS(HAWKBIT_CLIENT_IDLE_TIME_RST_S);
+            pollDelay = hawkbitPollGetDelay(&hawkbitClientPoll);
+            hawkbitClientPoll.firstPoll = false;
+
+            debugMessage.format("Next poll in %lus", (unsigned long)pollDelay);
+            debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
+
+            stateTimer = SECS_TO_CALLS(pollDelay);
             nextState = stmHawkbitIdle;
             break;
         
@@ -479,18 +868,27 @@ void hawkbitClientStateMachine(void) {
         
         // Poll hawkbit server for pending requests
         case(stmHawkbitPoll):
+            // Statistics cover one poll and everything it leads to (a whole deployment)
+            memset(&hawkbitClientStats, 0, sizeof(hawkbitClientStats));
+
             // Try to send the GET and if there is a failure restart
-            if(!hawkbitClientHttp(hawkbitClientServerPathBase, &doc, hawkbitClientHttpGET)) {
+            if(!hawkbitClientHttp(hawkbitClientServerPathBase.c_str(), &doc, hawkbitClientHttpGET, hawkbitClientGetFilter(stmHawkbitPoll))) {
+                hawkbitClientPoll.errors++;
                 nextState = stmHawkbitRestart;
             }
 
             // Success with GET HTTP and JSON decoding
             else {
+                hawkbitClientPoll.errors = 0;
+                hawkbitClientSetPollSleep(doc["config"]["polling"]["sleep"].as<const char*>());
 
                 hrefCancel = doc["_links"]["cancelAction"]["href"] | "";
                 hrefConfig = doc["_links"]["configData"]["href"] | "";
                 hrefDeployment = doc["_links"]["deploymentBase"]["href"] | "";
 
+                // Poll fast until the server has no more actions
+                hawkbitClientPoll.actionActive = (hrefCancel.isEmpty() == false) || (hrefConfig.isEmpty() == false) || (hrefDeployment.isEmpty() == false);
+
                 // Cancel request
                 if(hrefCancel.isEmpty() == false) {
                     nextState = stmHawkbitCancel;
@@ -516,7 +914,8 @@ void hawkbitClientStateMachine(void) {
         // Get details of a cancellation request
         case(stmHawkbitCancel):                                      
             // Try to send the GET and if there is a failure restart
-            if(!hawkbitClientHttp(hrefCancel, &doc, hawkbitClientHttpGET)) {
+            if(!hawkbitClientHttp(hrefCancel.c_str(), &doc, hawkbitClientHttpGET, hawkbitClientGetFilter(stmHawkbitCancel))) {
+                hawkbitClientPoll.errors++;
                 nextState = stmHawkbitRestart;
             }
 
@@ -531,51 +930,89 @@ void hawkbitClientStateMachine(void) {
         case(stmHawkbitCancelAck):            
             // Prepare the JSON acknowledgement
             doc.clear();
-            doc["id"] = actionID;
+            doc["id"] = actionID.c_str();
             doc["status"]["execution"] = "closed";
             doc["status"]["result"]["finished"] = "success";
 
             // Send the POST and move to restart
-            hawkbitClientHttp(hawkbitClientServerPathBase + "/cancelAction/" + actionID + "/feedback", &doc, hawkbitClientHttpPOST);
+            hawkbitClientFeedbackPath.format("%s/cancelAction/%s/feedback", hawkbitClientServerPathBase.c_str(), actionID.c_str());
+            hawkbitClientHttp(hawkbitClientFeedbackPath.c_str(), &doc, hawkbitClientHttpPOST, NULL);
             nextState = stmHawkbitRestart;
             break;
 
         // Get details of deployment and attempt programming
         case(stmHawkbitDeploy):
             // Try to send the GET and if there is a failure restart
-            if(!hawkbitClientHttp(hrefDeployment, &doc, hawkbitClientHttpGET)) {
+            if(!hawkbitClientHttp(hrefDeployment.c_str(), &doc, hawkbitClientHttpGET, hawkbitClientGetFilter(stmHawkbitDeploy))) {
+                hawkbitClientPoll.errors++;
                 nextState = stmHawkbitRestart;
             }
 
-            // If there is no failure, record the action ID, re-program, and move to acknowledgement
+            // If there is no failure, record the action ID and start the download (acknowledge straight away if it does not start)
             else {
-                actionID = doc["id"] | "";                
-                updateResult = hawkbitClientUpdateHandler(doc["deployment"]["chunks"][0]["artifacts"][0]["_links"]["download-http"]["href"] | "", actionID, &doc);                
+                actionID = doc["id"] | "";
+                hawkbitClientGetArtifact(doc["deployment"]["chunks"][0]["artifacts"].as<JsonArray>(), &hrefDownload);
+
+                if (hawkbitClientDownloadBegin(hrefDownload.c_str()) == true) {
+                    nextState = stmHawkbitDownload;
+                }
+                else {
+                    nextState = stmHawkbitDeployAck;
+                }
+
+                ackAttempts = 0;
+                stateTimer = 0;
+            }
+            break;
+
+        // Send progress while the download (run by hawkbitClientDownloadCyclic) runs and move to acknowledgement
+        case(stmHawkbitDownload):
+            if (hawkbitClientDownloadActive == false) {
                 nextState = stmHawkbitDeployAck;
             }
+            else {
+                hawkbitClientSendProgress(actionID.c_str(), &doc);
+            }
             break;
             
         // Acknowledge sucessfull or unsucessfull deployment attempt
+        // The final status is always sent, a failed POST is retried every HAWKBIT_CLIENT_ACK_RETRY_S (up to HAWKBIT_CLIENT_ACK_ATTEMPTS)
         case(stmHawkbitDeployAck):
+            // Wait to retry
+            if(stateTimer > 0) {
+                stateTimer--;
+                break;
+            }
+
             // Prepare the JSON acknowledgement
             doc.clear();
-            doc["id"] = actionID;
+            doc["id"] = actionID.c_str();
             doc["status"]["execution"] = "closed";
             
             // Success
-            if(updateResult.isEmpty()) {
+            if(hawkbitClientUpdateResult.isEmpty()) {
                 doc["status"]["result"]["finished"] = "success";
-                nextState = stmHawkbitWaitReboot;
             }
 
-            // Failed (no reboot)
+            // Failed
             else {
-                doc["status"]["details"][0] = updateResult;
+                doc["status"]["details"][0] = hawkbitClientUpdateResult.c_str();
                 doc["status"]["result"]["finished"] = "failure";
-                nextState = stmHawkbitRestart;
             }
 
-            hawkbitClientHttp(hawkbitClientServerPathBase + "/deploymentBase/" + actionID + "/feedback", &doc, hawkbitClientHttpPOST);
+            hawkbitClientFeedbackPath.format("%s/deploymentBase/%s/feedback", hawkbitClientServerPathBase.c_str(), actionID.c_str());
+            ackAttempts++;
+
+            if((hawkbitClientHttp(hawkbitClientFeedbackPath.c_str(), &doc, hawkbitClientHttpPOST, NULL) == false) && (ackAttempts < HAWKBIT_CLIENT_ACK_ATTEMPTS)) {
+                stateTimer = SECS_TO_CALLS(HAWKBIT_CLIENT_ACK_RETRY_S);
+                break;
+            }
+
+            // Success reboots, failure carries on polling (no reboot)
+            nextState = (hawkbitClientUpdateResult.isEmpty()) ? stmHawkbitWaitReboot : stmHawkbitRestart;
+
+            debugMessage.format("Deployment used %lu requests, %lu connections, %lums connecting", (unsigned long)hawkbitClientStats.requests, (unsigned long)hawkbitClientStats.connections, (unsigned long)hawkbitClientStats.connectTime);
+            debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
             break;
 
         // Programming success so wait for reboot, no further re-programming till reboot
@@ -585,7 +1022,7 @@ void hawkbitClientStateMachine(void) {
         
         // Configuration requested
         case(stmHawkbitConfig):
-            hawkbitClientConfigResponse(&hrefConfig, &doc);
+            hawkbitClientConfigResponse(hrefConfig.c_str(), &doc);
             nextState = stmHawkbitRestart;
             break;
 
@@ -597,8 +1034,8 @@ void hawkbitClientStateMachine(void) {
  
     // State change
     if (hawkbitClientCurrentState != nextState) {
-        debugMessage = String() + "State change to " + hawkbitClientStateNames[nextState];
-        debugLog(&debugMessage, hawkbitClientModuleName, info);
+        debugMessage.format("State change to %s", hawkbitClientStateNames[nextState]);
+        debugLog(debugMessage.c_str(), hawkbitClientModuleName, info);
     }
     
     // Update last states and current states (in this order)
@@ -613,3 +1050,43 @@ void hawkbitClientStateMachine(void) {
 hawkbitClientStm hawkbitClientGetCurrentState(void) {
     return(hawkbitClientCurrentState);
 }
+
+/**
+    Hawkbit download cyclic task.
+    Moves the download in progress on for up to HAWKBIT_DOWNLOAD_SLICE_MS per call (hawkbitDownloadSlice).
+*/
+void hawkbitClientDownloadCyclic(void) {
+
+    // Status of the download
+    hawkbitDownloadStatus status;
+
+    if (hawkbitClientDownloadActive == false) {
+        return;
+    }
+
+    status = hawkbitDownloadSlice(hawkbitClientDownloadWifi);
+
+    switch(status) {
+
+        case(hawkbitDownloadWriteError):
+            hawkbitClientUpdateResult.format("Update write error %u", Update.getError());
+            break;
+
+        case(hawkbitDownloadClosed):
+            hawkbitClientUpdateResult.format("Connection closed after %lu of %lu bytes", (unsigned long)Update.progress(), (unsigned long)Update.size());
+            break;
+
+        case(hawkbitDownloadTimeout):
+            hawkbitClientUpdateResult.format("Download timed out after %lu of %lu bytes", (unsigned long)Update.progress(), (unsigned long)Update.size());
+            break;
+
+        default:
+            break;
+    }
+
+    hawkbitClientSetProgress(Update.progress(), Update.size());
+
+    if (status != hawkbitDownloadRunning) {
+        hawkbitClientDownloadEnd();
+    }
+}
@@ -0,0 +1,65 @@
+#include <Arduino.h>
+#include <Updater.h>
+
+#include "hawkbit_download.h"
+
+
+// Download chunk
+static uint8_t hawkbitDownloadChunk[HAWKBIT_DOWNLOAD_CHUNK_SIZE];
+
+// Time of the last download data (mS)
+static uint32_t hawkbitDownloadLastData;
+
+
+/**
+    Start a download.
+    The updater must have been started with the image size.
+*/
+void hawkbitDownloadBegin(void) {
+    hawkbitDownloadLastData = millis();
+}
+
+/**
+    Move the download on for up to HAWKBIT_DOWNLOAD_SLICE_MS.
+    Chunks are read from the client as they arrive and passed to the updater (which writes whole flash sectors).
+
+    @param[in]     client connection with the image (the response header has been read).
+    @return        status of the download (hawkbitDownloadRunning until the image is written or the download failed).
+*/
+hawkbitDownloadStatus hawkbitDownloadSlice(Client & client) {
+
+    // Time the slice started
+    const uint32_t sliceStart = millis();
+
+    // Bytes waiting and bytes read
+    int available;
+    int length = 0;
+
+    do {
+        available = client.available();
+
+        if (available > 0) {
+            length = client.read(hawkbitDownloadChunk, ((size_t)available < sizeof(hawkbitDownloadChunk)) ? (size_t)available : sizeof(hawkbitDownloadChunk));
+
+            if ((length > 0) && (Update.write(hawkbitDownloadChunk, length) != (size_t)length)) {
+                return(hawkbitDownloadWriteError);
+            }
+
+            hawkbitDownloadLastData = millis();
+        }
+    } while ((available > 0) && (Update.remaining() > 0) && ((millis() - sliceStart) < HAWKBIT_DOWNLOAD_SLICE_MS));
+
+    if (Update.remaining() == 0) {
+        return(hawkbitDownloadComplete);
+    }
+
+    if ((client.connected() == false) && (client.available() == 0)) {
+        return(hawkbitDownloadClosed);
+    }
+
+    if ((millis() - hawkbitDownloadLastData) > HAWKBIT_DOWNLOAD_TIMEOUT_MS) {
+        return(hawkbitDownloadTimeout);
+    }
+
+    return(hawkbitDownloadRunning);
+}
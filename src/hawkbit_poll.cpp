@@ -0,0 +1,75 @@
+#include <Arduino.h>
+
+#include "hawkbit_poll.h"
+
+
+/**
+    Read the poll interval sent by the server.
+    The interval is "HH:MM:SS", it is limited to the HAWKBIT_POLL_SLEEP limits.
+
+    @param[in]     sleep pointer to the interval string (NULL when not sent).
+    @param[in]     pollSleep current poll interval in S.
+    @return        new poll interval in S (pollSleep when the server did not send a valid interval).
+*/
+uint32_t hawkbitPollParseSleep(const char * const sleep, const uint32_t pollSleep) {
+
+    // Hours, minutes and seconds of the interval
+    unsigned int hours;
+    unsigned int minutes;
+    unsigned int seconds;
+
+    // New interval in S
+    uint32_t returnValue = pollSleep;
+
+    if ((sleep != NULL) && (sscanf(sleep, "%u:%u:%u", &hours, &minutes, &seconds) == 3)) {
+        returnValue = (hours * 3600UL) + (minutes * 60UL) + seconds;
+
+        if (returnValue < HAWKBIT_POLL_SLEEP_MIN_S) {
+            returnValue = HAWKBIT_POLL_SLEEP_MIN_S;
+        }
+        else if (returnValue > HAWKBIT_POLL_SLEEP_MAX_S) {
+            returnValue = HAWKBIT_POLL_SLEEP_MAX_S;
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Get the time to the next poll.
+    Failed polls back off exponentially, an active action polls fast, otherwise the server interval is used.
+    Every interval gets random jitter so devices started together do not poll together.
+
+    @param[in]     pollStatePtr pointer to the poll state.
+    @return        time to the next poll in S.
+*/
+uint32_t hawkbitPollGetDelay(const hawkbitPollState * const pollStatePtr) {
+
+    // Interval before jitter and maximum jitter
+    uint32_t pollDelay;
+    uint32_t jitter;
+
+    // Spread the first poll over the whole default interval
+    if (pollStatePtr->firstPoll == true) {
+        return(HAWKBIT_POLL_FIRST_MIN_S + random(HAWKBIT_POLL_SLEEP_DEFAULT_S - HAWKBIT_POLL_FIRST_MIN_S + 1));
+    }
+
+    if (pollStatePtr->errors > 0) {
+        pollDelay = pollStatePtr->sleep << ((pollStatePtr->errors > HAWKBIT_POLL_BACKOFF_SHIFT_MAX) ? HAWKBIT_POLL_BACKOFF_SHIFT_MAX : pollStatePtr->errors);
+
+        // The backoff is capped, but a failed poll never polls sooner than the server interval
+        pollDelay = max(pollStatePtr->sleep, min(pollDelay, (uint32_t)HAWKBIT_POLL_BACKOFF_MAX_S));
+    }
+
+    else if (pollStatePtr->actionActive == true) {
+        pollDelay = HAWKBIT_POLL_ACTIVE_S;
+    }
+
+    else {
+        pollDelay = pollStatePtr->sleep;
+    }
+
+    jitter = (pollDelay * HAWKBIT_POLL_JITTER_PERCENT) / 100;
+
+    return(pollDelay - jitter + random((2 * jitter) + 1));
+}
@@ -0,0 +1,308 @@
+#include <Arduino.h>
+
+extern "C" {
+#include <user_interface.h>
+}
+
+#include "journal.h"
+
+#include "crc.h"
+#include "nvm.h"
+#include "rtc_mem_cfg.h"
+#include "messages_tx.h"
+
+
+// Magic number marking a journal in RTC memory
+#define JOURNAL_MAGIC                   (uint32_t(0x4A524E4C))
+
+// Number of log records held in the journal
+#define JOURNAL_RECORDS                 (4)
+
+// Maximum size of a single log record (including end of string)
+#define JOURNAL_RECORD_SIZE             (52)
+
+// Maximum size of a task name (including end of string)
+#define JOURNAL_TASK_NAME_SIZE          (16)
+
+// Size of a reset reason string (including end of string)
+#define JOURNAL_REASON_STRING_SIZE      (20)
+
+// Size of a hex address string (including end of string)
+#define JOURNAL_HEX_STRING_SIZE         (11)
+
+// Name for the reset reason
+#define JOURNAL_NAME_REASON             ("reason")
+
+// Name for the exception cause
+#define JOURNAL_NAME_EXCEPTION          ("exception")
+
+// Name for the exception program counter
+#define JOURNAL_NAME_EPC                ("epc")
+
+// Name for the exception virtual address
+#define JOURNAL_NAME_ADDRESS            ("address")
+
+// Name for the boot counter
+#define JOURNAL_NAME_BOOTS              ("boots")
+
+// Name for the uptime
+#define JOURNAL_NAME_UPTIME             ("uptime")
+
+// Name for the free heap
+#define JOURNAL_NAME_HEAP               ("heap")
+
+// Name for the task
+#define JOURNAL_NAME_TASK               ("task")
+
+// Name for the record number
+#define JOURNAL_NAME_RECORD             ("record")
+
+// Name for the log record
+#define JOURNAL_NAME_LOG                ("log")
+
+
+// Structure for the journal in RTC memory
+typedef struct {
+    uint32_t                magic;                                          // Journal magic number
+    uint32_t                boots;                                          // Boots since the journal was created
+    uint32_t                uptimeMs;                                       // Uptime at the last snapshot
+    uint32_t                freeHeap;                                       // Free heap at the last snapshot
+    char                    task[JOURNAL_TASK_NAME_SIZE];                   // Task executing at the last snapshot
+    uint8_t                 recordNext;                                     // Next record to write
+    uint8_t                 recordCount;                                    // Number of valid records
+    uint8_t                 spare[2];                                       // Spare (keeps the structure 32bit aligned)
+    char                    records[JOURNAL_RECORDS][JOURNAL_RECORD_SIZE];  // Log records (ring buffer)
+    crc_t                   crc;                                            // CRC
+} journalRtcStructure;
+
+static_assert((sizeof(journalRtcStructure) % RTC_MEM_BLOCK_SIZE) == 0, "journalRtcStructure must be a whole number of RTC memory blocks");
+static_assert(sizeof(journalRtcStructure) <= (RTC_MEM_BLOCKS_JOURNAL * RTC_MEM_BLOCK_SIZE), "journalRtcStructure does not fit into the RTC memory allocated for the journal");
+
+// Reset reason names (must align with rst_reason)
+static const char * journalResetReasonNames[] = {
+    "power on",
+    "hardware watchdog",
+    "exception",
+    "software watchdog",
+    "software restart",
+    "deep sleep wake",
+    "external reset"
+};
+
+// Log level characters (must align with the logLevel enum)
+static const char journalLevelCharacters[] = {'I', 'W', 'E'};
+
+// Module name for debug messages
+static const char* journalModuleName = "journal";
+
+// Journal for this boot
+static journalRtcStructure journalCurrent;
+
+// Journal from the previous boot
+static journalRtcStructure journalPrevious;
+
+// Task that is executing
+static const char * journalCurrentTask = "";
+
+// Previous journal has not been transmitted yet
+static bool journalPendingTransmit = false;
+
+// Previous reset reason
+static char journalResetReason[JOURNAL_REASON_STRING_SIZE];
+
+// Previous exception cause
+static uint32_t journalExceptionCause = 0;
+
+// Previous exception program counter
+static char journalEpcString[JOURNAL_HEX_STRING_SIZE];
+
+// Previous exception virtual address
+static char journalAddressString[JOURNAL_HEX_STRING_SIZE];
+
+// Record number being transmitted
+static unsigned int journalRecordNumber = 0;
+
+// Record being transmitted
+static char journalRecordBuffer[JOURNAL_RECORD_SIZE];
+
+// Journal data (previous boot)
+static const journalData journalDataTable = {JOURNAL_NAME_REASON,     journalResetReason,
+                                             JOURNAL_NAME_EXCEPTION,  &journalExceptionCause,
+                                             JOURNAL_NAME_EPC,        journalEpcString,
+                                             JOURNAL_NAME_ADDRESS,    journalAddressString,
+                                             JOURNAL_NAME_BOOTS,      &journalPrevious.boots,
+                                             JOURNAL_NAME_UPTIME,     &journalPrevious.uptimeMs,
+                                             JOURNAL_NAME_HEAP,       &journalPrevious.freeHeap,
+                                             JOURNAL_NAME_TASK,       journalPrevious.task
+};
+
+// Journal record data (previous boot)
+static const journalRecordData journalRecordDataTable = {JOURNAL_NAME_RECORD,   &journalRecordNumber,
+                                                         JOURNAL_NAME_LOG,      journalRecordBuffer
+};
+
+
+/**
+    Calculate the CRC of a journal.
+
+    @param[in]     journalPtr pointer to the journal.
+    @return        CRC of the journal (excluding the CRC itself).
+*/
+static crc_t journalCalculateCrc(const journalRtcStructure * const journalPtr) {
+    return(crcCalculate((const uint8_t *)journalPtr, offsetof(journalRtcStructure, crc)));
+}
+
+/**
+    Write the journal for this boot into RTC memory.
+    Does not touch the heap so it is safe to call from the crash callback.
+*/
+static void journalWrite(void) {
+
+    // Copy the task name (may not be terminated when truncated)
+    strncpy(journalCurrent.task, journalCurrentTask, sizeof(journalCurrent.task) - 1);
+    journalCurrent.task[sizeof(journalCurrent.task) - 1] = '\0';
+
+    journalCurrent.uptimeMs = millis();
+    journalCurrent.crc = journalCalculateCrc(&journalCurrent);
+
+    (void) ESP.rtcUserMemoryWrite(RTC_MEM_OFFSET_JOURNAL, (uint32_t *)&journalCurrent, sizeof(journalCurrent));
+}
+
+/**
+    Journal init.
+    Loads the journal from the previous boot out of RTC memory and starts a new one.
+    Should be called early / first during init.
+*/
+void journalInit(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Reset information from the SDK
+    const struct rst_info * const resetInfoPtr = ESP.getResetInfoPtr();
+
+    // Previous journal is valid
+    bool previousValid = false;
+
+    // Load and validate the journal from the previous boot
+    if (ESP.rtcUserMemoryRead(RTC_MEM_OFFSET_JOURNAL, (uint32_t *)&journalPrevious, sizeof(journalPrevious))) {
+        if ((journalPrevious.magic == JOURNAL_MAGIC) && (journalPrevious.crc == journalCalculateCrc(&journalPrevious)) && (journalPrevious.recordCount <= JOURNAL_RECORDS) && (journalPrevious.recordNext < JOURNAL_RECORDS)) {
+            previousValid = true;
+        }
+    }
+
+    // Power on or corrupt so there is nothing to report from the journal
+    if (previousValid == false) {
+        memset(&journalPrevious, 0, sizeof(journalPrevious));
+    }
+
+    // Buffer the reset information
+    if (resetInfoPtr->reason < (sizeof(journalResetReasonNames) / sizeof(journalResetReasonNames[0]))) {
+        strncpy(journalResetReason, journalResetReasonNames[resetInfoPtr->reason], sizeof(journalResetReason) - 1);
+    }
+    else {
+        strncpy(journalResetReason, "unknown", sizeof(journalResetReason) - 1);
+    }
+
+    journalExceptionCause = resetInfoPtr->exccause;
+    snprintf(journalEpcString, sizeof(journalEpcString), "0x%08x", resetInfoPtr->epc1);
+    snprintf(journalAddressString, sizeof(journalAddressString), "0x%08x", resetInfoPtr->excvaddr);
+
+    // Report valid journals and resets caused by a crash (a hardware watchdog may not leave a journal)
+    journalPendingTransmit = (previousValid || (resetInfoPtr->reason == REASON_WDT_RST) || (resetInfoPtr->reason == REASON_EXCEPTION_RST) || (resetInfoPtr->reason == REASON_SOFT_WDT_RST));
+
+    // Start the journal for this boot (keep any records already logged)
+    journalCurrent.magic = JOURNAL_MAGIC;
+    journalCurrent.boots = journalPrevious.boots + 1;
+    journalCurrent.freeHeap = ESP.getFreeHeap();
+    journalWrite();
+
+    debugMessage.format("Reset reason %s, boot %lu", journalResetReason, (unsigned long)journalCurrent.boots);
+    debugLog(debugMessage.c_str(), journalModuleName, info);
+}
+
+/**
+    Add a log record to the journal.
+    Called from debugLog so the journal holds the last records before a reset.
+
+    @param[in]     level log level of the record.
+    @param[in]     module pointer to the module name (NULL when there is no module).
+    @param[in]     message pointer to the message.
+*/
+void journalRecord(const logLevel level, const char * const module, const char * const message) {
+
+    // Level character for the record
+    const char levelCharacter = (level < sizeof(journalLevelCharacters)) ? journalLevelCharacters[level] : '?';
+
+    snprintf(journalCurrent.records[journalCurrent.recordNext], JOURNAL_RECORD_SIZE, "%c %lu %s%s%s",
+             levelCharacter, millis(), (module != NULL) ? module : "", (module != NULL) ? ": " : "", message);
+
+    journalCurrent.recordNext = (journalCurrent.recordNext + 1) % JOURNAL_RECORDS;
+
+    if (journalCurrent.recordCount < JOURNAL_RECORDS) {
+        journalCurrent.recordCount++;
+    }
+
+    // Warnings and errors often precede a reset so get them into RTC memory straight away
+    if ((level != info) && (journalCurrent.magic == JOURNAL_MAGIC)) {
+        journalSnapshot();
+    }
+}
+
+/**
+    Set the task that is executing.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void journalSetTask(const char * const taskName) {
+    journalCurrentTask = taskName;
+}
+
+/**
+    Snapshot the journal into RTC memory.
+    Call before any intentional reset.
+*/
+void journalSnapshot(void) {
+    journalCurrent.freeHeap = ESP.getFreeHeap();
+    journalWrite();
+}
+
+/**
+    Transmit the journal from the previous boot.
+    Only transmits once per boot and only when there is something to report.
+*/
+void journalTransmitCrashMessage(void) {
+
+    // Index of the record being transmitted
+    unsigned int recordIndex;
+
+    if (journalPendingTransmit) {
+
+        // Clear first, transmitting can log and reconnect
+        journalPendingTransmit = false;
+
+        messsagesTxCrashMessage(&journalDataTable);
+
+        // Transmit the records oldest first
+        for (journalRecordNumber = 1; journalRecordNumber <= journalPrevious.recordCount; journalRecordNumber++) {
+            recordIndex = (journalPrevious.recordNext + JOURNAL_RECORDS + journalRecordNumber - 1 - journalPrevious.recordCount) % JOURNAL_RECORDS;
+
+            strncpy(journalRecordBuffer, journalPrevious.records[recordIndex], sizeof(journalRecordBuffer) - 1);
+            journalRecordBuffer[sizeof(journalRecordBuffer) - 1] = '\0';
+
+            messsagesTxCrashRecordMessage(&journalRecordDataTable);
+        }
+    }
+}
+
+/**
+    Crash callback from the core (exceptions and software watchdog).
+    Snapshot the journal without using the heap.
+*/
+extern "C" void custom_crash_callback(struct rst_info * rst_info, uint32_t stack, uint32_t stack_end) {
+    (void) rst_info;
+    (void) stack;
+    (void) stack_end;
+
+    journalWrite();
+}
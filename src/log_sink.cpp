@@ -0,0 +1,503 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+
+#include "log_sink.h"
+
+#include "utils.h"
+#include "nvm_cfg.h"
+#include "wifi.h"
+#include "messages_tx.h"
+
+
+// Set the module call interval
+#define MODULE_CALL_INTERVAL            LOG_SINK_CYCLIC_RATE
+
+// Transport used by the log sink, off unless enabled with a build flag (-D LOG_SINK_TRANSPORT=logSinkSyslog or logSinkMqtt)
+#ifndef LOG_SINK_TRANSPORT
+#define LOG_SINK_TRANSPORT              logSinkOff
+#endif
+
+// Transport as a number for #if (enum names are 0 to the preprocessor), by name or by value
+#define LOG_SINK_TRANSPORT_ID_logSinkOff        (0)
+#define LOG_SINK_TRANSPORT_ID_logSinkSyslog     (1)
+#define LOG_SINK_TRANSPORT_ID_logSinkMqtt       (2)
+#define LOG_SINK_TRANSPORT_ID_0                 (0)
+#define LOG_SINK_TRANSPORT_ID_1                 (1)
+#define LOG_SINK_TRANSPORT_ID_2                 (2)
+#define LOG_SINK_TRANSPORT_PASTE(transport)     LOG_SINK_TRANSPORT_ID_ ## transport
+#define LOG_SINK_TRANSPORT_ID(transport)        LOG_SINK_TRANSPORT_PASTE(transport)
+
+// The ring buffer, batch buffer and transports are only built when the sink is on
+#define LOG_SINK_ENABLED                (LOG_SINK_TRANSPORT_ID(LOG_SINK_TRANSPORT) != LOG_SINK_TRANSPORT_ID_logSinkOff)
+
+// The syslog client is only built for the syslog transport
+#define LOG_SINK_SYSLOG_ENABLED         (LOG_SINK_TRANSPORT_ID(LOG_SINK_TRANSPORT) == LOG_SINK_TRANSPORT_ID_logSinkSyslog)
+
+// The number the preprocessor sees must be the transport the compiler sees
+static_assert(LOG_SINK_TRANSPORT_ID(LOG_SINK_TRANSPORT) == LOG_SINK_TRANSPORT, "LOG_SINK_TRANSPORT must be logSinkOff, logSinkSyslog or logSinkMqtt");
+
+// Number of records held in the ring buffer
+#define LOG_SINK_RECORDS                (12)
+
+// Longest module name including ": "
+#define LOG_SINK_MODULE_SIZE            (16 + 2)
+
+// Maximum size of a single record, a full debug message with its header and module (including end of string)
+#define LOG_SINK_RECORD_SIZE            (DEBUG_LOG_HEADER_SIZE + LOG_SINK_MODULE_SIZE + DEBUG_MESSAGE_SIZE)
+
+// Time between batches in S
+#define LOG_SINK_BATCH_TIME_S           (2)
+
+// Ring buffer fill level that forces a batch before the batch time has elapsed
+#define LOG_SINK_FLUSH_THRESHOLD        (LOG_SINK_RECORDS / 2)
+
+// Size of a syslog datagram
+#define LOG_SINK_SYSLOG_BATCH_SIZE      (512)
+
+// Size of a MQTT batch (must fit into the MQTT buffer of 384 bytes with the topic and JSON overhead)
+#define LOG_SINK_MQTT_BATCH_SIZE        (LOG_SINK_RECORD_SIZE + 64)
+
+// The MQTT batch is built in the batch buffer
+static_assert(LOG_SINK_MQTT_BATCH_SIZE <= LOG_SINK_SYSLOG_BATCH_SIZE, "LOG_SINK_MQTT_BATCH_SIZE must fit into the batch buffer");
+
+// Syslog server UDP port
+#define LOG_SINK_SYSLOG_PORT            (514)
+
+// Syslog facility (local0)
+#define LOG_SINK_SYSLOG_FACILITY        (16)
+
+// The syslog priority is patched into the header so it must always be three digits
+static_assert(((LOG_SINK_SYSLOG_FACILITY * 8) >= 100) && (((LOG_SINK_SYSLOG_FACILITY * 8) + 7) <= 999), "LOG_SINK_SYSLOG_FACILITY must give a three digit syslog priority");
+
+// Name for the log
+#define LOG_SINK_NAME_LOG               ("log")
+
+// Name for the dropped records
+#define LOG_SINK_NAME_DROPPED           ("dropped")
+
+
+#if LOG_SINK_ENABLED
+
+// Structure for a record in the ring buffer
+typedef struct {
+    uint32_t                sequence;
+    logLevel                level;
+    bool                    used;
+    char                    text[LOG_SINK_RECORD_SIZE];
+} logSinkRecordSlot;
+
+// Syslog severities (must align with the logLevel enum)
+static const uint8_t logSinkSyslogSeverities[] = {
+    6,      // info    -> informational
+    4,      // warning -> warning
+    3       // error   -> error
+};
+
+// Number of log levels
+static const unsigned int logSinkLevels = (sizeof(logSinkSyslogSeverities) / sizeof(logSinkSyslogSeverities[0]));
+
+// Ring buffer of log records
+static logSinkRecordSlot logSinkRing[LOG_SINK_RECORDS];
+
+// Number of used records in the ring buffer
+static unsigned int logSinkRecordsUsed = 0;
+
+// Sequence number for the next record
+static uint32_t logSinkSequence = 0;
+
+// Records dropped by level since the last batch
+static unsigned long logSinkDroppedByLevel[logSinkLevels];
+
+// Records dropped since the last batch
+static unsigned long logSinkDropped = 0;
+
+// Batch buffer
+static char logSinkBatch[LOG_SINK_SYSLOG_BATCH_SIZE];
+
+// Set while a batch is transmitted so the transport's own logging is not fed back into the sink
+static bool logSinkTransmitting = false;
+
+// Log sink data
+static const logSinkData logSinkDataTable = {LOG_SINK_NAME_LOG,       logSinkBatch,
+                                             LOG_SINK_NAME_DROPPED,   &logSinkDropped
+};
+
+#if LOG_SINK_SYSLOG_ENABLED
+
+// Syslog UDP client
+static WiFiUDP logSinkUdp;
+
+// Syslog server address
+static IPAddress logSinkSyslogAddress;
+
+// Syslog server address has been checked (since init or the last configuration change)
+static bool logSinkSyslogChecked = false;
+
+// Syslog server address is valid
+static bool logSinkSyslogValid = false;
+
+#endif
+
+
+/**
+    Find the oldest record in the ring buffer.
+
+    @param[in]     levelLimit only consider records with this level or lower.
+    @return        index of the record or LOG_SINK_RECORDS when there is none.
+*/
+static unsigned int logSinkFindOldest(const logLevel levelLimit) {
+
+    unsigned int returnValue = LOG_SINK_RECORDS;
+
+    for (unsigned int i = 0; i < LOG_SINK_RECORDS; i++) {
+        if ((logSinkRing[i].used == true) && (logSinkRing[i].level <= levelLimit)) {
+            if ((returnValue == LOG_SINK_RECORDS) || ((int32_t)(logSinkRing[i].sequence - logSinkRing[returnValue].sequence) < 0)) {
+                returnValue = i;
+            }
+        }
+    }
+
+    return(returnValue);
+}
+
+
+/**
+    Find a slot for a new record.
+    If the ring buffer is full, the oldest record of the lowest severity is dropped,
+    unless the new record itself has a lower severity than everything in the buffer.
+
+    @param[in]     level log level of the new record.
+    @return        index of the slot or LOG_SINK_RECORDS when the new record is dropped.
+*/
+static unsigned int logSinkAllocate(const logLevel level) {
+
+    unsigned int returnValue = LOG_SINK_RECORDS;
+
+    // Free slot available
+    if (logSinkRecordsUsed < LOG_SINK_RECORDS) {
+        for (returnValue = 0; returnValue < LOG_SINK_RECORDS; returnValue++) {
+            if (logSinkRing[returnValue].used == false) {
+                break;
+            }
+        }
+
+        logSinkRecordsUsed++;
+    }
+
+    // Ring full so find the oldest record with the lowest severity
+    else {
+        for (unsigned int i = 0; i <= (unsigned int)level; i++) {
+            returnValue = logSinkFindOldest((logLevel)i);
+
+            if (returnValue != LOG_SINK_RECORDS) {
+                break;
+            }
+        }
+
+        // Drop the victim (or the new record if nothing has a lower or equal severity)
+        if (returnValue != LOG_SINK_RECORDS) {
+            logSinkDroppedByLevel[logSinkRing[returnValue].level]++;
+        }
+        else {
+            logSinkDroppedByLevel[level]++;
+        }
+
+        logSinkDropped++;
+    }
+
+    return(returnValue);
+}
+
+
+#if LOG_SINK_SYSLOG_ENABLED
+
+/**
+    Get the syslog server (the MQTT server in NVM).
+    Only an IP address is accepted, a DNS lookup would block the scheduler.
+
+    @return        true when the server address is valid.
+*/
+static bool logSinkSyslogServer(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    if (logSinkSyslogChecked == false) {
+
+        // Set-up pointer to RAM mirror
+        (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+        logSinkSyslogChecked = true;
+        logSinkSyslogValid = logSinkSyslogAddress.fromString(ramMirrorPtr->mqtt.mqttServer);
+
+        if (logSinkSyslogValid == false) {
+            debugMessage.format("Syslog needs the MQTT server as an IP address, %s is not one", ramMirrorPtr->mqtt.mqttServer);
+            debugLog(debugMessage.c_str(), warning);
+        }
+    }
+
+    return(logSinkSyslogValid);
+}
+
+#endif
+
+
+/**
+    Build a batch from the ring buffer (oldest records first).
+    Records are only released from the ring buffer once the batch has been sent.
+
+    @param[in]     offset offset in the batch buffer to start at.
+    @param[in]     batchSize size of the batch.
+    @param[out]    selected records selected for the batch.
+    @param[out]    highestLevel highest log level in the batch.
+    @return        number of records in the batch.
+*/
+static unsigned int logSinkBuildBatch(size_t offset, const size_t batchSize, bool * const selected, logLevel * const highestLevel) {
+
+    unsigned int returnValue = 0;
+
+    // Length of the next record
+    size_t recordLength;
+
+    // Index of the next record
+    unsigned int next;
+
+    *highestLevel = info;
+
+    // Report drops first
+    if (logSinkDropped > 0) {
+        offset += snprintf(logSinkBatch + offset, batchSize - offset, "log sink dropped %lu records (E%lu W%lu I%lu)\n",
+                           logSinkDropped, logSinkDroppedByLevel[error], logSinkDroppedByLevel[warning], logSinkDroppedByLevel[info]);
+
+        offset = min(offset, batchSize - 1);
+        *highestLevel = warning;
+    }
+
+    for (unsigned int i = 0; i < LOG_SINK_RECORDS; i++) {
+        selected[i] = false;
+    }
+
+    // Add records in sequence order while they fit
+    for (unsigned int i = 0; i < logSinkRecordsUsed; i++) {
+
+        next = LOG_SINK_RECORDS;
+
+        for (unsigned int j = 0; j < LOG_SINK_RECORDS; j++) {
+            if ((logSinkRing[j].used == true) && (selected[j] == false)) {
+                if ((next == LOG_SINK_RECORDS) || ((int32_t)(logSinkRing[j].sequence - logSinkRing[next].sequence) < 0)) {
+                    next = j;
+                }
+            }
+        }
+
+        // Nothing left or the record does not fit (leave it for the next batch)
+        recordLength = (next != LOG_SINK_RECORDS) ? (strlen(logSinkRing[next].text) + 1) : 0;
+
+        if ((next == LOG_SINK_RECORDS) || ((offset + recordLength) >= batchSize)) {
+            break;
+        }
+
+        offset += snprintf(logSinkBatch + offset, batchSize - offset, "%s\n", logSinkRing[next].text);
+
+        if (logSinkRing[next].level > *highestLevel) {
+            *highestLevel = logSinkRing[next].level;
+        }
+
+        selected[next] = true;
+        returnValue++;
+    }
+
+    // Remove the trailing new line
+    if ((offset > 0) && (logSinkBatch[offset - 1] == '\n')) {
+        logSinkBatch[offset - 1] = '\0';
+    }
+
+    return(returnValue);
+}
+
+
+/**
+    Transmit one batch over the configured transport.
+    The records stay in the ring buffer when the transport fails (sent again with the next batch).
+
+    @return        true when a batch was handed to the network stack.
+*/
+static bool logSinkTransmitBatch(void) {
+
+    bool returnValue = false;
+
+    // Records selected for this batch
+    bool selected[LOG_SINK_RECORDS];
+
+    // Highest log level in the batch
+    logLevel highestLevel;
+
+#if LOG_SINK_SYSLOG_ENABLED
+    // Length of the syslog header
+    int headerLength = 0;
+
+    // Syslog priority digits
+    char priority[STRNLEN_INT(999) + 1];
+#endif
+
+    logSinkTransmitting = true;
+
+#if LOG_SINK_SYSLOG_ENABLED
+    if (logSinkSyslogServer() == true) {
+
+        // Leave space for the syslog header (priority is patched in once the highest level in the batch is known)
+        headerLength = snprintf(logSinkBatch, sizeof(logSinkBatch), "<%u>%s: ", (unsigned int)(LOG_SINK_SYSLOG_FACILITY * 8), getWiFiModuleDetails()->moduleHostName);
+
+        (void) logSinkBuildBatch(headerLength, sizeof(logSinkBatch), selected, &highestLevel);
+
+        // Patch the priority into the header
+        snprintf(priority, sizeof(priority), "%u", (unsigned int)((LOG_SINK_SYSLOG_FACILITY * 8) + logSinkSyslogSeverities[highestLevel]));
+        memcpy(logSinkBatch + 1, priority, STRNLEN_INT(999));
+
+        if (logSinkUdp.beginPacket(logSinkSyslogAddress, LOG_SINK_SYSLOG_PORT) == 1) {
+            (void) logSinkUdp.write((const uint8_t *)logSinkBatch, strlen(logSinkBatch));
+            returnValue = (logSinkUdp.endPacket() == 1);
+        }
+    }
+#else
+    (void) logSinkBuildBatch(0, LOG_SINK_MQTT_BATCH_SIZE, selected, &highestLevel);
+    returnValue = messsagesTxLogMessage(&logSinkDataTable);
+#endif
+
+    // Release the transmitted records and clear the drop counters
+    if (returnValue == true) {
+        for (unsigned int i = 0; i < LOG_SINK_RECORDS; i++) {
+            if (selected[i] == true) {
+                logSinkRing[i].used = false;
+                logSinkRecordsUsed--;
+            }
+        }
+
+        for (unsigned int i = 0; i < logSinkLevels; i++) {
+            logSinkDroppedByLevel[i] = 0;
+        }
+
+        logSinkDropped = 0;
+    }
+
+    logSinkTransmitting = false;
+
+    return(returnValue);
+}
+
+#endif
+
+
+/**
+    Log sink init.
+*/
+void logSinkInit(void) {
+
+#if LOG_SINK_ENABLED
+    for (unsigned int i = 0; i < LOG_SINK_RECORDS; i++) {
+        logSinkRing[i].used = false;
+    }
+
+    for (unsigned int i = 0; i < logSinkLevels; i++) {
+        logSinkDroppedByLevel[i] = 0;
+    }
+
+    logSinkRecordsUsed = 0;
+    logSinkDropped = 0;
+#endif
+
+#if LOG_SINK_SYSLOG_ENABLED
+    logSinkSyslogChecked = false;
+#endif
+}
+
+
+/**
+    Log sink re-init.
+    The syslog server follows the MQTT server so check it again after a configuration change.
+*/
+void logSinkReinit(void) {
+#if LOG_SINK_SYSLOG_ENABLED
+    logSinkSyslogChecked = false;
+#endif
+}
+
+
+/**
+    Add a formatted log record to the ring buffer.
+    Called from debugLog so the sink shares the debug formatting path.
+    When the ring buffer is full the lowest severity record is dropped.
+
+    @param[in]     level log level of the record.
+    @param[in]     header pointer to the formatted log header.
+    @param[in]     module pointer to the module name (NULL when there is no module).
+    @param[in]     message pointer to the message.
+*/
+void logSinkRecord(const logLevel level, const char * const header, const char * const module, const char * const message) {
+
+#if LOG_SINK_ENABLED
+    // Index of the slot for the record
+    unsigned int slot;
+
+    // Ignore records generated by the sink's own transmission
+    if ((logSinkTransmitting == true) || ((unsigned int)level >= logSinkLevels)) {
+        return;
+    }
+
+    slot = logSinkAllocate(level);
+
+    if (slot != LOG_SINK_RECORDS) {
+        logSinkRing[slot].used = true;
+        logSinkRing[slot].level = level;
+        logSinkRing[slot].sequence = logSinkSequence++;
+
+        if (module != NULL) {
+            snprintf(logSinkRing[slot].text, LOG_SINK_RECORD_SIZE, "%s%s: %s", header, module, message);
+        }
+        else {
+            snprintf(logSinkRing[slot].text, LOG_SINK_RECORD_SIZE, "%s%s", header, message);
+        }
+    }
+#else
+    // The sink is off, nothing is recorded
+    (void) level;
+    (void) header;
+    (void) module;
+    (void) message;
+#endif
+}
+
+
+/**
+    Cycle task for the log sink.
+    Transmits at most one batch per call so it never blocks the scheduler.
+*/
+void logSinkCyclicTask(void) {
+
+#if LOG_SINK_ENABLED
+    // Timer until the next batch
+    static uint32_t batchTimer = SECS_TO_CALLS(LOG_SINK_BATCH_TIME_S);
+
+    // Last batch was sent (after a failure the next batch waits for the batch time)
+    static bool batchSent = true;
+
+    if (batchTimer > 0) {
+        batchTimer--;
+    }
+
+    // Nothing to send
+    if ((logSinkRecordsUsed == 0) && (logSinkDropped == 0)) {
+        return;
+    }
+
+    // Batch time elapsed or the ring buffer is filling up, records stay buffered while WiFi is down or the transport fails
+    if (((batchTimer == 0) || ((logSinkRecordsUsed >= LOG_SINK_FLUSH_THRESHOLD) && (batchSent == true))) && (wifiIsConnected() == true)) {
+        batchSent = logSinkTransmitBatch();
+        batchTimer = SECS_TO_CALLS(LOG_SINK_BATCH_TIME_S);
+    }
+#endif
+}
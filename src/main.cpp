@@ -2,8 +2,13 @@
 #include <TaskScheduler.h>
 
 #include "debug.h"
+#include "log_sink.h"
+#include "journal.h"
+#include "stack_monitor.h"
+#include "boot_profile.h"
 #include "version.h"
 #include "wifi.h"
+#include "wifi_supervisor.h"
 #include "ota.h"
 #include "mqtt.h"
 #include "alarm.h"
@@ -19,6 +24,9 @@
 #include "ultrasonics_ctrl.h"
 #include "garage_door.h"
 
+// Wrap a task callback so the heap is sampled around the task and the executing task is known
+#define TASK_CALLBACK(callback)     ([]() { runtimeTaskStart(#callback); callback(); runtimeTaskEnd(#callback); })
+
 // Local function definitions
 void periodicMessageTx(void);
 
@@ -33,19 +41,24 @@ static HardwareSerial *debugSerialPort;
 static HardwareSerial *alarmSerialPort;
 
 // Create tasks
-Task wifiStatus(30000, TASK_FOREVER, &checkWifi);
-Task mqttClientTask(100, TASK_FOREVER, &mqttClientLoop);
-Task mqttMessageTask(10000, TASK_FOREVER, &mqttMessageLoop);
-
-Task taskInputsCyclic(INPUTS_CYCLIC_RATE, TASK_FOREVER, &inputsCyclicTask);
-Task taskOutputsCyclic(OUTPUTS_CYCLIC_RATE, TASK_FOREVER, &outputsCyclicTask);
-Task taskResetCtrl(RESET_CTRL_CYCLIC_RATE, TASK_FOREVER, &restCtrlStateMachine);
-Task taskStatusCtrl(STATUS_CTRL_CYCLIC_RATE, TASK_FOREVER, &statusCtrlStateMachine);
-Task taskHawkbitCtrl(HAWKBIT_CLIENT_CYCLIC_RATE, TASK_FOREVER, &hawkbitClientStateMachine);
-Task taskAlarmCyclic(ALARM_CYCLIC_RATE, TASK_FOREVER, &alarmCyclicTask);
-Task taskUltrasonicsCtrl(ULTRASONICS_CTRL_CYCLIC_RATE, TASK_FOREVER, &ultrasonicCtrlStateMachine);
-Task taskGarageDoorCyclic(GARAGE_DOOR_CYCLIC_RATE, TASK_FOREVER, &garageDoorCyclicTask);
-Task taskPeriodicMessageTx(30000, TASK_FOREVER, &periodicMessageTx);
+Task taskWifiCyclic(WIFI_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(wifiCyclicTask));
+Task taskWifiSupervisor(WIFI_SUPERVISOR_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(wifiSupervisorStateMachine));
+Task mqttClientTask(100, TASK_FOREVER, TASK_CALLBACK(mqttClientLoop));
+Task mqttMessageTask(10000, TASK_FOREVER, TASK_CALLBACK(mqttMessageLoop));
+
+Task taskInputsCyclic(INPUTS_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(inputsCyclicTask));
+Task taskOutputsCyclic(OUTPUTS_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(outputsCyclicTask));
+Task taskResetCtrl(RESET_CTRL_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(restCtrlStateMachine));
+Task taskStatusCtrl(STATUS_CTRL_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(statusCtrlStateMachine));
+Task taskHawkbitCtrl(HAWKBIT_CLIENT_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(hawkbitClientStateMachine));
+Task taskHawkbitDownload(HAWKBIT_CLIENT_DOWNLOAD_RATE, TASK_FOREVER, TASK_CALLBACK(hawkbitClientDownloadCyclic));
+Task taskAlarmCyclic(ALARM_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(alarmCyclicTask));
+Task taskUltrasonicsCtrl(ULTRASONICS_CTRL_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(ultrasonicCtrlStateMachine));
+Task taskGarageDoorCyclic(GARAGE_DOOR_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(garageDoorCyclicTask));
+Task taskPeriodicMessageTx(30000, TASK_FOREVER, TASK_CALLBACK(periodicMessageTx));
+Task taskLogSink(LOG_SINK_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(logSinkCyclicTask));
+Task taskNvmCyclic(NVM_CYCLIC_RATE, TASK_FOREVER, TASK_CALLBACK(nvmCyclicTask));
+Task taskNvmDeferred(NVM_DEFERRED_DELAY, TASK_ONCE, TASK_CALLBACK(nvmValidateDeferred));
 
 void testo() {
     //static bool pino = true;
@@ -58,28 +71,41 @@ void testo() {
     //else pino = true;
 }
 
-Task switcher(1000, TASK_FOREVER, &testo);
+Task switcher(1000, TASK_FOREVER, TASK_CALLBACK(testo));
 
 void setup(void) {
+
+    // Time spent before setup (core and SDK start-up)
+    bootProfileStep("preSetup");
     
     // STEP 0 - Identify variant
     wifiIdentifyModule();
+    bootProfileStep("wifiIdentifyModule");
 
     // STEP 1 - Setup debug serial
     debugSerialPort = debugSetSerial(&Serial1);
     debugSerialPort->begin(115200);
     debugSerialPort->println();    
+    logSinkInit();
+    journalInit();
+    stackMonitorInit();
+    bootProfileStep("debugInit");
     
     // STEP 2 - Set up basic software
     nvmInit();
+    bootProfileStep("nvmInit");
     inputsInit();
+    bootProfileStep("inputsInit");
     outputsInit();
+    bootProfileStep("outputsInit");
     versionInit();
+    bootProfileStep("versionInit");
 
     // STEP 3 - Set up the applications
-    hawkbitClientInit();
     restCtrlInit();
+    bootProfileStep("restCtrlInit");
     statusCtrlInit();
+    bootProfileStep("statusCtrlInit");
 
     if (getWiFiModuleDetails()->moduleHostType == alarmModule) {
         // Set up the alarm interface
@@ -93,19 +119,27 @@ void setup(void) {
     else if (getWiFiModuleDetails()->moduleHostType == garageDoorModule) {
         garageDoorInit();
     }
+    bootProfileStep("moduleInit");
 
     // Set-up wifi
     setupWifi();
+    wifiSupervisorInit();
+    bootProfileStep("setupWifi");
 
     // Set-up ota
     otaSetup();
+    bootProfileStep("otaSetup");
 
     // Set-up mqtt
     mqttSetup();
+    bootProfileStep("mqttSetup");
+
+    // Hawkbit is set up on its first task run (not needed until the first poll, validates its deferred NVM structure)
 
         
     // Add scheduler tasks and enable
-    scheduler.addTask(wifiStatus);        
+    scheduler.addTask(taskWifiSupervisor);
+    scheduler.addTask(taskWifiCyclic);        
     scheduler.addTask(mqttClientTask);
     scheduler.addTask(mqttMessageTask);
    
@@ -114,12 +148,17 @@ void setup(void) {
     scheduler.addTask(taskResetCtrl);
     scheduler.addTask(taskStatusCtrl);
     scheduler.addTask(taskHawkbitCtrl);
+    scheduler.addTask(taskHawkbitDownload);
     scheduler.addTask(taskPeriodicMessageTx);
     scheduler.addTask(taskAlarmCyclic);
     scheduler.addTask(taskUltrasonicsCtrl);
     scheduler.addTask(taskGarageDoorCyclic);
+    scheduler.addTask(taskLogSink);
+    scheduler.addTask(taskNvmCyclic);
+    scheduler.addTask(taskNvmDeferred);
 
-    wifiStatus.enable();
+    taskWifiSupervisor.enable();
+    taskWifiCyclic.enable();
     mqttClientTask.enable();
     mqttMessageTask.enable();
 
@@ -128,7 +167,11 @@ void setup(void) {
     taskResetCtrl.enable();
     taskStatusCtrl.enable();
     taskHawkbitCtrl.enable();
+    taskHawkbitDownload.enable();
     taskPeriodicMessageTx.enable();
+    taskLogSink.enable();
+    taskNvmCyclic.enable();
+    taskNvmDeferred.enableDelayed();
     
     if (getWiFiModuleDetails()->moduleHostType == alarmModule) {
         taskAlarmCyclic.enable();
@@ -156,6 +199,7 @@ void loop(void) {
 
     // Handle tasks
     otaLoop();
+    wifiPortalLoop();
     
     if (getWiFiModuleDetails()->moduleHostType == alarmModule) {
         alarmBackgroundLoop();
@@ -174,6 +218,7 @@ void periodicMessageTx(void) {
     versionTransmitVersionMessage();
     runtimeTransmitRuntimeMessage();
     wifiTransmitWifiMessage();
+    wifiSupervisorTransmitOutageMessage();
     nvmTransmitStatusMessage();
     
     // Only handle alarm messages if this is an alarm unit
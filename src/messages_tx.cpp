@@ -32,6 +32,21 @@ static const char* messageMqttTopicModuleRuntime = MESSAGES_TX_MQTT_TOPIC_MODULE
 // MQTT topic for module wifi
 static const char* messageMqttTopicModuleWifi = MESSAGES_TX_MQTT_TOPIC_MODULE_WIFI;
 
+// MQTT topic for module log
+static const char* messageMqttTopicModuleLog = MESSAGES_TX_MQTT_TOPIC_MODULE_LOG;
+
+// MQTT topic for module wifi outage
+static const char* messageMqttTopicModuleWifiOutage = MESSAGES_TX_MQTT_TOPIC_MODULE_WIFI_OUTAGE;
+
+// MQTT topic for module crash
+static const char* messageMqttTopicModuleCrash = MESSAGES_TX_MQTT_TOPIC_MODULE_CRASH;
+
+// MQTT topic for module boot
+static const char* messageMqttTopicModuleBoot = MESSAGES_TX_MQTT_TOPIC_MODULE_BOOT;
+
+// MQTT topic for module config values
+static const char* messageMqttTopicModuleConfig = MESSAGES_TX_MQTT_TOPIC_MODULE_CONFIG;
+
 // MQTT topic for alarm status
 static const char* messageMqttTopicAlarmStatus = MESSAGES_TX_MQTT_TOPIC_ALARM_STATUS;
 
@@ -75,15 +90,24 @@ void messsagesTxVersionMessage(const versionData * const versionDataStructurePtr
 
     @param[in]     runtimeDataStructurePtr pointer to the runtime data structure
     @param[in]     runtimeDataStructureSize size of the runtime data structure
+    @param[in]     runtimeStringDataStructurePtr pointer to the runtime string data structure
+    @param[in]     runtimeStringDataStructureSize size of the runtime string data structure
 */
-void messsagesTxRuntimeMessage(const runtimeData * const runtimeDataStructurePtr, const unsigned int * const runtimeDataStructureSize) {
+void messsagesTxRuntimeMessage(const runtimeData * const runtimeDataStructurePtr, const unsigned int * const runtimeDataStructureSize, const runtimeStringData * const runtimeStringDataStructurePtr, const unsigned int * const runtimeStringDataStructureSize) {
   
     // Clear the JSON object
     doc.clear();
 
-    // Append all of the version data to the JSON object
+    // Append all of the version data to the JSON object (values that are not known are left out)
     for (unsigned int i = 0; i < *runtimeDataStructureSize; i++) {
-        doc[(runtimeDataStructurePtr + i)->runtimeName] = (unsigned long)*(runtimeDataStructurePtr + i)->runtimeContents;
+        if (*(runtimeDataStructurePtr + i)->runtimeContents != RUNTIME_NOT_AVAILABLE) {
+            doc[(runtimeDataStructurePtr + i)->runtimeName] = (unsigned long)*(runtimeDataStructurePtr + i)->runtimeContents;
+        }
+    }
+
+    // Append all of the string data to the JSON object
+    for (unsigned int i = 0; i < *runtimeStringDataStructureSize; i++) {
+        doc[(runtimeStringDataStructurePtr + i)->runtimeName] = *(runtimeStringDataStructurePtr + i)->runtimeContents;
     }
     
     // Searilise the JSON string
@@ -112,6 +136,15 @@ void messsagesTxWifiMessage(const wifiData * const wifiDataStructurePtr) {
     doc[wifiDataStructurePtr->subnetMaskName] = wifiDataStructurePtr->subnetMaskDataPtr;
     doc[wifiDataStructurePtr->macAddressName] = wifiDataStructurePtr->macAddressDataPtr;
     doc[wifiDataStructurePtr->rssiName] = *wifiDataStructurePtr->rssiDataPtr;
+    doc[wifiDataStructurePtr->rssiAverageName] = *wifiDataStructurePtr->rssiAverageDataPtr;
+    doc[wifiDataStructurePtr->rssiMinName] = *wifiDataStructurePtr->rssiMinDataPtr;
+    doc[wifiDataStructurePtr->rssiMaxName] = *wifiDataStructurePtr->rssiMaxDataPtr;
+    doc[wifiDataStructurePtr->rssiP10Name] = *wifiDataStructurePtr->rssiP10DataPtr;
+    doc[wifiDataStructurePtr->rssiP50Name] = *wifiDataStructurePtr->rssiP50DataPtr;
+    doc[wifiDataStructurePtr->rssiP90Name] = *wifiDataStructurePtr->rssiP90DataPtr;
+    doc[wifiDataStructurePtr->reconnectsName] = *wifiDataStructurePtr->reconnectsDataPtr;
+    doc[wifiDataStructurePtr->connectName] = *wifiDataStructurePtr->connectDataPtr;
+    doc[wifiDataStructurePtr->connectTimeName] = *wifiDataStructurePtr->connectTimeDataPtr;
 
     // Searilise the JSON string
     serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
@@ -120,6 +153,63 @@ void messsagesTxWifiMessage(const wifiData * const wifiDataStructurePtr) {
     mqttMessageSendRaw(messageMqttTopicModuleWifi, messageToSend);   
 }
 
+/**
+    Transmit a wifi outage message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     wifiSupervisorDataStructurePtr pointer to the wifi supervisor data structure
+*/
+void messsagesTxWifiOutageMessage(const wifiSupervisorData * const wifiSupervisorDataStructurePtr) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the date (manually because of mixed types)
+    doc[wifiSupervisorDataStructurePtr->stateName] = *wifiSupervisorDataStructurePtr->statePtr;
+    doc[wifiSupervisorDataStructurePtr->outagesName] = *wifiSupervisorDataStructurePtr->outagesPtr;
+    doc[wifiSupervisorDataStructurePtr->outageName] = *wifiSupervisorDataStructurePtr->outagePtr;
+    doc[wifiSupervisorDataStructurePtr->lastOutageName] = *wifiSupervisorDataStructurePtr->lastOutagePtr;
+    doc[wifiSupervisorDataStructurePtr->longestOutageName] = *wifiSupervisorDataStructurePtr->longestOutagePtr;
+    doc[wifiSupervisorDataStructurePtr->totalOutageName] = *wifiSupervisorDataStructurePtr->totalOutagePtr;
+    doc[wifiSupervisorDataStructurePtr->reconnectsName] = *wifiSupervisorDataStructurePtr->reconnectsPtr;
+    doc[wifiSupervisorDataStructurePtr->reassociationsName] = *wifiSupervisorDataStructurePtr->reassociationsPtr;
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    mqttMessageSendRaw(messageMqttTopicModuleWifiOutage, messageToSend);
+}
+
+/**
+    Transmit a config values message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     configValueDataStructurePtr pointer to the config value data structure
+    @param[in]     configValueDataStructureSize size of the config value data structure
+*/
+void messsagesTxConfigMessage(const configValueData * const configValueDataStructurePtr, const unsigned int * const configValueDataStructureSize) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the data (strings or numbers)
+    for (unsigned int i = 0; i < *configValueDataStructureSize; i++) {
+        if (configValueDataStructurePtr[i].valueType == configTypeString) {
+            doc[configValueDataStructurePtr[i].valueName] = configValueDataStructurePtr[i].valueStringPtr;
+        }
+        else {
+            doc[configValueDataStructurePtr[i].valueName] = configValueDataStructurePtr[i].valueNumber;
+        }
+    }
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    mqttMessageSendRaw(messageMqttTopicModuleConfig, messageToSend);
+}
+
 /**
     Transmit a alarm status message.
     Convert the message structure into JSON format here.
@@ -222,6 +312,11 @@ void messsagesTxNvmStatusMessage(const nvmData * const nvmDataStructurePtr) {
     doc["bytesConsumed"] = nvmDataStructurePtr->bytesConsumed;
     doc["structures"] = nvmDataStructurePtr->structures;
     doc["errorCounter"] = nvmDataStructurePtr->core.errorCounter;
+    doc["commits"] = nvmDataStructurePtr->commits;
+    doc["commitsSkipped"] = nvmDataStructurePtr->commitsSkipped;
+    doc["lastCommitBytes"] = nvmDataStructurePtr->lastCommitBytes;
+    doc["lastCommitTime"] = nvmDataStructurePtr->lastCommitTime;
+    doc["logSectors"] = nvmDataStructurePtr->logSectors;
     
     // Searilise the JSON string
     serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
@@ -251,4 +346,100 @@ void messsagesTxGarageStatusMessage(const garageDoorStatusData * const garageDoo
     // Transmit the message
     mqttMessageSendRaw(messageMqttTopicGarageDoorStatus, messageToSend);  
 
-}
\ No newline at end of file
+}
+
+/**
+    Transmit a log message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     logSinkDataStructurePtr pointer to the log sink data structure
+    @return        true when the message was published.
+*/
+bool messsagesTxLogMessage(const logSinkData * const logSinkDataStructurePtr) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the date (manually because of mixed types)
+    doc[logSinkDataStructurePtr->logName] = logSinkDataStructurePtr->logPtr;
+    doc[logSinkDataStructurePtr->droppedName] = *logSinkDataStructurePtr->droppedPtr;
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    return(mqttMessageSendRaw(messageMqttTopicModuleLog, messageToSend));
+}
+
+/**
+    Transmit a crash message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     journalDataStructurePtr pointer to the journal data structure
+*/
+void messsagesTxCrashMessage(const journalData * const journalDataStructurePtr) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the date (manually because of mixed types)
+    doc[journalDataStructurePtr->reasonName] = journalDataStructurePtr->reasonPtr;
+    doc[journalDataStructurePtr->exceptionName] = *journalDataStructurePtr->exceptionPtr;
+    doc[journalDataStructurePtr->epcName] = journalDataStructurePtr->epcPtr;
+    doc[journalDataStructurePtr->addressName] = journalDataStructurePtr->addressPtr;
+    doc[journalDataStructurePtr->bootsName] = *journalDataStructurePtr->bootsPtr;
+    doc[journalDataStructurePtr->uptimeName] = *journalDataStructurePtr->uptimePtr;
+    doc[journalDataStructurePtr->heapName] = *journalDataStructurePtr->heapPtr;
+    doc[journalDataStructurePtr->taskName] = journalDataStructurePtr->taskPtr;
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    mqttMessageSendRaw(messageMqttTopicModuleCrash, messageToSend);
+}
+
+/**
+    Transmit a crash log record message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     journalRecordDataStructurePtr pointer to the journal record data structure
+*/
+void messsagesTxCrashRecordMessage(const journalRecordData * const journalRecordDataStructurePtr) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the date (manually because of mixed types)
+    doc[journalRecordDataStructurePtr->recordName] = *journalRecordDataStructurePtr->recordPtr;
+    doc[journalRecordDataStructurePtr->logName] = journalRecordDataStructurePtr->logPtr;
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    mqttMessageSendRaw(messageMqttTopicModuleCrash, messageToSend);
+}
+
+/**
+    Transmit a boot profile message.
+    Convert the message structure into JSON format here.
+
+    @param[in]     bootProfileDataStructurePtr pointer to the boot profile data structure
+*/
+void messsagesTxBootMessage(const bootProfileData * const bootProfileDataStructurePtr) {
+
+    // Clear the JSON object
+    doc.clear();
+
+    // Populate the date (manually because of mixed types)
+    doc[bootProfileDataStructurePtr->stepName] = *bootProfileDataStructurePtr->stepPtr;
+    doc[bootProfileDataStructurePtr->durationName] = *bootProfileDataStructurePtr->durationPtr;
+    doc[bootProfileDataStructurePtr->cumulativeName] = *bootProfileDataStructurePtr->cumulativePtr;
+
+    // Searilise the JSON string
+    serializeJson(doc, messageToSend, MESSAGES_TX_MESSAGE_BUFFER_SIZE);
+
+    // Transmit the message
+    mqttMessageSendRaw(messageMqttTopicModuleBoot, messageToSend);
+}
@@ -4,6 +4,7 @@
 #include <ArduinoJson.h>
 
 #include "debug.h"
+#include "fixed_string.h"
 #include "nvm_cfg.h"
 
 #include "wifi.h"
@@ -12,6 +13,9 @@
 #include "garage_door.h"
 #include "outputs_cfg.h"
 #include "reset_ctrl.h"
+#include "journal.h"
+#include "boot_profile.h"
+#include "config.h"
 
 // Definitions
 #define MQTT_PORT               (1883)
@@ -20,16 +24,32 @@
 #define JSON_DOC_VAR_ARMDISARM  "armdisarm"
 #define JSON_DOC_VAR_OPENCLOSE  "openclose"
 
+// Size of the MQTT client buffer (topic + payload), larger than the library default for the runtime message
+#define MQTT_BUFFER_SIZE        (384)
+
+// Capacity of a full topic [mqtt_prefix]/[hostname]/[shortTopic]
+#define MQTT_TOPIC_SIZE         (NVM_MAX_LENGTH_TOPIC + 64)
+
+// Capacity of a debug message that includes a topic and payload
+#define MQTT_DEBUG_MESSAGE_SIZE (MQTT_TOPIC_SIZE + MQTT_MAX_PACKET_SIZE + 32)
+
+// Full topic string (fixed capacity, no heap)
+typedef fixedString<MQTT_TOPIC_SIZE> mqttTopicString;
+
+// Debug message string for messages including a topic and payload
+typedef fixedString<MQTT_DEBUG_MESSAGE_SIZE> mqttDebugString;
+
 // Static functions
 static void mqttMessageCallback(char* topic, byte* payload, unsigned int length);
 static void mqttReconnect(void);
 static void mqttMessageSubscribe(const char * const shortTopic);
-static void mqttMessageFullTopic(const char * const shortTopic, String * const longTopicPtr);
+static void mqttMessageFullTopic(const char * const shortTopic, mqttTopicString * const longTopicPtr);
 
 // MQTT settings
 const char* mqtt_garage_door_command = "garage door command";
 const char* mqtt_alarm_command = "alarm command";
 const char* mqtt_module_command = "module command";
+const char* mqtt_module_config = "module config";
 const char* mqttLwtMessage = "module status";
 
 // LWT values
@@ -40,6 +60,19 @@ const char* mqttLwtValueOffline = "offline";
 WiFiClient espClient;
 PubSubClient client(espClient);
 
+// Received message buffers (static, the handlers and the send path below run nested on the stack)
+static mqttTopicString mqttRxTopicBase;
+static StaticJsonDocument<JSON_DOC_SIZE> mqttRxDoc;
+static char mqttRxPayload[MQTT_MAX_PACKET_SIZE];
+static mqttDebugString mqttRxDebugMessage;
+
+// Transmitted message buffers (static, kept off the stack of the modules that send)
+static mqttTopicString mqttTxTopic;
+static mqttDebugString mqttTxDebugMessage;
+
+// Boot and crash messages are due after a connection (sent by mqttClientLoop, never from inside a send)
+static bool mqttConnectMessagesPending = false;
+
 /**
     Call back for handling received mqtt messages.
     Callback also processes the command message.
@@ -50,42 +83,38 @@ PubSubClient client(espClient);
 */
 static void mqttMessageCallback(char* topic, byte* payload, unsigned int length) {
 
-    // Message topic base
-    String mqttMessageTopicBase;
-
-    StaticJsonDocument<JSON_DOC_SIZE> doc;
-    char payloadBuffer[MQTT_MAX_PACKET_SIZE];
-    String debugMessage;
+    // Buffers are static (mqttRx...), the message handlers can send and reconnect
+    StaticJsonDocument<JSON_DOC_SIZE> & doc = mqttRxDoc;
+    char * const payloadBuffer = mqttRxPayload;
+    mqttDebugString & debugMessage = mqttRxDebugMessage;
 
     // Construct the message topic base
-    mqttMessageFullTopic("", &mqttMessageTopicBase);
+    mqttMessageFullTopic("", &mqttRxTopicBase);
 
     // Make sure that message is smaller than the buffer
     if((length + 1) <= MQTT_MAX_PACKET_SIZE) {
         // Extract the message part of the payload
         snprintf(payloadBuffer, (length + 1), "%s", payload);
         
-        debugMessage = (String() + "MQTT RX message [" + topic + "]: " + payloadBuffer);
-        debugLog(&debugMessage, info);
+        debugMessage.format("MQTT RX message [%s]: %s", topic, payloadBuffer);
+        debugLog(debugMessage.c_str(), info);
 
         DeserializationError jsonError = deserializeJson(doc, payloadBuffer);
     
         // Check if the converted string was valid json
         if (jsonError) {
-            debugMessage = (String() + "MQTT deserializeJson() failed: " + jsonError.f_str());
-            debugLog(&debugMessage, error);
+            debugMessage.format("MQTT deserializeJson() failed: %s", jsonError.c_str());
+            debugLog(debugMessage.c_str(), error);
         }
 
         else {
 
             // Module command message (+1 because of /) 
-            if (strcmp(topic + mqttMessageTopicBase.length(), mqtt_module_command) == 0) {
+            if (strcmp(topic + mqttRxTopicBase.length(), mqtt_module_command) == 0) {
                 // Check if the json contains a valid text value
                 if (doc.containsKey(JSON_DOC_VAR_RESET)) {               
-                    String rxText = doc[JSON_DOC_VAR_RESET];
-
-                    debugMessage = (String() + "MQTT found JSON key: " + JSON_DOC_VAR_RESET);
-                    debugLog(&debugMessage, info);
+                    debugMessage.format("MQTT found JSON key: %s", JSON_DOC_VAR_RESET);
+                    debugLog(debugMessage.c_str(), info);
 
                     resetCtrlTypes resetCommanded = doc[JSON_DOC_VAR_RESET];
                     restCtrlSetResetRequest(resetCommanded);
@@ -100,37 +129,40 @@ static void mqttMessageCallback(char* topic, byte* payload, unsigned int length)
                 //Serial1.println(String() + a + " " + b + " " + c + " " + d + " " + e + " ");
             }
 
+            // Module config message (replies on the config values topic, last as applying can drop the connection)
+            else if (strcmp(topic + mqttRxTopicBase.length(), mqtt_module_config) == 0) {
+                configCommand(&doc);
+            }
+
             // Alarm command message (+1 because of /)
-            else if (strcmp(topic + mqttMessageTopicBase.length(), mqtt_alarm_command) == 0) {
+            else if (strcmp(topic + mqttRxTopicBase.length(), mqtt_alarm_command) == 0) {
 
                 // Check if the json contains a valid text value
                 if (doc.containsKey(JSON_DOC_VAR_ARMDISARM)) {               
-                    String rxText = doc[JSON_DOC_VAR_ARMDISARM];
                     alarmFireOneShot();
 
-                    debugMessage = (String() + "MQTT found JSON key: " + JSON_DOC_VAR_ARMDISARM);
-                    debugLog(&debugMessage, info);
+                    debugMessage.format("MQTT found JSON key: %s", JSON_DOC_VAR_ARMDISARM);
+                    debugLog(debugMessage.c_str(), info);
                 }
             }
 
             // Garage door command message (+1 because of /)
-            else if (strcmp(topic + mqttMessageTopicBase.length(), mqtt_garage_door_command) == 0) {
+            else if (strcmp(topic + mqttRxTopicBase.length(), mqtt_garage_door_command) == 0) {
 
                 // Check if the json contains a valid text value
                 if (doc.containsKey(JSON_DOC_VAR_OPENCLOSE)) {               
-                    String rxText = doc[JSON_DOC_VAR_OPENCLOSE];
                     garageDoorFireOneShot();
 
-                    debugMessage = (String() + "MQTT found JSON key: " + JSON_DOC_VAR_OPENCLOSE);
-                    debugLog(&debugMessage, info);
+                    debugMessage.format("MQTT found JSON key: %s", JSON_DOC_VAR_OPENCLOSE);
+                    debugLog(debugMessage.c_str(), info);
                 }
             }
         }
     }
 
     else {
-        debugMessage = (String() + "Received message bigger than allocated buffer of " + MQTT_MAX_PACKET_SIZE);
-        debugLog(&debugMessage, error);
+        debugMessage.format("Received message bigger than allocated buffer of %u", (unsigned int)MQTT_MAX_PACKET_SIZE);
+        debugLog(debugMessage.c_str(), error);
     }    
 }
 
@@ -141,10 +173,10 @@ static void mqttMessageCallback(char* topic, byte* payload, unsigned int length)
 static void mqttReconnect(void) {   
     
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // Full topic string
-    String fullTopicLwt;
+    mqttTopicString fullTopicLwt;
 
     // Pointer to the RAM mirror
     const nvmCompleteStructure * ramMirrorPtr;
@@ -152,21 +184,27 @@ static void mqttReconnect(void) {
     // Set-up pointer to RAM mirror
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
     
-    // Create a client ID based on the mac address
-    String clientId = (String() + getWiFiModuleDetails()->moduleHostName);
+    // Client ID is the host name
+    const char * const clientId = getWiFiModuleDetails()->moduleHostName;
+
+    // No point trying without WiFi (the WiFi supervisor handles the recovery)
+    if (wifiIsConnected() == false) {
+        return;
+    }
 
     // Create the full message topic with prefix and hostname for LWT
     mqttMessageFullTopic(mqttLwtMessage, &fullTopicLwt);
     
     // Attempt to connect
-    debugMessage = (String() + "MQTT attempting connection from " + clientId.c_str() + " to " + ramMirrorPtr->mqtt.mqttServer  + ":" + MQTT_PORT);
-    debugLog(&debugMessage, info);
+    debugMessage.format("MQTT attempting connection from %s to %s:%d", clientId, ramMirrorPtr->mqtt.mqttServer, MQTT_PORT);
+    debugLog(debugMessage.c_str(), info);
 
-    if (client.connect(clientId.c_str(), ramMirrorPtr->mqtt.mqttUser, ramMirrorPtr->mqtt.mqttPassword, fullTopicLwt.c_str(), 0, true, mqttLwtValueOffline)) {
-        debugMessage = (String() + "MQTT connected to " + ramMirrorPtr->mqtt.mqttServer + ":" + MQTT_PORT);
-        debugLog(&debugMessage, info);
+    if (client.connect(clientId, ramMirrorPtr->mqtt.mqttUser, ramMirrorPtr->mqtt.mqttPassword, fullTopicLwt.c_str(), 0, true, mqttLwtValueOffline)) {
+        debugMessage.format("MQTT connected to %s:%d", ramMirrorPtr->mqtt.mqttServer, MQTT_PORT);
+        debugLog(debugMessage.c_str(), info);
         
         mqttMessageSubscribe(mqtt_module_command);
+        mqttMessageSubscribe(mqtt_module_config);
 
         // Subscribing for module specific messages
         if (getWiFiModuleDetails()->moduleHostType == alarmModule) {
@@ -181,12 +219,15 @@ static void mqttReconnect(void) {
 
         // Transmit the LWT message
         client.publish(fullTopicLwt.c_str(), mqttLwtValueOnline, true);
-        debugMessage = (String() + "MQTT TX LWT message [" + fullTopicLwt + "]: " + mqttLwtValueOnline);
-        debugLog(&debugMessage, info);    
+        debugMessage.format("MQTT TX LWT message [%s]: %s", fullTopicLwt.c_str(), mqttLwtValueOnline);
+        debugLog(debugMessage.c_str(), info);    
+
+        // Report the boot profile and a crash / reset from the previous boot later (the messages share the buffers of messages_tx with the send that reconnected)
+        mqttConnectMessagesPending = true;
     } 
     else {
-        debugMessage = (String() + "MQTT connection to " + ramMirrorPtr->mqtt.mqttServer + ":" + MQTT_PORT + " failed (rc=" + client.state() + "), will retry later");
-        debugLog(&debugMessage, error);
+        debugMessage.format("MQTT connection to %s:%d failed (rc=%d), will retry later", ramMirrorPtr->mqtt.mqttServer, MQTT_PORT, client.state());
+        debugLog(debugMessage.c_str(), error);
     }
 }
 
@@ -202,6 +243,7 @@ void mqttSetup(void) {
     // Set-up pointer to RAM mirror
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
   
+    client.setBufferSize(MQTT_BUFFER_SIZE);
     client.setServer(ramMirrorPtr->mqtt.mqttServer, MQTT_PORT);
     client.setCallback(mqttMessageCallback);
 
@@ -210,11 +252,37 @@ void mqttSetup(void) {
 }
 
 
+/**
+    MQTT re-init.
+    Picks up a new server, credentials or root topic by dropping the connection (mqttMessageLoop reconnects).
+*/
+void mqttReinit(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    client.disconnect();
+    client.setServer(ramMirrorPtr->mqtt.mqttServer, MQTT_PORT);
+}
+
+
 /**
     MQTT client loop.
+    Sends the boot and crash messages once connected (own task, so never nested inside another send).
 */
 void mqttClientLoop(void) {
     client.loop();
+
+    // Report the boot profile and a crash / reset from the previous boot (only happens once)
+    if ((mqttConnectMessagesPending == true) && (client.connected())) {
+        mqttConnectMessagesPending = false;
+
+        bootProfileTransmitBootMessage();
+        journalTransmitCrashMessage();
+    }
 }
 
 
@@ -238,10 +306,7 @@ void mqttMessageLoop(void) {
     @param[in]     shortTopic pointer to the topic (short form without prefix and hostname)
     @param[in]     longTopicPtr pointer to the final location for the full topic
 */
-static void mqttMessageFullTopic(const char * const shortTopic, String * const longTopicPtr) {
-    
-    // Full topic string
-    String fullTopic;
+static void mqttMessageFullTopic(const char * const shortTopic, mqttTopicString * const longTopicPtr) {
     
     // Pointer to the RAM mirror
     const nvmCompleteStructure * ramMirrorPtr;
@@ -250,7 +315,7 @@ static void mqttMessageFullTopic(const char * const shortTopic, String * const l
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
 
     // Create the full message topic with prefix and hostname
-    *longTopicPtr = String() + ramMirrorPtr->mqtt.mqttTopicRoot + '/' + getWiFiModuleDetails()->moduleHostName + '/' + shortTopic;
+    longTopicPtr->format("%s/%s/%s", ramMirrorPtr->mqtt.mqttTopicRoot, getWiFiModuleDetails()->moduleHostName, shortTopic);
 }
 
 
@@ -264,18 +329,18 @@ static void mqttMessageFullTopic(const char * const shortTopic, String * const l
 static void mqttMessageSubscribe(const char * const shortTopic) {
     
     // Full topic string
-    String fullTopic;
+    mqttTopicString fullTopic;
     
     // Create the full message topic with prefix and hostname
     mqttMessageFullTopic(shortTopic, &fullTopic);
 
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // Subscribe to the message
     client.subscribe(fullTopic.c_str());
-    debugMessage = (String() + "MQTT subscribed to message [" + fullTopic + "]");
-    debugLog(&debugMessage, info);
+    debugMessage.format("MQTT subscribed to message [%s]", fullTopic.c_str());
+    debugLog(debugMessage.c_str(), info);
 }
 
 
@@ -286,25 +351,22 @@ static void mqttMessageSubscribe(const char * const shortTopic) {
 
     @param[in]     shortTopic pointer to the topic (short form without prefix and hostname)
     @param[in]     message pointer to the message
+    @return        true when the message was published.
 */
-void mqttMessageSendRaw(const char * const shortTopic, const char * const  message) {
-
-    // Full topic string
-    String fullTopic;
-
-    // Create the full message topic with prefix and hostname
-    mqttMessageFullTopic(shortTopic, &fullTopic);
-    
-    // Debug message
-    String debugMessage;
+bool mqttMessageSendRaw(const char * const shortTopic, const char * const  message) {
 
     // If the client isn't connected, try and reconnect
     if (!client.connected()) {
         mqttReconnect();
     }  
 
-    // Transmit the message
-    client.publish(fullTopic.c_str(), message);
-    debugMessage = (String() + "MQTT TX message [" + fullTopic + "]: " + message);
-    debugLog(&debugMessage, info);
+    // Create the full message topic with prefix and hostname
+    mqttMessageFullTopic(shortTopic, &mqttTxTopic);
+
+    // Transmit the message (fails when the reconnection failed)
+    const bool published = client.publish(mqttTxTopic.c_str(), message);
+    mqttTxDebugMessage.format("MQTT TX message [%s]: %s", mqttTxTopic.c_str(), message);
+    debugLog(mqttTxDebugMessage.c_str(), info);
+
+    return(published);
 }
@@ -1,10 +1,12 @@
 #include <Arduino.h>
 #include <EEPROM.h>
-#include <CRC32.h>
 
 #include "nvm.h"
 #include "nvm_cfg.h"
+#include "nvm_log.h"
+#include "crc.h"
 
+#include "utils.h"
 #include "debug.h"
 #include "messages_tx.h"
 
@@ -15,6 +17,41 @@
 // Cleared NVM contents
 static const nvmCompleteStructure nvmClearRamMirror = {0};
 
+// Structures with an updated CRC since the last commit (NVM_STRUCTURE_BIT)
+static uint32_t nvmDirtyStructures = 0;
+
+// Structures that have been validated (NVM_STRUCTURE_BIT)
+static uint32_t nvmValidatedStructures = 0;
+
+// Number of commits that wrote to flash
+static uint32_t nvmCommits = 0;
+
+// Number of commits skipped (nothing differed from flash)
+static uint32_t nvmCommitsSkipped = 0;
+
+// Bytes changed by the last commit
+static uint32_t nvmLastCommitBytes = 0;
+
+// Duration of the last commit (uS, time spent writing the flash)
+static uint32_t nvmLastCommitTime = 0;
+
+// Commit in progress
+static bool nvmCommitBusy = false;
+
+// Time spent writing the flash for the commit in progress (uS)
+static uint32_t nvmCommitTime = 0;
+
+// Callbacks waiting for the commit in progress
+static nvmCommitCallback nvmCommitCallbacks[NVM_COMMIT_CALLBACKS_MAX];
+
+// Number of callbacks waiting for the commit in progress
+static uint32_t nvmCommitCallbackCount = 0;
+
+// Local function definitions
+static void nvmCommitBegin(void);
+static bool nvmCommitStep(void);
+static void nvmCommitComplete(void);
+
 
 /**
     Clear the NVM contents.
@@ -28,23 +65,28 @@ void nvmClear(void) {
     // Set up read write pointers to the RAM mirror
     (void)nvmGetRamMirrorPointerRW(&ramMirrorPtr);
 
-    // Comitt a corrupted default configuration and reload RAM mirror
-    EEPROM.put(NVM_BASE_ADDRESS, nvmClearRamMirror);
-    EEPROM.commit();
-    EEPROM.get(NVM_BASE_ADDRESS, *ramMirrorPtr);
+    // Comitt a corrupted default configuration (restored to defaults at the next start-up)
+    // The log discards the older sectors at the next start-up, so no previous generation comes back
+    memcpy(ramMirrorPtr, &nvmClearRamMirror, sizeof(nvmClearRamMirror));
+    nvmLogWriteAll(ramMirrorPtr);
+
+    // RAM mirror matches the log again
+    nvmDirtyStructures = 0;
 }
 
 
 /**
-    Check the CRC's of all NVM structures.
-    If there is corruption and correctDefaults is allowed, then recover and rewrite EEPROM.
-    Assumes that RAM mirror is pre-populated from EEPROM.
-    This call is BLOCKING (can start writing the RAM mirrors to EEPROM).
+    Check the CRC's of the requested NVM structures (structures already validated are skipped).
+    If there is corruption, recover the previous generation from the NVM log, or the defaults when correctDefaults is allowed, and rewrite the NVM.
+    Assumes that RAM mirror is pre-populated from the NVM.
+    This call is BLOCKING (can start writing the RAM mirrors to the NVM log).
+
+    @param[in]     structures mask of the structures to check (NVM_STRUCTURE_BIT).
 */
-static void nvmCheckIntegrity(void) {
+static void nvmCheckIntegrity(const uint32_t structures) {
     
     // Debug message string
-    String debugMessage;
+    debugString debugMessage;
 
     // Pointer to the RAM mirror
     nvmCompleteStructure * ramMirrorPtr;
@@ -64,20 +106,21 @@ static void nvmCheckIntegrity(void) {
     // Read CRC
     crc_t crcRead = 0;
 
-    // Char buffer for expected CRC
-    char crcStringExpected[NVM_CRC_SIZE_CHARS];
-
-    // Char buffer for read CRC
-    char crcStringRead[NVM_CRC_SIZE_CHARS];
-    
     // NVM update
     bool nvmUpdate = false;
     
-    // Check the CRC's of all the NVM structures
+    // Check the CRC's of the requested NVM structures
     for (unsigned int i = 0; i < nvmConfigSize; i++) {
 
+        // Not requested or already validated
+        if (((structures & NVM_STRUCTURE_BIT(i)) == 0) || ((nvmValidatedStructures & NVM_STRUCTURE_BIT(i)) != 0)) {
+            continue;
+        }
+
+        nvmValidatedStructures |= NVM_STRUCTURE_BIT(i);
+
         // Calculate the expected CRC
-        crcExpected = CRC32::calculate(nvmConfigPtr[i].addressRamMirror, nvmConfigPtr[i].length);
+        crcExpected = crcCalculate(nvmConfigPtr[i].addressRamMirror, nvmConfigPtr[i].length);
 
         // Copy in the current CRC
         memcpy(&crcRead, nvmConfigPtr[i].addressCrc, NVM_CRC_SIZE_BYTES);
@@ -86,13 +129,25 @@ static void nvmCheckIntegrity(void) {
         if (crcExpected != crcRead) {
             
             // Debug message
-            sprintf(crcStringExpected, "%08X", crcExpected);
-            sprintf(crcStringRead, "%08X", crcRead);
-            debugMessage = String() + "NVM Structure: " + i + " is corrupt (expected 0x" + crcStringExpected + ", read 0x" + crcStringRead + ").";
-            debugLog(&debugMessage, error);
+            debugMessage.format("NVM Structure: %u is corrupt (expected 0x%08lX, read 0x%08lX).", i, (unsigned long)crcExpected, (unsigned long)crcRead);
+            debugLog(debugMessage.c_str(), error);
+
+            // Recover the previous generation from the NVM log first (keeps the configuration)
+            // A torn record is already skipped by the log replay, this covers an intact record holding a corrupt structure
+            if (nvmLogRestorePrevious(i, ramMirrorPtr) == true) {
+
+                // Update the CRC in the RAM mirror (marks the structure for the commit)
+                nvmUpdateRamMirrorCrcByIndex(i);
+
+                nvmUpdate = true;
+
+                // Debug message
+                debugMessage.format("NVM Structure: %u restored previous generation.", i);
+                debugLog(debugMessage.c_str(), warning);
+            }
 
             // Recovery is allowed for the current structure
-            if ((nvmConfigPtr + i)->rewriteWhenCorrupt == true) {
+            else if ((nvmConfigPtr + i)->rewriteWhenCorrupt == true) {
                 
                 // Copy the defaults to the RAM mirror
                 memcpy(nvmConfigPtr[i].addressRamMirror, nvmConfigPtr[i].addressRomDefault, nvmConfigPtr[i].length);
@@ -103,8 +158,8 @@ static void nvmCheckIntegrity(void) {
                 nvmUpdate = true;
 
                 // Debug message
-                debugMessage = String() + "NVM Structure: " + i + " restored defaults.";
-                debugLog(&debugMessage, warning);
+                debugMessage.format("NVM Structure: %u restored defaults.", i);
+                debugLog(debugMessage.c_str(), warning);
             }
         }
     }
@@ -126,6 +181,7 @@ static void nvmCheckIntegrity(void) {
 
 /**
     Update indexed RAM mirror structure CRC based on the current structure contents.
+    Marks the structure as dirty for the next commit.
   
     @param[in]     index index of the NVM structure the will have the CRC update.
 */
@@ -150,40 +206,185 @@ void nvmUpdateRamMirrorCrcByIndex(uint32_t index) {
     if(index < nvmConfigSize) {
         
         // Calculate the CRC and copy it to the RAM mirror
-        crcCalculated = CRC32::calculate(nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].length);
+        crcCalculated = crcCalculate(nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].length);
         memcpy(nvmConfigPtr[index].addressCrc, &crcCalculated, NVM_CRC_SIZE_BYTES);
+
+        nvmDirtyStructures |= NVM_STRUCTURE_BIT(index);
     }
 }
 
 
 /**
-    Comitt the RAM mirror directly to NVM.
-    Before calling, make sure the appropiate structure CRC's have been updated.
-    This call is BLOCKING (writing the RAM mirrors to EEPROM).
+    Migration that keeps the old data when fields were only added to the end of a structure.
+    The added fields keep their ROM defaults.
+
+    @param[in]     oldDataPtr pointer to the old data.
+    @param[in]     oldLength length of the old data (excluding the CRC).
+    @param[out]    newDataPtr pointer to the new data (pre-filled with the ROM defaults).
+    @param[in]     newLength length of the new data (excluding the CRC).
 */
-void nvmComittRamMirror(void) {
+void nvmMigrateExtend(const uint8_t * const oldDataPtr, const uint32_t oldLength, uint8_t * const newDataPtr, const uint32_t newLength) {
+
+    // The old footer buffer is not data, do not copy it over the new fields
+    const uint32_t dataLength = oldLength - min(oldLength, (uint32_t)sizeof(((nvmFooterCrc *)0)->buffer));
+
+    memcpy(newDataPtr, oldDataPtr, min(dataLength, newLength));
+}
+
+
+/**
+    Take the dirty structures for the commit (starts a commit or adds them to the one in progress).
+    Only structures that differ from the stored contents are written, the flash is not touched when nothing differs.
+*/
+static void nvmCommitBegin(void) {
 
     // Pointer to the RAM mirror
-    nvmCompleteStructure * ramMirrorPtr;
+    const nvmCompleteStructure * ramMirrorPtr;
 
     // Set-up pointer to RAM mirror
-    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Take the dirty structures that differ (no flash access)
+    const uint32_t commitBytes = nvmLogWriteBegin(ramMirrorPtr, nvmDirtyStructures);
+
+    nvmDirtyStructures = 0;
+
+    if (commitBytes > 0) {
+        nvmCommits++;
+    }
+    else {
+        nvmCommitsSkipped++;
+    }
+
+    if (nvmCommitBusy == false) {
+        nvmCommitBusy = true;
+        nvmCommitTime = 0;
+        nvmLastCommitBytes = 0;
+    }
+
+    nvmLastCommitBytes += commitBytes;
+}
+
+/**
+    Write the next step of the commit in progress.
+
+    @return        true while the commit has steps left.
+*/
+static bool nvmCommitStep(void) {
+
+    // Start of the step
+    const uint32_t stepStart = micros();
+
+    // Steps left
+    const bool returnValue = nvmLogWriteStep();
+
+    nvmCommitTime += micros() - stepStart;
+
+    return(returnValue);
+}
+
+/**
+    Complete the commit in progress and call the waiting callbacks.
+*/
+static void nvmCommitComplete(void) {
+
+    // Debug message string
+    debugString debugMessage;
+
+    // Callbacks to call (a callback can start the next commit)
+    nvmCommitCallback callbacks[NVM_COMMIT_CALLBACKS_MAX];
+
+    // Number of callbacks to call
+    const uint32_t callbackCount = nvmCommitCallbackCount;
 
-    // Write to EEPROM (blocking)
-    EEPROM.put(NVM_BASE_ADDRESS, *ramMirrorPtr);
-    EEPROM.commit();
+    memcpy(callbacks, nvmCommitCallbacks, sizeof(callbacks));
+    nvmCommitCallbackCount = 0;
+    nvmCommitBusy = false;
+    nvmLastCommitTime = nvmCommitTime;
+
+    // Debug message
+    debugMessage.format("NVM commit changed %lu bytes in %luus.", (unsigned long)nvmLastCommitBytes, (unsigned long)nvmLastCommitTime);
+    debugLog(debugMessage.c_str(), info);
+
+    for (unsigned int i = 0; i < callbackCount; i++) {
+        callbacks[i]();
+    }
+}
+
+
+/**
+    Comitt the dirty RAM mirror structures directly to NVM.
+    Only structures that differ from the stored contents are appended to the log, the flash is not touched when nothing differs.
+    Before calling, make sure the appropiate structure CRC's have been updated (this marks them dirty).
+    Also completes a background commit that is in progress.
+    This call is BLOCKING (writing the RAM mirrors to the NVM log).
+*/
+void nvmComittRamMirror(void) {
+
+    nvmCommitBegin();
+
+    while (nvmCommitStep() == true) {
+    }
+
+    nvmCommitComplete();
+}
+
+
+/**
+    Comitt the dirty RAM mirror structures to NVM in the background.
+    The dirty structures are taken now, the flash is written by nvmCyclicTask (one flash operation per call).
+    Use this at run time, nvmComittRamMirror is for boot.
+
+    @param[in]     callback function called when the commit is complete (NULL for none).
+*/
+void nvmComittRamMirrorAsync(const nvmCommitCallback callback) {
+
+    // Callback already waiting
+    bool callbackWaiting = false;
+
+    nvmCommitBegin();
+
+    for (unsigned int i = 0; i < nvmCommitCallbackCount; i++) {
+        callbackWaiting |= (nvmCommitCallbacks[i] == callback);
+    }
+
+    if ((callback != NULL) && (callbackWaiting == false)) {
+        if (nvmCommitCallbackCount < NVM_COMMIT_CALLBACKS_MAX) {
+            nvmCommitCallbacks[nvmCommitCallbackCount++] = callback;
+        }
+
+        // No room to wait, finish the commit now
+        else {
+            debugLog("NVM commit callbacks full, completing the commit now", warning);
+            nvmComittRamMirror();
+            callback();
+        }
+    }
+}
+
+
+/**
+    NVM cyclic task.
+    Writes the next step of a background commit.
+*/
+void nvmCyclicTask(void) {
+
+    if ((nvmCommitBusy == true) && (nvmCommitStep() == false)) {
+        nvmCommitComplete();
+    }
 }
 
 
 /**
     Initialise the NVM module.
-    Include initialisation of the RAM mirrors and recovery to defaults where allowed.
-    This call is BLOCKING (reading / populating the RAM mirrors from EEPROM).
+    Include initialisation of the RAM mirrors and recovery to defaults where allowed (boot critical structures only).
+    The legacy EEPROM contents are imported when the NVM log is empty.
+    This call is BLOCKING (reading / populating the RAM mirrors from the NVM log).
 */
 void nvmInit(void) {
 
     // Debug message string
-    String debugMessage;
+    debugString debugMessage;
 
     // Pointer to the RAM mirror
     nvmCompleteStructure * ramMirrorPtr;
@@ -191,20 +392,71 @@ void nvmInit(void) {
     // Set-up pointer to RAM mirror and get its size
     const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRW(&ramMirrorPtr);
 
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Boot critical structures (NVM_STRUCTURE_BIT)
+    uint32_t bootCriticalStructures = 0;
+
     // Debug message
-    debugMessage = String() + "NVM Structure is " + ramMirrorSize + " bytes.";
-    debugLog(&debugMessage, info);
+    debugMessage.format("NVM Structure is %lu bytes.", (unsigned long)ramMirrorSize);
+    debugLog(debugMessage.c_str(), info);
+
+    #ifdef CRC_BENCHMARK
+        crcBenchmark();
+    #endif
+
+    // Read the NVM structure to the RAM mirror from the log
+    if (nvmLogInit(ramMirrorPtr) == false) {
+
+        // Nothing in the log yet, import the legacy EEPROM contents
+        EEPROM.begin(ramMirrorSize);
+        EEPROM.get(NVM_BASE_ADDRESS, *ramMirrorPtr);
+        EEPROM.end();
+
+        nvmLogWriteAll(ramMirrorPtr);
 
-    // Read the NVM structure to the RAM mirror
-    EEPROM.begin(ramMirrorSize);
-    EEPROM.get(NVM_BASE_ADDRESS, *ramMirrorPtr);
+        // Debug message
+        debugLog("NVM imported from EEPROM.", info);
+    }
+
+    // Check integrity of the boot critical structures now, the rest on first access or in the background
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        if (nvmConfigPtr[i].bootCritical == true) {
+            bootCriticalStructures |= NVM_STRUCTURE_BIT(i);
+        }
+    }
 
-    // Check integrity
     #ifdef NVM_CORRUPT_TEST
         nvmClear();
     #else
-        nvmCheckIntegrity();
+        nvmCheckIntegrity(bootCriticalStructures);
     #endif
+}
+
+
+/**
+    Validate a deferred NVM structure before its first access.
+    Does nothing when the structure is already validated.
+    This call is BLOCKING (can start writing the RAM mirrors to the NVM log).
+
+    @param[in]     index index of the NVM structure.
+*/
+void nvmValidateStructure(const uint32_t index) {
+    nvmCheckIntegrity(NVM_STRUCTURE_BIT(index));
+}
+
+
+/**
+    Validate all deferred NVM structures that have not been accessed yet.
+    Call from a background task shortly after start-up.
+    This call is BLOCKING (can start writing the RAM mirrors to the NVM log).
+*/
+void nvmValidateDeferred(void) {
+    nvmCheckIntegrity(MAX_VALUE_32BIT_UNSIGNED_HEX);
 }    
 
 
@@ -228,6 +480,11 @@ void nvmTransmitStatusMessage(void) {
     nvmDataCurrent.structures = nvmGetConfigPointerRO(&nvmConfigPtr);
     nvmDataCurrent.core.errorCounter = ramMirrorPtr->nvm.core.errorCounter;
     nvmDataCurrent.core.version = ramMirrorPtr->nvm.core.version;
+    nvmDataCurrent.commits = nvmCommits;
+    nvmDataCurrent.commitsSkipped = nvmCommitsSkipped;
+    nvmDataCurrent.lastCommitBytes = nvmLastCommitBytes;
+    nvmDataCurrent.lastCommitTime = nvmLastCommitTime;
+    nvmDataCurrent.logSectors = nvmLogGetSectorSequence();
     
     messsagesTxNvmStatusMessage(&nvmDataCurrent);
 }
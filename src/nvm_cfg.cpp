@@ -28,6 +28,9 @@ static const nvmSubConfigHawkbit nvmSubConfigHawkbitDefault = {"svr.max.lan:9090
 // NVM ROM defaults for nvmSubConfigExt1
 static const nvmSubConfigExt1 nvmSubConfigExt1Default = {'G', 'R', nvmFooterCrcDefault};
 
+// NVM ROM defaults for nvmSubConfigWifi (no cached connection)
+static const nvmSubConfigWifi nvmSubConfigWifiDefault = {false, {0, 0, 0, 0, 0, 0}, 0, 0, 0, 0, 0, nvmFooterCrcDefault};
+
 // NVM RAM mirror
 static nvmCompleteStructure nvmRamMirror;
 
@@ -40,6 +43,8 @@ static const nvmStructureConfig nvmConfig[] = { // Memory configuration for nvmS
                                                 (const uint8_t * const) & nvmSubConfigNvmDefault,
                                                 (uint8_t * const) & nvmRamMirror.nvm.footer.crc,
                                                 ((sizeof(nvmRamMirror.nvm) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
                                                 true},
         
                                                 // Memory configuration for nvmSubConfigNetwork
@@ -47,6 +52,8 @@ static const nvmStructureConfig nvmConfig[] = { // Memory configuration for nvmS
                                                 (const uint8_t * const) & nvmSubConfigNetworkDefault,
                                                 (uint8_t * const) & nvmRamMirror.network.footer.crc,
                                                 ((sizeof(nvmRamMirror.network) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
                                                 true},
 
                                                 // Memory configuration for nvmSubConfigMqtt
@@ -54,6 +61,8 @@ static const nvmStructureConfig nvmConfig[] = { // Memory configuration for nvmS
                                                 (const uint8_t * const) & nvmSubConfigMqttDefault,
                                                 (uint8_t * const) & nvmRamMirror.mqtt.footer.crc,
                                                 ((sizeof(nvmRamMirror.mqtt) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
                                                 true},
 
                                                 // Memory configuration for nvmSubConfigIO
@@ -61,6 +70,8 @@ static const nvmStructureConfig nvmConfig[] = { // Memory configuration for nvmS
                                                 (const uint8_t * const) & nvmSubConfigIODefault,
                                                 (uint8_t * const) & nvmRamMirror.io.footer.crc,
                                                 ((sizeof(nvmRamMirror.io) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
                                                 true},
 
                                                 // Memory configuration for nvmSubConfigAlarm
@@ -68,21 +79,36 @@ static const nvmStructureConfig nvmConfig[] = { // Memory configuration for nvmS
                                                 (const uint8_t * const) & nvmSubConfigAlarmDefault,
                                                 (uint8_t * const) & nvmRamMirror.alarm.footer.crc,
                                                 ((sizeof(nvmRamMirror.alarm) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
-                                                true},
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
+                                                false},
 
                                                 // Memory configuration for nvmSubConfigHawkbit
                                                 {(uint8_t * const) & nvmRamMirror.hawkbit, 
                                                 (const uint8_t * const) & nvmSubConfigHawkbitDefault,
                                                 (uint8_t * const) & nvmRamMirror.hawkbit.footer.crc,
                                                 ((sizeof(nvmRamMirror.hawkbit) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
-                                                true},
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
+                                                false},
 
                                                 // Memory configuration for nvmSubConfigExt1
                                                 {(uint8_t * const) & nvmRamMirror.ext1,
                                                 (const uint8_t * const) & nvmSubConfigExt1Default,
                                                 (uint8_t * const) & nvmRamMirror.ext1.footer.crc,
                                                 ((sizeof(nvmRamMirror.ext1) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
-                                                false}
+                                                false,
+                                                NVM_SCHEMA_VERSION_INITIAL,
+                                                false},
+
+                                                // Memory configuration for nvmSubConfigWifi
+                                                {(uint8_t * const) & nvmRamMirror.wifi,
+                                                (const uint8_t * const) & nvmSubConfigWifiDefault,
+                                                (uint8_t * const) & nvmRamMirror.wifi.footer.crc,
+                                                ((sizeof(nvmRamMirror.wifi) / sizeof(uint8_t)) - NVM_CRC_SIZE_BYTES),
+                                                true,
+                                                NVM_SCHEMA_VERSION_INITIAL,
+                                                true}
 };
 
 // NVM configuration size (in elements)
@@ -91,6 +117,15 @@ static const uint32_t nvmConfigSizeElements = (sizeof(nvmConfig) / sizeof(nvmCon
 // Make sure that NVM configuraiton structure is the same size as the index enum
 static_assert(nvmSubConfigIndex::nvmNumberOfTypes == nvmConfigSizeElements, "Mismatch number of elements between <enum nvmSubConfigIndex> and <nvmConfig>.");
 
+// NVM migrations (from an older schema version to the current one)
+// Example when fields are added to the end of nvmSubConfigHawkbit: {nvmHawkbitStruc, NVM_SCHEMA_VERSION_INITIAL, nvmMigrateExtend}
+// Every migration needs a fixture in test/host/test_nvm_migrate.cpp
+static const nvmMigrationConfig nvmMigrations[] = {{nvmNumberOfTypes, NVM_SCHEMA_VERSION_INITIAL, NULL}};
+
+// NVM migrations size (in elements)
+static const uint32_t nvmMigrationsSizeElements = (sizeof(nvmMigrations) / sizeof(nvmMigrations[0]));
+
+
 /**
     Set-up read / write pointer to the RAM mirror
         
@@ -124,6 +159,17 @@ const uint32_t nvmGetConfigPointerRO(const nvmStructureConfig ** activeNvmConfig
     return(nvmConfigSizeElements);
 }
 
+/**
+    Set-up read only pointer to the NVM migrations
+        
+    @param[in]     activeNvmMigrations pointer for the NVM migrations.
+    @return        size of the NVM migrations (including the terminating entry).
+*/
+const uint32_t nvmGetMigrationPointerRO(const nvmMigrationConfig ** activeNvmMigrations) {
+    *activeNvmMigrations = &nvmMigrations[0];
+    return(nvmMigrationsSizeElements);
+}
+
 /**
     Update named RAM mirror structure CRC based on the current structure contents.
   
@@ -0,0 +1,821 @@
+#include <Arduino.h>
+
+#include "nvm_log.h"
+#include "nvm_log_format.h"
+
+#include "crc.h"
+#include "debug.h"
+
+
+// Base address of the memory mapped flash
+#define NVM_LOG_FLASH_MAPPED_BASE       (uint32_t(0x40200000))
+
+
+static_assert((sizeof(nvmLogSectorHeader) + (2 * (sizeof(nvmCompleteStructure) + (nvmNumberOfTypes * (sizeof(nvmLogRecordHeader) + 3))))) <= (SPI_FLASH_SEC_SIZE / 2), "A snapshot of both generations of all NVM structures must fit into half a log sector");
+static_assert(NVM_LOG_SECTORS >= 3, "The NVM log needs at least 3 sectors");
+
+// File system area from the linker script (the log uses the end of it)
+extern "C" uint32_t _FS_start;
+extern "C" uint32_t _FS_end;
+
+// Module name for debug messages
+static const char* nvmLogModuleName = "nvmLog";
+
+// Log flash area is available
+static bool nvmLogAvailable = false;
+
+// First flash sector of the log
+static uint32_t nvmLogFirstSector = 0;
+
+// Sector being written (NVM_LOG_SECTORS when there is none)
+static uint32_t nvmLogActiveSector = NVM_LOG_SECTORS;
+
+// Write offset in the active sector (SPI_FLASH_SEC_SIZE forces a new sector)
+static uint32_t nvmLogWriteOffset = SPI_FLASH_SEC_SIZE;
+
+// Sequence of the newest sector
+static uint32_t nvmLogSectorSequence = 0;
+
+// Sequence of the newest record
+static uint32_t nvmLogRecordSequence = 0;
+
+// Copy of the structures stored in the log (newest generation)
+static nvmCompleteStructure nvmLogStored;
+
+// Previous generation of the structures stored in the log
+static nvmCompleteStructure nvmLogPrevious;
+
+// Structures with a valid previous generation (NVM_STRUCTURE_BIT)
+static uint32_t nvmLogPreviousValid = 0;
+
+// Record buffer (flash access must be 32bit aligned)
+static uint32_t nvmLogBuffer[(sizeof(nvmLogRecordHeader) + NVM_LOG_PAYLOAD_MAX) / sizeof(uint32_t)];
+
+// Migrated structure buffer
+static uint8_t nvmLogMigrationBuffer[NVM_LOG_PAYLOAD_MAX];
+
+// Structures migrated from an older schema version (NVM_STRUCTURE_BIT)
+static uint32_t nvmLogMigrated = 0;
+
+// Structures waiting to be appended to the active sector (NVM_STRUCTURE_BIT)
+static uint32_t nvmLogPending = 0;
+
+// A new sector must be opened before anything else is written
+static bool nvmLogOpenRequest = false;
+
+// Next structure of the snapshot being written (nvmNumberOfTypes when no snapshot is being written)
+static uint32_t nvmLogSnapshotNext = nvmNumberOfTypes;
+
+// No flash errors in the snapshot being written
+static bool nvmLogSnapshotOk = true;
+
+// Local function definitions
+static uint32_t nvmLogSectorAddress(const uint32_t sector);
+static uint32_t nvmLogStructureOffset(const uint32_t index);
+static crc_t nvmLogRecordCrc(const uint32_t length);
+static bool nvmLogStructureValid(const nvmCompleteStructure * const structuresPtr, const uint32_t index);
+static void nvmLogStore(const uint32_t index, const uint8_t * const dataPtr);
+static void nvmLogStorePrevious(const uint32_t index, const uint8_t * const dataPtr);
+static bool nvmLogAppend(const uint32_t index, const bool previous);
+static bool nvmLogMigrate(const uint32_t index, const nvmLogRecordHeader * const headerPtr, const uint8_t * const oldDataPtr);
+static bool nvmLogEraseSector(const uint32_t flags);
+static bool nvmLogSnapshotStep(void);
+static bool nvmLogOpenSector(const uint32_t flags);
+static uint32_t nvmLogReplaySector(const uint32_t sector, bool * const tailValidPtr);
+
+
+/**
+    Get the flash address of a log sector.
+
+    @param[in]     sector log sector (0 to NVM_LOG_SECTORS - 1).
+    @return        flash address of the sector.
+*/
+static uint32_t nvmLogSectorAddress(const uint32_t sector) {
+    return((nvmLogFirstSector + sector) * SPI_FLASH_SEC_SIZE);
+}
+
+/**
+    Get the offset of a structure in nvmCompleteStructure.
+
+    @param[in]     index index of the NVM structure.
+    @return        offset of the structure.
+*/
+static uint32_t nvmLogStructureOffset(const uint32_t index) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    return(nvmConfigPtr[index].addressRamMirror - (const uint8_t *)ramMirrorPtr);
+}
+
+/**
+    Calculate the CRC of the record in the record buffer.
+    The CRC field in the buffer is cleared.
+
+    @param[in]     length length of the structure in the record.
+    @return        CRC of the record.
+*/
+static crc_t nvmLogRecordCrc(const uint32_t length) {
+
+    ((nvmLogRecordHeader *)nvmLogBuffer)->crc = 0;
+
+    return(crcCalculate((const uint8_t *)nvmLogBuffer, sizeof(nvmLogRecordHeader) + length));
+}
+
+/**
+    Check the CRC of a structure.
+
+    @param[in]     structuresPtr pointer to the structures holding the structure.
+    @param[in]     index index of the NVM structure.
+    @return        true when the CRC of the structure is valid.
+*/
+static bool nvmLogStructureValid(const nvmCompleteStructure * const structuresPtr, const uint32_t index) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Structure
+    const uint8_t * const structurePtr = ((const uint8_t *)structuresPtr) + nvmLogStructureOffset(index);
+
+    // CRC stored in the structure
+    crc_t crcRead;
+
+    memcpy(&crcRead, structurePtr + nvmConfigPtr[index].length, NVM_CRC_SIZE_BYTES);
+
+    return(crcRead == crcCalculate(structurePtr, nvmConfigPtr[index].length));
+}
+
+/**
+    Store a new generation of a structure.
+    The current generation becomes the previous generation when it is valid (a corrupt generation is never kept).
+
+    @param[in]     index index of the NVM structure.
+    @param[in]     dataPtr pointer to the new generation of the structure (including its CRC).
+*/
+static void nvmLogStore(const uint32_t index, const uint8_t * const dataPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Offset of the structure
+    const uint32_t structureOffset = nvmLogStructureOffset(index);
+
+    // Length of the structure including its CRC
+    const uint32_t length = nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES;
+
+    if (memcmp(((const uint8_t *)&nvmLogStored) + structureOffset, dataPtr, length) != 0) {
+
+        if (nvmLogStructureValid(&nvmLogStored, index) == true) {
+            memcpy(((uint8_t *)&nvmLogPrevious) + structureOffset, ((const uint8_t *)&nvmLogStored) + structureOffset, length);
+            nvmLogPreviousValid |= NVM_STRUCTURE_BIT(index);
+        }
+
+        memcpy(((uint8_t *)&nvmLogStored) + structureOffset, dataPtr, length);
+    }
+}
+
+/**
+    Store the previous generation of a structure (from a snapshot record).
+    Only a valid generation is kept, the stored generation is not touched.
+
+    @param[in]     index index of the NVM structure.
+    @param[in]     dataPtr pointer to the previous generation of the structure (including its CRC).
+*/
+static void nvmLogStorePrevious(const uint32_t index, const uint8_t * const dataPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Offset of the structure
+    const uint32_t structureOffset = nvmLogStructureOffset(index);
+
+    memcpy(((uint8_t *)&nvmLogPrevious) + structureOffset, dataPtr, nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES);
+
+    if (nvmLogStructureValid(&nvmLogPrevious, index) == true) {
+        nvmLogPreviousValid |= NVM_STRUCTURE_BIT(index);
+    }
+    else {
+        nvmLogPreviousValid &= ~NVM_STRUCTURE_BIT(index);
+    }
+}
+
+/**
+    Append a record holding a structure to the active sector.
+
+    @param[in]     index index of the NVM structure.
+    @param[in]     previous true for the previous generation, false for the stored generation.
+    @return        true when the record was written (false when the sector is full or on a flash error).
+*/
+static bool nvmLogAppend(const uint32_t index, const bool previous) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Record header in the record buffer
+    nvmLogRecordHeader * const headerPtr = (nvmLogRecordHeader *)nvmLogBuffer;
+
+    // Length of the structure including its CRC
+    const uint32_t length = nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES;
+
+    // Size of the record in flash
+    const uint32_t recordSize = NVM_LOG_ALIGN(sizeof(nvmLogRecordHeader) + length);
+
+    // Structures holding the generation
+    const nvmCompleteStructure * const structuresPtr = (previous == true) ? &nvmLogPrevious : &nvmLogStored;
+
+    bool returnValue = false;
+
+    if ((nvmLogActiveSector < NVM_LOG_SECTORS) && ((nvmLogWriteOffset + recordSize) <= SPI_FLASH_SEC_SIZE)) {
+
+        memset(nvmLogBuffer, 0, recordSize);
+        memcpy(((uint8_t *)nvmLogBuffer) + sizeof(nvmLogRecordHeader), ((const uint8_t *)structuresPtr) + nvmLogStructureOffset(index), length);
+
+        headerPtr->index = (previous == true) ? (index | NVM_LOG_RECORD_PREVIOUS) : index;
+        headerPtr->version = nvmConfigPtr[index].schemaVersion;
+        headerPtr->length = length;
+        headerPtr->sequence = ++nvmLogRecordSequence;
+        headerPtr->crc = nvmLogRecordCrc(length);
+
+        returnValue = ESP.flashWrite(nvmLogSectorAddress(nvmLogActiveSector) + nvmLogWriteOffset, nvmLogBuffer, recordSize);
+
+        // Move on even after a flash error (the area may be partly programmed)
+        nvmLogWriteOffset += recordSize;
+    }
+
+    return(returnValue);
+}
+
+/**
+    Migrate a record from an older schema version into the migration buffer.
+    Only records holding a valid structure are migrated, the migrated structure gets a new CRC.
+
+    @param[in]     index index of the NVM structure.
+    @param[in]     headerPtr pointer to the record header.
+    @param[in]     oldDataPtr pointer to the old structure (including its CRC).
+    @return        true when the record was migrated.
+*/
+static bool nvmLogMigrate(const uint32_t index, const nvmLogRecordHeader * const headerPtr, const uint8_t * const oldDataPtr) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Pointer to the NVM migrations
+    const nvmMigrationConfig * nvmMigrationPtr;
+
+    // Set-up pointer to NVM migrations and get its size
+    const uint32_t nvmMigrationSize = nvmGetMigrationPointerRO(&nvmMigrationPtr);
+
+    // Length of the old structure excluding its CRC
+    const uint32_t oldLength = headerPtr->length - NVM_CRC_SIZE_BYTES;
+
+    // Length of the new structure excluding its CRC
+    const uint32_t newLength = nvmConfigPtr[index].length;
+
+    // CRC of the old or new structure
+    crc_t crc;
+
+    bool returnValue = false;
+
+    memcpy(&crc, oldDataPtr + oldLength, NVM_CRC_SIZE_BYTES);
+
+    for (unsigned int i = 0; (i < nvmMigrationSize) && (nvmMigrationPtr[i].index < nvmNumberOfTypes); i++) {
+        if ((nvmMigrationPtr[i].index == index) && (nvmMigrationPtr[i].fromVersion == headerPtr->version) && (crc == crcCalculate(oldDataPtr, oldLength))) {
+
+            memcpy(nvmLogMigrationBuffer, nvmConfigPtr[index].addressRomDefault, newLength);
+            nvmMigrationPtr[i].migrationFunction(oldDataPtr, oldLength, nvmLogMigrationBuffer, newLength);
+
+            crc = crcCalculate(nvmLogMigrationBuffer, newLength);
+            memcpy(nvmLogMigrationBuffer + newLength, &crc, NVM_CRC_SIZE_BYTES);
+
+            returnValue = true;
+            break;
+        }
+    }
+
+    if (returnValue == false) {
+        debugMessage.format("No migration for structure %lu schema version %u", (unsigned long)index, headerPtr->version);
+        debugLog(debugMessage.c_str(), nvmLogModuleName, warning);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Erase the next sector and write its header, the snapshot is written by nvmLogSnapshotStep.
+    The next sector is the oldest, everything in it is superseded by the snapshot in the active sector.
+
+    @param[in]     flags sector flags (NVM_LOG_SECTOR_RESET).
+    @return        true when the sector was erased and the header written.
+*/
+static bool nvmLogEraseSector(const uint32_t flags) {
+
+    // Next sector to use
+    const uint32_t nextSector = (nvmLogActiveSector < NVM_LOG_SECTORS) ? ((nvmLogActiveSector + 1) % NVM_LOG_SECTORS) : 0;
+
+    // Sector header
+    nvmLogSectorHeader sectorHeader;
+
+    bool returnValue;
+
+    sectorHeader.magic = NVM_LOG_MAGIC;
+    sectorHeader.sequence = ++nvmLogSectorSequence;
+    sectorHeader.flags = flags;
+    sectorHeader.crc = crcCalculate((const uint8_t *)&sectorHeader, offsetof(nvmLogSectorHeader, crc));
+
+    returnValue = ESP.flashEraseSector(nvmLogFirstSector + nextSector);
+    returnValue &= ESP.flashWrite(nvmLogSectorAddress(nextSector), (uint32_t *)&sectorHeader, sizeof(sectorHeader));
+
+    nvmLogActiveSector = nextSector;
+    nvmLogWriteOffset = sizeof(nvmLogSectorHeader);
+    nvmLogSnapshotNext = 0;
+    nvmLogSnapshotOk = returnValue;
+
+    return(returnValue);
+}
+
+/**
+    Write the next structure of the snapshot (previous generation first).
+    An interrupted snapshot is the same as a power loss while opening a sector, the older sectors still hold every structure.
+
+    @return        true while the snapshot has structures left to write.
+*/
+static bool nvmLogSnapshotStep(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    if (nvmLogSnapshotNext < nvmNumberOfTypes) {
+        if ((nvmLogPreviousValid & NVM_STRUCTURE_BIT(nvmLogSnapshotNext)) != 0) {
+            nvmLogSnapshotOk &= nvmLogAppend(nvmLogSnapshotNext, true);
+        }
+
+        nvmLogSnapshotOk &= nvmLogAppend(nvmLogSnapshotNext, false);
+        nvmLogSnapshotNext++;
+
+        if ((nvmLogSnapshotNext == nvmNumberOfTypes) && (nvmLogSnapshotOk == true)) {
+            debugMessage.format("Opened log sector %lu (sequence %lu)", (unsigned long)nvmLogActiveSector, (unsigned long)nvmLogSectorSequence);
+            debugLog(debugMessage.c_str(), nvmLogModuleName, info);
+        }
+        else if (nvmLogSnapshotNext == nvmNumberOfTypes) {
+            debugMessage.format("Flash error opening log sector %lu", (unsigned long)nvmLogActiveSector);
+            debugLog(debugMessage.c_str(), nvmLogModuleName, error);
+        }
+    }
+
+    return(nvmLogSnapshotNext < nvmNumberOfTypes);
+}
+
+/**
+    Open the next sector and write a snapshot of all stored structures into it.
+    This call is BLOCKING (erasing and writing the flash).
+
+    @param[in]     flags sector flags (NVM_LOG_SECTOR_RESET).
+    @return        true when the sector and snapshot were written.
+*/
+static bool nvmLogOpenSector(const uint32_t flags) {
+
+    (void) nvmLogEraseSector(flags);
+
+    while (nvmLogSnapshotStep() == true) {
+    }
+
+    return(nvmLogSnapshotOk);
+}
+
+/**
+    Replay the valid records of a sector into the stored copy.
+    Skips records with an invalid CRC, stops at the end of the log or at an invalid record header (power lost while writing).
+
+    @param[in]     sector log sector.
+    @param[out]    tailValidPtr pointer to the tail valid flag (false when an invalid record was found).
+    @return        mask of the structures found in the sector (NVM_STRUCTURE_BIT).
+*/
+static uint32_t nvmLogReplaySector(const uint32_t sector, bool * const tailValidPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Record header in the record buffer
+    nvmLogRecordHeader * const headerPtr = (nvmLogRecordHeader *)nvmLogBuffer;
+
+    // Offset of the record in the sector
+    uint32_t offset = sizeof(nvmLogSectorHeader);
+
+    // CRC read from the record
+    crc_t crcRead;
+
+    // Size of the record in flash
+    uint32_t recordSize;
+
+    // Structure index of the record
+    uint32_t index;
+
+    // Record holds a previous generation
+    bool previous;
+
+    // Structures found
+    uint32_t structures = 0;
+
+    *tailValidPtr = true;
+
+    while ((offset + sizeof(nvmLogRecordHeader)) <= SPI_FLASH_SEC_SIZE) {
+
+        (void) ESP.flashRead(nvmLogSectorAddress(sector) + offset, nvmLogBuffer, sizeof(nvmLogRecordHeader));
+
+        // End of the log
+        if (nvmLogBuffer[0] == NVM_LOG_ERASED) {
+            break;
+        }
+
+        recordSize = NVM_LOG_ALIGN(sizeof(nvmLogRecordHeader) + headerPtr->length);
+        index = headerPtr->index & ~NVM_LOG_RECORD_PREVIOUS;
+        previous = ((headerPtr->index & NVM_LOG_RECORD_PREVIOUS) != 0);
+
+        // Header must describe a known structure (of any schema version) that fits into the sector
+        if ((index >= nvmNumberOfTypes) || (headerPtr->length <= NVM_CRC_SIZE_BYTES) || (headerPtr->length > NVM_LOG_PAYLOAD_MAX) || ((offset + recordSize) > SPI_FLASH_SEC_SIZE)) {
+            *tailValidPtr = false;
+            break;
+        }
+
+        (void) ESP.flashRead(nvmLogSectorAddress(sector) + offset + sizeof(nvmLogRecordHeader), nvmLogBuffer + (sizeof(nvmLogRecordHeader) / sizeof(uint32_t)), recordSize - sizeof(nvmLogRecordHeader));
+
+        crcRead = headerPtr->crc;
+
+        // Invalid record
+        if (crcRead != nvmLogRecordCrc(headerPtr->length)) {
+            *tailValidPtr = false;
+        }
+
+        // Previous generation of a snapshot (an interrupted snapshot must not roll the stored generation back)
+        else if ((previous == true) && (headerPtr->version == nvmConfigPtr[index].schemaVersion) && (headerPtr->length == (nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES))) {
+            nvmLogStorePrevious(index, ((const uint8_t *)nvmLogBuffer) + sizeof(nvmLogRecordHeader));
+            nvmLogRecordSequence = max(nvmLogRecordSequence, headerPtr->sequence);
+        }
+
+        // Newer records become the stored generation (a migrated record in an older sector is already rewritten)
+        else if ((headerPtr->version == nvmConfigPtr[index].schemaVersion) && (headerPtr->length == (nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES))) {
+            nvmLogStore(index, ((const uint8_t *)nvmLogBuffer) + sizeof(nvmLogRecordHeader));
+            structures |= NVM_STRUCTURE_BIT(index);
+            nvmLogMigrated &= ~NVM_STRUCTURE_BIT(index);
+            nvmLogRecordSequence = max(nvmLogRecordSequence, headerPtr->sequence);
+        }
+
+        // Older schema version, migrate to the current layout
+        else if (nvmLogMigrate(index, headerPtr, ((const uint8_t *)nvmLogBuffer) + sizeof(nvmLogRecordHeader)) == true) {
+            if (previous == true) {
+                nvmLogStorePrevious(index, nvmLogMigrationBuffer);
+            }
+            else {
+                nvmLogStore(index, nvmLogMigrationBuffer);
+                nvmLogMigrated |= NVM_STRUCTURE_BIT(index);
+            }
+
+            nvmLogRecordSequence = max(nvmLogRecordSequence, headerPtr->sequence);
+        }
+
+        offset += recordSize;
+    }
+
+    // Continue writing after the last valid record
+    nvmLogWriteOffset = offset;
+
+    return(structures);
+}
+
+/**
+    NVM log init.
+    Replays the records of all valid log sectors (oldest first) into the RAM mirror.
+    Records from an older schema version are migrated and rewritten in the current layout.
+    The log uses the last NVM_LOG_SECTORS sectors of the file system area (no file system is used).
+    This call is BLOCKING (reading the flash).
+
+    @param[out]    ramMirrorPtr pointer to the RAM mirror.
+    @return        true when the log holds data (RAM mirror populated).
+*/
+bool nvmLogInit(nvmCompleteStructure * const ramMirrorPtr) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Mask of all structures
+    const uint32_t allStructures = NVM_STRUCTURE_BIT(nvmConfigSize) - 1;
+
+    // Sector header
+    nvmLogSectorHeader sectorHeader;
+
+    // Sector sequences (0 when the sector is not valid)
+    uint32_t sectorSequences[NVM_LOG_SECTORS];
+
+    // Sector flags
+    uint32_t sectorFlags[NVM_LOG_SECTORS];
+
+    // Sector to replay next
+    uint32_t replaySector;
+
+    // Structures found in the active sector
+    uint32_t structures = 0;
+
+    // No invalid records in the active sector
+    bool tailValid = true;
+
+    // Check the flash area and that the largest structure fits into a record
+    nvmLogAvailable = (((uint32_t)(uintptr_t)&_FS_end - (uint32_t)(uintptr_t)&_FS_start) >= (NVM_LOG_SECTORS * SPI_FLASH_SEC_SIZE));
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        if ((nvmConfigPtr[i].length + NVM_CRC_SIZE_BYTES) > NVM_LOG_PAYLOAD_MAX) {
+            nvmLogAvailable = false;
+        }
+    }
+
+    if (nvmLogAvailable == false) {
+        debugLog("No flash available for the log, NVM will not be saved", nvmLogModuleName, error);
+        return(false);
+    }
+
+    nvmLogFirstSector = (((uint32_t)(uintptr_t)&_FS_end - NVM_LOG_FLASH_MAPPED_BASE) / SPI_FLASH_SEC_SIZE) - NVM_LOG_SECTORS;
+    memset(&nvmLogStored, 0, sizeof(nvmLogStored));
+    memset(&nvmLogPrevious, 0, sizeof(nvmLogPrevious));
+    nvmLogPreviousValid = 0;
+    nvmLogMigrated = 0;
+
+    // Find the valid sectors
+    for (unsigned int i = 0; i < NVM_LOG_SECTORS; i++) {
+        (void) ESP.flashRead(nvmLogSectorAddress(i), (uint32_t *)&sectorHeader, sizeof(sectorHeader));
+
+        if ((sectorHeader.magic == NVM_LOG_MAGIC) && (sectorHeader.sequence != 0) && (sectorHeader.crc == crcCalculate((const uint8_t *)&sectorHeader, offsetof(nvmLogSectorHeader, crc)))) {
+            sectorSequences[i] = sectorHeader.sequence;
+            sectorFlags[i] = sectorHeader.flags;
+        }
+        else {
+            sectorSequences[i] = 0;
+            sectorFlags[i] = 0;
+        }
+    }
+
+    // Replay the valid sectors oldest first (the last one replayed is the active sector)
+    do {
+        replaySector = NVM_LOG_SECTORS;
+
+        for (unsigned int i = 0; i < NVM_LOG_SECTORS; i++) {
+            if ((sectorSequences[i] > nvmLogSectorSequence) && ((replaySector == NVM_LOG_SECTORS) || (sectorSequences[i] < sectorSequences[replaySector]))) {
+                replaySector = i;
+            }
+        }
+
+        if (replaySector < NVM_LOG_SECTORS) {
+
+            // A reset discards both generations of everything replayed so far (the older sectors may still hold them)
+            if ((sectorFlags[replaySector] & NVM_LOG_SECTOR_RESET) != 0) {
+                memset(&nvmLogStored, 0, sizeof(nvmLogStored));
+                memset(&nvmLogPrevious, 0, sizeof(nvmLogPrevious));
+                nvmLogPreviousValid = 0;
+                nvmLogMigrated = 0;
+            }
+
+            structures = nvmLogReplaySector(replaySector, &tailValid);
+            nvmLogActiveSector = replaySector;
+            nvmLogSectorSequence = sectorSequences[replaySector];
+        }
+    } while (replaySector < NVM_LOG_SECTORS);
+
+    // Nothing stored yet
+    if (nvmLogActiveSector >= NVM_LOG_SECTORS) {
+        return(false);
+    }
+
+    // Power was lost writing the active sector, do not append after a partly programmed record or an incomplete snapshot
+    if ((tailValid == false) || (structures != allStructures)) {
+        nvmLogWriteOffset = SPI_FLASH_SEC_SIZE;
+
+        debugMessage.format("Log sector %lu is incomplete, will open a new sector", (unsigned long)nvmLogActiveSector);
+        debugLog(debugMessage.c_str(), nvmLogModuleName, warning);
+    }
+
+    // Rewrite migrated structures in the current layout
+    if (nvmLogMigrated != 0) {
+        debugMessage.format("Migrated structures 0x%02lx to the current schema", (unsigned long)nvmLogMigrated);
+        debugLog(debugMessage.c_str(), nvmLogModuleName, info);
+
+        (void) nvmLogOpenSector(0);
+    }
+
+    memcpy(ramMirrorPtr, &nvmLogStored, sizeof(nvmLogStored));
+
+    debugMessage.format("Loaded log sector %lu (sequence %lu, %lu bytes used)", (unsigned long)nvmLogActiveSector, (unsigned long)nvmLogSectorSequence, (unsigned long)nvmLogWriteOffset);
+    debugLog(debugMessage.c_str(), nvmLogModuleName, info);
+
+    return(true);
+}
+
+/**
+    Start writing the changed structures to the log.
+    Only structures that differ from the stored copy are taken (copied into the stored copy now), the flash is written by nvmLogWriteStep.
+    Can be called while a write is in progress, the changes are added to it.
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+    @param[in]     structures mask of structures to check (NVM_STRUCTURE_BIT).
+    @return        number of structure bytes to write (0 when nothing differed).
+*/
+uint32_t nvmLogWriteBegin(const nvmCompleteStructure * const ramMirrorPtr, const uint32_t structures) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Offset of the structure
+    uint32_t structureOffset;
+
+    // Length of the structure including its CRC
+    uint32_t length;
+
+    // Bytes to write
+    uint32_t bytesWritten = 0;
+
+    if (nvmLogAvailable == false) {
+        return(0);
+    }
+
+    // Update the stored copy
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        structureOffset = nvmLogStructureOffset(i);
+        length = nvmConfigPtr[i].length + NVM_CRC_SIZE_BYTES;
+
+        if (((structures & NVM_STRUCTURE_BIT(i)) != 0) && (memcmp(((const uint8_t *)&nvmLogStored) + structureOffset, ((const uint8_t *)ramMirrorPtr) + structureOffset, length) != 0)) {
+            nvmLogStore(i, ((const uint8_t *)ramMirrorPtr) + structureOffset);
+            nvmLogPending |= NVM_STRUCTURE_BIT(i);
+            bytesWritten += length;
+        }
+    }
+
+    return(bytesWritten);
+}
+
+/**
+    Do one step of the write in progress: erase a sector, write one structure of a snapshot or append one changed structure.
+    A new sector holds a snapshot of the stored copy, so the changes pending when it is opened are already written by it.
+    This call is BLOCKING for one flash operation (a sector erase is the longest).
+
+    @return        true while the write has steps left.
+*/
+bool nvmLogWriteStep(void) {
+
+    // Next structure to append
+    uint32_t index = 0;
+
+    if (nvmLogAvailable == false) {
+        nvmLogPending = 0;
+        return(false);
+    }
+
+    // Snapshot of a new sector
+    if (nvmLogSnapshotNext < nvmNumberOfTypes) {
+        (void) nvmLogSnapshotStep();
+    }
+
+    // Open a new sector (the erase is a step of its own)
+    else if (nvmLogOpenRequest == true) {
+        nvmLogOpenRequest = false;
+        nvmLogPending = 0;
+        (void) nvmLogEraseSector(0);
+    }
+
+    // Append the next change, open a new sector when the active one is full
+    else if (nvmLogPending != 0) {
+        while ((nvmLogPending & NVM_STRUCTURE_BIT(index)) == 0) {
+            index++;
+        }
+
+        if (nvmLogAppend(index, false) == true) {
+            nvmLogPending &= ~NVM_STRUCTURE_BIT(index);
+        }
+        else {
+            nvmLogOpenRequest = true;
+        }
+    }
+
+    return((nvmLogSnapshotNext < nvmNumberOfTypes) || (nvmLogOpenRequest == true) || (nvmLogPending != 0));
+}
+
+/**
+    Write the changed structures to the log.
+    Same as nvmLogWriteBegin followed by nvmLogWriteStep until done (also finishes a write that was already in progress).
+    This call is BLOCKING (writing the flash).
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+    @param[in]     structures mask of structures to check (NVM_STRUCTURE_BIT).
+    @return        number of structure bytes written (0 when nothing differed).
+*/
+uint32_t nvmLogWrite(const nvmCompleteStructure * const ramMirrorPtr, const uint32_t structures) {
+
+    // Bytes written
+    const uint32_t bytesWritten = nvmLogWriteBegin(ramMirrorPtr, structures);
+
+    while (nvmLogWriteStep() == true) {
+    }
+
+    return(bytesWritten);
+}
+
+/**
+    Write a snapshot of all structures into a new sector.
+    Used to import the legacy EEPROM contents and to clear the NVM (the previous generation is discarded).
+    The sector is flagged as a reset, so the replay at the next start-up discards the older sectors (the clear is final).
+    Power lost before the sector header is written keeps the old contents, after it the snapshot (or the part written) is all that is left.
+    This call is BLOCKING (erasing and writing the flash).
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+*/
+void nvmLogWriteAll(const nvmCompleteStructure * const ramMirrorPtr) {
+
+    if (nvmLogAvailable == true) {
+
+        // Finish a write in progress first, the snapshot supersedes it
+        while (nvmLogWriteStep() == true) {
+        }
+
+        memcpy(&nvmLogStored, ramMirrorPtr, sizeof(nvmLogStored));
+        nvmLogPreviousValid = 0;
+        (void) nvmLogOpenSector(NVM_LOG_SECTOR_RESET);
+    }
+}
+
+/**
+    Restore the previous generation of a structure into the RAM mirror.
+    The previous generation always has a valid CRC.
+    Records with an invalid record CRC (power lost while writing, flash damage) are skipped by the replay, the structure already
+    comes from the last good record. So this is only needed when a record is intact but the structure CRC in it is invalid
+    (the structure was already corrupt in the RAM mirror when it was committed).
+
+    @param[in]     index index of the NVM structure.
+    @param[out]    ramMirrorPtr pointer to the RAM mirror.
+    @return        true when there was a previous generation to restore.
+*/
+bool nvmLogRestorePrevious(const uint32_t index, nvmCompleteStructure * const ramMirrorPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Offset of the structure
+    uint32_t structureOffset;
+
+    bool returnValue = false;
+
+    if ((index < nvmConfigSize) && ((nvmLogPreviousValid & NVM_STRUCTURE_BIT(index)) != 0)) {
+        structureOffset = nvmLogStructureOffset(index);
+        memcpy(((uint8_t *)ramMirrorPtr) + structureOffset, ((const uint8_t *)&nvmLogPrevious) + structureOffset, nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES);
+        returnValue = true;
+    }
+
+    return(returnValue);
+}
+
+/**
+    Get the sequence of the newest log sector.
+    Increments every time a sector is erased so indicates the flash wear.
+
+    @return        sequence of the newest log sector.
+*/
+uint32_t nvmLogGetSectorSequence(void) {
+    return(nvmLogSectorSequence);
+}
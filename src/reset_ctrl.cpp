@@ -8,6 +8,7 @@
 #include "nvm_cfg.h"
 #include "wifi.h"
 #include "hawkbit_client.h"
+#include "journal.h"
 
 
 // Set the module call interval
@@ -64,7 +65,7 @@ static uint8_t resetCtrlResetSwitchEnabled = false;
 void restCtrlImmediateHandle(resetCtrlTypes requestedReset) {
 
     // Debug message
-    String debugMessage = (String() + "Rebooting unit");
+    debugString debugMessage("Rebooting unit");
 
     switch(requestedReset) {
 
@@ -73,20 +74,20 @@ void restCtrlImmediateHandle(resetCtrlTypes requestedReset) {
             break;
 
         case(rstTypeReset):
-            debugMessage = debugMessage + "...";
-            debugLog(&debugMessage, resetControllerModuleName, warning);
+            debugMessage.append("...");
+            debugLog(debugMessage.c_str(), resetControllerModuleName, warning);
             break;
         
         case(rstTypeResetWiFi):
-            debugMessage = debugMessage + " + clearing WiFi settings...";
-            debugLog(&debugMessage, resetControllerModuleName, warning);
+            debugMessage.append(" + clearing WiFi settings...");
+            debugLog(debugMessage.c_str(), resetControllerModuleName, warning);
 
             wifiReset();
             break;
 
         case(rstTypeResetWiFiNvm):
-            debugMessage = debugMessage + " + clearing WiFi + NVM settings...";
-            debugLog(&debugMessage, resetControllerModuleName, warning);
+            debugMessage.append(" + clearing WiFi + NVM settings...");
+            debugLog(debugMessage.c_str(), resetControllerModuleName, warning);
 
             nvmClear();
             wifiReset();
@@ -95,6 +96,7 @@ void restCtrlImmediateHandle(resetCtrlTypes requestedReset) {
     
     // Perform the physical reboot if a reset type has been specified and is within range
     if ((requestedReset != rstTypeNone) && (requestedReset < rstTypeNumberOfTypes)) {
+        journalSnapshot();
         ESP.restart();
     }
 }
@@ -118,13 +120,29 @@ void restCtrlInit(void) {
 }
 
 
+/**
+    Reset controller re-init.
+    Reloads the configuration from the RAM mirror without touching a reset in progress.
+*/
+void restCtrlReinit(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    resetCtrlResetSwitchEnabled = ramMirrorPtr->io.resetSwitchEnabled;
+}
+
+
 /**
     Reset controller state machine.
 */
 void restCtrlStateMachine(void) {
     
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // Last value of the reset switch
     static uint8_t resetSwLastState = LOW;
@@ -239,8 +257,8 @@ void restCtrlStateMachine(void) {
 
             // First transition to this state
             if(resetCtrlCurrentState != lastState) {
-                debugMessage = String() + "Reset will occurr in " + CALLS_TO_SECS(switchHeldTimer) + "s";
-                debugLog(&debugMessage, resetControllerModuleName, warning);
+                debugMessage.format("Reset will occurr in %lus", (unsigned long)CALLS_TO_SECS(switchHeldTimer));
+                debugLog(debugMessage.c_str(), resetControllerModuleName, warning);
             }
             
             // Switch released
@@ -282,8 +300,8 @@ void restCtrlStateMachine(void) {
  
     // State change
     if (resetCtrlCurrentState != nextState) {
-        debugMessage = String() + "State change to " + resetCtrlStateNames[nextState] + " (reqest type " + resetCtrlTypesNames[resetCtrlRequestedResetType] + ")";
-        debugLog(&debugMessage, resetControllerModuleName, info);
+        debugMessage.format("State change to %s (reqest type %s)", resetCtrlStateNames[nextState], resetCtrlTypesNames[resetCtrlRequestedResetType]);
+        debugLog(debugMessage.c_str(), resetControllerModuleName, info);
     }
     
     // Update last states and current states (in this order)
@@ -3,7 +3,10 @@
 #include "runtime.h"
 #include "runtime_cfg.h"
 
+#include "utils.h"
 #include "messages_tx.h"
+#include "journal.h"
+#include "stack_monitor.h"
 
 
 // The number of cycles to measure average runtime over
@@ -21,6 +24,30 @@
 // Name for the uptime
 #define RUNTIME_NAME_UPTIME         ("uptime")
 
+// Name for the free heap
+#define RUNTIME_NAME_HEAP           ("heap")
+
+// Name for the minimum free heap
+#define RUNTIME_NAME_HEAP_MIN       ("heapMin")
+
+// Name for the largest free heap block
+#define RUNTIME_NAME_HEAP_BLOCK     ("heapBlock")
+
+// Name for the heap fragmentation
+#define RUNTIME_NAME_HEAP_FRAG      ("heapFrag")
+
+// Name for the task executing when the minimum free heap was reached
+#define RUNTIME_NAME_HEAP_MIN_TASK  ("heapMinTask")
+
+// Name for the minimum free cont stack
+#define RUNTIME_NAME_STACK_CONT     ("stackCont")
+
+// Name for the minimum free SYS stack
+#define RUNTIME_NAME_STACK_SYS      ("stackSys")
+
+// Task name for the code outside the scheduler tasks (main loop and SDK)
+#define RUNTIME_TASK_LOOP           ("loop")
+
 
 // Average runtime
 static unsigned long averageRuntimeuS = 0;
@@ -31,15 +58,49 @@ static unsigned long peakRuntimeuS = 0;
 // Uptime
 static unsigned long uptimeuS = 0;
 
+// Free heap (in bytes)
+static unsigned long heapFree = 0;
+
+// Minimum free heap since boot (in bytes)
+static unsigned long heapFreeMin = MAX_VALUE_32BIT_UNSIGNED_HEX;
+
+// Largest free heap block (in bytes)
+static unsigned long heapMaxBlock = 0;
+
+// Heap fragmentation (in %)
+static unsigned long heapFragmentation = 0;
+
+// Task executing when the minimum free heap was reached
+static const char * heapFreeMinTask = "";
+
+// Minimum free cont stack since boot (in bytes)
+static unsigned long stackContFree = 0;
+
+// Minimum free SYS stack since boot (in bytes)
+static unsigned long stackSysFree = 0;
+
 // Runtime data for this software
-static const runtimeData runtimeDataSoftware[] = {{RUNTIME_NAME_PEAK,      &peakRuntimeuS},
-                                                  {RUNTIME_NAME_AVERAGE,   &averageRuntimeuS},
-                                                  {RUNTIME_NAME_UPTIME,    &uptimeuS}
+static const runtimeData runtimeDataSoftware[] = {{RUNTIME_NAME_PEAK,       &peakRuntimeuS},
+                                                  {RUNTIME_NAME_AVERAGE,    &averageRuntimeuS},
+                                                  {RUNTIME_NAME_UPTIME,     &uptimeuS},
+                                                  {RUNTIME_NAME_HEAP,       &heapFree},
+                                                  {RUNTIME_NAME_HEAP_MIN,   &heapFreeMin},
+                                                  {RUNTIME_NAME_HEAP_BLOCK, &heapMaxBlock},
+                                                  {RUNTIME_NAME_HEAP_FRAG,  &heapFragmentation},
+                                                  {RUNTIME_NAME_STACK_CONT, &stackContFree},
+                                                  {RUNTIME_NAME_STACK_SYS,  &stackSysFree}
 };  
 
 // Size of the runtimeDataSoftware structure
 static const unsigned int runtimeDataStructureSize = (sizeof(runtimeDataSoftware) / sizeof(runtimeDataSoftware[0]));
 
+// Runtime string data for this software
+static const runtimeStringData runtimeStringDataSoftware[] = {{RUNTIME_NAME_HEAP_MIN_TASK, &heapFreeMinTask}
+};
+
+// Size of the runtimeStringDataSoftware structure
+static const unsigned int runtimeStringDataStructureSize = (sizeof(runtimeStringDataSoftware) / sizeof(runtimeStringDataSoftware[0]));
+
 
 /**
     Measure average runtime.
@@ -109,14 +170,84 @@ void runtimeMeasurePeakuS(void) {
 }
 
 
+/**
+    Sample the free heap and keep the low water mark with the task it belongs to.
+    Only the free heap is sampled here (cheap), the heap walk for the largest block is done at transmit.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+static void runtimeSampleHeap(const char * const taskName) {
+
+    // Free heap now
+    unsigned long currentHeapFree = ESP.getFreeHeap();
+
+    // New low water mark
+    if (currentHeapFree < heapFreeMin) {
+        heapFreeMin = currentHeapFree;
+        heapFreeMinTask = taskName;
+    }
+}
+
+
+/**
+    Task start.
+    Called before each scheduler task executes to track the executing task.
+    Samples the heap left by the main loop since the previous task.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void runtimeTaskStart(const char * const taskName) {
+
+    runtimeSampleHeap(RUNTIME_TASK_LOOP);
+    journalSetTask(taskName);
+}
+
+
+/**
+    Task end.
+    Called after each scheduler task executes to sample the heap the task still holds.
+    Memory a task allocates and frees again before it returns is not seen.
+
+    @param[in]     taskName pointer to the task name (must be static).
+*/
+void runtimeTaskEnd(const char * const taskName) {
+
+    runtimeSampleHeap(taskName);
+    journalSetTask(RUNTIME_TASK_LOOP);
+}
+
+
 /**
     Transmit a runtime message.
     No processing of the message here.
 */
 void runtimeTransmitRuntimeMessage(void) {   
+
+    // Heap statistics
+    uint32_t currentHeapFree;
+    uint16_t currentHeapMaxBlock;
+    uint8_t currentHeapFragmentation;
     
-    // Update the uptime variable before transmitting
+    // Update the uptime, heap and stack variables before transmitting
     uptimeuS = millis();
 
-    messsagesTxRuntimeMessage(runtimeDataSoftware, &runtimeDataStructureSize);
+    ESP.getHeapStats(&currentHeapFree, &currentHeapMaxBlock, &currentHeapFragmentation);
+    heapFree = currentHeapFree;
+    heapMaxBlock = currentHeapMaxBlock;
+    heapFragmentation = currentHeapFragmentation;
+
+    if (heapFree < heapFreeMin) {
+        heapFreeMin = heapFree;
+        heapFreeMinTask = "runtimeTransmitRuntimeMessage";
+    }
+
+    stackContFree = stackMonitorContFree();
+    stackSysFree = stackMonitorSysFree();
+
+    // Nothing known about the SYS stack when it was not painted (0 would look like an overflow)
+    if (stackSysFree == STACK_MONITOR_NOT_PAINTED) {
+        stackSysFree = RUNTIME_NOT_AVAILABLE;
+    }
+
+    messsagesTxRuntimeMessage(runtimeDataSoftware, &runtimeDataStructureSize, runtimeStringDataSoftware, &runtimeStringDataStructureSize);
 }
@@ -0,0 +1,140 @@
+#include <Arduino.h>
+#include <cont.h>
+
+#include "stack_monitor.h"
+#include "stack_monitor_cfg.h"
+
+#include "debug.h"
+
+
+// Paint pattern (different to the cont stack guard so they can not be confused)
+#define STACK_MONITOR_PAINT         (uint32_t(0xA5A55A5A))
+
+// Bytes in a stack word
+#define STACK_MONITOR_WORD_SIZE     (sizeof(uint32_t))
+
+
+// SYS stack from the linker (defined in platformio.ini, the core has no symbols for it)
+extern "C" uint32_t _SYS_stack_start;
+extern "C" uint32_t _SYS_stack_end;
+
+// Module name for debug messages
+static const char* stackMonitorModuleName = "stackMonitor";
+
+// Painted part of the SYS stack
+static stackMonitorRegion stackMonitorSysRegion = {"sys", NULL, NULL};
+
+
+/**
+    Paint a stack region.
+    Every word from the bottom to the top of the region is filled with the paint pattern.
+
+    @param[in]     regionPtr pointer to the stack region.
+*/
+void stackMonitorPaintRegion(const stackMonitorRegion * const regionPtr) {
+
+    for (volatile uint32_t * word = regionPtr->regionBottom; word < regionPtr->regionTop; word++) {
+        *word = STACK_MONITOR_PAINT;
+    }
+}
+
+/**
+    Scan a painted stack region.
+
+    @param[in]     regionPtr pointer to the stack region.
+    @return        bytes from the bottom of the region that still hold the paint pattern.
+*/
+uint32_t stackMonitorScanRegion(const stackMonitorRegion * const regionPtr) {
+
+    // Stack word being checked
+    const volatile uint32_t * word = regionPtr->regionBottom;
+
+    // The stack grows down so the first word that has been overwritten marks the high water mark
+    while ((word < regionPtr->regionTop) && (*word == STACK_MONITOR_PAINT)) {
+        word++;
+    }
+
+    return((uint32_t)(word - regionPtr->regionBottom) * STACK_MONITOR_WORD_SIZE);
+}
+
+/**
+    Stack monitor init.
+    Paints the unused part of the SYS stack, the core paints the cont stack.
+    Should be called early during init.
+*/
+void stackMonitorInit(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Limits of the SYS stack
+    uint32_t * const sysBottom = &_SYS_stack_start;
+    uint32_t * sysTop = &_SYS_stack_end;
+
+    // The cont context is allocated on the SYS stack (core 2.5+), so the SYS stack really ends there
+    // When it is not inside the linker limits they do not match the core, so nothing is painted
+    if (((uint32_t *)g_pcont <= sysBottom) || ((uint32_t *)g_pcont >= sysTop)) {
+        debugMessage.format("Not painting %s stack, 0x%08x - 0x%08x does not hold the cont context", stackMonitorSysRegion.regionName, (unsigned int)(uintptr_t)sysBottom, (unsigned int)(uintptr_t)sysTop);
+        debugLog(debugMessage.c_str(), stackMonitorModuleName, warning);
+        return;
+    }
+
+    sysTop = (uint32_t *)g_pcont;
+
+    // Keep clear of the part of the SYS stack that is in use
+    if ((sysTop - sysBottom) > (ptrdiff_t)(STACK_MONITOR_SYS_RESERVE / STACK_MONITOR_WORD_SIZE)) {
+        sysTop -= (STACK_MONITOR_SYS_RESERVE / STACK_MONITOR_WORD_SIZE);
+    }
+    else {
+        sysTop = sysBottom;
+    }
+
+    // Only paint the deepest part of the stack (that is where the overflow margin is)
+    if (sysTop > (sysBottom + (STACK_MONITOR_SYS_PAINT / STACK_MONITOR_WORD_SIZE))) {
+        sysTop = sysBottom + (STACK_MONITOR_SYS_PAINT / STACK_MONITOR_WORD_SIZE);
+    }
+
+    if (sysTop > sysBottom) {
+        stackMonitorSysRegion.regionBottom = sysBottom;
+        stackMonitorSysRegion.regionTop = sysTop;
+
+        // Interrupts also use the SYS stack
+        noInterrupts();
+        stackMonitorPaintRegion(&stackMonitorSysRegion);
+        interrupts();
+
+        debugMessage.format("Painted %s stack 0x%08x - 0x%08x", stackMonitorSysRegion.regionName, (unsigned int)(uintptr_t)sysBottom, (unsigned int)(uintptr_t)sysTop);
+        debugLog(debugMessage.c_str(), stackMonitorModuleName, info);
+    }
+
+    else {
+        debugMessage.format("No room to paint %s stack", stackMonitorSysRegion.regionName);
+        debugLog(debugMessage.c_str(), stackMonitorModuleName, warning);
+    }
+}
+
+/**
+    Minimum free cont stack since boot.
+
+    @return        free bytes.
+*/
+uint32_t stackMonitorContFree(void) {
+    return(ESP.getFreeContStack());
+}
+
+/**
+    Minimum free SYS stack since boot.
+    Limited to the painted size (STACK_MONITOR_SYS_PAINT) when the stack never reached the painted area.
+
+    @return        free bytes or STACK_MONITOR_NOT_PAINTED when the SYS stack was not painted.
+*/
+uint32_t stackMonitorSysFree(void) {
+
+    uint32_t returnValue = STACK_MONITOR_NOT_PAINTED;
+
+    if (stackMonitorSysRegion.regionBottom != NULL) {
+        returnValue = stackMonitorScanRegion(&stackMonitorSysRegion);
+    }
+
+    return(returnValue);
+}
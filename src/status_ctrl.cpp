@@ -54,7 +54,7 @@ void statusCtrlInit(void) {
 void statusCtrlStateMachine(void) {
     
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
 
     // Last state
     static statusCtrlStm lastState = stmStatusIdle;
@@ -176,8 +176,8 @@ void statusCtrlStateMachine(void) {
 
     // State change
     if (statusCtrlCurrentState != nextState) {
-        debugMessage = String() + "statusCtrl changed to state to " + statusCtrlStateNames[nextState] + ".";
-        debugLog(&debugMessage, info);
+        debugMessage.format("statusCtrl changed to state to %s.", statusCtrlStateNames[nextState]);
+        debugLog(debugMessage.c_str(), info);
     }
     
     // Update last states and current states (in this order)
@@ -5,14 +5,20 @@
 #include <ESP8266WebServer.h>
 #include "WiFiManager.h"
 
+extern "C" {
+#include <user_interface.h>
+}
+
 #include "wifi.h"
 
 #include "utils.h"
 #include "debug.h"
+#include "fixed_string.h"
 #include "nvm_cfg.h"
 #include "outputs_cfg.h"
-#include "reset_ctrl.h"
+#include "config.h"
 #include "messages_tx.h"
+#include "rtc_mem_cfg.h"
 
 
 // Size of a MAC address char buffer
@@ -51,6 +57,63 @@
 // Name for the rssi
 #define WIFI_NAME_RSSI          ("rssi")
 
+// Name for the rssi average (EWMA)
+#define WIFI_NAME_RSSI_AVERAGE  ("rssiAvg")
+
+// Name for the rssi minimum (sample window)
+#define WIFI_NAME_RSSI_MIN      ("rssiMin")
+
+// Name for the rssi maximum (sample window)
+#define WIFI_NAME_RSSI_MAX      ("rssiMax")
+
+// Name for the rssi 10th percentile (sample window)
+#define WIFI_NAME_RSSI_P10      ("rssiP10")
+
+// Name for the rssi median (sample window)
+#define WIFI_NAME_RSSI_P50      ("rssiP50")
+
+// Name for the rssi 90th percentile (sample window)
+#define WIFI_NAME_RSSI_P90      ("rssiP90")
+
+// Name for the number of reconnections
+#define WIFI_NAME_RECONNECTS    ("reconnects")
+
+// Name for the connection path
+#define WIFI_NAME_CONNECT       ("connect")
+
+// Name for the connection time
+#define WIFI_NAME_CONNECT_TIME  ("connectTime")
+
+// Connection path when the cached BSSID, channel and IP configuration was used
+#define WIFI_CONNECT_CACHED     ("cached")
+
+// Connection path when WiFiManager scanned and ran DHCP
+#define WIFI_CONNECT_FULL       ("full")
+
+// Number of RSSI samples in the statistics window
+#define WIFI_RSSI_WINDOW        (32)
+
+// RSSI EWMA weight of a new sample as a shift (1/8)
+#define WIFI_RSSI_EWMA_SHIFT    (3)
+
+// RSSI EWMA fixed point fraction bits
+#define WIFI_RSSI_EWMA_FRACTION (4)
+
+// Configuration portal timeout, extended while a client is connected (s)
+#define WIFI_PORTAL_TIMEOUT     (180)
+
+// Timeout for WiFiManager connection attempts (s)
+#define WIFI_CONNECT_TIMEOUT    (10)
+
+// Magic number marking a WiFi connection cache in RTC memory
+#define WIFI_CACHE_MAGIC        (uint32_t(0x57434348))
+
+// Time to wait for a connection using the cache before falling back to WiFiManager (ms)
+#define WIFI_CACHE_TIMEOUT      (4000)
+
+// Time to wait between connection status checks when using the cache (ms)
+#define WIFI_CACHE_POLL         (10)
+
 // HTTP definitions for the configuration portal
 #define HTTP_PARAM_HEADING_START   "<br /><br /><br /> <b>"
 #define HTTP_PARAM_HEADING_END     "</b>"
@@ -124,18 +187,94 @@ static char subnetMaskString[WIFI_IP_BUFFER_SIZE];
 // MAC address
 static char macString[WIFI_MAC_BUFFER_SIZE];
 
-// RSSI
+// RSSI (last sample)
 static long rssi;
 
+// RSSI average (EWMA)
+static long rssiAverage;
+
+// RSSI minimum (sample window)
+static long rssiMin;
+
+// RSSI maximum (sample window)
+static long rssiMax;
+
+// RSSI 10th percentile (sample window)
+static long rssiP10;
+
+// RSSI median (sample window)
+static long rssiP50;
+
+// RSSI 90th percentile (sample window)
+static long rssiP90;
+
+// RSSI EWMA (fixed point with WIFI_RSSI_EWMA_FRACTION fraction bits)
+static int32_t rssiEwma = 0;
+
+// RSSI sample window (ring buffer)
+static int8_t rssiSamples[WIFI_RSSI_WINDOW];
+
+// Number of valid RSSI samples in the window
+static unsigned int rssiSampleCount = 0;
+
+// Next RSSI sample to write
+static unsigned int rssiSampleNext = 0;
+
+// Number of times an IP address was obtained
+static uint32_t gotIpEvents = 0;
+
+// Number of reconnections (IP address obtained after the first connection)
+static uint32_t reconnects = 0;
+
+// Station details need refreshing (set from the station events)
+static volatile bool stationDetailsStale = true;
+
+// Station got IP event handler
+static WiFiEventHandler wifiGotIpHandler;
+
+// Station disconnected event handler
+static WiFiEventHandler wifiDisconnectedHandler;
+
+// Connection path used during set-up
+static const char * connectPath = WIFI_CONNECT_FULL;
+
+// Time taken to connect during set-up (ms)
+static unsigned long connectTime = 0;
+
 // Wifi data for this software
 static wifiData wifiDataSoftware = {WIFI_NAME_SSID,         ssidString,
                                     WIFI_NAME_IP,           ipString,
                                     WIFI_NAME_GATEWAY,      gatewayString,
                                     WIFI_NAME_SUBNET_MASK,  subnetMaskString,
                                     WIFI_NAME_MAC,          macString,
-                                    WIFI_NAME_RSSI,         &rssi
+                                    WIFI_NAME_RSSI,         &rssi,
+                                    WIFI_NAME_RSSI_AVERAGE, &rssiAverage,
+                                    WIFI_NAME_RSSI_MIN,     &rssiMin,
+                                    WIFI_NAME_RSSI_MAX,     &rssiMax,
+                                    WIFI_NAME_RSSI_P10,     &rssiP10,
+                                    WIFI_NAME_RSSI_P50,     &rssiP50,
+                                    WIFI_NAME_RSSI_P90,     &rssiP90,
+                                    WIFI_NAME_RECONNECTS,   &reconnects,
+                                    WIFI_NAME_CONNECT,      &connectPath,
+                                    WIFI_NAME_CONNECT_TIME, &connectTime
 };
 
+// Structure for the WiFi connection cache in RTC memory
+typedef struct {
+    uint32_t                magic;                      // Cache magic number
+    uint8_t                 bssid[NVM_LENGTH_BSSID];    // Access point BSSID
+    uint8_t                 channel;                    // Access point channel
+    uint8_t                 spare;                      // Spare (keeps the structure 32bit aligned)
+    uint32_t                ip;                         // IP address
+    uint32_t                gateway;                    // Gateway address
+    uint32_t                mask;                       // Subnet mask
+    uint32_t                dns;                        // DNS server address
+    crc_t                   crc;                        // CRC
+} wifiCacheRtcStructure;
+
+static_assert((sizeof(wifiCacheRtcStructure) % RTC_MEM_BLOCK_SIZE) == 0, "wifiCacheRtcStructure must be a whole number of RTC memory blocks");
+static_assert(sizeof(wifiCacheRtcStructure) <= (RTC_MEM_BLOCKS_WIFI * RTC_MEM_BLOCK_SIZE), "wifiCacheRtcStructure does not fit into the RTC memory allocated for the WiFi cache");
+
 // Structure for all publisher modules
 // The last element is always the default 
 static wifiModuleDetail publisherModules[] = {{"483FDA482A64", "pub-garage-door-active-v2", garageDoorModule},
@@ -147,8 +286,68 @@ static wifiModuleDetail publisherModules[] = {{"483FDA482A64", "pub-garage-door-
 // Pointer to the active module in the publisher module structure
 static unsigned int activeModule;
 
-// Configuration save
-static bool configSave = false;
+// WiFi manager (lives for the whole run so the configuration portal can run in the background)
+static WiFiManager wifiManager;
+
+// Configuration portal was active on the last call
+static bool wifiPortalActive = false;
+
+// Configuration portal parameters (the field values are loaded from the RAM mirror in setupWifi)
+static WiFiManagerParameter textHeadingNvm(httpTextHeadingNvm);
+static WiFiManagerParameter textNvmVersion(httpTextNvmVersion);
+static WiFiManagerParameter fieldNvmVersion("nvmVersion", HTTP_TEXT_NVM_VERSION, "", STRNLEN_INT(NVM_MAX_VERSION));
+static WiFiManagerParameter textNvmErrorCnt(httpTextNvmErrorCnt);
+static WiFiManagerParameter fieldNvmErrorCnt("errorCounter", HTTP_TEXT_NVM_ERROR_CNT, "", STRNLEN_INT(NVM_MAX_ERROR));
+
+static WiFiManagerParameter textHeadingNetwork(httpTextHeadingNetwork);
+static WiFiManagerParameter textOtaPassword(httpTextOtaPassword);
+static WiFiManagerParameter fieldOtaPassword("otaPassword", HTTP_TEXT_NETWORK_OTA_PWD, "", NVM_MAX_LENGTH_PASSWORD);
+static WiFiManagerParameter textWifiApPassword(httpTextWifiApPassword);
+static WiFiManagerParameter fieldWifiApPassword("wifiAPPassword", HTTP_TEXT_NETWORK_AP_PWD, "", NVM_MAX_LENGTH_PASSWORD);
+
+static WiFiManagerParameter textHeadingMqtt(httpTextHeadingMqtt);
+static WiFiManagerParameter textMqttServer(httpTextMqttServer);
+static WiFiManagerParameter fieldMqttServer("mqttServer", HTTP_TEXT_MQTT_SERVER, "", NVM_MAX_LENGTH_URL);
+static WiFiManagerParameter textMqttUser(httpTextMqttUser);
+static WiFiManagerParameter fieldMqttUser("mqttUser", HTTP_TEXT_MQTT_USER, "", NVM_MAX_LENGTH_USER);
+static WiFiManagerParameter textMqttPassword(httpTextMqttPassword);
+static WiFiManagerParameter fieldMqttPassword("mqttPassword", HTTP_TEXT_MQTT_PWD, "", NVM_MAX_LENGTH_PASSWORD);
+static WiFiManagerParameter textMqttTopicRoot(httpTextMqttTopicRoot);
+static WiFiManagerParameter fieldMqttTopicRoot("mqttTopicRoot", HTTP_TEXT_MQTT_TOPIC, "", NVM_MAX_LENGTH_TOPIC);
+
+static WiFiManagerParameter textHeadingIO(httpTextHeadingIO);
+static WiFiManagerParameter textTextRunLedBright(httpTextRunLedBright);
+static WiFiManagerParameter fieldRunLedBright("ledBrightnessRunMode", HTTP_TEXT_IO_RUN_LED, "", STRNLEN_INT(PWMRANGE));
+static WiFiManagerParameter textCfgLedBright(httpTextCfgLedBright);
+static WiFiManagerParameter fieldCfgLedBright("ledBrightnessConfigMode", HTTP_TEXT_IO_CFG_LED, "", STRNLEN_INT(PWMRANGE));
+static WiFiManagerParameter textCfgResetSw(httpTextCfgResetSw);
+static WiFiManagerParameter fieldCfgResetSw("resetSwitchEnabled", HTTP_TEXT_IO_RESET_SW, "", STRNLEN_INT(1));
+
+static WiFiManagerParameter textHeadingAlarm(httpTextHeadingAlarm);
+static WiFiManagerParameter textHomeAddress(httpTextHomeAddress);
+static WiFiManagerParameter fieldHomeAddress("homeAddress", HTTP_TEXT_ALARM_ADDRESS, "", NVM_MAX_LENGTH_ADDRESS);
+
+static WiFiManagerParameter textHeadingHawkbit(httpTextHeadingHawkbit);
+static WiFiManagerParameter textHawkbitServer(httpTextHawkbitServer);
+static WiFiManagerParameter fieldHawkbitServer("hawkbitServer", HTTP_TEXT_HAWKBIT_SERVER, "", NVM_MAX_LENGTH_URL);
+static WiFiManagerParameter textHawkbitToken(httpTextHawkbitToken);
+static WiFiManagerParameter fieldHawkbitToken("hawkbitToken", HTTP_TEXT_HAWKBIT_TOKEN, "", NVM_MAX_LENGTH_HTTP_TOKEN);
+static WiFiManagerParameter textHawkbitTokenTyp(httpTextHawkbitTokenTyp);
+static WiFiManagerParameter fieldHawkbitTokenTyp("hawkbitTokenType", HTTP_TEXT_HAWKBIT_TOKEN_TYPE, "", STRNLEN_INT(255));
+static WiFiManagerParameter textHawkbitTennant(httpTextHawkbitTennant);
+static WiFiManagerParameter fieldHawkbitTennant("hawkbitTennant", HTTP_TEXT_HAWKBIT_TENNANT, "", NVM_MAX_LENGTH_TENNANT);
+
+// All configuration portal parameters (in display order)
+static WiFiManagerParameter * const wifiPortalParameters[] = {&textHeadingNvm,     &textNvmVersion,       &fieldNvmVersion,     &textNvmErrorCnt,     &fieldNvmErrorCnt,
+                                                              &textHeadingNetwork, &textOtaPassword,      &fieldOtaPassword,    &textWifiApPassword,  &fieldWifiApPassword,
+                                                              &textHeadingMqtt,    &textMqttServer,       &fieldMqttServer,     &textMqttUser,        &fieldMqttUser,
+                                                              &textMqttPassword,   &fieldMqttPassword,    &textMqttTopicRoot,   &fieldMqttTopicRoot,
+                                                              &textHeadingIO,      &textTextRunLedBright, &fieldRunLedBright,   &textCfgLedBright,    &fieldCfgLedBright,
+                                                              &textCfgResetSw,     &fieldCfgResetSw,
+                                                              &textHeadingAlarm,   &textHomeAddress,      &fieldHomeAddress,
+                                                              &textHeadingHawkbit, &textHawkbitServer,    &fieldHawkbitServer,  &textHawkbitToken,    &fieldHawkbitToken,
+                                                              &textHawkbitTokenTyp, &fieldHawkbitTokenTyp, &textHawkbitTennant, &fieldHawkbitTennant
+};
 
 // Decives WiFi full media access control (MAC) address
 static char deviceMac[WIFI_BUFFER_SIZE_MAC + 1];
@@ -163,7 +362,17 @@ static char deviceMacNic[WIFI_BUFFER_SIZE_NIC + 1];
 static void bufferMacString(void);
 static void findCurrentModule(void);
 static void callbackFailedWifiConnect (WiFiManager *myWiFiManager);
-static const char* wifiStatusToString(wl_status_t status);
+static void callbackConfigUpdated(void);
+static void wifiLoadPortalParameters(void);
+static void wifiIpToString(const IPAddress address, char * const buffer, const size_t bufferSize);
+static void wifiBufferStationDetails(void);
+static void wifiSampleRssi(void);
+static void wifiUpdateRssiStatistics(void);
+static crc_t wifiCacheCalculateCrc(const wifiCacheRtcStructure * const cachePtr);
+static bool wifiCacheLoad(wifiCacheRtcStructure * const cachePtr);
+static void wifiCacheSave(void);
+static bool wifiCacheConnect(void);
+static void wifiRestoreStationConfig(void);
 
 /**
     Buffer MAC address into a string.
@@ -217,13 +426,19 @@ static void callbackFailedWifiConnect(WiFiManager *myWiFiManager) {
     (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
 
     // Debug message
-    String debugMessage;
+    debugString debugMessage;
+
+    // Soft AP IP address
+    char softApIpString[WIFI_IP_BUFFER_SIZE];
+
+    debugLog("Entering WiFi configuration mode.", warning);
 
-    debugMessage = (String() + "Entering WiFi configuration mode.");
-    debugLog(&debugMessage, warning);
+    // Configuration portal parameters (only needed when the portal starts)
+    wifiLoadPortalParameters();
 
-    debugMessage = (String() + "SSID: " + myWiFiManager->getConfigPortalSSID() + ", IP: " + WiFi.softAPIP().toString());
-    debugLog(&debugMessage, warning);
+    wifiIpToString(WiFi.softAPIP(), softApIpString, sizeof(softApIpString));
+    debugMessage.format("SSID: %s, IP: %s", myWiFiManager->getConfigPortalSSID().c_str(), softApIpString);
+    debugLog(debugMessage.c_str(), warning);
 
     // Turn on the config mode LED
     outputsSetOutputByName(configMode, {direct, ramMirrorPtr->io.ledBrightnessConfigMode, 0, 0, 0});
@@ -231,9 +446,152 @@ static void callbackFailedWifiConnect(WiFiManager *myWiFiManager) {
 
 /**
     Callback when configuraiton needs to be saved.
+    Runs from the background configuration portal, so the changes are comitted and applied in place (no reboot).
 */
 static void callbackConfigUpdated(void) {
-    configSave = true;
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // CRC's before the update (a changed CRC means a changed structure)
+    crc_t crcBefore[nvmNumberOfTypes];
+
+    // CRC after the update
+    crc_t crcAfter;
+
+    // Mask of changed structures
+    uint32_t changedStructures = 0;
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        memcpy(&crcBefore[i], nvmConfigPtr[i].addressCrc, NVM_CRC_SIZE_BYTES);
+    }
+
+    // NVM configs
+    ramMirrorPtr->nvm.core.version = (uint16_t) atoi(fieldNvmVersion.getValue());
+    ramMirrorPtr->nvm.core.errorCounter = (uint16_t) atoi(fieldNvmErrorCnt.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmNvmStruc);
+
+    // Network configs
+    strcpy(ramMirrorPtr->network.otaPassword, fieldOtaPassword.getValue());
+    strcpy(ramMirrorPtr->network.wifiAPPassword, fieldWifiApPassword.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmNetworkStruc);
+
+    // MQTT configs
+    strcpy(ramMirrorPtr->mqtt.mqttServer, fieldMqttServer.getValue());
+    strcpy(ramMirrorPtr->mqtt.mqttUser, fieldMqttUser.getValue());
+    strcpy(ramMirrorPtr->mqtt.mqttPassword, fieldMqttPassword.getValue());
+    strcpy(ramMirrorPtr->mqtt.mqttTopicRoot, fieldMqttTopicRoot.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+
+    // IO configs
+    ramMirrorPtr->io.ledBrightnessConfigMode = (uint16_t) atoi(fieldCfgLedBright.getValue());
+    ramMirrorPtr->io.ledBrightnessRunMode = (uint16_t) atoi(fieldRunLedBright.getValue());
+    ramMirrorPtr->io.resetSwitchEnabled = (uint8_t) atoi(fieldCfgResetSw.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmIOStruc);
+
+    // Alarm configs
+    strcpy(ramMirrorPtr->alarm.homeAddress, fieldHomeAddress.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
+
+    // Hawkbit configs
+    strcpy(ramMirrorPtr->hawkbit.hawkbitServer, fieldHawkbitServer.getValue());
+    strcpy(ramMirrorPtr->hawkbit.hawkbitToken, fieldHawkbitToken.getValue());
+    ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex = (uint8_t) atoi(fieldHawkbitTokenTyp.getValue());
+    strcpy(ramMirrorPtr->hawkbit.hawkbitTennant, fieldHawkbitTennant.getValue());
+    nvmUpdateRamMirrorCrcByName(nvmHawkbitStruc);
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        memcpy(&crcAfter, nvmConfigPtr[i].addressCrc, NVM_CRC_SIZE_BYTES);
+
+        if (crcAfter != crcBefore[i]) {
+            changedStructures |= CONFIG_STRUCTURE_BIT(i);
+        }
+    }
+
+    // Only write and re-init when something changed
+    if (changedStructures != 0) {
+        nvmComittRamMirrorAsync(NULL);
+        configApply(changedStructures);
+
+        // Debug message
+        debugLog("Configuraiton data saved and applied.", info);
+    }
+}
+
+/**
+    Load the configuration portal fields from the RAM mirror.
+    The portal shows deferred NVM structures, so these are validated first.
+*/
+static void wifiLoadPortalParameters(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmValidateDeferred();
+
+    // String storage for NVM version integer (text entry field)
+    char nvmVersionString[STRNLEN_INT(NVM_MAX_VERSION) + 1];
+
+    // String storage for errorCounter integer (text entry field)
+    char nvmErrorCounterString[STRNLEN_INT(NVM_MAX_ERROR) + 1];
+
+    // String storage for run LED dimming integer (text entry field)
+    char ledRunDimmingString[STRNLEN_INT(PWMRANGE) + 1];
+
+    // String storage for config LED dimming integer (text entry field)
+    char ledCfgDimmingString[STRNLEN_INT(PWMRANGE) + 1];
+
+    // String storage for reset switch config (text entry field)
+    char resetSwCfgString[STRNLEN_INT(1) + 1];
+
+    // String storage for Hawkbit token type index
+    char hawkbitTokenTypeIndex[STRNLEN_INT(255) + 1];
+
+    // Nvm configs
+    snprintf(nvmVersionString, sizeof(nvmVersionString), "%d", ramMirrorPtr->nvm.core.version);
+    fieldNvmVersion.setValue(nvmVersionString, STRNLEN_INT(NVM_MAX_VERSION));
+    snprintf(nvmErrorCounterString, sizeof(nvmErrorCounterString), "%d", ramMirrorPtr->nvm.core.errorCounter);
+    fieldNvmErrorCnt.setValue(nvmErrorCounterString, STRNLEN_INT(NVM_MAX_ERROR));
+
+    // Network configs
+    fieldOtaPassword.setValue(ramMirrorPtr->network.otaPassword, NVM_MAX_LENGTH_PASSWORD);
+    fieldWifiApPassword.setValue(ramMirrorPtr->network.wifiAPPassword, NVM_MAX_LENGTH_PASSWORD);
+
+    // MQTT configs
+    fieldMqttServer.setValue(ramMirrorPtr->mqtt.mqttServer, NVM_MAX_LENGTH_URL);
+    fieldMqttUser.setValue(ramMirrorPtr->mqtt.mqttUser, NVM_MAX_LENGTH_USER);
+    fieldMqttPassword.setValue(ramMirrorPtr->mqtt.mqttPassword, NVM_MAX_LENGTH_PASSWORD);
+    fieldMqttTopicRoot.setValue(ramMirrorPtr->mqtt.mqttTopicRoot, NVM_MAX_LENGTH_TOPIC);
+
+    // IO configs
+    snprintf(ledRunDimmingString, sizeof(ledRunDimmingString), "%d", ramMirrorPtr->io.ledBrightnessRunMode);
+    fieldRunLedBright.setValue(ledRunDimmingString, STRNLEN_INT(PWMRANGE));
+    snprintf(ledCfgDimmingString, sizeof(ledCfgDimmingString), "%d", ramMirrorPtr->io.ledBrightnessConfigMode);
+    fieldCfgLedBright.setValue(ledCfgDimmingString, STRNLEN_INT(PWMRANGE));
+    snprintf(resetSwCfgString, sizeof(resetSwCfgString), "%d", ramMirrorPtr->io.resetSwitchEnabled);
+    fieldCfgResetSw.setValue(resetSwCfgString, STRNLEN_INT(1));
+
+    // Alarm configs
+    fieldHomeAddress.setValue(ramMirrorPtr->alarm.homeAddress, NVM_MAX_LENGTH_ADDRESS);
+
+    // Hawkbit configs
+    fieldHawkbitServer.setValue(ramMirrorPtr->hawkbit.hawkbitServer, NVM_MAX_LENGTH_URL);
+    fieldHawkbitToken.setValue(ramMirrorPtr->hawkbit.hawkbitToken, NVM_MAX_LENGTH_HTTP_TOKEN);
+    snprintf(hawkbitTokenTypeIndex, sizeof(hawkbitTokenTypeIndex), "%d", ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex);
+    fieldHawkbitTokenTyp.setValue(hawkbitTokenTypeIndex, STRNLEN_INT(255));
+    fieldHawkbitTennant.setValue(ramMirrorPtr->hawkbit.hawkbitTennant, NVM_MAX_LENGTH_TENNANT);
 }
 
 /**
@@ -250,7 +608,7 @@ wifiModuleDetail* const getWiFiModuleDetails(void) {
     @param[in]     status wifi status value to check.
     @return        string explaining the wifi code.
 */
-static const char* wifiStatusToString(wl_status_t status) {
+const char* wifiStatusToString(const wl_status_t status) {
   switch (status) {
     case WL_NO_SHIELD: return "WL_NO_SHIELD";
     case WL_IDLE_STATUS: return "WL_IDLE_STATUS";
@@ -264,6 +622,276 @@ static const char* wifiStatusToString(wl_status_t status) {
   }
 }
 
+/**
+    Format an IP address into a char buffer (dotted decimal).
+    @param[in]     address IP address to format.
+    @param[out]    buffer pointer to the buffer for the string.
+    @param[in]     bufferSize size of the buffer.
+*/
+static void wifiIpToString(const IPAddress address, char * const buffer, const size_t bufferSize) {
+    snprintf(buffer, bufferSize, "%u.%u.%u.%u", address[0], address[1], address[2], address[3]);
+}
+
+/**
+    Buffer the station SSID, IP, gateway, subnet mask and MAC into the wifi data strings.
+*/
+static void wifiBufferStationDetails(void) {
+
+    // Station configuration (holds the SSID)
+    struct station_config stationConfig;
+
+    // Raw MAC address
+    uint8_t rawMAC[6];
+
+    // SSID is not terminated when it uses all 32 characters
+    wifi_station_get_config(&stationConfig);
+    memset(ssidString, 0, sizeof(ssidString));
+    strncpy(ssidString, (const char *)stationConfig.ssid, min(sizeof(stationConfig.ssid), sizeof(ssidString) - 1));
+
+    wifiIpToString(WiFi.localIP(), ipString, sizeof(ipString));
+    wifiIpToString(WiFi.gatewayIP(), gatewayString, sizeof(gatewayString));
+    wifiIpToString(WiFi.subnetMask(), subnetMaskString, sizeof(subnetMaskString));
+
+    WiFi.macAddress(rawMAC);
+    snprintf(macString, sizeof(macString), "%02X:%02X:%02X:%02X:%02X:%02X", rawMAC[0], rawMAC[1], rawMAC[2], rawMAC[3], rawMAC[4], rawMAC[5]);
+}
+
+/**
+    Sample the RSSI into the EWMA and the statistics window.
+*/
+static void wifiSampleRssi(void) {
+
+    rssi = WiFi.RSSI();
+
+    // First sample seeds the average
+    if (rssiSampleCount == 0) {
+        rssiEwma = rssi * (1 << WIFI_RSSI_EWMA_FRACTION);
+    }
+    else {
+        rssiEwma += ((rssi * (1 << WIFI_RSSI_EWMA_FRACTION)) - rssiEwma) / (1 << WIFI_RSSI_EWMA_SHIFT);
+    }
+
+    rssiSamples[rssiSampleNext] = (int8_t) rssi;
+    rssiSampleNext = (rssiSampleNext + 1) % WIFI_RSSI_WINDOW;
+
+    if (rssiSampleCount < WIFI_RSSI_WINDOW) {
+        rssiSampleCount++;
+    }
+}
+
+/**
+    Update the RSSI average, minimum, maximum and percentiles from the statistics window.
+*/
+static void wifiUpdateRssiStatistics(void) {
+
+    // Sorted copy of the sample window
+    int8_t sorted[WIFI_RSSI_WINDOW];
+
+    // Sample being inserted
+    int8_t sample;
+
+    unsigned int j;
+
+    if (rssiSampleCount > 0) {
+
+        // Insertion sort (small window)
+        for (unsigned int i = 0; i < rssiSampleCount; i++) {
+            sample = rssiSamples[i];
+
+            for (j = i; (j > 0) && (sorted[j - 1] > sample); j--) {
+                sorted[j] = sorted[j - 1];
+            }
+
+            sorted[j] = sample;
+        }
+
+        rssiAverage = rssiEwma / (1 << WIFI_RSSI_EWMA_FRACTION);
+        rssiMin = sorted[0];
+        rssiMax = sorted[rssiSampleCount - 1];
+        rssiP10 = sorted[(rssiSampleCount * 10) / 100];
+        rssiP50 = sorted[(rssiSampleCount * 50) / 100];
+        rssiP90 = sorted[(rssiSampleCount * 90) / 100];
+    }
+}
+
+/**
+    Calculate the CRC of a WiFi connection cache.
+
+    @param[in]     cachePtr pointer to the cache.
+    @return        CRC of the cache (excluding the CRC itself).
+*/
+static crc_t wifiCacheCalculateCrc(const wifiCacheRtcStructure * const cachePtr) {
+    return(crcCalculate((const uint8_t *)cachePtr, offsetof(wifiCacheRtcStructure, crc)));
+}
+
+/**
+    Load the WiFi connection cache.
+    RTC memory survives warm resets, NVM is used after a cold boot.
+
+    @param[out]    cachePtr pointer to the cache to populate.
+    @return        true when a valid cache was loaded.
+*/
+static bool wifiCacheLoad(wifiCacheRtcStructure * const cachePtr) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    bool returnValue = false;
+
+    // Warm reset, try RTC memory first
+    if (ESP.rtcUserMemoryRead(RTC_MEM_OFFSET_WIFI, (uint32_t *)cachePtr, sizeof(*cachePtr))) {
+        if ((cachePtr->magic == WIFI_CACHE_MAGIC) && (cachePtr->crc == wifiCacheCalculateCrc(cachePtr))) {
+            returnValue = true;
+        }
+    }
+
+    // Cold boot (or RTC memory corrupt), the NVM integrity check has already validated the CRC
+    if ((returnValue == false) && (ramMirrorPtr->wifi.valid != false)) {
+        memcpy(cachePtr->bssid, ramMirrorPtr->wifi.bssid, sizeof(cachePtr->bssid));
+        cachePtr->channel = ramMirrorPtr->wifi.channel;
+        cachePtr->ip = ramMirrorPtr->wifi.ip;
+        cachePtr->gateway = ramMirrorPtr->wifi.gateway;
+        cachePtr->mask = ramMirrorPtr->wifi.mask;
+        cachePtr->dns = ramMirrorPtr->wifi.dns;
+        returnValue = true;
+    }
+
+    return(returnValue);
+}
+
+/**
+    Save the current connection into the WiFi connection cache.
+    RTC memory is always written, NVM is only written when the connection has changed (saves flash wear).
+*/
+static void wifiCacheSave(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Cache for RTC memory
+    wifiCacheRtcStructure cache;
+
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = WIFI_CACHE_MAGIC;
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = (uint8_t) WiFi.channel();
+    cache.ip = (uint32_t) WiFi.localIP();
+    cache.gateway = (uint32_t) WiFi.gatewayIP();
+    cache.mask = (uint32_t) WiFi.subnetMask();
+    cache.dns = (uint32_t) WiFi.dnsIP(0);
+    cache.crc = wifiCacheCalculateCrc(&cache);
+
+    (void) ESP.rtcUserMemoryWrite(RTC_MEM_OFFSET_WIFI, (uint32_t *)&cache, sizeof(cache));
+
+    // Only commit to NVM when something has changed
+    if ((ramMirrorPtr->wifi.valid == false) ||
+        (memcmp(ramMirrorPtr->wifi.bssid, cache.bssid, sizeof(cache.bssid)) != 0) ||
+        (ramMirrorPtr->wifi.channel != cache.channel) ||
+        (ramMirrorPtr->wifi.ip != cache.ip) ||
+        (ramMirrorPtr->wifi.gateway != cache.gateway) ||
+        (ramMirrorPtr->wifi.mask != cache.mask) ||
+        (ramMirrorPtr->wifi.dns != cache.dns)) {
+
+        ramMirrorPtr->wifi.valid = true;
+        memcpy(ramMirrorPtr->wifi.bssid, cache.bssid, sizeof(cache.bssid));
+        ramMirrorPtr->wifi.channel = cache.channel;
+        ramMirrorPtr->wifi.ip = cache.ip;
+        ramMirrorPtr->wifi.gateway = cache.gateway;
+        ramMirrorPtr->wifi.mask = cache.mask;
+        ramMirrorPtr->wifi.dns = cache.dns;
+        nvmUpdateRamMirrorCrcByName(nvmWifiStruc);
+        nvmComittRamMirrorAsync(NULL);
+
+        debugLog("WiFi connection cache updated.", info);
+    }
+}
+
+/**
+    Disconnect and return the station to the stored configuration (no BSSID lock) with DHCP.
+*/
+static void wifiRestoreStationConfig(void) {
+
+    // Stored station configuration
+    struct station_config stationConfig;
+
+    wifi_station_disconnect();
+
+    if (wifi_station_get_config_default(&stationConfig) == true) {
+        (void) wifi_station_set_config_current(&stationConfig);
+    }
+
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+}
+
+/**
+    Connect directly using the cached BSSID, channel and IP configuration.
+    Skips the channel scan and waiting for DHCP, once connected DHCP runs in the background to renew the lease.
+    On failure the station is returned to the stored configuration with DHCP.
+    This call is BLOCKING (up to WIFI_CACHE_TIMEOUT).
+
+    @return        true when connected.
+*/
+static bool wifiCacheConnect(void) {
+
+    // Cached connection
+    wifiCacheRtcStructure cache;
+
+    // Stored station configuration (SSID and password)
+    struct station_config stationConfig;
+
+    // SSID and password are not terminated when they use the full field
+    char ssid[sizeof(stationConfig.ssid) + 1];
+    char password[sizeof(stationConfig.password) + 1];
+
+    // Time the attempt started
+    unsigned long startTime;
+
+    bool returnValue = false;
+
+    if ((wifiCacheLoad(&cache) == true) && (wifi_station_get_config_default(&stationConfig) == true) && (stationConfig.ssid[0] != '\0')) {
+
+        memset(ssid, 0, sizeof(ssid));
+        memcpy(ssid, stationConfig.ssid, sizeof(stationConfig.ssid));
+        memset(password, 0, sizeof(password));
+        memcpy(password, stationConfig.password, sizeof(stationConfig.password));
+
+        // Do not persist the BSSID lock or static IP into the SDK flash configuration
+        WiFi.persistent(false);
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.mask), IPAddress(cache.dns));
+        WiFi.begin(ssid, password, cache.channel, cache.bssid);
+
+        startTime = millis();
+        while ((WiFi.status() != WL_CONNECTED) && ((millis() - startTime) < WIFI_CACHE_TIMEOUT)) {
+            delay(WIFI_CACHE_POLL);
+        }
+
+        returnValue = (WiFi.status() == WL_CONNECTED);
+
+        // Hand the address back to DHCP, the cached lease only speeds up the connect and is never used as a static IP
+        // The address is kept until DHCP binds, the server may hand out a different one shortly after boot
+        if (returnValue == true) {
+            WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+        }
+
+        // Back to the stored configuration (no BSSID lock) with DHCP for WiFiManager
+        else {
+            debugLog("Connection using the WiFi cache failed, falling back to a full connect.", warning);
+
+            wifiRestoreStationConfig();
+        }
+
+        WiFi.persistent(true);
+    }
+
+    return(returnValue);
+}
+
 /**
     Identify the module based on the MAC.
     This informaiton is used by many modules to set variant specific configuration during init.
@@ -276,35 +904,17 @@ void wifiIdentifyModule(void) {
 
 /**
     WiFi set-up and connect.
+    When the connection fails the configuration portal keeps running in the background (see wifiPortalLoop).
 */
 void setupWifi(void) {
-    String debugMessage;
-    WiFiManager wifiManager;    
+    debugString debugMessage;
 
     // Pointer to the RAM mirror
-    nvmCompleteStructure * ramMirrorPtr;
+    const nvmCompleteStructure * ramMirrorPtr;
 
     // Set-up pointer to RAM mirror
-    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
-
-    // String storage for NVM version integer (text entry field)
-    char nvmVersionString[STRNLEN_INT(NVM_MAX_VERSION) + 1];
-
-    // String storage for errorCounter integer (text entry field)
-    char nvmErrorCounterString[STRNLEN_INT(NVM_MAX_ERROR) + 1];
-
-    // String storage for run LED dimming integer (text entry field)
-    char ledRunDimmingString[STRNLEN_INT(PWMRANGE) + 1];
-
-    // String storage for config LED dimming integer (text entry field)
-    char ledCfgDimmingString[STRNLEN_INT(PWMRANGE) + 1];
-
-    // String storage for reset switch config (text entry field)
-    char resetSwCfgString[STRNLEN_INT(1) + 1];
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
 
-    // String storage for Hawkbit token type index
-    char hawkbitTokenTypeIndex[STRNLEN_INT(255) + 1];
-    
     // Explicitly set mode, esp defaults to STA+AP
     WiFi.mode(WIFI_STA);
     WiFi.hostname(publisherModules[activeModule].moduleHostName);
@@ -312,204 +922,89 @@ void setupWifi(void) {
     // Setup debug output and call backs for the wifiManager
     wifiManager.setDebugOutput(false);
     wifiManager.setAPCallback(callbackFailedWifiConnect);
-    wifiManager.setSaveConfigCallback(callbackConfigUpdated);
+    wifiManager.setSaveParamsCallback(callbackConfigUpdated);
 
-    // Setup the config portal timeout (standard is 180s but have chosen 60s)
-    wifiManager.setConfigPortalTimeout(60);
+    // Run the configuration portal alongside the scheduler (AP+STA) instead of blocking set-up
+    wifiManager.setConfigPortalBlocking(false);
+    wifiManager.setConfigPortalTimeout(WIFI_PORTAL_TIMEOUT);
+    wifiManager.setConnectTimeout(WIFI_CONNECT_TIMEOUT);
 
     // Save parameters even if connection is unsuccessful
     wifiManager.setBreakAfterConfig(true);
 
-    // Nvm configs
-    WiFiManagerParameter textHeadingNvm(httpTextHeadingNvm);
-    WiFiManagerParameter textNvmVersion(httpTextNvmVersion);
-    sprintf(nvmVersionString, "%d", ramMirrorPtr->nvm.core.version);
-    WiFiManagerParameter fieldNvmVersion("nvmVersion", HTTP_TEXT_NVM_ERROR_CNT, nvmVersionString, STRNLEN_INT(NVM_MAX_VERSION));
-    WiFiManagerParameter textNvmErrorCnt(httpTextNvmErrorCnt);
-    sprintf(nvmErrorCounterString, "%d", ramMirrorPtr->nvm.core.errorCounter);
-    WiFiManagerParameter fieldNvmErrorCnt("errorCounter", HTTP_TEXT_NVM_ERROR_CNT, nvmErrorCounterString, STRNLEN_INT(NVM_MAX_ERROR));
-
-    wifiManager.addParameter(&textHeadingNvm);
-    wifiManager.addParameter(&textNvmVersion);
-    wifiManager.addParameter(&fieldNvmVersion);
-    wifiManager.addParameter(&textNvmErrorCnt);
-    wifiManager.addParameter(&fieldNvmErrorCnt);
-
-    // Network configs
-    WiFiManagerParameter textHeadingNetwork(httpTextHeadingNetwork);
-    WiFiManagerParameter textOtaPassword(httpTextOtaPassword);
-    WiFiManagerParameter fieldOtaPassword("otaPassword", HTTP_TEXT_NETWORK_OTA_PWD, ramMirrorPtr->network.otaPassword, NVM_MAX_LENGTH_PASSWORD);
-    WiFiManagerParameter textWifiApPassword(httpTextWifiApPassword);
-    WiFiManagerParameter fieldWifiApPassword("wifiAPPassword", HTTP_TEXT_NETWORK_AP_PWD, ramMirrorPtr->network.wifiAPPassword, NVM_MAX_LENGTH_PASSWORD);
-    
-    wifiManager.addParameter(&textHeadingNetwork);
-    wifiManager.addParameter(&textOtaPassword);
-    wifiManager.addParameter(&fieldOtaPassword);
-    wifiManager.addParameter(&textWifiApPassword);
-    wifiManager.addParameter(&fieldWifiApPassword);
+    // Configuration portal parameters (loaded from the RAM mirror when the portal starts)
+    for (unsigned int i = 0; i < (sizeof(wifiPortalParameters) / sizeof(wifiPortalParameters[0])); i++) {
+        wifiManager.addParameter(wifiPortalParameters[i]);
+    }
 
-    // MQTT configs
-    WiFiManagerParameter textHeadingMqtt(httpTextHeadingMqtt);
-    WiFiManagerParameter textMqttServer(httpTextMqttServer);
-    WiFiManagerParameter fieldMqttServer("mqttServer", HTTP_TEXT_MQTT_SERVER, ramMirrorPtr->mqtt.mqttServer, NVM_MAX_LENGTH_URL);
-    WiFiManagerParameter textMqttUser(httpTextMqttUser);
-    WiFiManagerParameter fieldMqttUser("mqttUser", HTTP_TEXT_MQTT_USER, ramMirrorPtr->mqtt.mqttUser, NVM_MAX_LENGTH_USER);
-    WiFiManagerParameter textMqttPassword(httpTextMqttPassword);
-    WiFiManagerParameter fieldMqttPassword("mqttPassword", HTTP_TEXT_MQTT_PWD, ramMirrorPtr->mqtt.mqttPassword, NVM_MAX_LENGTH_PASSWORD);
-    WiFiManagerParameter textMqttTopicRoot(httpTextMqttTopicRoot);
-    WiFiManagerParameter fieldMqttTopicRoot("mqttTopicRoot", HTTP_TEXT_MQTT_TOPIC, ramMirrorPtr->mqtt.mqttTopicRoot, NVM_MAX_LENGTH_TOPIC);
-
-    wifiManager.addParameter(&textHeadingMqtt);
-    wifiManager.addParameter(&textMqttServer);
-    wifiManager.addParameter(&fieldMqttServer);
-    wifiManager.addParameter(&textMqttUser);
-    wifiManager.addParameter(&fieldMqttUser);
-    wifiManager.addParameter(&textMqttPassword);
-    wifiManager.addParameter(&fieldMqttPassword);
-    wifiManager.addParameter(&textMqttTopicRoot);
-    wifiManager.addParameter(&fieldMqttTopicRoot);
+    // Station details are only refreshed after these events (events run in the system context, only flag them here)
+    wifiGotIpHandler = WiFi.onStationModeGotIP([](const WiFiEventStationModeGotIP& event) {
+        (void) event;
+        gotIpEvents++;
+        reconnects = (gotIpEvents > 1) ? (gotIpEvents - 1) : 0;
+        stationDetailsStale = true;
+    });
 
-    // IO configs
-    WiFiManagerParameter textHeadingIO(httpTextHeadingIO);
-    WiFiManagerParameter textTextRunLedBright(httpTextRunLedBright);
-    sprintf(ledRunDimmingString, "%d", ramMirrorPtr->io.ledBrightnessRunMode);
-    WiFiManagerParameter fieldRunLedBright("ledBrightnessRunMode", HTTP_TEXT_IO_RUN_LED, ledRunDimmingString, STRNLEN_INT(PWMRANGE));
-    WiFiManagerParameter textCfgLedBright(httpTextCfgLedBright);
-    sprintf(ledCfgDimmingString, "%d", ramMirrorPtr->io.ledBrightnessConfigMode);
-    WiFiManagerParameter fieldCfgLedBright("ledBrightnessConfigMode", HTTP_TEXT_IO_CFG_LED, ledCfgDimmingString, STRNLEN_INT(PWMRANGE));
-    WiFiManagerParameter textCfgResetSw(httpTextCfgResetSw);
-    sprintf(resetSwCfgString, "%d", ramMirrorPtr->io.resetSwitchEnabled);
-    WiFiManagerParameter fieldCfgResetSw("resetSwitchEnabled", HTTP_TEXT_IO_RESET_SW, resetSwCfgString, STRNLEN_INT(1));
-
-    wifiManager.addParameter(&textHeadingIO);
-    wifiManager.addParameter(&textTextRunLedBright);
-    wifiManager.addParameter(&fieldRunLedBright);
-    wifiManager.addParameter(&textCfgLedBright);
-    wifiManager.addParameter(&fieldCfgLedBright);
-    wifiManager.addParameter(&textCfgResetSw);
-    wifiManager.addParameter(&fieldCfgResetSw);
+    wifiDisconnectedHandler = WiFi.onStationModeDisconnected([](const WiFiEventStationModeDisconnected& event) {
+        (void) event;
+        stationDetailsStale = true;
+    });
 
-    // Alarm configs
-    WiFiManagerParameter textHeadingAlarm(httpTextHeadingAlarm);
-    WiFiManagerParameter textHomeAddress(httpTextHomeAddress);
-    WiFiManagerParameter fieldHomeAddress("homeAddress", HTTP_TEXT_ALARM_ADDRESS, ramMirrorPtr->alarm.homeAddress, NVM_MAX_LENGTH_ADDRESS);
-
-    wifiManager.addParameter(&textHeadingAlarm);
-    wifiManager.addParameter(&textHomeAddress);
-    wifiManager.addParameter(&fieldHomeAddress);
-    
-    // Hawkbit configs
-    WiFiManagerParameter textHeadingHawkbit(httpTextHeadingHawkbit);
-    WiFiManagerParameter textHawkbitServer(httpTextHawkbitServer);
-    WiFiManagerParameter fieldHawkbitServer("hawkbitServer", HTTP_TEXT_HAWKBIT_SERVER, ramMirrorPtr->hawkbit.hawkbitServer, sizeof(ramMirrorPtr->hawkbit.hawkbitServer));
-    WiFiManagerParameter textHawkbitToken(httpTextHawkbitToken);
-    WiFiManagerParameter fieldHawkbitToken("hawkbitToken", HTTP_TEXT_HAWKBIT_TOKEN, ramMirrorPtr->hawkbit.hawkbitToken, sizeof(ramMirrorPtr->hawkbit.hawkbitToken));
-    WiFiManagerParameter textHawkbitTokenTyp(httpTextHawkbitTokenTyp);
-    sprintf(hawkbitTokenTypeIndex, "%d", ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex);
-    WiFiManagerParameter fieldHawkbitTokenTyp("hawkbitTokenType", HTTP_TEXT_HAWKBIT_TOKEN_TYPE, hawkbitTokenTypeIndex, STRNLEN_INT(255));
-    WiFiManagerParameter textHawkbitTennant(httpTextHawkbitTennant);
-    WiFiManagerParameter fieldHawkbitTennant("hawkbitTennant", HTTP_TEXT_HAWKBIT_TENNANT, ramMirrorPtr->hawkbit.hawkbitTennant, sizeof(ramMirrorPtr->hawkbit.hawkbitTennant));
-
-    wifiManager.addParameter(&textHeadingHawkbit);
-    wifiManager.addParameter(&textHawkbitServer);
-    wifiManager.addParameter(&fieldHawkbitServer);
-    wifiManager.addParameter(&textHawkbitToken);
-    wifiManager.addParameter(&fieldHawkbitToken);
-    wifiManager.addParameter(&textHawkbitTokenTyp);
-    wifiManager.addParameter(&fieldHawkbitTokenTyp);
-    wifiManager.addParameter(&textHawkbitTennant);
-    wifiManager.addParameter(&fieldHawkbitTennant);
-    
     // Debug message
-    debugMessage = (String() + "Connecting to WiFi network...");
-    debugLog(&debugMessage, info);
+    debugLog("Connecting to WiFi network...", info);
+
+    // Try the cached connection first (WiFiManager does nothing when already connected)
+    connectTime = millis();
+    connectPath = wifiCacheConnect() ? WIFI_CONNECT_CACHED : WIFI_CONNECT_FULL;
 
-    // Try auto connect
+    // Try auto connect (returns straight away with the portal running when it fails)
     bool connectionStatus = wifiManager.autoConnect(publisherModules[activeModule].moduleHostName, ramMirrorPtr->network.wifiAPPassword);
 
-    // Turn off the config mode LED
-    outputsSetOutputByName(configMode, {direct, 0, 0, 0, 0});
-
-    // If there is data to update
-    if(configSave == true) {
-
-        // NVM configs
-        ramMirrorPtr->nvm.core.version = (uint16_t) atoi(fieldNvmVersion.getValue());
-        ramMirrorPtr->nvm.core.errorCounter = (uint16_t) atoi(fieldNvmErrorCnt.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmNvmStruc);
-
-        // Network configs
-        strcpy(ramMirrorPtr->network.otaPassword, fieldOtaPassword.getValue());
-        strcpy(ramMirrorPtr->network.wifiAPPassword, fieldWifiApPassword.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmNetworkStruc);
-
-        // MQTT configs
-        strcpy(ramMirrorPtr->mqtt.mqttServer, fieldMqttServer.getValue());
-        strcpy(ramMirrorPtr->mqtt.mqttUser, fieldMqttUser.getValue());
-        strcpy(ramMirrorPtr->mqtt.mqttPassword, fieldMqttPassword.getValue());
-        strcpy(ramMirrorPtr->mqtt.mqttTopicRoot, fieldMqttTopicRoot.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
-
-        // IO configs
-        ramMirrorPtr->io.ledBrightnessConfigMode = (uint16_t) atoi(fieldCfgLedBright.getValue());
-        ramMirrorPtr->io.ledBrightnessRunMode = (uint16_t) atoi(fieldRunLedBright.getValue());
-        ramMirrorPtr->io.resetSwitchEnabled = (uint8_t) atoi(fieldCfgResetSw.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmIOStruc);
-
-        // Alarm configs
-        strcpy(ramMirrorPtr->alarm.homeAddress, fieldHomeAddress.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
-        
-        // Hawkbit configs
-        strcpy(ramMirrorPtr->hawkbit.hawkbitServer, fieldHawkbitServer.getValue());
-        strcpy(ramMirrorPtr->hawkbit.hawkbitToken, fieldHawkbitToken.getValue());
-        ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex = (uint8_t) atoi(fieldHawkbitTokenTyp.getValue());
-        strcpy(ramMirrorPtr->hawkbit.hawkbitTennant, fieldHawkbitTennant.getValue());
-        nvmUpdateRamMirrorCrcByName(nvmHawkbitStruc);
-        
-        nvmComittRamMirror();
-        
-        // Debug message
-        debugMessage = (String() + "Configuraiton data saved.  Rebooting in 5s...");
-        debugLog(&debugMessage, info);
+    // If the auto connect failed, carry on (the WiFi supervisor and the configuration portal recover the connection)
+    if(connectionStatus == false) {
+        debugLog("WiFi connection set-up failed! Configuration portal running in the background...", error);
+    }
 
-        // Reboot so modules initialise from NVM (!!! could avoid reboot by doing a re-init here !!!)
-        delay(5000);
-        restCtrlImmediateHandle(rstTypeReset);
+    else {
+        connectTime = millis() - connectTime;
+        wifiCacheSave();
+        wifiBufferStationDetails();
+        debugMessage.format("Connected to %s with IP address %s (%s connect in %lums)", ssidString, ipString, connectPath, connectTime);
+        debugLog(debugMessage.c_str(), info);
     }
+}
 
-    // If the auto connect failed, reset
-    if(connectionStatus == false) {
-        debugMessage = (String() + "WiFi connection set-up failed! Rebooting in 5s...");
-        debugLog(&debugMessage, error);
+/**
+    WiFi configuration portal loop.
+    Services the background configuration portal, call from the main loop (needs to be called often).
+*/
+void wifiPortalLoop(void) {
 
-        // Reboot
-        delay(5000);
-        restCtrlImmediateHandle(rstTypeReset);
+    if (wifiManager.getConfigPortalActive() == true) {
+        wifiManager.process();
+        wifiPortalActive = true;
     }
 
-    // Reaching this point means WiFi is sucessfully connected
-    debugMessage = (String() + "Connected to " + WiFi.SSID() + " with IP address " + WiFi.localIP().toString());
-    debugLog(&debugMessage, info);
+    // Portal closed (timeout or new credentials)
+    else if (wifiPortalActive == true) {
+        wifiPortalActive = false;
+
+        // Turn off the config mode LED
+        outputsSetOutputByName(configMode, {direct, 0, 0, 0, 0});
 
+        debugLog("Leaving WiFi configuration mode.", info);
+    }
 }
 
 /**
-    WiFi check and prints status to the console.
+    Re-associate with the stored network.
+    Drops any BSSID lock and static IP from the WiFi cache so the SDK scans for the access point and DHCP runs.
 */
-void checkWifi(void) {
-    String debugMessage;
-
-    debugMessage = (String() + "WiFi status: " + wifiStatusToString(WiFi.status()) + ", RSSI: " + WiFi.RSSI());
-    debugLog(&debugMessage, info);
+void wifiReassociate(void) {
+    debugLog("WiFi re-associating...", warning);
 
-    if (WiFi.status() != WL_CONNECTED) {
-        debugMessage = (String() + "WiFi connection failed! Rebooting in 5s...");
-        debugLog(&debugMessage, error);
-
-        delay(5000);
-        ESP.restart();
-    }
+    wifiRestoreStationConfig();
+    WiFi.begin();
 }
 
 /**
@@ -535,6 +1030,34 @@ bool wifiIsConnected(void) {
     return(returnValue);
 }
 
+/**
+    Returns true when the configuration portal is active (the radio is serving the portal).
+*/
+bool wifiIsPortalActive(void) {
+    return(wifiManager.getConfigPortalActive());
+}
+
+
+/**
+    WiFi cyclic task.
+    Refreshes the station details and the WiFi cache after a station event and samples the RSSI.
+*/
+void wifiCyclicTask(void) {
+
+    if (stationDetailsStale == true) {
+        stationDetailsStale = false;
+        wifiBufferStationDetails();
+
+        // Keep the cache on the current lease (DHCP can move the address after a cached connect)
+        if (WiFi.status() == WL_CONNECTED) {
+            wifiCacheSave();
+        }
+    }
+
+    if (WiFi.status() == WL_CONNECTED) {
+        wifiSampleRssi();
+    }
+}
 
 /**
     Transmit a wifi message.
@@ -542,13 +1065,8 @@ bool wifiIsConnected(void) {
 */
 void wifiTransmitWifiMessage(void) {   
 
-    // Update the IP, gateway, subnet mask, MAC, and RSSI variables before transmitting
-    strcpy(ssidString, WiFi.SSID().c_str());
-    strcpy(ipString, WiFi.localIP().toString().c_str());
-    strcpy(gatewayString, WiFi.gatewayIP().toString().c_str());
-    strcpy(subnetMaskString, WiFi.subnetMask().toString().c_str());
-    strcpy(macString, WiFi.macAddress().c_str());
-    rssi = WiFi.RSSI();
+    // Everything else is cached, only the statistics window needs reducing
+    wifiUpdateRssiStatistics();
 
     messsagesTxWifiMessage(&wifiDataSoftware);
 }
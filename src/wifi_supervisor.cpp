@@ -0,0 +1,358 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#include "wifi_supervisor.h"
+
+#include "utils.h"
+#include "debug.h"
+#include "wifi.h"
+#include "reset_ctrl.h"
+#include "messages_tx.h"
+
+
+// Set the module call interval
+#define MODULE_CALL_INTERVAL                    WIFI_SUPERVISOR_CYCLIC_RATE
+
+// Outage budget, reboot when the WiFi has been down this long in S (change with a build flag, -D WIFI_SUPERVISOR_OUTAGE_BUDGET_S=1800)
+#ifndef WIFI_SUPERVISOR_OUTAGE_BUDGET_S
+#define WIFI_SUPERVISOR_OUTAGE_BUDGET_S         (600)
+#endif
+
+static_assert((WIFI_SUPERVISOR_OUTAGE_BUDGET_S > 0) && (WIFI_SUPERVISOR_OUTAGE_BUDGET_S <= 86400), "WIFI_SUPERVISOR_OUTAGE_BUDGET_S must be 1 to 86400 S");
+
+// First reconnect delay (doubles on every attempt)
+#define WIFI_SUPERVISOR_BACKOFF_MIN_S           (1)
+
+// Longest delay between reconnect / re-association attempts
+#define WIFI_SUPERVISOR_BACKOFF_MAX_S           (32)
+
+// Reconnect attempts before escalating to re-association
+#define WIFI_SUPERVISOR_RECONNECT_ATTEMPTS      (4)
+
+// Name for the supervisor state
+#define WIFI_SUPERVISOR_NAME_STATE              ("state")
+
+// Name for the number of outages
+#define WIFI_SUPERVISOR_NAME_OUTAGES            ("outages")
+
+// Name for the current outage duration
+#define WIFI_SUPERVISOR_NAME_OUTAGE             ("outage")
+
+// Name for the last outage duration
+#define WIFI_SUPERVISOR_NAME_LAST_OUTAGE        ("lastOutage")
+
+// Name for the longest outage duration
+#define WIFI_SUPERVISOR_NAME_LONGEST_OUTAGE     ("longestOutage")
+
+// Name for the total outage duration
+#define WIFI_SUPERVISOR_NAME_TOTAL_OUTAGE       ("totalOutage")
+
+// Name for the number of reconnect attempts
+#define WIFI_SUPERVISOR_NAME_RECONNECTS         ("reconnects")
+
+// Name for the number of re-association attempts
+#define WIFI_SUPERVISOR_NAME_REASSOCIATIONS     ("reassociations")
+
+
+// Module name for debug messages
+static const char* wifiSupervisorModuleName = "wifiSupervisor";
+
+// WiFi supervisor state machine state names (must align with the enum)
+static const char * wifiSupervisorStateNames[] = {
+    "stmWifiSupervisorConnected",
+    "stmWifiSupervisorReconnect",
+    "stmWifiSupervisorReassociate",
+    "stmWifiSupervisorReboot"
+};
+
+// Current state
+static wifiSupervisorStm wifiSupervisorCurrentState = stmWifiSupervisorConnected;
+
+// Current state name (for the outage message)
+static const char * wifiSupervisorStateName = wifiSupervisorStateNames[stmWifiSupervisorConnected];
+
+// Station disconnected event handler
+static WiFiEventHandler wifiSupervisorDisconnectedHandler;
+
+// Station disconnected since the last call (set from the event)
+static volatile bool wifiSupervisorDisconnectedEvent = false;
+
+// Time the current outage started (ms)
+static uint32_t wifiSupervisorOutageStart = 0;
+
+// Number of outages
+static uint32_t wifiSupervisorOutages = 0;
+
+// Current outage duration (ms)
+static uint32_t wifiSupervisorOutage = 0;
+
+// Last outage duration (ms)
+static uint32_t wifiSupervisorLastOutage = 0;
+
+// Longest outage duration (ms)
+static uint32_t wifiSupervisorLongestOutage = 0;
+
+// Total outage duration (ms)
+static uint32_t wifiSupervisorTotalOutage = 0;
+
+// Paused while the configuration portal is active
+static bool wifiSupervisorPaused = false;
+
+// Time the pause started (ms)
+static uint32_t wifiSupervisorPauseStart = 0;
+
+// Number of reconnect attempts
+static uint32_t wifiSupervisorReconnects = 0;
+
+// Number of re-association attempts
+static uint32_t wifiSupervisorReassociations = 0;
+
+// Wifi supervisor data
+static const wifiSupervisorData wifiSupervisorDataTable = {WIFI_SUPERVISOR_NAME_STATE,            &wifiSupervisorStateName,
+                                                           WIFI_SUPERVISOR_NAME_OUTAGES,          &wifiSupervisorOutages,
+                                                           WIFI_SUPERVISOR_NAME_OUTAGE,           &wifiSupervisorOutage,
+                                                           WIFI_SUPERVISOR_NAME_LAST_OUTAGE,      &wifiSupervisorLastOutage,
+                                                           WIFI_SUPERVISOR_NAME_LONGEST_OUTAGE,   &wifiSupervisorLongestOutage,
+                                                           WIFI_SUPERVISOR_NAME_TOTAL_OUTAGE,     &wifiSupervisorTotalOutage,
+                                                           WIFI_SUPERVISOR_NAME_RECONNECTS,       &wifiSupervisorReconnects,
+                                                           WIFI_SUPERVISOR_NAME_REASSOCIATIONS,   &wifiSupervisorReassociations
+};
+
+// Local function definitions
+static void wifiSupervisorStartOutage(void);
+static void wifiSupervisorEndOutage(void);
+
+
+/**
+    Start an outage (when one is not already running).
+*/
+static void wifiSupervisorStartOutage(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    wifiSupervisorOutageStart = millis();
+    wifiSupervisorOutage = 0;
+    wifiSupervisorOutages++;
+
+    debugMessage.format("WiFi lost (status %s), outage %lu", wifiStatusToString(WiFi.status()), (unsigned long)wifiSupervisorOutages);
+    debugLog(debugMessage.c_str(), wifiSupervisorModuleName, warning);
+}
+
+/**
+    End the current outage and update the outage statistics.
+*/
+static void wifiSupervisorEndOutage(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    wifiSupervisorLastOutage = millis() - wifiSupervisorOutageStart;
+    wifiSupervisorTotalOutage += wifiSupervisorLastOutage;
+    wifiSupervisorOutage = 0;
+
+    if (wifiSupervisorLastOutage > wifiSupervisorLongestOutage) {
+        wifiSupervisorLongestOutage = wifiSupervisorLastOutage;
+    }
+
+    debugMessage.format("WiFi restored after %lums", (unsigned long)wifiSupervisorLastOutage);
+    debugLog(debugMessage.c_str(), wifiSupervisorModuleName, info);
+}
+
+/**
+    WiFi supervisor init.
+    Registers for the station events, call after setupWifi.
+*/
+void wifiSupervisorInit(void) {
+
+    // Event runs in the system context, only flag it here and handle it in the state machine
+    wifiSupervisorDisconnectedHandler = WiFi.onStationModeDisconnected([](const WiFiEventStationModeDisconnected& event) {
+        (void) event;
+        wifiSupervisorDisconnectedEvent = true;
+    });
+
+    wifiSupervisorDisconnectedEvent = false;
+    wifiSupervisorPaused = false;
+    wifiSupervisorCurrentState = stmWifiSupervisorConnected;
+}
+
+/**
+    WiFi supervisor state machine.
+    Recovers the WiFi connection without blocking (reconnect, re-associate, then reboot once the outage budget is spent).
+    Paused while the configuration portal is active, the portal time does not count against the outage budget.
+*/
+void wifiSupervisorStateMachine(void) {
+
+    // Debug message
+    debugString debugMessage;
+
+    // Calls until the next recovery attempt
+    static uint32_t attemptTimer = 0;
+
+    // Current backoff (calls)
+    static uint32_t backoff = 0;
+
+    // Reconnect attempts in this outage
+    static uint32_t reconnectAttempts = 0;
+
+    // Current WiFi status
+    const bool wifiConnected = wifiIsConnected();
+
+    // Next state
+    wifiSupervisorStm nextState = wifiSupervisorCurrentState;
+
+    // The portal drives the radio (reconnects would drop the user off the access point), stop the outage clock
+    if (wifiIsPortalActive() == true) {
+
+        if (wifiSupervisorPaused == false) {
+            wifiSupervisorPaused = true;
+            wifiSupervisorPauseStart = millis();
+
+            debugLog("Paused while the configuration portal is active", wifiSupervisorModuleName, info);
+        }
+
+        // Disconnects caused by the portal are not outages
+        wifiSupervisorDisconnectedEvent = false;
+        return;
+    }
+
+    // Portal closed, an outage continues without the portal time
+    if (wifiSupervisorPaused == true) {
+        wifiSupervisorPaused = false;
+        wifiSupervisorOutageStart += millis() - wifiSupervisorPauseStart;
+
+        debugMessage.format("Resumed after %lums of configuration portal", (unsigned long)(millis() - wifiSupervisorPauseStart));
+        debugLog(debugMessage.c_str(), wifiSupervisorModuleName, info);
+    }
+
+    // Update the current outage duration
+    if (wifiSupervisorCurrentState != stmWifiSupervisorConnected) {
+        wifiSupervisorOutage = millis() - wifiSupervisorOutageStart;
+    }
+
+    // Handle the state machine
+    switch(wifiSupervisorCurrentState) {
+
+        case(stmWifiSupervisorConnected):
+
+            // Disconnect event or status lost (a short drop that already recovered still counts)
+            if ((wifiSupervisorDisconnectedEvent == true) || (wifiConnected == false)) {
+                wifiSupervisorStartOutage();
+
+                backoff = SECS_TO_CALLS(WIFI_SUPERVISOR_BACKOFF_MIN_S);
+                attemptTimer = backoff;
+                reconnectAttempts = 0;
+                nextState = stmWifiSupervisorReconnect;
+            }
+
+            break;
+
+        case(stmWifiSupervisorReconnect):
+
+            // Connection restored
+            if (wifiConnected == true) {
+                wifiSupervisorEndOutage();
+                nextState = stmWifiSupervisorConnected;
+            }
+
+            // Outage budget spent
+            else if (wifiSupervisorOutage >= (WIFI_SUPERVISOR_OUTAGE_BUDGET_S * 1000UL)) {
+                nextState = stmWifiSupervisorReboot;
+            }
+
+            // Timer running
+            else if (attemptTimer > 0) {
+                attemptTimer--;
+            }
+
+            // Reconnect attempts exhausted, escalate
+            else if (reconnectAttempts >= WIFI_SUPERVISOR_RECONNECT_ATTEMPTS) {
+                nextState = stmWifiSupervisorReassociate;
+            }
+
+            // Timer elapsed, reconnect to the same access point
+            else {
+                WiFi.reconnect();
+                wifiSupervisorReconnects++;
+                reconnectAttempts++;
+
+                backoff = min(backoff * 2, (uint32_t)SECS_TO_CALLS(WIFI_SUPERVISOR_BACKOFF_MAX_S));
+                attemptTimer = backoff;
+            }
+
+            break;
+
+        case(stmWifiSupervisorReassociate):
+
+            // Connection restored
+            if (wifiConnected == true) {
+                wifiSupervisorEndOutage();
+                nextState = stmWifiSupervisorConnected;
+            }
+
+            // Outage budget spent
+            else if (wifiSupervisorOutage >= (WIFI_SUPERVISOR_OUTAGE_BUDGET_S * 1000UL)) {
+                nextState = stmWifiSupervisorReboot;
+            }
+
+            // Timer running
+            else if (attemptTimer > 0) {
+                attemptTimer--;
+            }
+
+            // Timer elapsed, re-associate (scan for any access point and renew DHCP)
+            else {
+                wifiReassociate();
+                wifiSupervisorReassociations++;
+
+                attemptTimer = SECS_TO_CALLS(WIFI_SUPERVISOR_BACKOFF_MAX_S);
+            }
+
+            break;
+
+        case(stmWifiSupervisorReboot):
+
+            // Ask the reset controller for the reboot (retry until it accepts the request)
+            if ((restCtrlGetResetState() == stmResetIdle) && (restCtrlGetResetRequest() == rstTypeNone)) {
+                debugMessage.format("WiFi outage budget of %lus spent, requesting reboot", (unsigned long)WIFI_SUPERVISOR_OUTAGE_BUDGET_S);
+                debugLog(debugMessage.c_str(), wifiSupervisorModuleName, error);
+
+                restCtrlSetResetRequest(rstTypeReset);
+            }
+
+            break;
+
+        default:
+            nextState = stmWifiSupervisorConnected;
+            break;
+    }
+
+    // Event handled
+    wifiSupervisorDisconnectedEvent = false;
+
+    // State change
+    if (wifiSupervisorCurrentState != nextState) {
+        debugMessage.format("State change to %s", wifiSupervisorStateNames[nextState]);
+        debugLog(debugMessage.c_str(), wifiSupervisorModuleName, info);
+    }
+
+    wifiSupervisorCurrentState = nextState;
+    wifiSupervisorStateName = wifiSupervisorStateNames[wifiSupervisorCurrentState];
+}
+
+/**
+    Get the current state of the state machine.
+
+    @return        state machine state.
+*/
+wifiSupervisorStm wifiSupervisorGetState(void) {
+    return(wifiSupervisorCurrentState);
+}
+
+/**
+    Transmit a wifi outage message.
+    No processing of the message here.
+*/
+void wifiSupervisorTransmitOutageMessage(void) {
+    messsagesTxWifiOutageMessage(&wifiSupervisorDataTable);
+}
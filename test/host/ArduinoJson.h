@@ -0,0 +1,1244 @@
+#ifndef ARDUINOJSON_H
+#define ARDUINOJSON_H
+
+// Host (Linux) replacement for the ArduinoJson library (version 6 API)
+// Objects, arrays, numbers, booleans and strings in a fixed pool per document (no heap like the static documents of the library)
+// Only what the firmware modules use: member and element access, deserialization of a string or a stream (with a filter), serialization into a buffer
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <type_traits>
+
+// Maximum number of values of a document (including the root)
+#define HOST_JSON_NODES                 (64)
+
+// Size of the string pool of a document (keys and copied strings)
+#define HOST_JSON_STRINGS_SIZE          (1024)
+
+// Maximum nesting of a deserialized document
+#define HOST_JSON_NESTING_MAX           (10)
+
+// Size of a key or number while it is parsed
+#define HOST_JSON_TOKEN_SIZE            (64)
+
+
+class JsonDocument;
+class JsonVariant;
+class JsonObject;
+class JsonArray;
+class hostJsonPath;
+
+// Type of a value
+enum hostJsonType {
+    hostJsonNull,
+    hostJsonObject,
+    hostJsonArray,
+    hostJsonInteger,
+    hostJsonReal,
+    hostJsonBool,
+    hostJsonString
+};
+
+// Value in the pool of a document (members and elements are a list of children)
+typedef struct {
+    const char *            key;                // Key (members only)
+    const char *            string;             // String (kept by pointer for a const char *, copied into the pool otherwise)
+    long long               integer;            // Integer or boolean
+    double                  real;               // Real number
+    hostJsonType            type;               // Type of the value
+    int                     child;              // First member / element (-1 when there is none)
+    int                     next;               // Next member / element of the parent (-1 when there is none)
+} hostJsonNode;
+
+
+// Error of a deserialization
+class DeserializationError {
+public:
+    enum Code {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError(void) : errorCode(Ok) {}
+    DeserializationError(const Code code) : errorCode(code) {}
+
+    explicit operator bool(void) const {
+        return(errorCode != Ok);
+    }
+
+    Code code(void) const {
+        return(errorCode);
+    }
+
+    const char * c_str(void) const {
+        static const char * const names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+        return(names[errorCode]);
+    }
+
+private:
+    Code errorCode;
+};
+
+namespace DeserializationOption {
+
+// Deserialization filter (true keeps a value, the first element of an array applies to every element)
+class Filter {
+public:
+    explicit Filter(const JsonDocument & filter) : filterDoc(&filter) {}
+
+    const JsonDocument * filterDoc;
+};
+
+}
+
+// Key of an object member
+class JsonString {
+public:
+    JsonString(const char * const string) : stringPtr(string) {}
+
+    const char * c_str(void) const {
+        return(stringPtr);
+    }
+
+private:
+    const char * stringPtr;
+};
+
+
+// Document (pool of values, the root is the first value)
+class JsonDocument {
+public:
+    JsonDocument(void) {
+        clear();
+    }
+
+    void clear(void) {
+        documentNodeCount = 1;
+        documentStringsUsed = 0;
+        documentNodes[0] = hostJsonNode{NULL, NULL, 0, 0.0, hostJsonNull, -1, -1};
+    }
+
+    // Pool access for the variants, paths and the parser
+    hostJsonNode * hostNodeAt(const int node) {
+        return(((node >= 0) && ((unsigned int)node < documentNodeCount)) ? &documentNodes[node] : NULL);
+    }
+
+    const hostJsonNode * hostNodeAt(const int node) const {
+        return(((node >= 0) && ((unsigned int)node < documentNodeCount)) ? &documentNodes[node] : NULL);
+    }
+
+    // Add a value to the end of the members / elements of a parent (-1 when the pool is full)
+    int hostNodeAppend(const int parent, const char * const key) {
+
+        // Index of the new value and of the last child
+        int node;
+        int last;
+
+        if ((documentNodeCount >= HOST_JSON_NODES) || (hostNodeAt(parent) == NULL)) {
+            return(-1);
+        }
+
+        node = (int)documentNodeCount++;
+        documentNodes[node] = hostJsonNode{key, NULL, 0, 0.0, hostJsonNull, -1, -1};
+
+        if (documentNodes[parent].child < 0) {
+            documentNodes[parent].child = node;
+        }
+        else {
+            for (last = documentNodes[parent].child; documentNodes[last].next >= 0; last = documentNodes[last].next) {
+            }
+            documentNodes[last].next = node;
+        }
+
+        return(node);
+    }
+
+    // Find a member / element of a parent and add it when requested (-1 when it is not there)
+    int hostNodeChild(const int parent, const char * const key, const int index, const bool create) {
+
+        // Parent value
+        hostJsonNode * const parentPtr = hostNodeAt(parent);
+
+        // Child being checked and its position
+        int node = -1;
+        int position = 0;
+
+        if (parentPtr == NULL) {
+            return(-1);
+        }
+
+        if (key != NULL) {
+            if (parentPtr->type == hostJsonObject) {
+                for (node = parentPtr->child; node >= 0; node = documentNodes[node].next) {
+                    if (strcmp(documentNodes[node].key, key) == 0) {
+                        return(node);
+                    }
+                }
+            }
+
+            if ((create == false) || ((parentPtr->type != hostJsonNull) && (parentPtr->type != hostJsonObject))) {
+                return(-1);
+            }
+
+            if (parentPtr->type == hostJsonNull) {
+                parentPtr->type = hostJsonObject;
+                parentPtr->child = -1;
+            }
+
+            return(hostNodeAppend(parent, hostStringCopy(key)));
+        }
+
+        if (index < 0) {
+            return(-1);
+        }
+
+        if (parentPtr->type == hostJsonArray) {
+            for (node = parentPtr->child; node >= 0; node = documentNodes[node].next) {
+                if (position++ == index) {
+                    return(node);
+                }
+            }
+        }
+
+        if ((create == false) || ((parentPtr->type != hostJsonNull) && (parentPtr->type != hostJsonArray))) {
+            return(-1);
+        }
+
+        if (parentPtr->type == hostJsonNull) {
+            parentPtr->type = hostJsonArray;
+            parentPtr->child = -1;
+            position = 0;
+        }
+
+        // Elements up to the index are added (null)
+        for (; position <= index; position++) {
+            if ((node = hostNodeAppend(parent, NULL)) < 0) {
+                return(-1);
+            }
+        }
+
+        return(node);
+    }
+
+    // Copy a string into the pool (NULL when it is full)
+    const char * hostStringCopy(const char * const string) {
+
+        // Size of the string including the end of string
+        const size_t size = strlen(string) + 1;
+
+        // Copy in the pool
+        char * copy;
+
+        if (size > (HOST_JSON_STRINGS_SIZE - documentStringsUsed)) {
+            return(NULL);
+        }
+
+        copy = &documentStrings[documentStringsUsed];
+        memcpy(copy, string, size);
+        documentStringsUsed += size;
+
+        return(copy);
+    }
+
+    // Start a string in the pool, characters are added with hostStringAdd (false when the pool is full)
+    bool hostStringAdd(const char character) {
+
+        if (documentStringsUsed >= HOST_JSON_STRINGS_SIZE) {
+            return(false);
+        }
+
+        documentStrings[documentStringsUsed++] = character;
+
+        return(true);
+    }
+
+    const char * hostStringEnd(void) const {
+        return(&documentStrings[documentStringsUsed]);
+    }
+
+    // Value access of the root (like a variant)
+    template <typename T> T as(void) const;
+    template <typename T> bool is(void) const;
+    bool containsKey(const char * const key) const;
+    bool isNull(void) const;
+    template <typename T> bool set(const T value);
+    hostJsonPath operator[](const char * const key);
+    hostJsonPath operator[](const int index);
+    JsonVariant operator[](const char * const key) const;
+
+private:
+    hostJsonNode documentNodes[HOST_JSON_NODES];
+    unsigned int documentNodeCount;
+    char documentStrings[HOST_JSON_STRINGS_SIZE];
+    size_t documentStringsUsed;
+};
+
+// Document with its capacity (the host ignores the capacity, HOST_JSON_NODES and HOST_JSON_STRINGS_SIZE are the limits)
+template <size_t capacity> class StaticJsonDocument : public JsonDocument {
+};
+
+
+/**
+    Get a value as a string.
+
+    @param[in]     nodePtr pointer to the value (NULL when there is none).
+    @return        pointer to the string (NULL when the value is not a string).
+*/
+inline const char * hostJsonGet(const JsonDocument * const doc, const int node, const char ** const) {
+    const hostJsonNode * const nodePtr = (doc != NULL) ? doc->hostNodeAt(node) : NULL;
+    return(((nodePtr != NULL) && (nodePtr->type == hostJsonString)) ? nodePtr->string : NULL);
+}
+
+/**
+    Get a value as a number, boolean or enum.
+
+    @param[in]     doc pointer to the document.
+    @param[in]     node index of the value.
+    @return        the value (0 when it is not a number or boolean).
+*/
+template <typename T> inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, T>::type hostJsonGet(const JsonDocument * const doc, const int node, T * const) {
+
+    // Value
+    const hostJsonNode * const nodePtr = (doc != NULL) ? doc->hostNodeAt(node) : NULL;
+
+    if (nodePtr == NULL) {
+        return((T)0);
+    }
+
+    switch (nodePtr->type) {
+        case hostJsonInteger:
+        case hostJsonBool:
+            return((T)nodePtr->integer);
+
+        case hostJsonReal:
+            return((T)nodePtr->real);
+
+        default:
+            return((T)0);
+    }
+}
+
+inline JsonVariant hostJsonGet(const JsonDocument * const doc, const int node, JsonVariant * const);
+inline JsonObject hostJsonGet(const JsonDocument * const doc, const int node, JsonObject * const);
+inline JsonArray hostJsonGet(const JsonDocument * const doc, const int node, JsonArray * const);
+
+/**
+    Check the type of a value.
+
+    @param[in]     nodePtr pointer to the value (NULL when there is none).
+    @return        true when the value has the type.
+*/
+inline bool hostJsonIs(const hostJsonNode * const nodePtr, const char ** const) {
+    return((nodePtr != NULL) && (nodePtr->type == hostJsonString));
+}
+
+inline bool hostJsonIs(const hostJsonNode * const nodePtr, bool * const) {
+    return((nodePtr != NULL) && (nodePtr->type == hostJsonBool));
+}
+
+inline bool hostJsonIs(const hostJsonNode * const nodePtr, JsonObject * const) {
+    return((nodePtr != NULL) && (nodePtr->type == hostJsonObject));
+}
+
+inline bool hostJsonIs(const hostJsonNode * const nodePtr, JsonArray * const) {
+    return((nodePtr != NULL) && (nodePtr->type == hostJsonArray));
+}
+
+template <typename T> inline typename std::enable_if<std::is_integral<T>::value, bool>::type hostJsonIs(const hostJsonNode * const nodePtr, T * const) {
+    return((nodePtr != NULL) && (nodePtr->type == hostJsonInteger) && ((std::is_signed<T>::value == true) || (nodePtr->integer >= 0)));
+}
+
+template <typename T> inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type hostJsonIs(const hostJsonNode * const nodePtr, T * const) {
+    return((nodePtr != NULL) && ((nodePtr->type == hostJsonInteger) || (nodePtr->type == hostJsonReal)));
+}
+
+/**
+    Set a value.
+
+    @param[in]     nodePtr pointer to the value (NULL when the pool is full, nothing is set).
+    @param[in]     value the new value.
+*/
+inline void hostJsonSet(JsonDocument * const, hostJsonNode * const nodePtr, const char * const value) {
+    if (nodePtr != NULL) {
+        nodePtr->type = (value != NULL) ? hostJsonString : hostJsonNull;
+        nodePtr->string = value;
+    }
+}
+
+inline void hostJsonSet(JsonDocument * const doc, hostJsonNode * const nodePtr, char * const value) {
+    hostJsonSet(doc, nodePtr, (value != NULL) ? doc->hostStringCopy(value) : (const char *)NULL);
+}
+
+inline void hostJsonSet(JsonDocument * const, hostJsonNode * const nodePtr, const bool value) {
+    if (nodePtr != NULL) {
+        nodePtr->type = hostJsonBool;
+        nodePtr->integer = value ? 1 : 0;
+    }
+}
+
+template <typename T> inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type hostJsonSet(JsonDocument * const, hostJsonNode * const nodePtr, const T value) {
+    if (nodePtr != NULL) {
+        nodePtr->type = hostJsonInteger;
+        nodePtr->integer = (long long)value;
+    }
+}
+
+template <typename T> inline typename std::enable_if<std::is_floating_point<T>::value>::type hostJsonSet(JsonDocument * const, hostJsonNode * const nodePtr, const T value) {
+    if (nodePtr != NULL) {
+        nodePtr->type = hostJsonReal;
+        nodePtr->real = (double)value;
+    }
+}
+
+
+// Value access shared by the paths, variants, objects and arrays (TRef provides hostDoc and hostNode)
+template <typename TRef> class hostJsonValue {
+public:
+    template <typename T> T as(void) const {
+        return(hostJsonGet(self().hostDoc(), self().hostNode(false), (T *)NULL));
+    }
+
+    template <typename T> bool is(void) const {
+        return(hostJsonIs((self().hostDoc() != NULL) ? self().hostDoc()->hostNodeAt(self().hostNode(false)) : (const hostJsonNode *)NULL, (T *)NULL));
+    }
+
+    // Converts to numbers, booleans, enums and strings (variants, objects and arrays are constructed from the value)
+    template <typename T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_same<T, const char *>::value, int>::type = 0>
+    operator T(void) const {
+        return(as<T>());
+    }
+
+    // The string or a default when the value is not a string
+    const char * operator|(const char * const defaultValue) const {
+        const char * const value = as<const char *>();
+        return((value != NULL) ? value : defaultValue);
+    }
+
+    bool isNull(void) const {
+        const hostJsonNode * const nodePtr = (self().hostDoc() != NULL) ? self().hostDoc()->hostNodeAt(self().hostNode(false)) : NULL;
+        return((nodePtr == NULL) || (nodePtr->type == hostJsonNull));
+    }
+
+    bool containsKey(const char * const key) const {
+        return((self().hostDoc() != NULL) && (self().hostDoc()->hostNodeChild(self().hostNode(false), key, -1, false) >= 0));
+    }
+
+    template <typename T> bool set(const T value) const {
+
+        // Value to set (added when it is not there)
+        hostJsonNode * const nodePtr = (self().hostDoc() != NULL) ? self().hostDoc()->hostNodeAt(self().hostNode(true)) : NULL;
+
+        hostJsonSet(self().hostDoc(), nodePtr, value);
+
+        return(nodePtr != NULL);
+    }
+
+    size_t size(void) const {
+
+        // Value and number of members / elements
+        const hostJsonNode * const nodePtr = (self().hostDoc() != NULL) ? self().hostDoc()->hostNodeAt(self().hostNode(false)) : NULL;
+        size_t count = 0;
+
+        if ((nodePtr != NULL) && ((nodePtr->type == hostJsonObject) || (nodePtr->type == hostJsonArray))) {
+            for (int node = nodePtr->child; node >= 0; node = self().hostDoc()->hostNodeAt(node)->next) {
+                count++;
+            }
+        }
+
+        return(count);
+    }
+
+private:
+    const TRef & self(void) const {
+        return(*static_cast<const TRef *>(this));
+    }
+};
+
+
+// Member or element of a value that is only added when it is written (like the proxies of the library)
+class hostJsonPath : public hostJsonValue<hostJsonPath> {
+public:
+    hostJsonPath(JsonDocument * const doc, const hostJsonPath * const parentPath, const int parentNode, const char * const key, const int index) :
+        pathDoc(doc), pathParent(parentPath), pathParentNode(parentNode), pathKey(key), pathIndex(index) {}
+
+    JsonDocument * hostDoc(void) const {
+        return(pathDoc);
+    }
+
+    int hostNode(const bool create) const {
+
+        // Parent value
+        const int parent = (pathParent != NULL) ? pathParent->hostNode(create) : pathParentNode;
+
+        return((pathDoc != NULL) ? pathDoc->hostNodeChild(parent, pathKey, pathIndex, create) : -1);
+    }
+
+    // The parent path is a temporary of the same expression (a path is not kept)
+    hostJsonPath operator[](const char * const key) const {
+        return(hostJsonPath(pathDoc, this, -1, key, -1));
+    }
+
+    hostJsonPath operator[](const int index) const {
+        return(hostJsonPath(pathDoc, this, -1, NULL, index));
+    }
+
+    template <typename T> hostJsonPath & operator=(const T value) {
+        set(value);
+        return(*this);
+    }
+
+private:
+    hostJsonPath & operator=(const hostJsonPath &);
+
+    JsonDocument * pathDoc;
+    const hostJsonPath * pathParent;
+    int pathParentNode;
+    const char * pathKey;
+    int pathIndex;
+};
+
+
+// Reference to a value of a document
+class JsonVariant : public hostJsonValue<JsonVariant> {
+public:
+    JsonVariant(void) : variantDoc(NULL), variantNode(-1) {}
+    JsonVariant(JsonDocument * const doc, const int node) : variantDoc(doc), variantNode(node) {}
+    JsonVariant(const hostJsonPath & path) : variantDoc(path.hostDoc()), variantNode(path.hostNode(false)) {}
+
+    JsonDocument * hostDoc(void) const {
+        return(variantDoc);
+    }
+
+    int hostNode(const bool) const {
+        return(variantNode);
+    }
+
+    hostJsonPath operator[](const char * const key) const {
+        return(hostJsonPath(variantDoc, NULL, variantNode, key, -1));
+    }
+
+    hostJsonPath operator[](const int index) const {
+        return(hostJsonPath(variantDoc, NULL, variantNode, NULL, index));
+    }
+
+private:
+    JsonDocument * variantDoc;
+    int variantNode;
+};
+
+// Member of an object
+class JsonPair {
+public:
+    JsonPair(JsonDocument * const doc, const int node) : pairDoc(doc), pairNode(node) {}
+
+    JsonString key(void) const {
+        return(JsonString(pairDoc->hostNodeAt(pairNode)->key));
+    }
+
+    JsonVariant value(void) const {
+        return(JsonVariant(pairDoc, pairNode));
+    }
+
+private:
+    JsonDocument * pairDoc;
+    int pairNode;
+};
+
+// Iterator over the members / elements of a value
+template <typename TItem> class hostJsonIterator {
+public:
+    hostJsonIterator(JsonDocument * const doc, const int node) : iteratorDoc(doc), iteratorNode(node) {}
+
+    TItem operator*(void) const {
+        return(TItem(iteratorDoc, iteratorNode));
+    }
+
+    hostJsonIterator & operator++(void) {
+        iteratorNode = iteratorDoc->hostNodeAt(iteratorNode)->next;
+        return(*this);
+    }
+
+    bool operator!=(const hostJsonIterator & other) const {
+        return(iteratorNode != other.iteratorNode);
+    }
+
+private:
+    JsonDocument * iteratorDoc;
+    int iteratorNode;
+};
+
+// Reference to an object (null when the value is not an object)
+class JsonObject : public hostJsonValue<JsonObject> {
+public:
+    JsonObject(void) : objectDoc(NULL), objectNode(-1) {}
+
+    JsonObject(JsonDocument * const doc, const int node) : objectDoc(doc), objectNode(-1) {
+        const hostJsonNode * const nodePtr = (doc != NULL) ? doc->hostNodeAt(node) : NULL;
+        objectNode = ((nodePtr != NULL) && (nodePtr->type == hostJsonObject)) ? node : -1;
+    }
+
+    JsonObject(const JsonVariant & variant) : JsonObject(variant.hostDoc(), variant.hostNode(false)) {}
+
+    JsonDocument * hostDoc(void) const {
+        return(objectDoc);
+    }
+
+    int hostNode(const bool) const {
+        return(objectNode);
+    }
+
+    hostJsonPath operator[](const char * const key) const {
+        return(hostJsonPath(objectDoc, NULL, objectNode, key, -1));
+    }
+
+    hostJsonIterator<JsonPair> begin(void) const {
+        return(hostJsonIterator<JsonPair>(objectDoc, (objectNode >= 0) ? objectDoc->hostNodeAt(objectNode)->child : -1));
+    }
+
+    hostJsonIterator<JsonPair> end(void) const {
+        return(hostJsonIterator<JsonPair>(objectDoc, -1));
+    }
+
+private:
+    JsonDocument * objectDoc;
+    int objectNode;
+};
+
+// Reference to an array (null when the value is not an array)
+class JsonArray : public hostJsonValue<JsonArray> {
+public:
+    JsonArray(void) : arrayDoc(NULL), arrayNode(-1) {}
+
+    JsonArray(JsonDocument * const doc, const int node) : arrayDoc(doc), arrayNode(-1) {
+        const hostJsonNode * const nodePtr = (doc != NULL) ? doc->hostNodeAt(node) : NULL;
+        arrayNode = ((nodePtr != NULL) && (nodePtr->type == hostJsonArray)) ? node : -1;
+    }
+
+    JsonDocument * hostDoc(void) const {
+        return(arrayDoc);
+    }
+
+    int hostNode(const bool) const {
+        return(arrayNode);
+    }
+
+    hostJsonPath operator[](const int index) const {
+        return(hostJsonPath(arrayDoc, NULL, arrayNode, NULL, index));
+    }
+
+    hostJsonIterator<JsonVariant> begin(void) const {
+        return(hostJsonIterator<JsonVariant>(arrayDoc, (arrayNode >= 0) ? arrayDoc->hostNodeAt(arrayNode)->child : -1));
+    }
+
+    hostJsonIterator<JsonVariant> end(void) const {
+        return(hostJsonIterator<JsonVariant>(arrayDoc, -1));
+    }
+
+private:
+    JsonDocument * arrayDoc;
+    int arrayNode;
+};
+
+
+inline JsonVariant hostJsonGet(const JsonDocument * const doc, const int node, JsonVariant * const) {
+    return(JsonVariant(const_cast<JsonDocument *>(doc), node));
+}
+
+inline JsonObject hostJsonGet(const JsonDocument * const doc, const int node, JsonObject * const) {
+    return(JsonObject(const_cast<JsonDocument *>(doc), node));
+}
+
+inline JsonArray hostJsonGet(const JsonDocument * const doc, const int node, JsonArray * const) {
+    return(JsonArray(const_cast<JsonDocument *>(doc), node));
+}
+
+template <typename T> inline T JsonDocument::as(void) const {
+    return(JsonVariant(const_cast<JsonDocument *>(this), 0).as<T>());
+}
+
+template <typename T> inline bool JsonDocument::is(void) const {
+    return(JsonVariant(const_cast<JsonDocument *>(this), 0).is<T>());
+}
+
+inline bool JsonDocument::containsKey(const char * const key) const {
+    return(JsonVariant(const_cast<JsonDocument *>(this), 0).containsKey(key));
+}
+
+inline bool JsonDocument::isNull(void) const {
+    return(JsonVariant(const_cast<JsonDocument *>(this), 0).isNull());
+}
+
+template <typename T> inline bool JsonDocument::set(const T value) {
+    return(JsonVariant(this, 0).set(value));
+}
+
+inline hostJsonPath JsonDocument::operator[](const char * const key) {
+    return(hostJsonPath(this, NULL, 0, key, -1));
+}
+
+inline hostJsonPath JsonDocument::operator[](const int index) {
+    return(hostJsonPath(this, NULL, 0, NULL, index));
+}
+
+inline JsonVariant JsonDocument::operator[](const char * const key) const {
+    return(JsonVariant(hostJsonPath(const_cast<JsonDocument *>(this), NULL, 0, key, -1)));
+}
+
+
+// Reader of a terminated string
+class hostJsonStringReader {
+public:
+    hostJsonStringReader(const char * const input) : readerInput(input) {}
+
+    int peek(void) {
+        return((*readerInput != 0) ? (unsigned char)*readerInput : -1);
+    }
+
+    int read(void) {
+        return((*readerInput != 0) ? (unsigned char)*readerInput++ : -1);
+    }
+
+private:
+    const char * readerInput;
+};
+
+// Reader of a stream (read into a buffer, the end is when nothing more is available)
+template <typename TStream> class hostJsonStreamReader {
+public:
+    hostJsonStreamReader(TStream & input) : readerInput(input), readerNext(-1) {}
+
+    int peek(void) {
+
+        // Character read
+        uint8_t character;
+
+        if ((readerNext < 0) && (readerInput.read(&character, 1) == 1)) {
+            readerNext = character;
+        }
+
+        return(readerNext);
+    }
+
+    int read(void) {
+
+        // Character read
+        const int character = peek();
+
+        readerNext = -1;
+
+        return(character);
+    }
+
+private:
+    TStream & readerInput;
+    int readerNext;
+};
+
+// Parser into the pool of a document (values the filter does not keep are parsed and dropped)
+template <typename TReader> class hostJsonParser {
+public:
+    hostJsonParser(JsonDocument & doc, TReader & reader, const JsonDocument * const filter) : parserDoc(doc), parserReader(reader), parserFilter(filter) {}
+
+    DeserializationError parse(void) {
+
+        // Error of the value
+        DeserializationError error;
+
+        parserDoc.clear();
+
+        skipSpace();
+        if (parserReader.peek() < 0) {
+            return(DeserializationError::EmptyInput);
+        }
+
+        error = parseValue(0, (parserFilter != NULL) ? filterFollow(0) : filterKeepAll, 0);
+
+        // A filter that drops everything leaves a null document
+        return(error);
+    }
+
+private:
+    // Filter values for everything and for nothing
+    static const int filterKeepAll = -1;
+    static const int filterDropAll = -2;
+
+    // Map a filter value (true keeps everything, false or missing drops it)
+    int filterFollow(const int filterNode) const {
+
+        // Filter value
+        const hostJsonNode * const nodePtr = parserFilter->hostNodeAt(filterNode);
+
+        if ((nodePtr == NULL) || (nodePtr->type == hostJsonNull)) {
+            return(filterDropAll);
+        }
+
+        if ((nodePtr->type == hostJsonObject) || (nodePtr->type == hostJsonArray)) {
+            return(filterNode);
+        }
+
+        return((nodePtr->integer != 0) ? filterKeepAll : filterDropAll);
+    }
+
+    // Filter of a member (key) or of the elements (NULL key) of a filtered value
+    int filterChild(const int filter, const char * const key) const {
+
+        // Filter value
+        const hostJsonNode * nodePtr;
+
+        if ((filter == filterKeepAll) || (filter == filterDropAll)) {
+            return(filter);
+        }
+
+        nodePtr = parserFilter->hostNodeAt(filter);
+
+        if ((key != NULL) && (nodePtr->type == hostJsonObject)) {
+            return(filterFollow(const_cast<JsonDocument *>(parserFilter)->hostNodeChild(filter, key, -1, false)));
+        }
+
+        if ((key == NULL) && (nodePtr->type == hostJsonArray)) {
+            return(filterFollow(nodePtr->child));
+        }
+
+        return(filterDropAll);
+    }
+
+    void skipSpace(void) {
+        while ((parserReader.peek() == ' ') || (parserReader.peek() == '\t') || (parserReader.peek() == '\r') || (parserReader.peek() == '\n')) {
+            parserReader.read();
+        }
+    }
+
+    // Parse a string into a buffer (kept) or drop it
+    DeserializationError parseString(char * const buffer, const size_t size, const bool keep, const char ** const stringPtr) {
+
+        // Character of the string
+        int character;
+
+        // Length of the string in the buffer
+        size_t length = 0;
+
+        // Start of the string in the pool
+        const char * const start = parserDoc.hostStringEnd();
+
+        parserReader.read();
+
+        while ((character = parserReader.read()) != '"') {
+            if (character < 0) {
+                return(DeserializationError::IncompleteInput);
+            }
+
+            if (character == '\\') {
+                switch (character = parserReader.read()) {
+                    case 'n':
+                        character = '\n';
+                        break;
+                    case 't':
+                        character = '\t';
+                        break;
+                    case 'r':
+                        character = '\r';
+                        break;
+                    case 'b':
+                        character = '\b';
+                        break;
+                    case 'f':
+                        character = '\f';
+                        break;
+                    case '"':
+                    case '\\':
+                    case '/':
+                        break;
+                    default:
+                        return((character < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput);
+                }
+            }
+
+            if (buffer != NULL) {
+                if (length < (size - 1)) {
+                    buffer[length++] = (char)character;
+                }
+            }
+            else if ((keep == true) && (parserDoc.hostStringAdd((char)character) == false)) {
+                return(DeserializationError::NoMemory);
+            }
+        }
+
+        if (buffer != NULL) {
+            buffer[length] = 0;
+        }
+        else if (keep == true) {
+            if (parserDoc.hostStringAdd(0) == false) {
+                return(DeserializationError::NoMemory);
+            }
+            *stringPtr = start;
+        }
+
+        return(DeserializationError::Ok);
+    }
+
+    // Parse a value into a node (-1 when it is dropped)
+    DeserializationError parseValue(const int node, const int filter, const unsigned int depth) {
+
+        // Value being parsed
+        hostJsonNode * nodePtr = parserDoc.hostNodeAt(node);
+
+        // Value is kept
+        const bool keep = (nodePtr != NULL) && (filter != filterDropAll);
+
+        // Error of a member / element
+        DeserializationError error;
+
+        // Key of a member and text of a number or literal
+        char token[HOST_JSON_TOKEN_SIZE];
+        size_t length = 0;
+
+        // Member / element added and its filter
+        int child;
+        int childFilter;
+
+        // End of a number
+        char * numberEnd;
+
+        if (depth > HOST_JSON_NESTING_MAX) {
+            return(DeserializationError::TooDeep);
+        }
+
+        skipSpace();
+
+        switch (parserReader.peek()) {
+
+            case -1:
+                return(DeserializationError::IncompleteInput);
+
+            case '{':
+                parserReader.read();
+                if (keep == true) {
+                    nodePtr->type = hostJsonObject;
+                    nodePtr->child = -1;
+                }
+
+                skipSpace();
+                if (parserReader.peek() == '}') {
+                    parserReader.read();
+                    return(DeserializationError::Ok);
+                }
+
+                for (; ; ) {
+                    skipSpace();
+                    if (parserReader.peek() != '"') {
+                        return((parserReader.peek() < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput);
+                    }
+
+                    if ((error = parseString(token, sizeof(token), false, NULL))) {
+                        return(error);
+                    }
+
+                    skipSpace();
+                    if (parserReader.read() != ':') {
+                        return(DeserializationError::InvalidInput);
+                    }
+
+                    childFilter = filterChild(keep ? filter : filterDropAll, token);
+                    child = -1;
+
+                    if ((keep == true) && (childFilter != filterDropAll)) {
+                        if ((child = parserDoc.hostNodeAppend(node, parserDoc.hostStringCopy(token))) < 0) {
+                            return(DeserializationError::NoMemory);
+                        }
+                    }
+
+                    if ((error = parseValue(child, childFilter, depth + 1))) {
+                        return(error);
+                    }
+
+                    skipSpace();
+                    switch (parserReader.read()) {
+                        case ',':
+                            break;
+                        case '}':
+                            return(DeserializationError::Ok);
+                        case -1:
+                            return(DeserializationError::IncompleteInput);
+                        default:
+                            return(DeserializationError::InvalidInput);
+                    }
+                }
+
+            case '[':
+                parserReader.read();
+                if (keep == true) {
+                    nodePtr->type = hostJsonArray;
+                    nodePtr->child = -1;
+                }
+
+                skipSpace();
+                if (parserReader.peek() == ']') {
+                    parserReader.read();
+                    return(DeserializationError::Ok);
+                }
+
+                childFilter = filterChild(keep ? filter : filterDropAll, NULL);
+
+                for (; ; ) {
+                    child = -1;
+
+                    if ((keep == true) && (childFilter != filterDropAll)) {
+                        if ((child = parserDoc.hostNodeAppend(node, NULL)) < 0) {
+                            return(DeserializationError::NoMemory);
+                        }
+                    }
+
+                    if ((error = parseValue(child, childFilter, depth + 1))) {
+                        return(error);
+                    }
+
+                    skipSpace();
+                    switch (parserReader.read()) {
+                        case ',':
+                            break;
+                        case ']':
+                            return(DeserializationError::Ok);
+                        case -1:
+                            return(DeserializationError::IncompleteInput);
+                        default:
+                            return(DeserializationError::InvalidInput);
+                    }
+                }
+
+            case '"':
+                if ((error = parseString(NULL, 0, keep, (keep == true) ? &nodePtr->string : NULL))) {
+                    return(error);
+                }
+                if (keep == true) {
+                    nodePtr = parserDoc.hostNodeAt(node);
+                    nodePtr->type = hostJsonString;
+                }
+                return(DeserializationError::Ok);
+
+            default:
+                while ((parserReader.peek() >= 0) && (strchr(",}] \t\r\n", parserReader.peek()) == NULL)) {
+                    if (length >= (sizeof(token) - 1)) {
+                        return(DeserializationError::InvalidInput);
+                    }
+                    token[length++] = (char)parserReader.read();
+                }
+                token[length] = 0;
+
+                if ((strcmp(token, "true") == 0) || (strcmp(token, "false") == 0)) {
+                    if (keep == true) {
+                        nodePtr->type = hostJsonBool;
+                        nodePtr->integer = (token[0] == 't') ? 1 : 0;
+                    }
+                }
+                else if (strcmp(token, "null") == 0) {
+                }
+                else if (strpbrk(token, ".eE") != NULL) {
+                    const double real = strtod(token, &numberEnd);
+                    if ((length == 0) || (*numberEnd != 0)) {
+                        return((parserReader.peek() < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput);
+                    }
+                    if (keep == true) {
+                        nodePtr->type = hostJsonReal;
+                        nodePtr->real = real;
+                    }
+                }
+                else {
+                    const long long integer = strtoll(token, &numberEnd, 10);
+                    if ((length == 0) || (*numberEnd != 0)) {
+                        return((parserReader.peek() < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput);
+                    }
+                    if (keep == true) {
+                        nodePtr->type = hostJsonInteger;
+                        nodePtr->integer = integer;
+                    }
+                }
+                return(DeserializationError::Ok);
+        }
+    }
+
+    JsonDocument & parserDoc;
+    TReader & parserReader;
+    const JsonDocument * parserFilter;
+};
+
+// Serializer of a document into a buffer (truncated like the library)
+class hostJsonSerializer {
+public:
+    hostJsonSerializer(const JsonDocument & doc, char * const output, const size_t size) : serializerDoc(doc), serializerOutput(output), serializerSize(size), serializerLength(0) {
+        if (size > 0) {
+            output[0] = 0;
+        }
+    }
+
+    size_t serialize(void) {
+        serializeValue(0);
+        return(serializerLength);
+    }
+
+private:
+    void append(const char * text) {
+
+        while (*text != 0) {
+            if ((serializerLength + 1) < serializerSize) {
+                serializerOutput[serializerLength++] = *text;
+                serializerOutput[serializerLength] = 0;
+            }
+            text++;
+        }
+    }
+
+    void appendString(const char * const text) {
+
+        // Escaped character
+        char escaped[8];
+
+        append("\"");
+
+        for (const char * character = text; *character != 0; character++) {
+            switch (*character) {
+                case '"':
+                    append("\\\"");
+                    break;
+                case '\\':
+                    append("\\\\");
+                    break;
+                case '\n':
+                    append("\\n");
+                    break;
+                case '\r':
+                    append("\\r");
+                    break;
+                case '\t':
+                    append("\\t");
+                    break;
+                default:
+                    snprintf(escaped, sizeof(escaped), "%c", *character);
+                    append(escaped);
+                    break;
+            }
+        }
+
+        append("\"");
+    }
+
+    void serializeValue(const int node) {
+
+        // Value
+        const hostJsonNode * const nodePtr = serializerDoc.hostNodeAt(node);
+
+        // Number as text
+        char number[32];
+
+        switch (nodePtr->type) {
+            case hostJsonObject:
+            case hostJsonArray:
+                append((nodePtr->type == hostJsonObject) ? "{" : "[");
+                for (int child = nodePtr->child; child >= 0; child = serializerDoc.hostNodeAt(child)->next) {
+                    if (child != nodePtr->child) {
+                        append(",");
+                    }
+                    if (nodePtr->type == hostJsonObject) {
+                        appendString(serializerDoc.hostNodeAt(child)->key);
+                        append(":");
+                    }
+                    serializeValue(child);
+                }
+                append((nodePtr->type == hostJsonObject) ? "}" : "]");
+                break;
+
+            case hostJsonInteger:
+                snprintf(number, sizeof(number), "%lld", nodePtr->integer);
+                append(number);
+                break;
+
+            case hostJsonReal:
+                snprintf(number, sizeof(number), "%.9g", nodePtr->real);
+                append(number);
+                break;
+
+            case hostJsonBool:
+                append((nodePtr->integer != 0) ? "true" : "false");
+                break;
+
+            case hostJsonString:
+                appendString(nodePtr->string);
+                break;
+
+            case hostJsonNull:
+            default:
+                append("null");
+                break;
+        }
+    }
+
+    const JsonDocument & serializerDoc;
+    char * serializerOutput;
+    size_t serializerSize;
+    size_t serializerLength;
+};
+
+
+/**
+    Deserialize a terminated JSON text into a document.
+
+    @param[in]     doc document.
+    @param[in]     input pointer to the terminated JSON text.
+    @return        error of the deserialization.
+*/
+inline DeserializationError deserializeJson(JsonDocument & doc, const char * const input) {
+
+    // Reader of the text
+    hostJsonStringReader reader(input);
+
+    return(hostJsonParser<hostJsonStringReader>(doc, reader, NULL).parse());
+}
+
+/**
+    Deserialize a JSON text from a stream into a document, only the values in the filter are kept.
+
+    @param[in]     doc document.
+    @param[in]     input the stream.
+    @param[in]     filter the filter.
+    @return        error of the deserialization.
+*/
+template <typename TStream> inline typename std::enable_if<!std::is_pointer<TStream>::value, DeserializationError>::type deserializeJson(JsonDocument & doc, TStream & input, const DeserializationOption::Filter filter) {
+
+    // Reader of the stream
+    hostJsonStreamReader<TStream> reader(input);
+
+    return(hostJsonParser<hostJsonStreamReader<TStream> >(doc, reader, filter.filterDoc).parse());
+}
+
+/**
+    Deserialize a terminated JSON text into a document, only the values in the filter are kept.
+
+    @param[in]     doc document.
+    @param[in]     input pointer to the terminated JSON text.
+    @param[in]     filter the filter.
+    @return        error of the deserialization.
+*/
+inline DeserializationError deserializeJson(JsonDocument & doc, const char * const input, const DeserializationOption::Filter filter) {
+
+    // Reader of the text
+    hostJsonStringReader reader(input);
+
+    return(hostJsonParser<hostJsonStringReader>(doc, reader, filter.filterDoc).parse());
+}
+
+/**
+    Serialize a document into a buffer (truncated like the library).
+
+    @param[in]     doc document.
+    @param[out]    output pointer to the buffer.
+    @param[in]     size size of the buffer.
+    @return        number of characters written (excluding the end of string).
+*/
+inline size_t serializeJson(const JsonDocument & doc, char * const output, const size_t size) {
+    return(hostJsonSerializer(doc, output, size).serialize());
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+// Host (Linux) replacement for the Client class of the Arduino core
+// Only the reads used by the modules the host tests build, a test derives its stand-in for the connection
+
+#include <Arduino.h>
+
+
+// Connection of the Arduino core (WiFiClient derives from it)
+class Client {
+public:
+    virtual ~Client(void) {}
+
+    virtual int available(void) = 0;
+    virtual int read(uint8_t * buffer, size_t size) = 0;
+    virtual uint8_t connected(void) = 0;
+};
+
+#endif
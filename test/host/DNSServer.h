@@ -0,0 +1,6 @@
+#ifndef DNSSERVER_H
+#define DNSSERVER_H
+
+// Host (Linux) replacement for the DNSServer library (only included for the WiFiManager library)
+
+#endif
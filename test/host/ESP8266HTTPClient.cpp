@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <ESP8266HTTPClient.h>
+
+
+// Last request (method, path and payload)
+char hostHttpMethod[8];
+char hostHttpPath[HOST_HTTP_STRING_SIZE];
+char hostHttpPayload[HOST_HTTP_STRING_SIZE];
+
+// Number of requests
+unsigned int hostHttpRequests = 0;
+
+// Response of the simulated server
+static int hostHttpCode = HTTP_CODE_OK;
+static const char * hostHttpBody = "";
+
+
+bool HTTPClient::begin(WiFiClient & client, const char * url) {
+    clientConnection = &client;
+    snprintf(hostHttpPath, sizeof(hostHttpPath), "%s", url);
+    return(true);
+}
+
+void HTTPClient::useHTTP10(bool usehttp10) {
+    (void) usehttp10;
+}
+
+void HTTPClient::setReuse(bool reuse) {
+    (void) reuse;
+}
+
+void HTTPClient::addHeader(const char * name, const char * value) {
+    (void) name;
+    (void) value;
+}
+
+int HTTPClient::GET(void) {
+    return(request("GET", NULL, 0));
+}
+
+int HTTPClient::POST(uint8_t * payload, size_t size) {
+    return(request("POST", payload, size));
+}
+
+int HTTPClient::PUT(uint8_t * payload, size_t size) {
+    return(request("PUT", payload, size));
+}
+
+int HTTPClient::getSize(void) {
+    return((int)strlen(hostHttpBody));
+}
+
+WiFiClient & HTTPClient::getStream(void) {
+    return(*clientConnection);
+}
+
+void HTTPClient::end(void) {
+}
+
+/**
+    Send a request to the simulated server, the body of the response is queued on the connection.
+
+    @param[in]     method pointer to the method name.
+    @param[in]     payload pointer to the payload (NULL when there is none).
+    @param[in]     size size of the payload.
+    @return        HTTP code or HTTPC_ERROR_ code.
+*/
+int HTTPClient::request(const char * method, const uint8_t * payload, size_t size) {
+
+    hostHttpRequests++;
+    snprintf(hostHttpMethod, sizeof(hostHttpMethod), "%s", method);
+    snprintf(hostHttpPayload, sizeof(hostHttpPayload), "%.*s", (int)size, (payload != NULL) ? (const char *)payload : "");
+
+    if ((clientConnection == NULL) || (clientConnection->connected() == 0)) {
+        return(HTTPC_ERROR_CONNECTION_REFUSED);
+    }
+
+    if (hostHttpCode > 0) {
+        clientConnection->hostReceive((const uint8_t *)hostHttpBody, strlen(hostHttpBody));
+    }
+
+    return(hostHttpCode);
+}
+
+
+/**
+    Set the response of the next requests (the body is kept by pointer).
+
+    @param[in]     code HTTP code (or HTTPC_ERROR_ code).
+    @param[in]     body pointer to the body (terminated).
+*/
+void hostHttpRespond(const int code, const char * const body) {
+    hostHttpCode = code;
+    hostHttpBody = body;
+}
@@ -0,0 +1,61 @@
+#ifndef ESP8266HTTPCLIENT_H
+#define ESP8266HTTPCLIENT_H
+
+// Host (Linux) replacement for the ESP8266HTTPClient library
+// The server is simulated: a test sets the response (code and body), the body is read from the connection like the library
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+// HTTP codes of the library used on the host
+#define HTTP_CODE_OK                        (200)
+#define HTTP_CODE_NOT_FOUND                 (404)
+
+// Errors of the library (same values)
+#define HTTPC_ERROR_CONNECTION_REFUSED      (-1)
+#define HTTPC_ERROR_CONNECTION_LOST         (-5)
+
+// Size of the kept request path and payload
+#define HOST_HTTP_STRING_SIZE               (512)
+
+
+// HTTP client (the responses of all clients come from the simulated server)
+class HTTPClient {
+public:
+    HTTPClient(void) : clientConnection(NULL) {}
+
+    bool begin(WiFiClient & client, const char * url);
+    void useHTTP10(bool usehttp10);
+    void setReuse(bool reuse);
+    void addHeader(const char * name, const char * value);
+    int GET(void);
+    int POST(uint8_t * payload, size_t size);
+    int PUT(uint8_t * payload, size_t size);
+    int getSize(void);
+    WiFiClient & getStream(void);
+    void end(void);
+
+private:
+    int request(const char * method, const uint8_t * payload, size_t size);
+
+    WiFiClient * clientConnection;
+};
+
+// Last request (method, path and payload)
+extern char hostHttpMethod[8];
+extern char hostHttpPath[HOST_HTTP_STRING_SIZE];
+extern char hostHttpPayload[HOST_HTTP_STRING_SIZE];
+
+// Number of requests
+extern unsigned int hostHttpRequests;
+
+
+/**
+    Set the response of the next requests (the body is kept by pointer).
+
+    @param[in]     code HTTP code (or HTTPC_ERROR_ code).
+    @param[in]     body pointer to the body (terminated).
+*/
+void hostHttpRespond(const int code, const char * const body);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef ESP8266WEBSERVER_H
+#define ESP8266WEBSERVER_H
+
+// Host (Linux) replacement for the ESP8266WebServer library (only included for the WiFiManager library)
+
+#endif
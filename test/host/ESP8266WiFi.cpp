@@ -0,0 +1,264 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+extern "C" {
+#include <user_interface.h>
+}
+
+
+// Simulated station address, gateway, mask and DNS (192.168.1.50/24)
+#define HOST_WIFI_IP                    (0x3201A8C0UL)
+#define HOST_WIFI_GATEWAY               (0x0101A8C0UL)
+#define HOST_WIFI_MASK                  (0x00FFFFFFUL)
+
+// Simulated soft AP address (192.168.4.1)
+#define HOST_WIFI_SOFT_AP_IP            (0x0104A8C0UL)
+
+// Simulated channel
+#define HOST_WIFI_CHANNEL               (6)
+
+// Stored network of the simulated station
+#define HOST_WIFI_SSID                  "hostNetwork"
+#define HOST_WIFI_PASSWORD              "hostPassword"
+
+
+// WiFi station
+ESP8266WiFiClass WiFi;
+
+// Station status
+static wl_status_t hostWiFiStationStatus = WL_DISCONNECTED;
+
+// Station RSSI
+static int32_t hostWiFiStationRssi = -60;
+
+// TCP connections are accepted
+static bool hostWiFiAccept = true;
+
+// Reconnects and begins requested
+static unsigned int hostWiFiReconnectCount = 0;
+
+// Station MAC and access point BSSID
+static uint8_t hostWiFiMac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static uint8_t hostWiFiBssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+// Station event handlers
+static void (* hostWiFiGotIpHandler)(const WiFiEventStationModeGotIP &) = NULL;
+static void (* hostWiFiDisconnectedHandler)(const WiFiEventStationModeDisconnected &) = NULL;
+
+
+/**
+    Connect to a server.
+
+    @param[in]     host pointer to the host name.
+    @param[in]     port the port.
+    @return        1 when connected, 0 otherwise.
+*/
+int WiFiClient::connect(const char * host, uint16_t port) {
+    (void) host;
+    (void) port;
+
+    clientOpen = hostWiFiAccept;
+    clientSize = 0;
+
+    return(clientOpen ? 1 : 0);
+}
+
+
+bool ESP8266WiFiClass::mode(WiFiMode_t mode) {
+    (void) mode;
+    return(true);
+}
+
+bool ESP8266WiFiClass::hostname(const char * name) {
+    (void) name;
+    return(true);
+}
+
+uint8_t * ESP8266WiFiClass::macAddress(uint8_t * mac) {
+    memcpy(mac, hostWiFiMac, sizeof(hostWiFiMac));
+    return(mac);
+}
+
+IPAddress ESP8266WiFiClass::localIP(void) {
+    return(IPAddress((hostWiFiStationStatus == WL_CONNECTED) ? HOST_WIFI_IP : 0));
+}
+
+IPAddress ESP8266WiFiClass::gatewayIP(void) {
+    return(IPAddress((hostWiFiStationStatus == WL_CONNECTED) ? HOST_WIFI_GATEWAY : 0));
+}
+
+IPAddress ESP8266WiFiClass::subnetMask(void) {
+    return(IPAddress((hostWiFiStationStatus == WL_CONNECTED) ? HOST_WIFI_MASK : 0));
+}
+
+IPAddress ESP8266WiFiClass::dnsIP(uint8_t dnsNumber) {
+    return(IPAddress(((hostWiFiStationStatus == WL_CONNECTED) && (dnsNumber == 0)) ? HOST_WIFI_GATEWAY : 0));
+}
+
+IPAddress ESP8266WiFiClass::softAPIP(void) {
+    return(IPAddress(HOST_WIFI_SOFT_AP_IP));
+}
+
+wl_status_t ESP8266WiFiClass::status(void) {
+    return(hostWiFiStationStatus);
+}
+
+int32_t ESP8266WiFiClass::RSSI(void) {
+    return(hostWiFiStationRssi);
+}
+
+uint8_t * ESP8266WiFiClass::BSSID(void) {
+    return(hostWiFiBssid);
+}
+
+int32_t ESP8266WiFiClass::channel(void) {
+    return(HOST_WIFI_CHANNEL);
+}
+
+bool ESP8266WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1) {
+    (void) local;
+    (void) gateway;
+    (void) subnet;
+    (void) dns1;
+    return(true);
+}
+
+wl_status_t ESP8266WiFiClass::begin(void) {
+    hostWiFiReconnectCount++;
+    return(hostWiFiStationStatus);
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char * ssid, const char * passphrase, int32_t channel, const uint8_t * bssid) {
+    (void) ssid;
+    (void) passphrase;
+    (void) channel;
+    (void) bssid;
+    return(begin());
+}
+
+void ESP8266WiFiClass::persistent(bool persistent) {
+    (void) persistent;
+}
+
+bool ESP8266WiFiClass::reconnect(void) {
+    hostWiFiReconnectCount++;
+    return(true);
+}
+
+WiFiEventHandler ESP8266WiFiClass::onStationModeGotIP(void (* handler)(const WiFiEventStationModeGotIP &)) {
+    hostWiFiGotIpHandler = handler;
+    return((WiFiEventHandler)&hostWiFiGotIpHandler);
+}
+
+WiFiEventHandler ESP8266WiFiClass::onStationModeDisconnected(void (* handler)(const WiFiEventStationModeDisconnected &)) {
+    hostWiFiDisconnectedHandler = handler;
+    return((WiFiEventHandler)&hostWiFiDisconnectedHandler);
+}
+
+
+/**
+    Get the current station configuration.
+
+    @param[out]    config pointer to the configuration.
+    @return        true (the simulated station always has a stored network).
+*/
+bool wifi_station_get_config(struct station_config * config) {
+    memset(config, 0, sizeof(*config));
+    memcpy(config->ssid, HOST_WIFI_SSID, strlen(HOST_WIFI_SSID));
+    memcpy(config->password, HOST_WIFI_PASSWORD, strlen(HOST_WIFI_PASSWORD));
+    return(true);
+}
+
+/**
+    Get the stored station configuration.
+
+    @param[out]    config pointer to the configuration.
+    @return        true (the simulated station always has a stored network).
+*/
+bool wifi_station_get_config_default(struct station_config * config) {
+    return(wifi_station_get_config(config));
+}
+
+/**
+    Set the current station configuration (not kept on the host).
+
+    @param[in]     config pointer to the configuration.
+    @return        true.
+*/
+bool wifi_station_set_config_current(struct station_config * config) {
+    (void) config;
+    return(true);
+}
+
+/**
+    Disconnect the station.
+
+    @return        true.
+*/
+bool wifi_station_disconnect(void) {
+    hostWiFiStationStatus = WL_DISCONNECTED;
+    return(true);
+}
+
+
+/**
+    Set the status of the station.
+
+    @param[in]     status the new status.
+*/
+void hostWiFiStatus(const wl_status_t status) {
+    hostWiFiStationStatus = status;
+}
+
+/**
+    Set the RSSI of the station.
+
+    @param[in]     rssi the RSSI in dBm.
+*/
+void hostWiFiRssi(const int32_t rssi) {
+    hostWiFiStationRssi = rssi;
+}
+
+/**
+    Set the result of the next TCP connections.
+
+    @param[in]     accept true when a connection is accepted.
+*/
+void hostWiFiAcceptConnections(const bool accept) {
+    hostWiFiAccept = accept;
+}
+
+/**
+    Raise the got IP event (calls the handler).
+*/
+void hostWiFiGotIp(void) {
+
+    // Event details
+    const WiFiEventStationModeGotIP event = {IPAddress(HOST_WIFI_IP), IPAddress(HOST_WIFI_MASK), IPAddress(HOST_WIFI_GATEWAY)};
+
+    if (hostWiFiGotIpHandler != NULL) {
+        hostWiFiGotIpHandler(event);
+    }
+}
+
+/**
+    Raise the disconnected event (calls the handler).
+*/
+void hostWiFiDisconnected(void) {
+
+    // Event details
+    const WiFiEventStationModeDisconnected event = {0};
+
+    if (hostWiFiDisconnectedHandler != NULL) {
+        hostWiFiDisconnectedHandler(event);
+    }
+}
+
+/**
+    Get the number of reconnects and begins requested.
+
+    @return        number of WiFi.reconnect and WiFi.begin calls.
+*/
+unsigned int hostWiFiReconnects(void) {
+    return(hostWiFiReconnectCount);
+}
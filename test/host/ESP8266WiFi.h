@@ -0,0 +1,209 @@
+#ifndef ESP8266WIFI_H
+#define ESP8266WIFI_H
+
+// Host (Linux) replacement for the ESP8266WiFi library
+// The station is simulated: a test sets the status and RSSI and raises the station events (ESP8266WiFi.cpp)
+// A TCP connection only returns what a test (or the host HTTPClient) queued for it
+
+#include <Arduino.h>
+#include <Client.h>
+
+
+// WiFi status of the ESP8266WiFi library
+typedef enum {
+    WL_NO_SHIELD        = 255,
+    WL_IDLE_STATUS      = 0,
+    WL_NO_SSID_AVAIL    = 1,
+    WL_SCAN_COMPLETED   = 2,
+    WL_CONNECTED        = 3,
+    WL_CONNECT_FAILED   = 4,
+    WL_CONNECTION_LOST  = 5,
+    WL_DISCONNECTED     = 6
+} wl_status_t;
+
+// WiFi modes of the ESP8266WiFi library
+typedef enum {
+    WIFI_OFF            = 0,
+    WIFI_STA            = 1,
+    WIFI_AP             = 2,
+    WIFI_AP_STA         = 3
+} WiFiMode_t;
+
+// IPv4 address
+class IPAddress {
+public:
+    IPAddress(void) : ipAddress(0) {}
+    IPAddress(const uint32_t address) : ipAddress(address) {}
+
+    // Octet of the address (first octet is the lowest byte like the core)
+    uint8_t operator[](const int index) const {
+        return((uint8_t)(ipAddress >> (8 * index)));
+    }
+
+    // Parse a dotted decimal address (no DNS like the core)
+    bool fromString(const char * address) {
+
+        // Octet being parsed
+        unsigned int octet = 0;
+
+        // Number of digits in the octet
+        unsigned int digits = 0;
+
+        // Number of octets
+        unsigned int octets = 0;
+
+        ipAddress = 0;
+
+        for (; ; address++) {
+            if ((*address >= '0') && (*address <= '9') && (digits < 3)) {
+                octet = (octet * 10) + (*address - '0');
+                digits++;
+            }
+            else if (((*address == '.') || (*address == 0)) && (digits > 0) && (octet <= 255) && (octets < 4)) {
+                ipAddress |= (uint32_t)octet << (8 * octets++);
+                octet = 0;
+                digits = 0;
+
+                if (*address == 0) {
+                    return(octets == 4);
+                }
+            }
+            else {
+                ipAddress = 0;
+                return(false);
+            }
+        }
+    }
+
+    operator uint32_t(void) const {
+        return(ipAddress);
+    }
+
+private:
+    uint32_t ipAddress;
+};
+
+// TCP connection (connects when the host accepts it, only returns the data queued with hostReceive)
+class WiFiClient : public Client {
+public:
+    WiFiClient(void) : clientOpen(false), clientData(NULL), clientSize(0) {}
+
+    int connect(const char * host, uint16_t port);
+
+    void stop(void) {
+        clientOpen = false;
+        clientSize = 0;
+    }
+
+    int available(void) {
+        return((int)clientSize);
+    }
+
+    int read(uint8_t * buffer, size_t size) {
+
+        // Bytes read
+        const size_t count = min(size, clientSize);
+
+        memcpy(buffer, clientData, count);
+        clientData += count;
+        clientSize -= count;
+
+        return((int)count);
+    }
+
+    uint8_t connected(void) {
+        return(clientOpen ? 1 : 0);
+    }
+
+    // Queue data for the connection (kept by pointer, replaces what was not read)
+    void hostReceive(const uint8_t * const data, const size_t size) {
+        clientData = data;
+        clientSize = size;
+    }
+
+private:
+    bool clientOpen;
+    const uint8_t * clientData;
+    size_t clientSize;
+};
+
+// Station events (the handlers only flag the event on the host)
+struct WiFiEventStationModeGotIP {
+    IPAddress               ip;
+    IPAddress               mask;
+    IPAddress               gw;
+};
+
+struct WiFiEventStationModeDisconnected {
+    uint8_t                 reason;
+};
+
+// Event handler (the core uses a shared pointer, the host keeps one handler per event)
+typedef const void * WiFiEventHandler;
+
+// WiFi station of the ESP8266WiFi library (the connection is simulated)
+class ESP8266WiFiClass {
+public:
+    bool mode(WiFiMode_t mode);
+    bool hostname(const char * name);
+    uint8_t * macAddress(uint8_t * mac);
+    IPAddress localIP(void);
+    IPAddress gatewayIP(void);
+    IPAddress subnetMask(void);
+    IPAddress dnsIP(uint8_t dnsNumber = 0);
+    IPAddress softAPIP(void);
+    wl_status_t status(void);
+    int32_t RSSI(void);
+    uint8_t * BSSID(void);
+    int32_t channel(void);
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress((uint32_t)0));
+    wl_status_t begin(void);
+    wl_status_t begin(const char * ssid, const char * passphrase, int32_t channel, const uint8_t * bssid);
+    void persistent(bool persistent);
+    bool reconnect(void);
+    WiFiEventHandler onStationModeGotIP(void (* handler)(const WiFiEventStationModeGotIP &));
+    WiFiEventHandler onStationModeDisconnected(void (* handler)(const WiFiEventStationModeDisconnected &));
+};
+
+extern ESP8266WiFiClass WiFi;
+
+
+/**
+    Set the status of the station.
+
+    @param[in]     status the new status.
+*/
+void hostWiFiStatus(const wl_status_t status);
+
+/**
+    Set the RSSI of the station.
+
+    @param[in]     rssi the RSSI in dBm.
+*/
+void hostWiFiRssi(const int32_t rssi);
+
+/**
+    Set the result of the next TCP connections.
+
+    @param[in]     accept true when a connection is accepted.
+*/
+void hostWiFiAcceptConnections(const bool accept);
+
+/**
+    Raise the got IP event (calls the handler).
+*/
+void hostWiFiGotIp(void);
+
+/**
+    Raise the disconnected event (calls the handler).
+*/
+void hostWiFiDisconnected(void);
+
+/**
+    Get the number of reconnects and begins requested.
+
+    @return        number of WiFi.reconnect and WiFi.begin calls.
+*/
+unsigned int hostWiFiReconnects(void);
+
+#endif
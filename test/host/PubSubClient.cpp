@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include <PubSubClient.h>
+
+
+// Published messages
+hostPubSubMessage hostPubSubPublished[HOST_PUBSUB_MESSAGES];
+
+// Number of published messages
+unsigned int hostPubSubPublishedCount = 0;
+
+// Number of connection attempts
+unsigned int hostPubSubConnects = 0;
+
+// Broker accepts connections
+static bool hostPubSubAccepting = true;
+
+// Client is connected
+static bool hostPubSubConnected = false;
+
+// Callback for a received message
+static void (* hostPubSubCallback)(char *, uint8_t *, unsigned int) = NULL;
+
+// Queued message from the broker
+static char hostPubSubRxTopic[HOST_PUBSUB_STRING_SIZE];
+static uint8_t hostPubSubRxPayload[HOST_PUBSUB_STRING_SIZE + 1];
+static unsigned int hostPubSubRxLength = 0;
+static bool hostPubSubRxPending = false;
+
+
+PubSubClient::PubSubClient(Client & client) {
+    (void) client;
+}
+
+PubSubClient & PubSubClient::setServer(const char * domain, uint16_t port) {
+    (void) domain;
+    (void) port;
+    return(*this);
+}
+
+PubSubClient & PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    hostPubSubCallback = callback;
+    return(*this);
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    (void) size;
+    return(true);
+}
+
+bool PubSubClient::connect(const char * id, const char * user, const char * pass, const char * willTopic, uint8_t willQos, bool willRetain, const char * willMessage) {
+    (void) id;
+    (void) user;
+    (void) pass;
+    (void) willTopic;
+    (void) willQos;
+    (void) willRetain;
+    (void) willMessage;
+
+    hostPubSubConnects++;
+    hostPubSubConnected = hostPubSubAccepting;
+
+    return(hostPubSubConnected);
+}
+
+void PubSubClient::disconnect(void) {
+    hostPubSubConnected = false;
+}
+
+bool PubSubClient::connected(void) {
+    return(hostPubSubConnected);
+}
+
+int PubSubClient::state(void) {
+    return(hostPubSubConnected ? MQTT_CONNECTED : (hostPubSubAccepting ? MQTT_DISCONNECTED : MQTT_CONNECT_FAILED));
+}
+
+bool PubSubClient::publish(const char * topic, const char * payload) {
+    return(publish(topic, payload, false));
+}
+
+bool PubSubClient::publish(const char * topic, const char * payload, bool retained) {
+
+    if (hostPubSubConnected == false) {
+        return(false);
+    }
+
+    if (hostPubSubPublishedCount < HOST_PUBSUB_MESSAGES) {
+        snprintf(hostPubSubPublished[hostPubSubPublishedCount].topic, HOST_PUBSUB_STRING_SIZE, "%s", topic);
+        snprintf(hostPubSubPublished[hostPubSubPublishedCount].payload, HOST_PUBSUB_STRING_SIZE, "%s", payload);
+        hostPubSubPublished[hostPubSubPublishedCount].retained = retained;
+    }
+
+    hostPubSubPublishedCount++;
+
+    return(true);
+}
+
+bool PubSubClient::subscribe(const char * topic) {
+    (void) topic;
+    return(hostPubSubConnected);
+}
+
+bool PubSubClient::loop(void) {
+
+    // Deliver the queued message like the library (the length counts, the payload is only terminated to keep the host reads in the buffer)
+    if ((hostPubSubConnected == true) && (hostPubSubRxPending == true) && (hostPubSubCallback != NULL)) {
+        hostPubSubRxPending = false;
+        hostPubSubCallback(hostPubSubRxTopic, hostPubSubRxPayload, hostPubSubRxLength);
+    }
+
+    return(hostPubSubConnected);
+}
+
+
+/**
+    Set the result of the next connection attempts.
+
+    @param[in]     accept true when the broker accepts the connection.
+*/
+void hostPubSubAccept(const bool accept) {
+    hostPubSubAccepting = accept;
+}
+
+/**
+    Queue a message from the broker, the callback receives it in the next loop().
+
+    @param[in]     topic pointer to the full topic.
+    @param[in]     payload pointer to the payload.
+*/
+void hostPubSubReceive(const char * const topic, const char * const payload) {
+
+    snprintf(hostPubSubRxTopic, sizeof(hostPubSubRxTopic), "%s", topic);
+    hostPubSubRxLength = min(strlen(payload), (size_t)HOST_PUBSUB_STRING_SIZE);
+    memcpy(hostPubSubRxPayload, payload, hostPubSubRxLength);
+    hostPubSubRxPayload[hostPubSubRxLength] = 0;
+    hostPubSubRxPending = true;
+}
+
+/**
+    Forget the published messages.
+*/
+void hostPubSubClear(void) {
+    hostPubSubPublishedCount = 0;
+}
@@ -0,0 +1,85 @@
+#ifndef PUBSUBCLIENT_H
+#define PUBSUBCLIENT_H
+
+// Host (Linux) replacement for the PubSubClient library
+// The broker is simulated: a test sets the result of a connection, delivers messages and reads back what was published
+
+#include <Arduino.h>
+#include <Client.h>
+
+// Maximum packet size (default of the PubSubClient library)
+#define MQTT_MAX_PACKET_SIZE            (256)
+
+// Callback for a received message
+#define MQTT_CALLBACK_SIGNATURE         void (*callback)(char *, uint8_t *, unsigned int)
+
+// Connection states of the PubSubClient library used on the host
+#define MQTT_CONNECT_FAILED             (-2)
+#define MQTT_DISCONNECTED               (-1)
+#define MQTT_CONNECTED                  (0)
+
+// Maximum number of published messages kept
+#define HOST_PUBSUB_MESSAGES            (32)
+
+// Size of a kept topic and payload
+#define HOST_PUBSUB_STRING_SIZE         (256)
+
+// Published message
+typedef struct {
+    char                    topic[HOST_PUBSUB_STRING_SIZE];     // Full topic
+    char                    payload[HOST_PUBSUB_STRING_SIZE];   // Payload
+    bool                    retained;                           // Retained flag
+} hostPubSubMessage;
+
+
+// MQTT client of the PubSubClient library (one per process on the host)
+class PubSubClient {
+public:
+    PubSubClient(Client & client);
+
+    PubSubClient & setServer(const char * domain, uint16_t port);
+    PubSubClient & setCallback(MQTT_CALLBACK_SIGNATURE);
+    bool setBufferSize(uint16_t size);
+
+    bool connect(const char * id, const char * user, const char * pass, const char * willTopic, uint8_t willQos, bool willRetain, const char * willMessage);
+    void disconnect(void);
+    bool connected(void);
+    int state(void);
+
+    bool publish(const char * topic, const char * payload);
+    bool publish(const char * topic, const char * payload, bool retained);
+    bool subscribe(const char * topic);
+    bool loop(void);
+};
+
+
+// Published messages
+extern hostPubSubMessage hostPubSubPublished[HOST_PUBSUB_MESSAGES];
+
+// Number of published messages
+extern unsigned int hostPubSubPublishedCount;
+
+// Number of connection attempts
+extern unsigned int hostPubSubConnects;
+
+/**
+    Set the result of the next connection attempts.
+
+    @param[in]     accept true when the broker accepts the connection.
+*/
+void hostPubSubAccept(const bool accept);
+
+/**
+    Queue a message from the broker, the callback receives it in the next loop().
+
+    @param[in]     topic pointer to the full topic.
+    @param[in]     payload pointer to the payload.
+*/
+void hostPubSubReceive(const char * const topic, const char * const payload);
+
+/**
+    Forget the published messages.
+*/
+void hostPubSubClear(void);
+
+#endif
@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include <Updater.h>
+
+
+// Updater
+UpdaterClass Update;
+
+// Image written to the updater
+static uint8_t hostUpdaterData[HOST_UPDATER_SIZE_MAX];
+
+// Simulated flash write time (uS)
+static unsigned long hostUpdaterWriteuS = 0;
+
+// Number of bytes the failing write reaches (0 never fails)
+static size_t hostUpdaterFailProgress = 0;
+
+// Last update was completed by end()
+static bool hostUpdaterComplete = false;
+
+
+/**
+    Start an update.
+
+    @param[in]     size size of the image.
+    @return        true when the image fits.
+*/
+bool UpdaterClass::begin(size_t size) {
+
+    updaterSize = 0;
+    updaterProgress = 0;
+    updaterError = 0;
+    hostUpdaterComplete = false;
+
+    if (size > sizeof(hostUpdaterData)) {
+        updaterError = UPDATE_ERROR_SPACE;
+        return(false);
+    }
+
+    updaterSize = size;
+    memset(hostUpdaterData, 0, sizeof(hostUpdaterData));
+
+    return(true);
+}
+
+/**
+    Write the next part of the image.
+
+    @param[in]     data pointer to the data.
+    @param[in]     len length of the data.
+    @return        number of bytes written (0 on an error).
+*/
+size_t UpdaterClass::write(uint8_t * data, size_t len) {
+
+    hostClockAdvance(hostUpdaterWriteuS);
+
+    if ((len > remaining()) || ((hostUpdaterFailProgress > 0) && ((updaterProgress + len) >= hostUpdaterFailProgress))) {
+        updaterError = UPDATE_ERROR_WRITE;
+        return(0);
+    }
+
+    memcpy(hostUpdaterData + updaterProgress, data, len);
+    updaterProgress += len;
+
+    return(len);
+}
+
+/**
+    Finish the update, an incomplete update is abandoned.
+
+    @return        true when the complete image was written.
+*/
+bool UpdaterClass::end(void) {
+
+    hostUpdaterComplete = ((updaterSize > 0) && (updaterProgress == updaterSize) && (updaterError == 0));
+    updaterSize = 0;
+    updaterProgress = 0;
+
+    return(hostUpdaterComplete);
+}
+
+
+/**
+    Get the image written to the updater.
+
+    @return        pointer to the image (HOST_UPDATER_SIZE_MAX bytes).
+*/
+const uint8_t * hostUpdaterImage(void) {
+    return(hostUpdaterData);
+}
+
+/**
+    Set the simulated flash write time of the updater.
+    The clock moves on by this time for every write.
+
+    @param[in]     uS time of a write in uS.
+*/
+void hostUpdaterWriteTime(const unsigned long uS) {
+    hostUpdaterWriteuS = uS;
+}
+
+/**
+    Fail the write that reaches a number of bytes.
+
+    @param[in]     progress number of bytes the failing write reaches (0 never fails).
+*/
+void hostUpdaterFailAt(const size_t progress) {
+    hostUpdaterFailProgress = progress;
+}
+
+/**
+    Check if the last update was completed by end().
+
+    @return        true when the complete image was written.
+*/
+bool hostUpdaterCompleted(void) {
+    return(hostUpdaterComplete);
+}
@@ -0,0 +1,69 @@
+#ifndef UPDATER_H
+#define UPDATER_H
+
+// Host (Linux) replacement for the Updater of the Arduino core
+// The image is kept in memory, a flash write time and a write error can be simulated
+
+#include <Arduino.h>
+
+// Largest image the host updater takes
+#define HOST_UPDATER_SIZE_MAX           (1024 * 1024)
+
+// Error when the image does not fit (same value as the core)
+#define UPDATE_ERROR_SPACE              (4)
+
+// Error when writing the flash failed (same value as the core)
+#define UPDATE_ERROR_WRITE              (1)
+
+
+// Firmware updater (same signatures as the core)
+class UpdaterClass {
+public:
+    bool begin(size_t size);
+    size_t write(uint8_t * data, size_t len);
+    bool end(void);
+
+    uint8_t getError(void) { return(updaterError); }
+    size_t size(void) { return(updaterSize); }
+    size_t progress(void) { return(updaterProgress); }
+    size_t remaining(void) { return(updaterSize - updaterProgress); }
+
+private:
+    size_t updaterSize = 0;
+    size_t updaterProgress = 0;
+    uint8_t updaterError = 0;
+};
+
+extern UpdaterClass Update;
+
+
+/**
+    Get the image written to the updater.
+
+    @return        pointer to the image (HOST_UPDATER_SIZE_MAX bytes).
+*/
+const uint8_t * hostUpdaterImage(void);
+
+/**
+    Set the simulated flash write time of the updater.
+    The clock moves on by this time for every write.
+
+    @param[in]     uS time of a write in uS.
+*/
+void hostUpdaterWriteTime(const unsigned long uS);
+
+/**
+    Fail the write that reaches a number of bytes.
+
+    @param[in]     progress number of bytes the failing write reaches (0 never fails).
+*/
+void hostUpdaterFailAt(const size_t progress);
+
+/**
+    Check if the last update was completed by end().
+
+    @return        true when the complete image was written.
+*/
+bool hostUpdaterCompleted(void);
+
+#endif
@@ -0,0 +1,166 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiManager.h>
+
+
+// Result of autoConnect
+static bool hostWiFiManagerConnects = true;
+
+// Configuration portal is open
+static bool hostWiFiManagerPortalActive = false;
+
+// Configuration portal process calls
+static unsigned int hostWiFiManagerProcessCount = 0;
+
+// WiFi settings resets
+static unsigned int hostWiFiManagerResetCount = 0;
+
+// Callbacks of the configuration portal
+static void (* hostWiFiManagerApCallback)(WiFiManager *) = NULL;
+static void (* hostWiFiManagerSaveCallback)(void) = NULL;
+
+// WiFi manager running the portal
+static WiFiManager * hostWiFiManagerPortalOwner = NULL;
+
+
+WiFiManagerParameter::WiFiManagerParameter(const char * custom) : parameterId(NULL) {
+    (void) custom;
+    parameterValue[0] = '\0';
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char * id, const char * label, const char * defaultValue, int length) : parameterId(id) {
+    (void) label;
+    setValue(defaultValue, length);
+}
+
+void WiFiManagerParameter::setValue(const char * defaultValue, int length) {
+    snprintf(parameterValue, min(sizeof(parameterValue), (size_t)(length + 1)), "%s", defaultValue);
+}
+
+const char * WiFiManagerParameter::getValue(void) const {
+    return(parameterValue);
+}
+
+const char * WiFiManagerParameter::getID(void) const {
+    return(parameterId);
+}
+
+
+void WiFiManager::setDebugOutput(bool debug) {
+    (void) debug;
+}
+
+void WiFiManager::setAPCallback(void (* callback)(WiFiManager *)) {
+    hostWiFiManagerApCallback = callback;
+}
+
+void WiFiManager::setSaveParamsCallback(void (* callback)(void)) {
+    hostWiFiManagerSaveCallback = callback;
+}
+
+void WiFiManager::setConfigPortalBlocking(bool shouldBlock) {
+    (void) shouldBlock;
+}
+
+void WiFiManager::setConfigPortalTimeout(unsigned long seconds) {
+    (void) seconds;
+}
+
+void WiFiManager::setConnectTimeout(unsigned long seconds) {
+    (void) seconds;
+}
+
+void WiFiManager::setBreakAfterConfig(bool shouldBreak) {
+    (void) shouldBreak;
+}
+
+bool WiFiManager::addParameter(WiFiManagerParameter * parameter) {
+    (void) parameter;
+    return(true);
+}
+
+bool WiFiManager::autoConnect(const char * apName, const char * apPassword) {
+    (void) apName;
+    (void) apPassword;
+
+    hostWiFiManagerPortalOwner = this;
+
+    if (hostWiFiManagerConnects == true) {
+        hostWiFiStatus(WL_CONNECTED);
+        hostWiFiGotIp();
+    }
+    else {
+        hostWiFiManagerPortal(true);
+    }
+
+    return(hostWiFiManagerConnects);
+}
+
+bool WiFiManager::getConfigPortalActive(void) {
+    return(hostWiFiManagerPortalActive);
+}
+
+bool WiFiManager::process(void) {
+    hostWiFiManagerProcessCount++;
+    return(false);
+}
+
+void WiFiManager::resetSettings(void) {
+    hostWiFiManagerResetCount++;
+}
+
+String WiFiManager::getConfigPortalSSID(void) {
+    return(String("hostPortal"));
+}
+
+
+/**
+    Set the result of the next autoConnect (false opens the portal).
+
+    @param[in]     connect true when autoConnect connects.
+*/
+void hostWiFiManagerConnect(const bool connect) {
+    hostWiFiManagerConnects = connect;
+}
+
+/**
+    Open or close the configuration portal.
+
+    @param[in]     active true opens the portal.
+*/
+void hostWiFiManagerPortal(const bool active) {
+
+    // Opening calls the AP callback like the library
+    if ((active == true) && (hostWiFiManagerPortalActive == false) && (hostWiFiManagerApCallback != NULL)) {
+        hostWiFiManagerApCallback(hostWiFiManagerPortalOwner);
+    }
+
+    hostWiFiManagerPortalActive = active;
+}
+
+/**
+    Save the portal parameters (calls the save parameters callback like a submitted form).
+*/
+void hostWiFiManagerSave(void) {
+    if (hostWiFiManagerSaveCallback != NULL) {
+        hostWiFiManagerSaveCallback();
+    }
+}
+
+/**
+    Get the number of configuration portal process calls.
+
+    @return        number of process calls.
+*/
+unsigned int hostWiFiManagerProcessed(void) {
+    return(hostWiFiManagerProcessCount);
+}
+
+/**
+    Get the number of WiFi settings resets.
+
+    @return        number of resetSettings calls.
+*/
+unsigned int hostWiFiManagerResets(void) {
+    return(hostWiFiManagerResetCount);
+}
@@ -0,0 +1,80 @@
+#ifndef WIFIMANAGER_H
+#define WIFIMANAGER_H
+
+// Host (Linux) replacement for the WiFiManager library
+// The configuration portal is simulated: a test sets the result of autoConnect and opens / closes the portal
+
+#include <Arduino.h>
+
+// Capacity of a parameter value
+#define HOST_WIFIMANAGER_VALUE_SIZE     (128)
+
+
+// Configuration portal parameter (custom HTML or a field)
+class WiFiManagerParameter {
+public:
+    WiFiManagerParameter(const char * custom);
+    WiFiManagerParameter(const char * id, const char * label, const char * defaultValue, int length);
+
+    void setValue(const char * defaultValue, int length);
+    const char * getValue(void) const;
+    const char * getID(void) const;
+
+private:
+    const char * parameterId;
+    char parameterValue[HOST_WIFIMANAGER_VALUE_SIZE];
+};
+
+// WiFi manager (one configuration portal per process on the host)
+class WiFiManager {
+public:
+    void setDebugOutput(bool debug);
+    void setAPCallback(void (* callback)(WiFiManager *));
+    void setSaveParamsCallback(void (* callback)(void));
+    void setConfigPortalBlocking(bool shouldBlock);
+    void setConfigPortalTimeout(unsigned long seconds);
+    void setConnectTimeout(unsigned long seconds);
+    void setBreakAfterConfig(bool shouldBreak);
+    bool addParameter(WiFiManagerParameter * parameter);
+    bool autoConnect(const char * apName, const char * apPassword);
+    bool getConfigPortalActive(void);
+    bool process(void);
+    void resetSettings(void);
+    String getConfigPortalSSID(void);
+};
+
+
+/**
+    Set the result of the next autoConnect (false opens the portal).
+
+    @param[in]     connect true when autoConnect connects.
+*/
+void hostWiFiManagerConnect(const bool connect);
+
+/**
+    Open or close the configuration portal.
+
+    @param[in]     active true opens the portal.
+*/
+void hostWiFiManagerPortal(const bool active);
+
+/**
+    Save the portal parameters (calls the save parameters callback like a submitted form).
+*/
+void hostWiFiManagerSave(void);
+
+/**
+    Get the number of configuration portal process calls.
+
+    @return        number of process calls.
+*/
+unsigned int hostWiFiManagerProcessed(void);
+
+/**
+    Get the number of WiFi settings resets.
+
+    @return        number of resetSettings calls.
+*/
+unsigned int hostWiFiManagerResets(void);
+
+#endif
@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+
+// Last datagram (terminated)
+char hostUdpDatagram[HOST_UDP_DATAGRAM_SIZE];
+
+// Destination of the last datagram
+uint32_t hostUdpAddress = 0;
+uint16_t hostUdpPort = 0;
+
+// Number of datagrams sent
+unsigned int hostUdpDatagrams = 0;
+
+// Length of the datagram being built
+static size_t hostUdpLength = 0;
+
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    hostUdpAddress = ip;
+    hostUdpPort = port;
+    hostUdpLength = 0;
+    return(1);
+}
+
+size_t WiFiUDP::write(const uint8_t * buffer, size_t size) {
+    size = min(size, sizeof(hostUdpDatagram) - 1 - hostUdpLength);
+    memcpy(hostUdpDatagram + hostUdpLength, buffer, size);
+    hostUdpLength += size;
+    return(size);
+}
+
+int WiFiUDP::endPacket(void) {
+    hostUdpDatagram[hostUdpLength] = 0;
+    hostUdpDatagrams++;
+    return(1);
+}
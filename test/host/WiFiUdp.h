@@ -0,0 +1,33 @@
+#ifndef WIFIUDP_H
+#define WIFIUDP_H
+
+// Host (Linux) replacement for the WiFiUdp library
+// Datagrams are not sent, the last one is kept for the test
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+// Size of the kept datagram
+#define HOST_UDP_DATAGRAM_SIZE          (1024)
+
+
+// UDP socket
+class WiFiUDP {
+public:
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(const uint8_t * buffer, size_t size);
+    int endPacket(void);
+};
+
+
+// Last datagram (terminated)
+extern char hostUdpDatagram[HOST_UDP_DATAGRAM_SIZE];
+
+// Destination of the last datagram
+extern uint32_t hostUdpAddress;
+extern uint16_t hostUdpPort;
+
+// Number of datagrams sent
+extern unsigned int hostUdpDatagrams;
+
+#endif
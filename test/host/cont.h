@@ -0,0 +1,17 @@
+#ifndef CONT_H
+#define CONT_H
+
+// Host (Linux) replacement for the cont (user task context) header of the Arduino core
+// A test sets g_pcont, the core allocates the context on the SYS stack
+
+#include <stdint.h>
+
+// Context of the user task (the host only needs its address)
+typedef struct cont_ {
+    uint32_t                stack_guard1;
+} cont_t;
+
+// Context of the user task
+extern cont_t * g_pcont;
+
+#endif
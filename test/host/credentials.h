@@ -0,0 +1,9 @@
+#ifndef CREDENTIALS_H
+#define CREDENTIALS_H
+
+// Host (Linux) credentials (the firmware uses a copy of include/credentials-template.h that is not in the repository)
+
+// Credentials for ota
+#define OTA_PASSWORD        "PASSWORD"
+
+#endif
@@ -0,0 +1,33 @@
+#include <stddef.h>
+
+#include "host_heap.h"
+
+
+// glibc allocator (wrapped to count the allocations, operator new uses malloc)
+extern "C" void * __libc_malloc(size_t size);
+extern "C" void * __libc_calloc(size_t count, size_t size);
+extern "C" void * __libc_realloc(void * ptr, size_t size);
+extern "C" void __libc_free(void * ptr);
+
+// Number of heap allocations (a test clears it before the code it checks)
+volatile unsigned int hostHeapAllocations = 0;
+
+
+extern "C" void * malloc(size_t size) {
+    hostHeapAllocations++;
+    return(__libc_malloc(size));
+}
+
+extern "C" void * calloc(size_t count, size_t size) {
+    hostHeapAllocations++;
+    return(__libc_calloc(count, size));
+}
+
+extern "C" void * realloc(void * ptr, size_t size) {
+    hostHeapAllocations++;
+    return(__libc_realloc(ptr, size));
+}
+
+extern "C" void free(void * ptr) {
+    __libc_free(ptr);
+}
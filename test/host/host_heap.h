@@ -0,0 +1,10 @@
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+// Host (Linux) heap allocation counter
+// host_heap.cpp wraps the glibc allocator, a test linking it counts every allocation (malloc, calloc, realloc and operator new)
+
+// Number of heap allocations (a test clears it before the code it checks, volatile as the compiler assumes malloc does not change it)
+extern volatile unsigned int hostHeapAllocations;
+
+#endif
@@ -0,0 +1,67 @@
+#include <Arduino.h>
+
+#include "host_stubs.h"
+
+
+// Last NVM status message
+nvmData hostStubNvmData;
+
+// Boot profile messages
+hostStubBootMessage hostStubBootMessages[HOST_STUB_BOOT_MESSAGES];
+
+// Number of boot profile messages
+unsigned int hostStubBootMessageCount = 0;
+
+// Last published log message
+char hostStubLogMessage[HOST_STUB_LOG_MESSAGE_SIZE];
+
+// Number of log messages published / attempted
+unsigned int hostStubLogMessageCount = 0;
+unsigned int hostStubLogMessageAttempts = 0;
+
+// Result of publishing a log message (false simulates a failed MQTT publish)
+bool hostStubLogPublish = true;
+
+
+/**
+    Transmit a NVM status message (host stub, keeps the message).
+
+    @param[in]     nvmDataStructurePtr pointer to the NVM data structure
+*/
+void messsagesTxNvmStatusMessage(const nvmData * const nvmDataStructurePtr) {
+    memcpy(&hostStubNvmData, nvmDataStructurePtr, sizeof(hostStubNvmData));
+}
+
+/**
+    Transmit a boot profile message (host stub, keeps the message).
+
+    @param[in]     bootProfileDataStructurePtr pointer to the boot profile data structure
+*/
+void messsagesTxBootMessage(const bootProfileData * const bootProfileDataStructurePtr) {
+
+    if (hostStubBootMessageCount < HOST_STUB_BOOT_MESSAGES) {
+        hostStubBootMessages[hostStubBootMessageCount].step = *bootProfileDataStructurePtr->stepPtr;
+        hostStubBootMessages[hostStubBootMessageCount].durationuS = *bootProfileDataStructurePtr->durationPtr;
+        hostStubBootMessages[hostStubBootMessageCount].cumulativeuS = *bootProfileDataStructurePtr->cumulativePtr;
+    }
+
+    hostStubBootMessageCount++;
+}
+
+/**
+    Transmit a log message (host stub, keeps the message when the publish succeeds).
+
+    @param[in]     logSinkDataStructurePtr pointer to the log sink data structure
+    @return        true when the message was published.
+*/
+bool messsagesTxLogMessage(const logSinkData * const logSinkDataStructurePtr) {
+
+    hostStubLogMessageAttempts++;
+
+    if (hostStubLogPublish == true) {
+        snprintf(hostStubLogMessage, sizeof(hostStubLogMessage), "%s", logSinkDataStructurePtr->logPtr);
+        hostStubLogMessageCount++;
+    }
+
+    return(hostStubLogPublish);
+}
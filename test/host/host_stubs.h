@@ -0,0 +1,41 @@
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+
+// Host (Linux) stubs for the modules the host tests do not build
+
+#include "messages_tx.h"
+
+// Maximum number of boot profile messages kept
+#define HOST_STUB_BOOT_MESSAGES         (32)
+
+// Size of a kept log message
+#define HOST_STUB_LOG_MESSAGE_SIZE      (512)
+
+// Boot profile message
+typedef struct {
+    const char *            step;               // Step name
+    unsigned long           durationuS;         // Step duration
+    unsigned long           cumulativeuS;       // Time since boot at the end of the step
+} hostStubBootMessage;
+
+
+// Last NVM status message
+extern nvmData hostStubNvmData;
+
+// Boot profile messages
+extern hostStubBootMessage hostStubBootMessages[HOST_STUB_BOOT_MESSAGES];
+
+// Number of boot profile messages
+extern unsigned int hostStubBootMessageCount;
+
+// Last published log message
+extern char hostStubLogMessage[HOST_STUB_LOG_MESSAGE_SIZE];
+
+// Number of log messages published / attempted
+extern unsigned int hostStubLogMessageCount;
+extern unsigned int hostStubLogMessageAttempts;
+
+// Result of publishing a log message (false simulates a failed MQTT publish)
+extern bool hostStubLogPublish;
+
+#endif
@@ -0,0 +1,212 @@
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "host_test.h"
+#include "debug.h"
+
+
+// Directory for the test files
+#ifndef HOST_TEST_BUILD_DIR
+#define HOST_TEST_BUILD_DIR             "build"
+#endif
+
+// Size of the debug log kept for hostTestLogContains
+#define HOST_TEST_LOG_SIZE              (64 * 1024)
+
+// Environment variable that prints the debug log
+#define HOST_TEST_VERBOSE               ("HOST_TEST_VERBOSE")
+
+
+// Log level names (must align with the logLevel enum)
+static const char * hostTestLevelNames[] = {"I", "W", "E"};
+
+// Number of failed checks
+static unsigned int hostTestFailures = 0;
+
+// Number of checks
+static unsigned int hostTestChecks = 0;
+
+// Number of checks of the last boot (shared with the boots)
+static unsigned int * hostTestBootChecks = NULL;
+
+// Debug log since the start of the boot (one message per line)
+static char hostTestLog[HOST_TEST_LOG_SIZE];
+
+// Length of the debug log
+static size_t hostTestLogLength = 0;
+
+
+/**
+    Add a message to the debug log.
+
+    @param[in]     message pointer to the message.
+    @param[in]     module pointer to the module name (NULL when there is no module).
+    @param[in]     level log level.
+*/
+static void hostTestLogAdd(const char * const message, const char * const module, const logLevel level) {
+
+    // Length of the message in the log
+    int length = snprintf(hostTestLog + hostTestLogLength, sizeof(hostTestLog) - hostTestLogLength, "%s %s: %s\n", hostTestLevelNames[level], (module != NULL) ? module : "-", message);
+
+    if (getenv(HOST_TEST_VERBOSE) != NULL) {
+        printf("    %s", hostTestLog + hostTestLogLength);
+    }
+
+    if (length > 0) {
+        hostTestLogLength = min(hostTestLogLength + (size_t)length, sizeof(hostTestLog) - 1);
+    }
+}
+
+
+/**
+    Prints to the log (host replacement for debug.cpp, weak so a test can link the real one).
+
+    @param[in]     message pointer to the message.
+    @param[in]     level log level.
+*/
+__attribute__ ((weak)) void debugLog(const char * const message, logLevel level) {
+    hostTestLogAdd(message, NULL, level);
+}
+
+/**
+    Prints to the log (host replacement for debug.cpp, weak so a test can link the real one).
+
+    @param[in]     message pointer to the message.
+    @param[in]     module pointer to the module name.
+    @param[in]     level log level.
+*/
+__attribute__ ((weak)) void debugLog(const char * const message, const char * const module, logLevel level) {
+    hostTestLogAdd(message, module, level);
+}
+
+
+/**
+    Check a condition and report a failure.
+
+    @param[in]     condition result of the check.
+    @param[in]     text text of the check.
+    @param[in]     file source file of the check.
+    @param[in]     line source line of the check.
+    @return        the condition.
+*/
+bool hostTestCheck(const bool condition, const char * const text, const char * const file, const int line) {
+
+    hostTestChecks++;
+
+    if (condition == false) {
+        hostTestFailures++;
+        printf("FAIL %s:%d: %s\n", file, line, text);
+    }
+
+    return(condition);
+}
+
+/**
+    Run a function in a child process (a boot of the device).
+    The boot ends when the function returns or the simulated flash loses power.
+
+    @param[in]     function function to run.
+    @return        HOST_TEST_BOOT_OK, HOST_TEST_BOOT_FAILED or HOST_FLASH_POWER_LOSS_EXIT.
+*/
+int hostTestBoot(void (* const function)(void)) {
+
+    // Child process
+    pid_t child;
+
+    // Exit status of the child
+    int status = 0;
+
+    if (hostTestBootChecks == NULL) {
+        hostTestBootChecks = (unsigned int *)hostTestShared(sizeof(*hostTestBootChecks));
+    }
+
+    *hostTestBootChecks = 0;
+
+    (void) fflush(stdout);
+    child = fork();
+
+    if (child == 0) {
+        hostTestChecks = 0;
+        hostTestFailures = 0;
+        hostTestLogLength = 0;
+        hostTestLog[0] = '\0';
+
+        function();
+
+        *hostTestBootChecks = hostTestChecks;
+        (void) fflush(stdout);
+        _exit((hostTestFailures == 0) ? HOST_TEST_BOOT_OK : HOST_TEST_BOOT_FAILED);
+    }
+
+    if ((child < 0) || (waitpid(child, &status, 0) != child) || (WIFEXITED(status) == false)) {
+        return(HOST_TEST_BOOT_FAILED);
+    }
+
+    // The checks of a boot that lost power are not counted (the boot never finished)
+    hostTestChecks += *hostTestBootChecks;
+
+    return(WEXITSTATUS(status));
+}
+
+/**
+    Allocate memory shared with the boots (zeroed).
+
+    @param[in]     size size of the memory.
+    @return        pointer to the memory.
+*/
+void * hostTestShared(const size_t size) {
+
+    // Shared memory
+    void * const shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (shared == MAP_FAILED) {
+        printf("FAIL no shared memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return(shared);
+}
+
+/**
+    Open the simulated flash of a test in the build directory.
+
+    @param[in]     name name of the test.
+*/
+void hostTestFlashOpen(const char * const name) {
+
+    // Path of the flash file
+    char path[256];
+
+    (void) snprintf(path, sizeof(path), "%s/%s.flash", HOST_TEST_BUILD_DIR, name);
+
+    if (hostFlashOpen(path) == false) {
+        printf("FAIL cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+    Check if a debug log message containing the text was logged since the start of the boot.
+
+    @param[in]     text text to find.
+    @return        true when a message contains the text.
+*/
+bool hostTestLogContains(const char * const text) {
+    return(strstr(hostTestLog, text) != NULL);
+}
+
+/**
+    Report the result of the test.
+
+    @param[in]     name name of the test.
+    @return        exit code of the test.
+*/
+int hostTestResult(const char * const name) {
+
+    printf("%s: %u checks, %u failed\n", name, hostTestChecks, hostTestFailures);
+
+    return((hostTestFailures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,70 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Host (Linux) test helpers
+// Each "boot" runs in a child process so every module starts with its initial state, the simulated flash is shared
+
+#include <Arduino.h>
+
+// Check a condition, the test continues after a failure
+#define HOST_TEST_CHECK(condition)      hostTestCheck((condition), #condition, __FILE__, __LINE__)
+
+// Exit code of a boot without failed checks
+#define HOST_TEST_BOOT_OK               (0)
+
+// Exit code of a boot with failed checks
+#define HOST_TEST_BOOT_FAILED           (1)
+
+
+/**
+    Check a condition and report a failure.
+
+    @param[in]     condition result of the check.
+    @param[in]     text text of the check.
+    @param[in]     file source file of the check.
+    @param[in]     line source line of the check.
+    @return        the condition.
+*/
+bool hostTestCheck(const bool condition, const char * const text, const char * const file, const int line);
+
+/**
+    Run a function in a child process (a boot of the device).
+    The boot ends when the function returns or the simulated flash loses power.
+
+    @param[in]     function function to run.
+    @return        HOST_TEST_BOOT_OK, HOST_TEST_BOOT_FAILED or HOST_FLASH_POWER_LOSS_EXIT.
+*/
+int hostTestBoot(void (* const function)(void));
+
+/**
+    Allocate memory shared with the boots (zeroed).
+
+    @param[in]     size size of the memory.
+    @return        pointer to the memory.
+*/
+void * hostTestShared(const size_t size);
+
+/**
+    Open the simulated flash of a test in the build directory.
+
+    @param[in]     name name of the test.
+*/
+void hostTestFlashOpen(const char * const name);
+
+/**
+    Check if a debug log message containing the text was logged since the start of the boot.
+
+    @param[in]     text text to find.
+    @return        true when a message contains the text.
+*/
+bool hostTestLogContains(const char * const text);
+
+/**
+    Report the result of the test.
+
+    @param[in]     name name of the test.
+    @return        exit code of the test.
+*/
+int hostTestResult(const char * const name);
+
+#endif
@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include <unistd.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "boot_profile.h"
+
+
+// Time spent in a simulated boot step (uS)
+#define TEST_STEP_TIME                  (2000)
+
+// Number of boot steps in setup() (main.cpp)
+#define TEST_SETUP_STEPS                (13)
+
+// Maximum number of boot steps recorded (BOOT_PROFILE_STEPS)
+#define TEST_RECORDED_STEPS_MAX         (16)
+
+
+// Boot step names (static like the names in main.cpp)
+static const char * const testStepNames[] = {"step0", "step1", "step2", "step3", "step4", "step5", "step6", "step7",
+                                             "step8", "step9", "step10", "step11", "step12", "step13", "step14", "step15",
+                                             "step16", "step17", "step18", "step19"};
+
+
+/**
+    Check the transmitted profile: one message per step ending with the MQTT connection, durations add up to the cumulative times.
+
+    @param[in]     steps number of steps marked before the MQTT connection.
+    @param[in]     stepTime minimum time of a step (uS).
+*/
+static void testCheckProfile(const unsigned int steps, const unsigned long stepTime) {
+
+    // End of the previous step (uS)
+    unsigned long previousuS = 0;
+
+    HOST_TEST_CHECK(hostStubBootMessageCount == (steps + 1));
+    HOST_TEST_CHECK(strcmp(hostStubBootMessages[steps].step, "mqttConnected") == 0);
+    HOST_TEST_CHECK(hostTestLogContains("from boot to MQTT connected") == true);
+
+    for (unsigned int i = 0; (i <= steps) && (i < HOST_STUB_BOOT_MESSAGES); i++) {
+        if (i < steps) {
+            HOST_TEST_CHECK(hostStubBootMessages[i].step == testStepNames[i]);
+        }
+
+        if (i > 0) {
+            HOST_TEST_CHECK(hostStubBootMessages[i].durationuS >= stepTime);
+        }
+
+        HOST_TEST_CHECK(hostStubBootMessages[i].durationuS == (hostStubBootMessages[i].cumulativeuS - previousuS));
+        previousuS = hostStubBootMessages[i].cumulativeuS;
+    }
+}
+
+/**
+    Boot: the steps of setup() and the first MQTT connection are transmitted once.
+*/
+static void testBootSetup(void) {
+
+    for (unsigned int i = 0; i < TEST_SETUP_STEPS; i++) {
+        bootProfileStep(testStepNames[i]);
+        (void) usleep(TEST_STEP_TIME);
+    }
+
+    bootProfileTransmitBootMessage();
+    testCheckProfile(TEST_SETUP_STEPS, TEST_STEP_TIME);
+
+    // Steps and reconnections after the first connection are ignored
+    bootProfileStep(testStepNames[TEST_SETUP_STEPS]);
+    bootProfileTransmitBootMessage();
+    HOST_TEST_CHECK(hostStubBootMessageCount == (TEST_SETUP_STEPS + 1));
+}
+
+/**
+    Boot: more steps than recorded, the first MQTT connection is still transmitted.
+*/
+static void testBootTooManySteps(void) {
+
+    for (unsigned int i = 0; i < (sizeof(testStepNames) / sizeof(testStepNames[0])); i++) {
+        bootProfileStep(testStepNames[i]);
+    }
+
+    (void) usleep(TEST_STEP_TIME);
+    bootProfileTransmitBootMessage();
+
+    testCheckProfile(TEST_RECORDED_STEPS_MAX - 1, 0);
+    HOST_TEST_CHECK(hostStubBootMessages[TEST_RECORDED_STEPS_MAX - 1].durationuS >= TEST_STEP_TIME);
+}
+
+
+int main(void) {
+
+    HOST_TEST_CHECK(hostTestBoot(testBootSetup) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootTooManySteps) == HOST_TEST_BOOT_OK);
+
+    return(hostTestResult("test_boot_profile"));
+}
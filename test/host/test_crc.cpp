@@ -0,0 +1,124 @@
+#include <Arduino.h>
+
+#include "host_test.h"
+#include "crc.h"
+
+
+// Longest block checked against the reference
+#define TEST_CRC_LENGTH_MAX             (300)
+
+// Size of the benchmark block (same as CRC_BENCHMARK_SIZE)
+#define TEST_CRC_BENCHMARK_SIZE         (1024)
+
+// Number of benchmark blocks
+#define TEST_CRC_BENCHMARK_BLOCKS       (20000)
+
+
+/**
+    Calculate the CRC32 one bit at a time (reference, same result as the CRC32 library).
+
+    @param[in]     dataPtr pointer to the data.
+    @param[in]     length length of the data in bytes.
+    @return        CRC of the data.
+*/
+static crc_t testCrcBitwise(const uint8_t * const dataPtr, const size_t length) {
+
+    // Working CRC (pre-inverted)
+    uint32_t crcWorking = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+        crcWorking ^= dataPtr[i];
+
+        for (unsigned int bit = 0; bit < 8; bit++) {
+            crcWorking = (crcWorking >> 1) ^ ((crcWorking & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return(~crcWorking);
+}
+
+/**
+    Time a CRC function over the benchmark blocks.
+
+    @param[in]     function CRC function.
+    @param[in]     dataPtr pointer to the benchmark block.
+    @param[out]    crcPtr pointer to the CRC of the last block.
+    @return        time per block (nS).
+*/
+static uint32_t testCrcTime(crc_t (* const function)(const uint8_t * const, const size_t), const uint8_t * const dataPtr, crc_t * const crcPtr) {
+
+    // Start time (uS)
+    const uint32_t startTime = micros();
+
+    // CRC of the blocks (kept so the loop is not optimised away)
+    crc_t crc = 0;
+
+    for (unsigned int i = 0; i < TEST_CRC_BENCHMARK_BLOCKS; i++) {
+        crc ^= function(dataPtr, TEST_CRC_BENCHMARK_SIZE);
+    }
+
+    *crcPtr = crc;
+
+    return((uint32_t)(((uint64_t)(micros() - startTime) * 1000) / TEST_CRC_BENCHMARK_BLOCKS));
+}
+
+/**
+    Calculate the CRC32 with crcCalculate (signature of the reference).
+
+    @param[in]     dataPtr pointer to the data.
+    @param[in]     length length of the data in bytes.
+    @return        CRC of the data.
+*/
+static crc_t testCrcTable(const uint8_t * const dataPtr, const size_t length) {
+    return(crcCalculate(dataPtr, length));
+}
+
+
+int main(void) {
+
+    // Test data (room for every alignment)
+    static uint8_t data[TEST_CRC_BENCHMARK_SIZE + 4];
+
+    // Results of the benchmark
+    crc_t crcBitwise;
+    crc_t crcTable;
+    uint32_t timeBitwise;
+    uint32_t timeTable;
+
+    // Number of mismatches
+    unsigned int mismatches = 0;
+
+    for (unsigned int i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    // Check value of the CRC32
+    HOST_TEST_CHECK(crcCalculate("123456789", 9) == 0xCBF43926);
+    HOST_TEST_CHECK(crcCalculate(data, 0) == 0);
+
+    // Every length and alignment (the table driven CRC handles the unaligned head and the tail bytewise)
+    for (unsigned int offset = 0; offset < 4; offset++) {
+        for (unsigned int length = 0; length <= TEST_CRC_LENGTH_MAX; length++) {
+            mismatches += (crcCalculate(data + offset, length) != testCrcBitwise(data + offset, length)) ? 1 : 0;
+        }
+    }
+    HOST_TEST_CHECK(mismatches == 0);
+
+    // Blocks continued with crcUpdate
+    mismatches = 0;
+    for (unsigned int split = 0; split <= TEST_CRC_LENGTH_MAX; split++) {
+        mismatches += (crcUpdate(crcCalculate(data + 1, split), data + 1 + split, TEST_CRC_LENGTH_MAX - split) != testCrcBitwise(data + 1, TEST_CRC_LENGTH_MAX)) ? 1 : 0;
+    }
+    HOST_TEST_CHECK(mismatches == 0);
+
+    // Benchmark (host timings only compare the two implementations, the target numbers come from CRC_BENCHMARK)
+    timeBitwise = testCrcTime(testCrcBitwise, data, &crcBitwise);
+    timeTable = testCrcTime(testCrcTable, data, &crcTable);
+
+    HOST_TEST_CHECK(crcBitwise == crcTable);
+    HOST_TEST_CHECK(timeTable < timeBitwise);
+
+    printf("test_crc: %u bytes: bitwise %luns, table %luns (%.1fx)\n", TEST_CRC_BENCHMARK_SIZE, (unsigned long)timeBitwise, (unsigned long)timeTable, (timeTable > 0) ? ((double)timeBitwise / timeTable) : 0.0);
+
+    return(hostTestResult("test_crc"));
+}
@@ -0,0 +1,245 @@
+#include <Arduino.h>
+#include <Client.h>
+#include <Updater.h>
+
+#include "host_test.h"
+#include "hawkbit_download.h"
+
+
+// Size of the test image (not a whole number of chunks)
+#define TEST_IMAGE_SIZE                 (100 * 1024 + 123)
+
+// Simulated flash write time of a chunk (uS)
+#define TEST_WRITE_TIME                 (2000)
+
+// Maximum number of slices for a download
+#define TEST_SLICES_MAX                 (10000)
+
+
+// HTTP stand-in: serves the body of the image response as it arrives from the network
+class testHttpServer : public Client {
+public:
+    testHttpServer(const uint8_t * const image, const size_t size) : serverImage(image), serverSize(size) {}
+
+    // Data arrives from the network
+    void deliver(const size_t size) {
+        serverArrived = min(serverArrived + size, serverSize);
+    }
+
+    // Server closes the connection
+    void close(void) {
+        serverConnected = false;
+    }
+
+    int available(void) {
+        return((int)(serverArrived - serverRead));
+    }
+
+    int read(uint8_t * buffer, size_t size) {
+        const size_t length = min(size, serverArrived - serverRead);
+
+        memcpy(buffer, serverImage + serverRead, length);
+        serverRead += length;
+
+        return((int)length);
+    }
+
+    uint8_t connected(void) {
+        return(serverConnected ? 1 : 0);
+    }
+
+private:
+    const uint8_t * serverImage;
+    size_t serverSize;
+    size_t serverArrived = 0;
+    size_t serverRead = 0;
+    bool serverConnected = true;
+};
+
+
+// Test image
+static uint8_t testImage[TEST_IMAGE_SIZE];
+
+
+/**
+    Start the updater and the download of the test image.
+*/
+static void testBegin(void) {
+
+    hostUpdaterWriteTime(0);
+    hostUpdaterFailAt(0);
+
+    HOST_TEST_CHECK(Update.begin(sizeof(testImage)) == true);
+    hawkbitDownloadBegin();
+}
+
+/**
+    The image arrives faster than it is written, every slice stops after HAWKBIT_DOWNLOAD_SLICE_MS.
+*/
+static void testFastNetwork(void) {
+
+    // HTTP stand-in with the complete image waiting
+    testHttpServer server(testImage, sizeof(testImage));
+
+    // Status of the download
+    hawkbitDownloadStatus status = hawkbitDownloadRunning;
+
+    // Progress before the slice
+    size_t progress;
+
+    // Number of slices
+    unsigned int slices = 0;
+
+    // Largest number of bytes written by a slice
+    size_t sliceBytesMax = 0;
+
+    testBegin();
+    hostUpdaterWriteTime(TEST_WRITE_TIME);
+    server.deliver(sizeof(testImage));
+
+    while ((status == hawkbitDownloadRunning) && (slices < TEST_SLICES_MAX)) {
+        progress = Update.progress();
+        status = hawkbitDownloadSlice(server);
+        sliceBytesMax = max(sliceBytesMax, Update.progress() - progress);
+        slices++;
+    }
+
+    HOST_TEST_CHECK(status == hawkbitDownloadComplete);
+    HOST_TEST_CHECK(memcmp(hostUpdaterImage(), testImage, sizeof(testImage)) == 0);
+    HOST_TEST_CHECK(Update.end() == true);
+
+    // A slice writes the chunks that fit into the slice time (plus the one running when the time is up)
+    HOST_TEST_CHECK(sliceBytesMax <= (((HAWKBIT_DOWNLOAD_SLICE_MS * 1000 / TEST_WRITE_TIME) + 1) * HAWKBIT_DOWNLOAD_CHUNK_SIZE));
+    HOST_TEST_CHECK(slices > (sizeof(testImage) / sliceBytesMax));
+
+    printf("test_hawkbit_download: %u bytes in %u slices of up to %lu bytes\n", TEST_IMAGE_SIZE, slices, (unsigned long)sliceBytesMax);
+}
+
+/**
+    The image arrives slowly and with gaps, the download waits for it.
+*/
+static void testSlowNetwork(void) {
+
+    // HTTP stand-in
+    testHttpServer server(testImage, sizeof(testImage));
+
+    // Status of the download
+    hawkbitDownloadStatus status = hawkbitDownloadRunning;
+
+    // Number of slices
+    unsigned int slices = 0;
+
+    testBegin();
+
+    while ((status == hawkbitDownloadRunning) && (slices < TEST_SLICES_MAX)) {
+
+        // Every third slice nothing arrives, an odd size so the chunks are not aligned
+        if ((slices % 3) != 2) {
+            server.deliver(777);
+        }
+
+        status = hawkbitDownloadSlice(server);
+        hostClockAdvance(10 * 1000);
+        slices++;
+
+        if (status == hawkbitDownloadRunning) {
+            HOST_TEST_CHECK(Update.progress() < sizeof(testImage));
+        }
+    }
+
+    HOST_TEST_CHECK(status == hawkbitDownloadComplete);
+    HOST_TEST_CHECK(memcmp(hostUpdaterImage(), testImage, sizeof(testImage)) == 0);
+    HOST_TEST_CHECK(Update.end() == true);
+}
+
+/**
+    The server stops sending, the download fails after HAWKBIT_DOWNLOAD_TIMEOUT_MS without data.
+*/
+static void testTimeout(void) {
+
+    // HTTP stand-in
+    testHttpServer server(testImage, sizeof(testImage));
+
+    testBegin();
+    server.deliver(sizeof(testImage) / 2);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadRunning);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadRunning);
+
+    hostClockAdvance((HAWKBIT_DOWNLOAD_TIMEOUT_MS - 1000) * 1000);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadRunning);
+
+    // Data resets the timeout
+    server.deliver(100);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadRunning);
+    hostClockAdvance((HAWKBIT_DOWNLOAD_TIMEOUT_MS - 1000) * 1000);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadRunning);
+
+    hostClockAdvance(2000 * 1000);
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadTimeout);
+    HOST_TEST_CHECK(Update.progress() == ((sizeof(testImage) / 2) + 100));
+    HOST_TEST_CHECK(Update.end() == false);
+}
+
+/**
+    The server closes the connection early, the data that arrived is written first.
+*/
+static void testClosed(void) {
+
+    // HTTP stand-in
+    testHttpServer server(testImage, sizeof(testImage));
+
+    // Status of the download
+    hawkbitDownloadStatus status = hawkbitDownloadRunning;
+
+    // Number of slices
+    unsigned int slices = 0;
+
+    testBegin();
+    hostUpdaterWriteTime(TEST_WRITE_TIME);
+    server.deliver(sizeof(testImage) / 2);
+    server.close();
+
+    while ((status == hawkbitDownloadRunning) && (slices < TEST_SLICES_MAX)) {
+        status = hawkbitDownloadSlice(server);
+        slices++;
+    }
+
+    HOST_TEST_CHECK(slices > 1);
+    HOST_TEST_CHECK(status == hawkbitDownloadClosed);
+    HOST_TEST_CHECK(Update.progress() == (sizeof(testImage) / 2));
+    HOST_TEST_CHECK(Update.end() == false);
+}
+
+/**
+    The updater fails to write, the download stops straight away.
+*/
+static void testWriteError(void) {
+
+    // HTTP stand-in
+    testHttpServer server(testImage, sizeof(testImage));
+
+    testBegin();
+    hostUpdaterFailAt(5000);
+    server.deliver(sizeof(testImage));
+
+    HOST_TEST_CHECK(hawkbitDownloadSlice(server) == hawkbitDownloadWriteError);
+    HOST_TEST_CHECK(Update.getError() == UPDATE_ERROR_WRITE);
+    HOST_TEST_CHECK(Update.progress() < 5000);
+    HOST_TEST_CHECK(Update.end() == false);
+}
+
+
+int main(void) {
+
+    for (unsigned int i = 0; i < sizeof(testImage); i++) {
+        testImage[i] = (uint8_t)((i * 131) ^ (i >> 8));
+    }
+
+    testFastNetwork();
+    testSlowNetwork();
+    testTimeout();
+    testClosed();
+    testWriteError();
+
+    return(hostTestResult("test_hawkbit_download"));
+}
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+
+#include "host_test.h"
+#include "hawkbit_poll.h"
+
+
+// Delays drawn per case (covers the jitter range)
+#define TEST_DRAWS                      (2000)
+
+// Server interval above the backoff maximum (2 hours in S)
+#define TEST_LONG_SLEEP_S               (7200)
+
+
+/**
+    Draw delays and check they stay within the jitter range of an interval.
+
+    @param[in]     pollStatePtr pointer to the poll state.
+    @param[in]     pollDelay interval before jitter in S.
+*/
+static void testDelayRange(const hawkbitPollState * const pollStatePtr, const uint32_t pollDelay) {
+
+    // Maximum jitter of the interval
+    const uint32_t jitter = (pollDelay * HAWKBIT_POLL_JITTER_PERCENT) / 100;
+
+    // Smallest and largest delay drawn
+    uint32_t lowest = UINT32_MAX;
+    uint32_t highest = 0;
+
+    // Delay drawn
+    uint32_t delay;
+
+    for (unsigned int i = 0; i < TEST_DRAWS; i++) {
+        delay = hawkbitPollGetDelay(pollStatePtr);
+        lowest = min(lowest, delay);
+        highest = max(highest, delay);
+    }
+
+    HOST_TEST_CHECK(lowest >= (pollDelay - jitter));
+    HOST_TEST_CHECK(highest <= (pollDelay + jitter));
+
+    // The jitter is used (both sides of the interval are drawn)
+    if (jitter > 0) {
+        HOST_TEST_CHECK(lowest < pollDelay);
+        HOST_TEST_CHECK(highest > pollDelay);
+    }
+}
+
+/**
+    The first poll is spread from the earliest first poll up to the default interval.
+*/
+static void testFirstPoll(void) {
+
+    // Poll state after init
+    const hawkbitPollState pollState = {HAWKBIT_POLL_SLEEP_DEFAULT_S, 0, false, true};
+
+    // Smallest and largest delay drawn
+    uint32_t lowest = UINT32_MAX;
+    uint32_t highest = 0;
+
+    // Delay drawn
+    uint32_t delay;
+
+    for (unsigned int i = 0; i < TEST_DRAWS; i++) {
+        delay = hawkbitPollGetDelay(&pollState);
+        lowest = min(lowest, delay);
+        highest = max(highest, delay);
+    }
+
+    HOST_TEST_CHECK(lowest >= HAWKBIT_POLL_FIRST_MIN_S);
+    HOST_TEST_CHECK(highest <= HAWKBIT_POLL_SLEEP_DEFAULT_S);
+    HOST_TEST_CHECK((highest - lowest) > (HAWKBIT_POLL_SLEEP_DEFAULT_S / 2));
+}
+
+/**
+    A successful poll uses the server interval, an active action polls fast even with a long server interval.
+*/
+static void testInterval(void) {
+
+    // Poll state after a successful poll
+    hawkbitPollState pollState = {HAWKBIT_POLL_SLEEP_DEFAULT_S, 0, false, false};
+
+    testDelayRange(&pollState, HAWKBIT_POLL_SLEEP_DEFAULT_S);
+
+    pollState.sleep = HAWKBIT_POLL_SLEEP_MIN_S;
+    testDelayRange(&pollState, HAWKBIT_POLL_SLEEP_MIN_S);
+
+    pollState.sleep = HAWKBIT_POLL_SLEEP_MAX_S;
+    testDelayRange(&pollState, HAWKBIT_POLL_SLEEP_MAX_S);
+
+    pollState.actionActive = true;
+    testDelayRange(&pollState, HAWKBIT_POLL_ACTIVE_S);
+}
+
+/**
+    Failed polls double the interval up to the backoff maximum, the shift stops at its maximum.
+*/
+static void testBackoff(void) {
+
+    // Poll state after failed polls (the action is ignored while polls fail)
+    hawkbitPollState pollState = {HAWKBIT_POLL_SLEEP_MIN_S, 0, true, false};
+
+    // Interval of the failed polls
+    uint32_t pollDelay;
+
+    for (uint32_t errors = 1; errors <= (HAWKBIT_POLL_BACKOFF_SHIFT_MAX + 4); errors++) {
+        pollState.errors = errors;
+        pollDelay = HAWKBIT_POLL_SLEEP_MIN_S << min(errors, (uint32_t)HAWKBIT_POLL_BACKOFF_SHIFT_MAX);
+        testDelayRange(&pollState, pollDelay);
+    }
+
+    // The default interval reaches the backoff maximum
+    pollState.sleep = HAWKBIT_POLL_SLEEP_DEFAULT_S;
+    pollState.errors = 1;
+    testDelayRange(&pollState, 2 * HAWKBIT_POLL_SLEEP_DEFAULT_S);
+
+    pollState.errors = HAWKBIT_POLL_BACKOFF_SHIFT_MAX;
+    testDelayRange(&pollState, HAWKBIT_POLL_BACKOFF_MAX_S);
+
+    pollState.errors = 1000;
+    testDelayRange(&pollState, HAWKBIT_POLL_BACKOFF_MAX_S);
+}
+
+/**
+    A server interval above the backoff maximum is never cut short by failed polls.
+*/
+static void testLongInterval(void) {
+
+    // Poll state with a long server interval
+    hawkbitPollState pollState = {TEST_LONG_SLEEP_S, 0, false, false};
+
+    testDelayRange(&pollState, TEST_LONG_SLEEP_S);
+
+    for (uint32_t errors = 1; errors <= (HAWKBIT_POLL_BACKOFF_SHIFT_MAX + 1); errors++) {
+        pollState.errors = errors;
+        testDelayRange(&pollState, TEST_LONG_SLEEP_S);
+    }
+
+    pollState.sleep = HAWKBIT_POLL_SLEEP_MAX_S;
+    pollState.errors = HAWKBIT_POLL_BACKOFF_SHIFT_MAX;
+    testDelayRange(&pollState, HAWKBIT_POLL_SLEEP_MAX_S);
+}
+
+/**
+    The server interval is read as "HH:MM:SS" and limited, anything else keeps the current interval.
+*/
+static void testParseSleep(void) {
+
+    HOST_TEST_CHECK(hawkbitPollParseSleep("00:05:00", 1) == 300);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("02:00:00", 1) == TEST_LONG_SLEEP_S);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("01:02:03", 1) == 3723);
+
+    // Limits
+    HOST_TEST_CHECK(hawkbitPollParseSleep("00:00:00", 1) == HAWKBIT_POLL_SLEEP_MIN_S);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("00:00:09", 1) == HAWKBIT_POLL_SLEEP_MIN_S);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("24:00:00", 1) == HAWKBIT_POLL_SLEEP_MAX_S);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("99:00:00", 1) == HAWKBIT_POLL_SLEEP_MAX_S);
+
+    // Not sent or not valid
+    HOST_TEST_CHECK(hawkbitPollParseSleep(NULL, 123) == 123);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("", 123) == 123);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("300", 123) == 123);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("00:05", 123) == 123);
+    HOST_TEST_CHECK(hawkbitPollParseSleep("aa:bb:cc", 123) == 123);
+}
+
+
+int main(void) {
+
+    testFirstPoll();
+    testInterval();
+    testBackoff();
+    testLongInterval();
+    testParseSleep();
+
+    return(hostTestResult("test_hawkbit_poll"));
+}
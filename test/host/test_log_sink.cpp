@@ -0,0 +1,224 @@
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+#include "wifi.h"
+#include "log_sink.h"
+
+
+// Calls of the log sink task per batch time (LOG_SINK_BATCH_TIME_S / LOG_SINK_CYCLIC_RATE)
+#define TEST_BATCH_CALLS                (2000 / LOG_SINK_CYCLIC_RATE)
+
+// Records that force a batch (LOG_SINK_FLUSH_THRESHOLD)
+#define TEST_FLUSH_RECORDS              (6)
+
+// Header of the test records (same format as debug.cpp)
+#define TEST_HEADER                     "[I0000012345ms] "
+
+// Longest module name
+#define TEST_MODULE                     "ultrasonicsCtrl"
+
+// Maximum number of task calls to empty the ring buffer
+#define TEST_CALLS_MAX                  (1000)
+
+
+// The syslog and default (off) builds of log_sink.cpp (renamed, see the Makefile)
+void logSinkUdpInit(void);
+void logSinkUdpReinit(void);
+void logSinkUdpRecord(const logLevel level, const char * const header, const char * const module, const char * const message);
+void logSinkUdpCyclicTask(void);
+void logSinkOffInit(void);
+void logSinkOffRecord(const logLevel level, const char * const header, const char * const module, const char * const message);
+void logSinkOffCyclicTask(void);
+
+// Test module
+static wifiModuleDetail testModuleDetail = {"00:00:00:00:00:00", "testAlarm", alarmModule};
+
+// Full length debug messages
+static char testMessages[TEST_FLUSH_RECORDS + 1][DEBUG_MESSAGE_SIZE + 1];
+
+
+wifiModuleDetail * const getWiFiModuleDetails(void) {
+    return(&testModuleDetail);
+}
+
+bool wifiIsConnected(void) {
+    return(true);
+}
+
+
+/**
+    Run the log sink task.
+
+    @param[in]     task log sink task.
+    @param[in]     calls number of calls.
+*/
+static void testRun(void (* const task)(void), const unsigned int calls) {
+
+    for (unsigned int i = 0; i < calls; i++) {
+        task();
+    }
+}
+
+/**
+    Set the MQTT server (the syslog server).
+
+    @param[in]     server pointer to the server name or address.
+*/
+static void testServer(const char * const server) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+    snprintf(ramMirrorPtr->mqtt.mqttServer, sizeof(ramMirrorPtr->mqtt.mqttServer), "%s", server);
+}
+
+/**
+    MQTT: full length records are kept until the publish succeeds, a failed batch waits for the batch time.
+*/
+static void testMqtt(void) {
+
+    // Records found in the published batches
+    unsigned int found = 0;
+
+    logSinkInit();
+    hostStubLogPublish = false;
+
+    logSinkRecord(info, TEST_HEADER, TEST_MODULE, testMessages[0]);
+    testRun(logSinkCyclicTask, TEST_BATCH_CALLS);
+    HOST_TEST_CHECK(hostStubLogMessageAttempts == 1);
+    HOST_TEST_CHECK(hostStubLogMessageCount == 0);
+
+    // Filling up does not retry the failed batch before the batch time
+    for (unsigned int i = 1; i < TEST_FLUSH_RECORDS + 1; i++) {
+        logSinkRecord(warning, TEST_HEADER, TEST_MODULE, testMessages[i]);
+    }
+    testRun(logSinkCyclicTask, TEST_BATCH_CALLS - 1);
+    HOST_TEST_CHECK(hostStubLogMessageAttempts == 1);
+
+    testRun(logSinkCyclicTask, 1);
+    HOST_TEST_CHECK(hostStubLogMessageAttempts == 2);
+    HOST_TEST_CHECK(hostStubLogMessageCount == 0);
+
+    // Publish works again, every record is sent in order with the full message
+    hostStubLogPublish = true;
+    for (unsigned int i = 0; (i < TEST_CALLS_MAX) && (found < (TEST_FLUSH_RECORDS + 1)); i++) {
+        const unsigned int count = hostStubLogMessageCount;
+
+        logSinkCyclicTask();
+
+        if (hostStubLogMessageCount != count) {
+            found += (strstr(hostStubLogMessage, testMessages[found]) != NULL) ? 1 : 0;
+            HOST_TEST_CHECK(strstr(hostStubLogMessage, TEST_HEADER TEST_MODULE ": ") != NULL);
+        }
+    }
+    HOST_TEST_CHECK(found == (TEST_FLUSH_RECORDS + 1));
+    HOST_TEST_CHECK(hostTestLogContains("log sink dropped") == false);
+}
+
+/**
+    Syslog: the server must be an IP address (no DNS lookup), checked again after a configuration change.
+*/
+static void testSyslog(void) {
+
+    testServer("broker.local");
+    logSinkUdpInit();
+    logSinkUdpRecord(error, TEST_HEADER, TEST_MODULE, testMessages[0]);
+    testRun(logSinkUdpCyclicTask, 3 * TEST_BATCH_CALLS);
+
+    HOST_TEST_CHECK(hostUdpDatagrams == 0);
+    HOST_TEST_CHECK(hostTestLogContains("Syslog needs the MQTT server as an IP address, broker.local is not one") == true);
+
+    testServer("192.168.1.10");
+    logSinkUdpReinit();
+    testRun(logSinkUdpCyclicTask, TEST_BATCH_CALLS);
+
+    HOST_TEST_CHECK(hostUdpDatagrams == 1);
+    HOST_TEST_CHECK(hostUdpAddress == ((10U << 24) | (1U << 16) | (168U << 8) | 192U));
+    HOST_TEST_CHECK(hostUdpPort == 514);
+    HOST_TEST_CHECK(strncmp(hostUdpDatagram, "<131>testAlarm: ", 16) == 0);
+    HOST_TEST_CHECK(strstr(hostUdpDatagram, testMessages[0]) != NULL);
+}
+
+/**
+    Overfill the ring buffer with mixed levels: the oldest record of the lowest severity goes first,
+    a record less severe than everything buffered is dropped itself, the drops are counted per level.
+*/
+static void testOverfill(void) {
+
+    // Levels of the records in the order they are logged
+    static const logLevel levels[] = {error,   error,   error,   error,             // r00 - r03 kept
+                                      warning, warning, warning, warning,           // r04 - r07 dropped by r16 - r19
+                                      info,    info,    info,    info,              // r08 - r11 dropped by r12 - r15
+                                      error,   error,   error,   error,             // r12 - r15 kept
+                                      warning, warning, warning, warning,           // r16 - r17 dropped by r22 - r23
+                                      info,    info,                                // r20 - r21 dropped (less severe than the ring)
+                                      warning, warning};                            // r22 - r23 kept
+
+    // Short record text
+    char text[8];
+
+    logSinkUdpInit();
+
+    for (unsigned int i = 0; i < (sizeof(levels) / sizeof(levels[0])); i++) {
+        snprintf(text, sizeof(text), "r%02u", i);
+        logSinkUdpRecord(levels[i], "", NULL, text);
+    }
+
+    // The full ring goes out in one datagram with the drop report first
+    testRun(logSinkUdpCyclicTask, 1);
+
+    HOST_TEST_CHECK(hostUdpDatagrams == 2);
+    HOST_TEST_CHECK(strcmp(hostUdpDatagram, "<131>testAlarm: log sink dropped 12 records (E0 W6 I6)\n"
+                                            "r00\nr01\nr02\nr03\nr12\nr13\nr14\nr15\nr18\nr19\nr22\nr23") == 0);
+
+    // Released and the drop counters cleared
+    testRun(logSinkUdpCyclicTask, 3 * TEST_BATCH_CALLS);
+    HOST_TEST_CHECK(hostUdpDatagrams == 2);
+
+    logSinkUdpRecord(info, "", NULL, "r24");
+    testRun(logSinkUdpCyclicTask, TEST_BATCH_CALLS);
+    HOST_TEST_CHECK(hostUdpDatagrams == 3);
+    HOST_TEST_CHECK(strcmp(hostUdpDatagram, "<134>testAlarm: r24") == 0);
+}
+
+/**
+    Default build: the log sink is off, nothing is buffered or sent.
+*/
+static void testOff(void) {
+
+    // Counts before
+    const unsigned int attempts = hostStubLogMessageAttempts;
+    const unsigned int datagrams = hostUdpDatagrams;
+
+    logSinkOffInit();
+    for (unsigned int i = 0; i < (TEST_FLUSH_RECORDS + 1); i++) {
+        logSinkOffRecord(error, TEST_HEADER, TEST_MODULE, testMessages[i]);
+    }
+    testRun(logSinkOffCyclicTask, 3 * TEST_BATCH_CALLS);
+
+    HOST_TEST_CHECK(hostStubLogMessageAttempts == attempts);
+    HOST_TEST_CHECK(hostUdpDatagrams == datagrams);
+}
+
+
+int main(void) {
+
+    // Messages of DEBUG_MESSAGE_SIZE characters, unique at the start
+    for (unsigned int i = 0; i < (TEST_FLUSH_RECORDS + 1); i++) {
+        memset(testMessages[i], 'a' + i, DEBUG_MESSAGE_SIZE);
+        testMessages[i][0] = '0' + i;
+        testMessages[i][DEBUG_MESSAGE_SIZE] = 0;
+    }
+
+    testMqtt();
+    testSyslog();
+    testOverfill();
+    testOff();
+
+    return(hostTestResult("test_log_sink"));
+}
@@ -0,0 +1,279 @@
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <ArduinoJson.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "host_heap.h"
+#include "messages_tx.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+#include "wifi.h"
+#include "mqtt.h"
+#include "alarm.h"
+#include "garage_door.h"
+#include "reset_ctrl.h"
+#include "journal.h"
+#include "boot_profile.h"
+#include "config.h"
+
+extern "C" {
+#include <user_interface.h>
+}
+
+
+// Root topic and host name of the test module
+#define TEST_TOPIC_ROOT                 "home"
+#define TEST_HOST_NAME                  "testAlarm"
+#define TEST_TOPIC_BASE                 TEST_TOPIC_ROOT "/" TEST_HOST_NAME "/"
+
+// Largest stack frame of the MQTT receive and send functions (bytes, the buffers are static)
+#define TEST_STACK_FRAME_MAX            (128)
+
+// Log record sent in the log message (like a batch of the log sink)
+#define TEST_LOG_RECORD                 "E 1234 wifi: connection lost"
+
+// Exception cause of the previous boot
+#define TEST_EXCEPTION_CAUSE            (29)
+
+
+// Test module (alarm module, subscribes to the alarm commands)
+static wifiModuleDetail testModuleDetail = {"00:00:00:00:00:00", TEST_HOST_NAME, alarmModule};
+
+// Calls of the stubbed modules
+static unsigned int testAlarmOneShots = 0;
+static unsigned int testGarageDoorOneShots = 0;
+static unsigned int testConfigCommands = 0;
+static int testResetRequest = -1;
+
+
+wifiModuleDetail * const getWiFiModuleDetails(void) {
+    return(&testModuleDetail);
+}
+
+bool wifiIsConnected(void) {
+    return(true);
+}
+
+void alarmFireOneShot(void) {
+    testAlarmOneShots++;
+}
+
+void garageDoorFireOneShot(void) {
+    testGarageDoorOneShots++;
+}
+
+void restCtrlSetResetRequest(const resetCtrlTypes reqeustedRest) {
+    testResetRequest = (int)reqeustedRest;
+}
+
+/**
+    Module config command (host stub, replies like config.cpp).
+
+    @param[in]     docPtr pointer to the JSON document holding the command.
+*/
+void configCommand(JsonDocument * const docPtr) {
+    testConfigCommands++;
+    mqttMessageSendRaw("config values", docPtr->containsKey("get") ? "{\"get\":1}" : "{}");
+}
+
+
+/**
+    Check a published message.
+
+    @param[in]     index index of the published message.
+    @param[in]     topic pointer to the expected full topic.
+    @param[in]     payload pointer to the expected payload.
+*/
+static void testPublished(const unsigned int index, const char * const topic, const char * const payload) {
+
+    HOST_TEST_CHECK(index < hostPubSubPublishedCount);
+
+    if (index < min(hostPubSubPublishedCount, (unsigned int)HOST_PUBSUB_MESSAGES)) {
+        HOST_TEST_CHECK(strcmp(hostPubSubPublished[index].topic, topic) == 0);
+        HOST_TEST_CHECK(strcmp(hostPubSubPublished[index].payload, payload) == 0);
+    }
+}
+
+/**
+    Check the start of a published message.
+
+    @param[in]     index index of the published message.
+    @param[in]     topic pointer to the expected full topic.
+    @param[in]     payload pointer to the expected start of the payload.
+*/
+static void testPublishedStart(const unsigned int index, const char * const topic, const char * const payload) {
+
+    HOST_TEST_CHECK(index < hostPubSubPublishedCount);
+
+    if (index < min(hostPubSubPublishedCount, (unsigned int)HOST_PUBSUB_MESSAGES)) {
+        HOST_TEST_CHECK(strcmp(hostPubSubPublished[index].topic, topic) == 0);
+        HOST_TEST_CHECK(strncmp(hostPubSubPublished[index].payload, payload, strlen(payload)) == 0);
+    }
+}
+
+/**
+    Send while disconnected through messages_tx: the reconnection sends the LWT, the message keeps its payload.
+    The boot profile and the crash message (same messages_tx buffers) follow from the client loop.
+*/
+static void testSendReconnect(void) {
+
+    // Dropped records of the log message
+    const unsigned long dropped = 3;
+
+    // Log message (like the log sink)
+    const logSinkData logData = {"log", TEST_LOG_RECORD, "dropped", &dropped};
+
+    // Previous boot crashed, boot steps before the MQTT connection
+    hostResetReason(REASON_EXCEPTION_RST, TEST_EXCEPTION_CAUSE);
+    journalInit();
+    bootProfileStep("preSetup");
+    bootProfileStep("setupWifi");
+
+    hostPubSubAccept(false);
+    mqttSetup();
+    HOST_TEST_CHECK(hostPubSubConnects == 1);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 0);
+    HOST_TEST_CHECK(hostTestLogContains("MQTT connection to") == true);
+
+    // Broker still refuses, nothing is published
+    HOST_TEST_CHECK(messsagesTxLogMessage(&logData) == false);
+    mqttClientLoop();
+    HOST_TEST_CHECK(hostPubSubConnects == 2);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 0);
+
+    hostPubSubAccept(true);
+    hostHeapAllocations = 0;
+    HOST_TEST_CHECK(messsagesTxLogMessage(&logData) == true);
+
+    HOST_TEST_CHECK(hostHeapAllocations == 0);
+    HOST_TEST_CHECK(hostPubSubConnects == 3);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 2);
+    testPublished(0, TEST_TOPIC_BASE "module status", "online");
+    testPublished(1, TEST_TOPIC_BASE "module log", "{\"log\":\"" TEST_LOG_RECORD "\",\"dropped\":3}");
+    HOST_TEST_CHECK(hostPubSubPublished[0].retained == true);
+    HOST_TEST_CHECK(hostTestLogContains("MQTT TX message [" TEST_TOPIC_BASE "module log" "]: {\"log\"") == true);
+
+    // Boot profile (one message per step) and crash message from the client loop
+    hostPubSubClear();
+    hostHeapAllocations = 0;
+    mqttClientLoop();
+    HOST_TEST_CHECK(hostHeapAllocations == 0);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 4);
+    testPublishedStart(0, TEST_TOPIC_BASE "module boot", "{\"step\":\"preSetup\",\"duration\":");
+    testPublishedStart(1, TEST_TOPIC_BASE "module boot", "{\"step\":\"setupWifi\",\"duration\":");
+    testPublishedStart(2, TEST_TOPIC_BASE "module boot", "{\"step\":\"mqttConnected\",\"duration\":");
+    testPublishedStart(3, TEST_TOPIC_BASE "module crash", "{\"reason\":\"exception\",\"exception\":29,");
+
+    // Only once
+    hostPubSubClear();
+    mqttClientLoop();
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 0);
+
+    // Connected, a send is published straight away
+    hostHeapAllocations = 0;
+    mqttMessageSendRaw("pir", "{}");
+    HOST_TEST_CHECK(hostHeapAllocations == 0);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 1);
+    testPublished(0, TEST_TOPIC_BASE "pir", "{}");
+}
+
+/**
+    Receive the commands, the handlers run (and send) without allocating.
+*/
+static void testReceive(void) {
+
+    hostPubSubClear();
+    hostHeapAllocations = 0;
+
+    hostPubSubReceive(TEST_TOPIC_BASE "module command", "{\"reset\": 2}");
+    mqttClientLoop();
+    HOST_TEST_CHECK(testResetRequest == 2);
+
+    hostPubSubReceive(TEST_TOPIC_BASE "alarm command", "{\"armdisarm\": 1}");
+    mqttClientLoop();
+    HOST_TEST_CHECK(testAlarmOneShots == 1);
+
+    // The config command replies from inside the callback
+    hostPubSubReceive(TEST_TOPIC_BASE "module config", "{\"get\": 0}");
+    mqttClientLoop();
+    HOST_TEST_CHECK(testConfigCommands == 1);
+    HOST_TEST_CHECK(hostPubSubPublishedCount == 1);
+    testPublished(0, TEST_TOPIC_BASE "config values", "{\"get\":1}");
+
+    // Unknown topic and invalid JSON
+    hostPubSubReceive(TEST_TOPIC_BASE "unknown command", "{\"openclose\": 1}");
+    mqttClientLoop();
+    hostPubSubReceive(TEST_TOPIC_BASE "module command", "{\"reset\": ");
+    mqttClientLoop();
+
+    HOST_TEST_CHECK(hostHeapAllocations == 0);
+    HOST_TEST_CHECK(testGarageDoorOneShots == 0);
+    HOST_TEST_CHECK(hostTestLogContains("MQTT deserializeJson() failed") == true);
+    HOST_TEST_CHECK(hostTestLogContains("MQTT RX message [" TEST_TOPIC_BASE "alarm command]: {\"armdisarm\": 1}") == true);
+}
+
+/**
+    Check the stack frames of the receive and send functions (from the stack usage file of mqtt.cpp).
+*/
+static void testStackFrames(void) {
+
+    // Stack usage file
+    FILE * const file = fopen(HOST_TEST_STACK_USAGE, "r");
+
+    // Line of the stack usage file
+    char line[256];
+
+    // Stack frame of a function (bytes)
+    unsigned long frame;
+
+    // Functions found
+    unsigned int found = 0;
+
+    HOST_TEST_CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+
+    // Lines are "file:line:column:function<tab>bytes<tab>qualifiers"
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if ((strstr(line, "mqttMessageCallback") != NULL) || (strstr(line, "mqttMessageSendRaw") != NULL)) {
+            frame = strtoul(strchr(line, '\t') + 1, NULL, 10);
+            HOST_TEST_CHECK(frame <= TEST_STACK_FRAME_MAX);
+            printf("test_mqtt: %s", strrchr(line, ':') + 1);
+            found++;
+        }
+    }
+
+    fclose(file);
+
+    HOST_TEST_CHECK(found == 2);
+}
+
+
+int main(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Blocks allocated to check the counter (volatile so the allocations are not optimised out)
+    int * volatile object;
+    void * volatile block;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+    snprintf(ramMirrorPtr->mqtt.mqttTopicRoot, sizeof(ramMirrorPtr->mqtt.mqttTopicRoot), TEST_TOPIC_ROOT);
+
+    // The allocation counter sees the heap
+    hostHeapAllocations = 0;
+    object = new int;
+    delete object;
+    block = malloc(1);
+    free(block);
+    HOST_TEST_CHECK(hostHeapAllocations == 2);
+
+    testSendReconnect();
+    testReceive();
+    testStackFrames();
+
+    return(hostTestResult("test_mqtt"));
+}
@@ -0,0 +1,177 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+
+
+// Length of the MQTT structure including its CRC
+#define TEST_MQTT_LENGTH                (sizeof(nvmSubConfigMqtt))
+
+
+// Structure for the data shared with the boots
+typedef struct {
+    hostFlashCounters       legacyCommit;       // Flash operations of a legacy EEPROM commit
+    uint32_t                legacyTime;         // Duration of a legacy EEPROM commit (uS)
+    hostFlashCounters       logCommit;          // Flash operations of a commit of one structure
+    uint32_t                logTime;            // Duration of a commit of one structure (uS)
+} testSharedData;
+
+// Data shared with the boots
+static testSharedData * testShared;
+
+
+/**
+    Commit and get the flash operations it took.
+
+    @return        pointer to the flash operation counters of the commit.
+*/
+static const hostFlashCounters * testCommit(void) {
+
+    hostFlashResetCounters();
+    nvmComittRamMirror();
+    nvmTransmitStatusMessage();
+
+    return(hostFlashGetCounters());
+}
+
+/**
+    Boot: set up the NVM from erased flash, measure a legacy EEPROM commit of the same RAM mirror.
+*/
+static void testBootSetup(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Start of the legacy commit (uS)
+    uint32_t startTime;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    // Legacy EEPROM commit (every commit erases the sector and writes the complete structure)
+    EEPROM.begin(sizeof(nvmCompleteStructure));
+    EEPROM.put(NVM_BASE_ADDRESS, *ramMirrorPtr);
+
+    hostFlashResetCounters();
+    startTime = micros();
+    HOST_TEST_CHECK(EEPROM.commit() == true);
+    testShared->legacyTime = micros() - startTime;
+    testShared->legacyCommit = *hostFlashGetCounters();
+
+    EEPROM.end();
+}
+
+/**
+    Boot: commits only write the changed structures and skip the flash when nothing changed.
+*/
+static void testBootCommits(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Flash operations of a commit
+    const hostFlashCounters * countersPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    // Nothing dirty
+    countersPtr = testCommit();
+    HOST_TEST_CHECK((countersPtr->erases == 0) && (countersPtr->writes == 0));
+    HOST_TEST_CHECK(hostStubNvmData.lastCommitBytes == 0);
+
+    // Dirty but not changed
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+    countersPtr = testCommit();
+    HOST_TEST_CHECK((countersPtr->erases == 0) && (countersPtr->writes == 0));
+    HOST_TEST_CHECK(hostStubNvmData.commitsSkipped == 2);
+    HOST_TEST_CHECK(hostStubNvmData.commits == 0);
+
+    // One structure changed, one record is appended
+    snprintf(ramMirrorPtr->mqtt.mqttTopicRoot, sizeof(ramMirrorPtr->mqtt.mqttTopicRoot), "changed");
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+    nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
+    countersPtr = testCommit();
+    HOST_TEST_CHECK((countersPtr->erases == 0) && (countersPtr->writes == 1));
+    HOST_TEST_CHECK((countersPtr->bytesWritten >= TEST_MQTT_LENGTH) && (countersPtr->bytesWritten < (TEST_MQTT_LENGTH + 32)));
+    HOST_TEST_CHECK(hostStubNvmData.lastCommitBytes == TEST_MQTT_LENGTH);
+    HOST_TEST_CHECK(hostStubNvmData.commits == 1);
+
+    testShared->logCommit = *countersPtr;
+    testShared->logTime = hostStubNvmData.lastCommitTime;
+
+    // Background commit, one flash operation per call
+    snprintf(ramMirrorPtr->mqtt.mqttTopicRoot, sizeof(ramMirrorPtr->mqtt.mqttTopicRoot), "background");
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+    snprintf(ramMirrorPtr->alarm.homeAddress, sizeof(ramMirrorPtr->alarm.homeAddress), "background");
+    nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
+
+    hostFlashResetCounters();
+    nvmComittRamMirrorAsync(NULL);
+    HOST_TEST_CHECK(hostFlashGetCounters()->writes == 0);
+
+    for (unsigned int i = 1; i <= 2; i++) {
+        nvmCyclicTask();
+        HOST_TEST_CHECK((hostFlashGetCounters()->erases + hostFlashGetCounters()->writes) == i);
+    }
+
+    nvmCyclicTask();
+    HOST_TEST_CHECK(hostFlashGetCounters()->writes == 2);
+
+    // Corrupt structure in the RAM mirror, committed as it is
+    ramMirrorPtr->alarm.homeAddress[0] ^= 1;
+    nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
+    ramMirrorPtr->alarm.homeAddress[0] ^= 1;
+    nvmComittRamMirror();
+}
+
+/**
+    Boot: recovering one corrupt structure only writes that structure and the NVM error counter.
+    The previous generation of the structure is restored.
+*/
+static void testBootIntegrity(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+
+    hostFlashResetCounters();
+    nvmValidateStructure(nvmAlarmStruc);
+
+    HOST_TEST_CHECK(hostTestLogContains("NVM Structure: 4 is corrupt") == true);
+    HOST_TEST_CHECK(hostTestLogContains("NVM Structure: 4 restored previous generation") == true);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->alarm.homeAddress, "background") == 0);
+    HOST_TEST_CHECK((hostFlashGetCounters()->erases == 0) && (hostFlashGetCounters()->writes == 2));
+}
+
+
+int main(void) {
+
+    testShared = (testSharedData *)hostTestShared(sizeof(testSharedData));
+    hostTestFlashOpen("test_nvm_commit");
+    hostFlashEraseAll();
+
+    HOST_TEST_CHECK(hostTestBoot(testBootSetup) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootCommits) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootIntegrity) == HOST_TEST_BOOT_OK);
+
+    // A commit of one structure writes less than the legacy EEPROM commit and never erases
+    HOST_TEST_CHECK((testShared->legacyCommit.erases == 1) && (testShared->legacyCommit.bytesWritten >= sizeof(nvmCompleteStructure)));
+    HOST_TEST_CHECK(testShared->logCommit.bytesWritten < testShared->legacyCommit.bytesWritten);
+
+    printf("test_nvm_commit: legacy EEPROM commit %lu erase, %lu bytes, %luus - log commit %lu erase, %lu bytes, %luus\n",
+           (unsigned long)testShared->legacyCommit.erases, (unsigned long)testShared->legacyCommit.bytesWritten, (unsigned long)testShared->legacyTime,
+           (unsigned long)testShared->logCommit.erases, (unsigned long)testShared->logCommit.bytesWritten, (unsigned long)testShared->logTime);
+
+    return(hostTestResult("test_nvm_commit"));
+}
@@ -0,0 +1,506 @@
+#include <Arduino.h>
+
+#include "host_test.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+#include "nvm_log.h"
+#include "crc.h"
+
+
+// Commits in the test sequence (enough to wrap the log sectors more than once)
+#define TEST_COMMITS                    (150)
+
+// Start of the flash area restored before every power loss (the NVM log and the EEPROM sector)
+#define TEST_FLASH_AREA_START           (HOST_FLASH_SIZE - 0x10000)
+
+// Size of the flash area restored before every power loss
+#define TEST_FLASH_AREA_SIZE            (0x10000)
+
+// Home address written by the boot after the power loss
+#define TEST_RECOVERED_ADDRESS          ("recovered")
+
+// MQTT root topic of a corrupt commit or a torn record
+#define TEST_LOST_TOPIC                 ("lost topic")
+
+
+// Structure for the data shared with the boots
+typedef struct {
+    nvmCompleteStructure    baseline;           // RAM mirror before the test sequence
+    nvmCompleteStructure    recovered;          // RAM mirror after the recovery
+    uint32_t                commitsDone;        // Commits of the test sequence completed before the power loss
+    uint32_t                lossOperation;      // Flash operation the power is lost at (0 for never)
+    hostFlashLossMode       lossMode;           // How much of the interrupted operation is applied
+    uint32_t                operations;         // Flash erases and writes of the test sequence
+    uint32_t                sectorSequence;     // Log sector sequence after the test sequence
+    bool                    clearDone;          // nvmClear returned
+} testSharedData;
+
+// Data shared with the boots
+static testSharedData * testShared;
+
+
+/**
+    Recalculate the CRCs of all structures in a copy of the RAM mirror.
+
+    @param[in]     structuresPtr pointer to the structures.
+*/
+static void testUpdateCrcs(nvmCompleteStructure * const structuresPtr) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointers
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Offset of the structure
+    uint32_t offset;
+
+    // CRC of the structure
+    crc_t crc;
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        offset = nvmConfigPtr[i].addressRamMirror - (const uint8_t *)ramMirrorPtr;
+        crc = crcCalculate(((const uint8_t *)structuresPtr) + offset, nvmConfigPtr[i].length);
+        memcpy(((uint8_t *)structuresPtr) + offset + nvmConfigPtr[i].length, &crc, NVM_CRC_SIZE_BYTES);
+    }
+}
+
+/**
+    Apply a commit of the test sequence (one structure changes per commit).
+
+    @param[in]     structuresPtr pointer to the structures.
+    @param[in]     commit number of the commit (from 1).
+    @return        index of the changed structure.
+*/
+static uint32_t testApplyCommit(nvmCompleteStructure * const structuresPtr, const uint32_t commit) {
+
+    if ((commit % 2) != 0) {
+        snprintf(structuresPtr->mqtt.mqttTopicRoot, sizeof(structuresPtr->mqtt.mqttTopicRoot), "topic %lu", (unsigned long)commit);
+        return(nvmMqttStruc);
+    }
+
+    snprintf(structuresPtr->network.otaPassword, sizeof(structuresPtr->network.otaPassword), "password %lu", (unsigned long)commit);
+    return(nvmNetworkStruc);
+}
+
+/**
+    Get the structures expected after a number of commits of the test sequence.
+
+    @param[in]     commits commits completed.
+    @param[out]    structuresPtr pointer to the expected structures.
+*/
+static void testExpected(const uint32_t commits, nvmCompleteStructure * const structuresPtr) {
+
+    memcpy(structuresPtr, &testShared->baseline, sizeof(*structuresPtr));
+
+    for (uint32_t i = 1; i <= commits; i++) {
+        (void) testApplyCommit(structuresPtr, i);
+    }
+
+    testUpdateCrcs(structuresPtr);
+}
+
+/**
+    Boot: set up the NVM from erased flash and keep the RAM mirror as the baseline.
+*/
+static void testBootSetup(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    // Ext1 is never rewritten with the defaults, give it valid contents
+    ramMirrorPtr->ext1.char1 = 'G';
+    ramMirrorPtr->ext1.char2 = 'R';
+    ramMirrorPtr->ext1.footer.buffer = NVM_BUFFER_DEFAULT;
+    nvmUpdateRamMirrorCrcByName(nvmExt1Struc);
+    nvmComittRamMirror();
+
+    memcpy(&testShared->baseline, ramMirrorPtr, sizeof(testShared->baseline));
+}
+
+/**
+    Boot: run the test sequence, losing power at the requested flash operation.
+*/
+static void testBootSequence(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(memcmp(ramMirrorPtr, &testShared->baseline, sizeof(testShared->baseline)) == 0);
+
+    hostFlashResetCounters();
+    hostFlashPowerLoss(testShared->lossOperation, testShared->lossMode);
+
+    for (uint32_t i = 1; i <= TEST_COMMITS; i++) {
+        nvmUpdateRamMirrorCrcByIndex(testApplyCommit(ramMirrorPtr, i));
+        nvmComittRamMirror();
+        testShared->commitsDone = i;
+    }
+
+    testShared->operations = hostFlashGetCounters()->erases + hostFlashGetCounters()->writes;
+    testShared->sectorSequence = nvmLogGetSectorSequence();
+}
+
+/**
+    Boot: after the power loss the NVM holds the old or the new snapshot, and the log can be written again.
+*/
+static void testBootRecover(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Snapshot before the interrupted commit
+    static nvmCompleteStructure expectedOld;
+
+    // Snapshot after the interrupted commit
+    static nvmCompleteStructure expectedNew;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    testExpected(testShared->commitsDone, &expectedOld);
+    testExpected(testShared->commitsDone + 1, &expectedNew);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK((memcmp(ramMirrorPtr, &expectedOld, sizeof(expectedOld)) == 0) || (memcmp(ramMirrorPtr, &expectedNew, sizeof(expectedNew)) == 0));
+    HOST_TEST_CHECK(hostTestLogContains("corrupt") == false);
+
+    snprintf(ramMirrorPtr->alarm.homeAddress, sizeof(ramMirrorPtr->alarm.homeAddress), "%s", TEST_RECOVERED_ADDRESS);
+    nvmUpdateRamMirrorCrcByName(nvmAlarmStruc);
+    nvmComittRamMirror();
+
+    memcpy(&testShared->recovered, ramMirrorPtr, sizeof(testShared->recovered));
+}
+
+/**
+    Boot: the write after the recovery is kept.
+*/
+static void testBootRecovered(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(memcmp(ramMirrorPtr, &testShared->recovered, sizeof(testShared->recovered)) == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->alarm.homeAddress, TEST_RECOVERED_ADDRESS) == 0);
+}
+
+
+/**
+    Check the RAM mirror holds the cleared NVM (defaults, nothing from before the clear).
+
+    @param[in]     ramMirrorPtr pointer to the RAM mirror.
+    @return        true when the NVM is cleared.
+*/
+static bool testCleared(const nvmCompleteStructure * const ramMirrorPtr) {
+    return((strcmp(ramMirrorPtr->mqtt.mqttTopicRoot, "publisher") == 0) &&
+           (strcmp(ramMirrorPtr->network.otaPassword, "password") == 0) &&
+           (strcmp(ramMirrorPtr->alarm.homeAddress, "Home Address") == 0) &&
+           (ramMirrorPtr->ext1.char1 == 0) &&
+           (hostTestLogContains("restored previous generation") == false));
+}
+
+/**
+    Boot: clear the NVM, losing power at the requested flash operation.
+*/
+static void testBootClear(void) {
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    hostFlashResetCounters();
+    hostFlashPowerLoss(testShared->lossOperation, testShared->lossMode);
+
+    nvmClear();
+
+    testShared->clearDone = true;
+    testShared->operations = hostFlashGetCounters()->erases + hostFlashGetCounters()->writes;
+}
+
+/**
+    Boot: after a clear the NVM is cleared (or still the old contents when power was lost before the clear got into the log).
+*/
+static void testBootCleared(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Contents before the clear
+    static nvmCompleteStructure expectedOld;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    testExpected(TEST_COMMITS, &expectedOld);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    if (testShared->clearDone == true) {
+        HOST_TEST_CHECK(testCleared(ramMirrorPtr) == true);
+    }
+    else {
+        HOST_TEST_CHECK((testCleared(ramMirrorPtr) == true) || (memcmp(ramMirrorPtr, &expectedOld, sizeof(expectedOld)) == 0));
+    }
+}
+
+/**
+    Boot: the clear is final, the next boot after the clear is still cleared.
+*/
+static void testBootClearedAgain(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    if (memcmp(ramMirrorPtr->mqtt.mqttTopicRoot, "topic", strlen("topic")) != 0) {
+        HOST_TEST_CHECK(testCleared(ramMirrorPtr) == true);
+    }
+}
+
+/**
+    Boot: commit a structure that is already corrupt in the RAM mirror (intact record, invalid structure CRC).
+*/
+static void testBootCorruptCommit(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+
+    snprintf(ramMirrorPtr->mqtt.mqttTopicRoot, sizeof(ramMirrorPtr->mqtt.mqttTopicRoot), "%s", TEST_LOST_TOPIC);
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+    ramMirrorPtr->mqtt.mqttTopicRoot[0] ^= 1;
+    nvmComittRamMirror();
+}
+
+/**
+    Boot: commit a structure whose record is torn afterwards (invalid record CRC).
+*/
+static void testBootTornCommit(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+
+    snprintf(ramMirrorPtr->mqtt.mqttTopicRoot, sizeof(ramMirrorPtr->mqtt.mqttTopicRoot), "%s", TEST_LOST_TOPIC);
+    nvmUpdateRamMirrorCrcByName(nvmMqttStruc);
+    nvmComittRamMirror();
+}
+
+/**
+    Boot: the structure of the intact record with an invalid structure CRC is recovered from the previous generation.
+*/
+static void testBootPreviousRestored(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Contents before the lost commit
+    static nvmCompleteStructure expected;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    testExpected(TEST_COMMITS, &expected);
+
+    nvmInit();
+
+    HOST_TEST_CHECK(hostTestLogContains("restored previous generation") == true);
+    HOST_TEST_CHECK(memcmp(&ramMirrorPtr->mqtt, &expected.mqtt, sizeof(expected.mqtt)) == 0);
+}
+
+/**
+    Boot: the torn record is skipped by the replay, the structure comes from the record before it without a CRC error.
+*/
+static void testBootTornSkipped(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Contents before the lost commit
+    static nvmCompleteStructure expected;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    testExpected(TEST_COMMITS, &expected);
+
+    nvmInit();
+
+    HOST_TEST_CHECK(hostTestLogContains("corrupt") == false);
+    HOST_TEST_CHECK(memcmp(&ramMirrorPtr->mqtt, &expected.mqtt, sizeof(expected.mqtt)) == 0);
+}
+
+/**
+    Tear the record holding a text in the log (clear a bit of the text, like an interrupted write).
+
+    @param[in]     text text to find.
+    @return        true when the record was found.
+*/
+static bool testTearRecord(const char * const text) {
+
+    // Log area
+    uint8_t * const area = hostFlashImage() + TEST_FLASH_AREA_START;
+
+    // Found text
+    uint8_t * const found = (uint8_t *)memmem(area, TEST_FLASH_AREA_SIZE, text, strlen(text));
+
+    if (found != NULL) {
+        found[0] &= (found[0] - 1);
+    }
+
+    return(found != NULL);
+}
+
+
+/**
+    Lose power at every erase and write of the test sequence, before and half way through the operation.
+
+    @param[in]     flashBaseline flash area before the test sequence.
+*/
+static void testPowerLoss(const uint8_t * const flashBaseline) {
+
+    // Boots that lost power
+    uint32_t powerLosses = 0;
+
+    for (uint32_t operation = 1; operation <= testShared->operations; operation++) {
+        for (int mode = hostFlashLossBefore; mode <= hostFlashLossHalf; mode++) {
+            memcpy(hostFlashImage() + TEST_FLASH_AREA_START, flashBaseline, TEST_FLASH_AREA_SIZE);
+
+            testShared->commitsDone = 0;
+            testShared->lossOperation = operation;
+            testShared->lossMode = (hostFlashLossMode)mode;
+
+            if (HOST_TEST_CHECK(hostTestBoot(testBootSequence) == HOST_FLASH_POWER_LOSS_EXIT) == true) {
+                powerLosses++;
+            }
+
+            if ((HOST_TEST_CHECK(hostTestBoot(testBootRecover) == HOST_TEST_BOOT_OK) == false) ||
+                (HOST_TEST_CHECK(hostTestBoot(testBootRecovered) == HOST_TEST_BOOT_OK) == false)) {
+                printf("    power lost at operation %lu (mode %d) after %lu commits\n", (unsigned long)operation, mode, (unsigned long)testShared->commitsDone);
+            }
+        }
+    }
+
+    printf("test_nvm_log: %lu power losses over %lu flash operations\n", (unsigned long)powerLosses, (unsigned long)testShared->operations);
+}
+
+/**
+    Clear the NVM (with and without a power loss at every erase and write), the clear is final.
+
+    @param[in]     flashSequence flash area after the test sequence.
+*/
+static void testClear(const uint8_t * const flashSequence) {
+
+    // Flash operations of the clear
+    uint32_t operations;
+
+    memcpy(hostFlashImage() + TEST_FLASH_AREA_START, flashSequence, TEST_FLASH_AREA_SIZE);
+
+    testShared->lossOperation = 0;
+    testShared->clearDone = false;
+    HOST_TEST_CHECK(hostTestBoot(testBootClear) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootCleared) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootClearedAgain) == HOST_TEST_BOOT_OK);
+
+    operations = testShared->operations;
+
+    for (uint32_t operation = 1; operation <= operations; operation++) {
+        for (int mode = hostFlashLossBefore; mode <= hostFlashLossHalf; mode++) {
+            memcpy(hostFlashImage() + TEST_FLASH_AREA_START, flashSequence, TEST_FLASH_AREA_SIZE);
+
+            testShared->clearDone = false;
+            testShared->lossOperation = operation;
+            testShared->lossMode = (hostFlashLossMode)mode;
+
+            HOST_TEST_CHECK(hostTestBoot(testBootClear) == HOST_FLASH_POWER_LOSS_EXIT);
+
+            if ((HOST_TEST_CHECK(hostTestBoot(testBootCleared) == HOST_TEST_BOOT_OK) == false) ||
+                (HOST_TEST_CHECK(hostTestBoot(testBootClearedAgain) == HOST_TEST_BOOT_OK) == false)) {
+                printf("    power lost at clear operation %lu (mode %d)\n", (unsigned long)operation, mode);
+            }
+        }
+    }
+}
+
+/**
+    The previous generation is only used for an intact record holding a corrupt structure, a torn record is skipped.
+
+    @param[in]     flashSequence flash area after the test sequence.
+*/
+static void testGenerations(const uint8_t * const flashSequence) {
+
+    memcpy(hostFlashImage() + TEST_FLASH_AREA_START, flashSequence, TEST_FLASH_AREA_SIZE);
+    HOST_TEST_CHECK(hostTestBoot(testBootCorruptCommit) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootPreviousRestored) == HOST_TEST_BOOT_OK);
+
+    memcpy(hostFlashImage() + TEST_FLASH_AREA_START, flashSequence, TEST_FLASH_AREA_SIZE);
+    HOST_TEST_CHECK(hostTestBoot(testBootTornCommit) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(testTearRecord(TEST_LOST_TOPIC) == true);
+    HOST_TEST_CHECK(hostTestBoot(testBootTornSkipped) == HOST_TEST_BOOT_OK);
+}
+
+
+int main(void) {
+
+    // Flash area before the test sequence
+    static uint8_t flashBaseline[TEST_FLASH_AREA_SIZE];
+
+    // Flash area after the test sequence
+    static uint8_t flashSequence[TEST_FLASH_AREA_SIZE];
+
+    // Expected contents after the test sequence
+    nvmCompleteStructure expected;
+
+    testShared = (testSharedData *)hostTestShared(sizeof(testSharedData));
+    hostTestFlashOpen("test_nvm_log");
+    hostFlashEraseAll();
+
+    HOST_TEST_CHECK(hostTestBoot(testBootSetup) == HOST_TEST_BOOT_OK);
+    memcpy(flashBaseline, hostFlashImage() + TEST_FLASH_AREA_START, sizeof(flashBaseline));
+
+    // Without a power loss every commit is kept and the log wraps
+    testShared->lossOperation = 0;
+    HOST_TEST_CHECK(hostTestBoot(testBootSequence) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(testShared->commitsDone == TEST_COMMITS);
+    HOST_TEST_CHECK(testShared->sectorSequence > (NVM_LOG_SECTORS + 1));
+    memcpy(flashSequence, hostFlashImage() + TEST_FLASH_AREA_START, sizeof(flashSequence));
+
+    testShared->commitsDone = TEST_COMMITS - 1;
+    HOST_TEST_CHECK(hostTestBoot(testBootRecover) == HOST_TEST_BOOT_OK);
+    testExpected(TEST_COMMITS, &expected);
+    memcpy(&expected.alarm, &testShared->recovered.alarm, sizeof(expected.alarm));
+    HOST_TEST_CHECK(memcmp(&testShared->recovered, &expected, sizeof(expected)) == 0);
+
+    testPowerLoss(flashBaseline);
+    testClear(flashSequence);
+    testGenerations(flashSequence);
+
+    return(hostTestResult("test_nvm_log"));
+}
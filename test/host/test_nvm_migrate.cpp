@@ -0,0 +1,546 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <new>
+
+#include "host_test.h"
+#include "crc.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+
+
+// Directory of the release binaries
+#ifndef HOST_TEST_RELEASES_DIR
+#define HOST_TEST_RELEASES_DIR          "../../releases"
+#endif
+
+// Maximum size of a release binary
+#define TEST_RELEASE_SIZE_MAX           (1024 * 1024)
+
+// Legacy EEPROM layout of the releases (the complete structure up to the WiFi connection cache)
+#define TEST_LEGACY_EEPROM_SIZE         (offsetof(nvmCompleteStructure, wifi))
+
+// Schema version of the hawkbit structure after the synthetic migration
+#define TEST_HAWKBIT_SCHEMA_VERSION     (NVM_SCHEMA_VERSION_INITIAL + 1)
+
+
+// NVM configuration and migrations of nvm_cfg.cpp (renamed when building this test, the test firmwares wrap them)
+const uint32_t nvmCfgGetConfigPointerRO(const nvmStructureConfig ** activeNvmConfig);
+const uint32_t nvmCfgGetMigrationPointerRO(const nvmMigrationConfig ** activeNvmMigrations);
+
+
+// Firmware running the boot
+typedef enum {
+    testFirmwareCurrent        = 0,     // This tree
+    testFirmwareHawkbitV0      = 1,     // Hawkbit structure without the tennant (schema version 0)
+    testFirmwareHawkbitV1      = 2,     // Hawkbit structure with the tennant (schema version 1, migration from version 0)
+    testFirmwareHawkbitNoMig   = 3      // Hawkbit structure with the tennant (schema version 1, no migration)
+} testFirmware;
+
+// Hawkbit NVM structure of schema version 0 (before the tennant was added)
+typedef struct __attribute__ ((packed)) {
+    char                     hawkbitServer[NVM_MAX_LENGTH_URL];         // Hawkbit server
+    char                     hawkbitToken[NVM_MAX_LENGTH_HTTP_TOKEN];   // Hawkbit security token
+    uint8_t                  hawkbitTokenTypeIndex;                     // Hawkbit security token type index
+
+    nvmFooterCrc             footer;
+} testHawkbitV0;
+
+// Release and the settings its EEPROM holds
+typedef struct {
+    const char *            version;            // Release version (releases/publisher-<version>.bin)
+    const char *            mqttServer;         // MQTT server default of the release
+} testRelease;
+
+// Default structure of a release, found in the release binary from a pattern at a known offset
+typedef struct {
+    uint32_t                index;              // Index of the NVM structure
+    const char *            text1;              // First string of the pattern (padded to its field length)
+    uint32_t                length1;            // Field length of the first string
+    const char *            text2;              // Second string of the pattern (NULL for none)
+    uint32_t                length2;            // Field length of the second string
+    uint32_t                offset;             // Offset of the pattern in the structure
+} testReleaseDefault;
+
+// Fixture for a migration (every migration of nvm_cfg.cpp needs one)
+typedef struct {
+    uint32_t                index;              // Index of the NVM structure (nvmNumberOfTypes terminates the table)
+    uint8_t                 fromVersion;        // Schema version the fixture writes
+    void                    (* function)(void); // Boot of the firmware writing the schema version
+} testMigrationFixture;
+
+// Data shared with the boots
+typedef struct {
+    testFirmware            firmware;           // Firmware of the next boot
+    const testRelease *     release;            // Release of the EEPROM fixture
+} testSharedData;
+
+
+// Releases in releases/ (all use the legacy EEPROM layout)
+static const testRelease testReleases[] = {{"000.006.005", "swarm.max.lan"},
+                                           {"000.007.005", "swarm-100.max.lan"},
+                                           {"000.007.006", "swarm-100.max.lan"},
+                                           {"000.007.007", "swarm-100.max.lan"}};
+
+// Release defaults found by their pattern (the NVM structure and the extensions are not unique, built from this tree)
+static const testReleaseDefault testReleaseDefaults[] = {{nvmNetworkStruc, "password", NVM_MAX_LENGTH_PASSWORD, "password", NVM_MAX_LENGTH_PASSWORD, 0},
+                                                         {nvmMqttStruc, "testuser", NVM_MAX_LENGTH_USER, "password", NVM_MAX_LENGTH_PASSWORD, NVM_MAX_LENGTH_URL},
+                                                         {nvmIOStruc, "\x2C\x01\xFF\x03\x01", 5, NULL, 0, 0},
+                                                         {nvmAlarmStruc, "Home Address", NVM_MAX_LENGTH_ADDRESS, NULL, 0, 0},
+                                                         {nvmHawkbitStruc, "svr.max.lan:9090", NVM_MAX_LENGTH_URL, NULL, 0, 0}};
+
+// ROM defaults of the hawkbit structure of schema version 0
+static const testHawkbitV0 testHawkbitV0Default = {"svr.max.lan:9090", "00000000000000000000000000000000", 0, {NVM_BUFFER_DEFAULT, NVM_CRC_DEFAULT}};
+
+// Migration of the hawkbit structure from schema version 0
+static const nvmMigrationConfig testMigrations[] = {{nvmHawkbitStruc, NVM_SCHEMA_VERSION_INITIAL, nvmMigrateExtend},
+                                                    {nvmNumberOfTypes, NVM_SCHEMA_VERSION_INITIAL, NULL}};
+
+// Data shared with the boots
+static testSharedData * testShared;
+
+
+/**
+    Set-up read only pointer to the NVM configuration of the firmware running the boot.
+    Only the hawkbit structure differs from nvm_cfg.cpp.
+
+    @param[in]     activeNvmConfig pointer for the NVM configuration.
+    @return        size of the NVM configuration.
+*/
+const uint32_t nvmGetConfigPointerRO(const nvmStructureConfig ** activeNvmConfig) {
+
+    // NVM configuration of the test firmware
+    alignas(nvmStructureConfig) static uint8_t configStorage[sizeof(nvmStructureConfig) * nvmNumberOfTypes];
+
+    // NVM configuration of the test firmware is set up
+    static bool configValid = false;
+
+    // Configuration of nvm_cfg.cpp
+    const nvmStructureConfig * cfgPtr;
+    const uint32_t cfgSize = nvmCfgGetConfigPointerRO(&cfgPtr);
+
+    // Configuration of the test firmware
+    nvmStructureConfig * const configPtr = (nvmStructureConfig *)configStorage;
+
+    if (testShared->firmware == testFirmwareCurrent) {
+        *activeNvmConfig = cfgPtr;
+        return(cfgSize);
+    }
+
+    if (configValid == false) {
+        for (unsigned int i = 0; i < cfgSize; i++) {
+            if (i != nvmHawkbitStruc) {
+                new (&configPtr[i]) nvmStructureConfig(cfgPtr[i]);
+            }
+            else if (testShared->firmware == testFirmwareHawkbitV0) {
+                new (&configPtr[i]) nvmStructureConfig{cfgPtr[i].addressRamMirror,
+                                                       (const uint8_t *)&testHawkbitV0Default,
+                                                       cfgPtr[i].addressRamMirror + offsetof(testHawkbitV0, footer.crc),
+                                                       offsetof(testHawkbitV0, footer.crc),
+                                                       cfgPtr[i].rewriteWhenCorrupt,
+                                                       NVM_SCHEMA_VERSION_INITIAL,
+                                                       cfgPtr[i].bootCritical};
+            }
+            else {
+                new (&configPtr[i]) nvmStructureConfig{cfgPtr[i].addressRamMirror,
+                                                       cfgPtr[i].addressRomDefault,
+                                                       cfgPtr[i].addressCrc,
+                                                       cfgPtr[i].length,
+                                                       cfgPtr[i].rewriteWhenCorrupt,
+                                                       TEST_HAWKBIT_SCHEMA_VERSION,
+                                                       cfgPtr[i].bootCritical};
+            }
+        }
+
+        configValid = true;
+    }
+
+    *activeNvmConfig = configPtr;
+    return(cfgSize);
+}
+
+/**
+    Set-up read only pointer to the NVM migrations of the firmware running the boot.
+
+    @param[in]     activeNvmMigrations pointer for the NVM migrations.
+    @return        size of the NVM migrations (including the terminating entry).
+*/
+const uint32_t nvmGetMigrationPointerRO(const nvmMigrationConfig ** activeNvmMigrations) {
+
+    if (testShared->firmware == testFirmwareHawkbitV1) {
+        *activeNvmMigrations = &testMigrations[0];
+        return(sizeof(testMigrations) / sizeof(testMigrations[0]));
+    }
+
+    if (testShared->firmware == testFirmwareHawkbitNoMig) {
+        *activeNvmMigrations = &testMigrations[1];
+        return(1);
+    }
+
+    return(nvmCfgGetMigrationPointerRO(activeNvmMigrations));
+}
+
+
+/**
+    Build the legacy EEPROM of a release from the defaults in its binary, with settings changed like a configured device.
+
+    @param[in]     releasePtr pointer to the release.
+    @return        true when every default was found.
+*/
+static bool testWriteReleaseEeprom(const testRelease * const releasePtr) {
+
+    // Path of the release binary
+    char path[256];
+
+    // Release binary
+    static uint8_t binary[TEST_RELEASE_SIZE_MAX];
+
+    // Size of the release binary
+    size_t binarySize;
+
+    // Pattern of a default
+    uint8_t pattern[2 * NVM_MAX_LENGTH_URL];
+
+    // Legacy EEPROM contents
+    nvmCompleteStructure image;
+
+    // Legacy EEPROM contents in flash words
+    uint32_t imageWords[(sizeof(nvmCompleteStructure) + 3) / sizeof(uint32_t)];
+
+    // Default found in the binary
+    const uint8_t * foundPtr;
+
+    // CRC of a structure
+    crc_t crc;
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Pointer to the RAM mirror (only for the structure offsets)
+    const nvmCompleteStructure * ramMirrorPtr;
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    FILE * file;
+
+    (void) snprintf(path, sizeof(path), "%s/publisher-%s.bin", HOST_TEST_RELEASES_DIR, releasePtr->version);
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("FAIL cannot open %s\n", path);
+        return(false);
+    }
+
+    binarySize = fread(binary, 1, sizeof(binary), file);
+    (void) fclose(file);
+
+    memset(&image, 0xFF, sizeof(image));
+
+    // NVM structure and extensions are built from this tree (neither changed since the releases)
+    image.nvm.core.errorCounter = NVM_DATA_ERRORS_DEFAULT;
+    image.nvm.core.version = NVM_DATA_VERSION_DEFAULT;
+    image.nvm.footer.buffer = NVM_BUFFER_DEFAULT;
+    image.ext1.char1 = 'G';
+    image.ext1.char2 = 'R';
+    image.ext1.footer.buffer = NVM_BUFFER_DEFAULT;
+
+    for (unsigned int i = 0; i < (sizeof(testReleaseDefaults) / sizeof(testReleaseDefaults[0])); i++) {
+        const testReleaseDefault * const defaultPtr = &testReleaseDefaults[i];
+
+        memset(pattern, 0, sizeof(pattern));
+        memcpy(pattern, defaultPtr->text1, min((size_t)defaultPtr->length1, strlen(defaultPtr->text1)));
+
+        if (defaultPtr->text2 != NULL) {
+            memcpy(pattern + defaultPtr->length1, defaultPtr->text2, strlen(defaultPtr->text2));
+        }
+
+        foundPtr = (const uint8_t *)memmem(binary, binarySize, pattern, defaultPtr->length1 + defaultPtr->length2);
+
+        if ((foundPtr == NULL) || ((uint32_t)(foundPtr - binary) < defaultPtr->offset)) {
+            printf("FAIL no default for structure %lu in %s\n", (unsigned long)defaultPtr->index, path);
+            return(false);
+        }
+
+        memcpy(nvmConfigPtr[defaultPtr->index].addressRamMirror - (const uint8_t *)ramMirrorPtr + (uint8_t *)&image, foundPtr - defaultPtr->offset, nvmConfigPtr[defaultPtr->index].length);
+    }
+
+    // Settings of a configured device
+    (void) snprintf(image.alarm.homeAddress, sizeof(image.alarm.homeAddress), "Release %s", releasePtr->version);
+    image.io.ledBrightnessRunMode = 100;
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        const uint32_t offset = nvmConfigPtr[i].addressRamMirror - (const uint8_t *)ramMirrorPtr;
+
+        if ((offset + nvmConfigPtr[i].length) < TEST_LEGACY_EEPROM_SIZE) {
+            crc = crcCalculate(((const uint8_t *)&image) + offset, nvmConfigPtr[i].length);
+            memcpy(((uint8_t *)&image) + offset + nvmConfigPtr[i].length, &crc, NVM_CRC_SIZE_BYTES);
+        }
+    }
+
+    // The release EEPROM sector only holds its own layout, the rest of the sector is erased
+    memcpy(imageWords, &image, sizeof(image));
+    (void) ESP.flashEraseSector(HOST_EEPROM_SECTOR);
+    (void) ESP.flashWrite(HOST_EEPROM_SECTOR * SPI_FLASH_SEC_SIZE, imageWords, (TEST_LEGACY_EEPROM_SIZE + 3) & ~3);
+
+    return(true);
+}
+
+/**
+    Check the settings kept from the release EEPROM.
+*/
+static void testCheckRelease(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Home address of the release
+    char homeAddress[NVM_MAX_LENGTH_ADDRESS];
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+    (void) snprintf(homeAddress, sizeof(homeAddress), "Release %s", testShared->release->version);
+
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->mqtt.mqttServer, testShared->release->mqttServer) == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->mqtt.mqttUser, "testuser") == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->network.otaPassword, "password") == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->alarm.homeAddress, homeAddress) == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitTennant, "DEFAULT") == 0);
+    HOST_TEST_CHECK(ramMirrorPtr->io.ledBrightnessRunMode == 100);
+    HOST_TEST_CHECK((ramMirrorPtr->ext1.char1 == 'G') && (ramMirrorPtr->ext1.char2 == 'R'));
+    HOST_TEST_CHECK(ramMirrorPtr->nvm.core.errorCounter == 1);
+
+    // Added after the releases, gets its defaults
+    HOST_TEST_CHECK(ramMirrorPtr->wifi.valid == 0);
+}
+
+/**
+    Boot: the first start-up after the update from a release imports its EEPROM.
+*/
+static void testBootReleaseImport(void) {
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("NVM imported from EEPROM") == true);
+    HOST_TEST_CHECK(hostTestLogContains("NVM Structure: 7 restored defaults") == true);
+
+    // Only the structure added after the releases is corrupt
+    HOST_TEST_CHECK(hostTestLogContains("is corrupt") == true);
+    for (unsigned int i = 0; i < nvmWifiStruc; i++) {
+        char text[32];
+        (void) snprintf(text, sizeof(text), "Structure: %u is corrupt", i);
+        HOST_TEST_CHECK(hostTestLogContains(text) == false);
+    }
+
+    testCheckRelease();
+}
+
+/**
+    Boot: the imported release is read from the log in the current layout.
+*/
+static void testBootReleaseLog(void) {
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("NVM imported from EEPROM") == false);
+    HOST_TEST_CHECK(hostTestLogContains("Loaded log sector") == true);
+    HOST_TEST_CHECK(hostTestLogContains("is corrupt") == false);
+    HOST_TEST_CHECK(hostTestLogContains("Migrated") == false);
+
+    testCheckRelease();
+}
+
+/**
+    Boot: firmware with the hawkbit structure of schema version 0 writes its settings.
+*/
+static void testBootHawkbitV0(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    (void) snprintf(ramMirrorPtr->hawkbit.hawkbitServer, sizeof(ramMirrorPtr->hawkbit.hawkbitServer), "v0.max.lan:9090");
+    (void) snprintf(ramMirrorPtr->hawkbit.hawkbitToken, sizeof(ramMirrorPtr->hawkbit.hawkbitToken), "v0token");
+    ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex = 1;
+    nvmUpdateRamMirrorCrcByName(nvmHawkbitStruc);
+
+    // The extensions are not restored when corrupt, keep them valid so only the hawkbit structure is checked
+    ramMirrorPtr->ext1.char1 = 'G';
+    ramMirrorPtr->ext1.char2 = 'R';
+    nvmUpdateRamMirrorCrcByName(nvmExt1Struc);
+    nvmComittRamMirror();
+
+    HOST_TEST_CHECK(hostTestLogContains("NVM commit changed") == true);
+}
+
+/**
+    Boot: firmware with the hawkbit structure of schema version 1 migrates the version 0 record.
+*/
+static void testBootHawkbitV1(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("Migrated structures 0x20") == true);
+    HOST_TEST_CHECK(hostTestLogContains("is corrupt") == false);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitServer, "v0.max.lan:9090") == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitToken, "v0token") == 0);
+    HOST_TEST_CHECK(ramMirrorPtr->hawkbit.hawkbitTokenTypeIndex == 1);
+
+    // Added in schema version 1, gets its default (not the old footer buffer)
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitTennant, "DEFAULT") == 0);
+}
+
+/**
+    Boot: the migrated record was rewritten in schema version 1 once.
+    The older sector still holds the version 0 records until the log wraps, they must not be rewritten again.
+*/
+static void testBootHawkbitV1Again(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    hostFlashResetCounters();
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("Migrated") == false);
+    HOST_TEST_CHECK((hostFlashGetCounters()->erases == 0) && (hostFlashGetCounters()->writes == 0));
+    HOST_TEST_CHECK(hostTestLogContains("is corrupt") == false);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitServer, "v0.max.lan:9090") == 0);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitTennant, "DEFAULT") == 0);
+}
+
+/**
+    Boot: without a migration the version 0 record is skipped and the structure recovers to its defaults.
+*/
+static void testBootHawkbitNoMigration(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("No migration for structure 5 schema version 0") == true);
+    HOST_TEST_CHECK(hostTestLogContains("NVM Structure: 5 restored defaults") == true);
+    HOST_TEST_CHECK(strcmp(ramMirrorPtr->hawkbit.hawkbitServer, "svr.max.lan:9090") == 0);
+}
+
+/**
+    Boot: this tree migrates the record of a fixture without a corrupt structure.
+*/
+static void testBootFixtureMigrated(void) {
+
+    nvmInit();
+    nvmValidateDeferred();
+
+    HOST_TEST_CHECK(hostTestLogContains("Migrated structures") == true);
+    HOST_TEST_CHECK(hostTestLogContains("No migration") == false);
+    HOST_TEST_CHECK(hostTestLogContains("is corrupt") == false);
+}
+
+// Fixtures for the migrations of nvm_cfg.cpp (add one with every migration, the boot writes the older schema version)
+static const testMigrationFixture testMigrationFixtures[] = {{nvmNumberOfTypes, NVM_SCHEMA_VERSION_INITIAL, NULL}};
+
+
+/**
+    Legacy EEPROM of every release is imported and rewritten in the current layout.
+*/
+static void testReleaseImports(void) {
+
+    for (unsigned int i = 0; i < (sizeof(testReleases) / sizeof(testReleases[0])); i++) {
+        testShared->firmware = testFirmwareCurrent;
+        testShared->release = &testReleases[i];
+
+        hostFlashEraseAll();
+
+        if (HOST_TEST_CHECK(testWriteReleaseEeprom(&testReleases[i]) == true) == true) {
+            HOST_TEST_CHECK(hostTestBoot(testBootReleaseImport) == HOST_TEST_BOOT_OK);
+            HOST_TEST_CHECK(hostTestBoot(testBootReleaseLog) == HOST_TEST_BOOT_OK);
+        }
+    }
+}
+
+/**
+    Record of an older schema version is migrated, or skipped when there is no migration.
+*/
+static void testMigration(void) {
+
+    // Flash after the boot of the older firmware
+    uint8_t * const flashPtr = (uint8_t *)malloc(HOST_FLASH_SIZE);
+
+    hostFlashEraseAll();
+
+    testShared->firmware = testFirmwareHawkbitV0;
+    HOST_TEST_CHECK(hostTestBoot(testBootHawkbitV0) == HOST_TEST_BOOT_OK);
+    memcpy(flashPtr, hostFlashImage(), HOST_FLASH_SIZE);
+
+    testShared->firmware = testFirmwareHawkbitNoMig;
+    HOST_TEST_CHECK(hostTestBoot(testBootHawkbitNoMigration) == HOST_TEST_BOOT_OK);
+    memcpy(hostFlashImage(), flashPtr, HOST_FLASH_SIZE);
+
+    testShared->firmware = testFirmwareHawkbitV1;
+    HOST_TEST_CHECK(hostTestBoot(testBootHawkbitV1) == HOST_TEST_BOOT_OK);
+    HOST_TEST_CHECK(hostTestBoot(testBootHawkbitV1Again) == HOST_TEST_BOOT_OK);
+
+    free(flashPtr);
+}
+
+/**
+    Every migration of nvm_cfg.cpp has a fixture and the fixture is migrated by this tree.
+*/
+static void testMigrationCoverage(void) {
+
+    // Pointer to the NVM migrations of nvm_cfg.cpp
+    const nvmMigrationConfig * nvmMigrationPtr;
+    const uint32_t nvmMigrationSize = nvmCfgGetMigrationPointerRO(&nvmMigrationPtr);
+
+    // Fixture found for the migration
+    bool found;
+
+    testShared->firmware = testFirmwareCurrent;
+
+    for (unsigned int i = 0; (i < nvmMigrationSize) && (nvmMigrationPtr[i].index < nvmNumberOfTypes); i++) {
+        found = false;
+
+        for (unsigned int j = 0; testMigrationFixtures[j].index < nvmNumberOfTypes; j++) {
+            if ((testMigrationFixtures[j].index == nvmMigrationPtr[i].index) && (testMigrationFixtures[j].fromVersion == nvmMigrationPtr[i].fromVersion)) {
+                found = true;
+
+                hostFlashEraseAll();
+                HOST_TEST_CHECK(hostTestBoot(testMigrationFixtures[j].function) == HOST_TEST_BOOT_OK);
+                HOST_TEST_CHECK(hostTestBoot(testBootFixtureMigrated) == HOST_TEST_BOOT_OK);
+            }
+        }
+
+        if (HOST_TEST_CHECK(found == true) == false) {
+            printf("FAIL no fixture for the migration of structure %lu schema version %u\n", (unsigned long)nvmMigrationPtr[i].index, nvmMigrationPtr[i].fromVersion);
+        }
+    }
+}
+
+
+int main(void) {
+
+    testShared = (testSharedData *)hostTestShared(sizeof(testSharedData));
+    hostTestFlashOpen("test_nvm_migrate");
+
+    testReleaseImports();
+    testMigration();
+    testMigrationCoverage();
+
+    return(hostTestResult("test_nvm_migrate"));
+}
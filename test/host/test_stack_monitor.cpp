@@ -0,0 +1,134 @@
+#include <Arduino.h>
+#include <cont.h>
+
+#include "host_test.h"
+#include "stack_monitor.h"
+#include "stack_monitor_cfg.h"
+
+
+// Words of the painted test region
+#define TEST_REGION_WORDS               (64)
+
+// Words of the simulated SYS stack (TEST_SYS_STACK_SIZE bytes, the Makefile places _SYS_stack_start / _SYS_stack_end around it)
+#define TEST_SYS_STACK_WORDS            (TEST_SYS_STACK_SIZE / sizeof(uint32_t))
+
+// Words of the cont context at the top of the simulated SYS stack
+#define TEST_CONT_WORDS                 (64)
+
+// Word of the painted SYS stack overwritten by the deepest call
+#define TEST_SYS_STACK_DEEPEST          (400)
+
+// Value of an overwritten stack word
+#define TEST_STACK_USED                 (0x12345678)
+
+
+// Simulated SYS stack (C linkage for the linker symbols)
+extern "C" {
+    uint32_t testSysStack[TEST_SYS_STACK_WORDS];
+}
+
+// Context of the user task (set by the test, allocated at the top of the SYS stack by the core)
+cont_t * g_pcont = NULL;
+
+// Test region
+static uint32_t testRegionWords[TEST_REGION_WORDS];
+
+
+/**
+    Paint the test region and overwrite words from its top (the stack grows down).
+
+    @param[in]     used number of words used from the top.
+    @return        bytes still holding the paint pattern.
+*/
+static uint32_t testRegionUse(const unsigned int used) {
+
+    // Test region
+    const stackMonitorRegion region = {"test", &testRegionWords[0], &testRegionWords[TEST_REGION_WORDS]};
+
+    stackMonitorPaintRegion(&region);
+
+    for (unsigned int i = TEST_REGION_WORDS - used; i < TEST_REGION_WORDS; i++) {
+        testRegionWords[i] = TEST_STACK_USED;
+    }
+
+    return(stackMonitorScanRegion(&region));
+}
+
+/**
+    High water mark of a painted region for every number of used words (nothing used to fully used).
+*/
+static void testRegion(void) {
+
+    // Test region
+    const stackMonitorRegion region = {"test", &testRegionWords[0], &testRegionWords[TEST_REGION_WORDS]};
+
+    for (unsigned int used = 0; used <= TEST_REGION_WORDS; used++) {
+        HOST_TEST_CHECK(testRegionUse(used) == ((TEST_REGION_WORDS - used) * sizeof(uint32_t)));
+    }
+
+    // A word used deep in the region marks the high water mark (words above it left unwritten by a large frame)
+    (void) testRegionUse(1);
+    testRegionWords[10] = TEST_STACK_USED;
+    HOST_TEST_CHECK(stackMonitorScanRegion(&region) == (10 * sizeof(uint32_t)));
+}
+
+/**
+    An unpainted region has no free words and an empty region has nothing to paint.
+*/
+static void testUnpainted(void) {
+
+    // Unpainted and empty regions
+    const stackMonitorRegion unpainted = {"unpainted", &testRegionWords[0], &testRegionWords[TEST_REGION_WORDS]};
+    const stackMonitorRegion empty = {"empty", &testRegionWords[0], &testRegionWords[0]};
+
+    memset(testRegionWords, 0, sizeof(testRegionWords));
+    HOST_TEST_CHECK(stackMonitorScanRegion(&unpainted) == 0);
+
+    stackMonitorPaintRegion(&empty);
+    HOST_TEST_CHECK(stackMonitorScanRegion(&empty) == 0);
+    HOST_TEST_CHECK(testRegionWords[0] == 0);
+
+    // The SYS stack is not known before the init
+    HOST_TEST_CHECK(stackMonitorSysFree() == STACK_MONITOR_NOT_PAINTED);
+}
+
+/**
+    The SYS stack is only painted when the cont context is inside it with room below the reserve.
+*/
+static void testSysStackPaint(void) {
+
+    // The cont context is not on the SYS stack
+    g_pcont = NULL;
+    stackMonitorInit();
+    HOST_TEST_CHECK(stackMonitorSysFree() == STACK_MONITOR_NOT_PAINTED);
+    HOST_TEST_CHECK(hostTestLogContains("Not painting sys stack") == true);
+
+    // The cont context leaves only the reserve
+    g_pcont = (cont_t *)&testSysStack[STACK_MONITOR_SYS_RESERVE / sizeof(uint32_t)];
+    stackMonitorInit();
+    HOST_TEST_CHECK(stackMonitorSysFree() == STACK_MONITOR_NOT_PAINTED);
+    HOST_TEST_CHECK(hostTestLogContains("No room to paint sys stack") == true);
+
+    // The cont context at the top, only the deepest STACK_MONITOR_SYS_PAINT bytes are painted
+    g_pcont = (cont_t *)&testSysStack[TEST_SYS_STACK_WORDS - TEST_CONT_WORDS];
+    stackMonitorInit();
+    HOST_TEST_CHECK(stackMonitorSysFree() == STACK_MONITOR_SYS_PAINT);
+    HOST_TEST_CHECK(testSysStack[(STACK_MONITOR_SYS_PAINT / sizeof(uint32_t)) - 1] != 0);
+    HOST_TEST_CHECK(testSysStack[STACK_MONITOR_SYS_PAINT / sizeof(uint32_t)] == 0);
+
+    testSysStack[TEST_SYS_STACK_DEEPEST] = TEST_STACK_USED;
+    HOST_TEST_CHECK(stackMonitorSysFree() == (TEST_SYS_STACK_DEEPEST * sizeof(uint32_t)));
+
+    testSysStack[0] = TEST_STACK_USED;
+    HOST_TEST_CHECK(stackMonitorSysFree() == 0);
+}
+
+
+int main(void) {
+
+    testRegion();
+    testUnpainted();
+    testSysStackPaint();
+
+    return(hostTestResult("test_stack_monitor"));
+}
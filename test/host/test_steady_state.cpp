@@ -0,0 +1,284 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#include <PubSubClient.h>
+#include <WiFiManager.h>
+#include <ArduinoJson.h>
+
+#include "host_test.h"
+#include "host_heap.h"
+#include "nvm.h"
+#include "nvm_cfg.h"
+#include "debug.h"
+#include "log_sink.h"
+#include "journal.h"
+#include "boot_profile.h"
+#include "inputs.h"
+#include "outputs.h"
+#include "wifi.h"
+#include "mqtt.h"
+#include "hawkbit_client.h"
+#include "reset_ctrl.h"
+#include "status_ctrl.h"
+#include "alarm.h"
+#include "garage_door.h"
+#include "config.h"
+#include "version.h"
+
+
+// Simulated time of one loop iteration (uS, the fastest task rate, every task runs once per iteration)
+#define TEST_ITERATION_US               (10000UL)
+
+// Iterations of the warm-up (the first hawkbit poll is at most 300 calls after the start)
+#define TEST_WARM_UP_ITERATIONS         (40000)
+
+// Iterations of the checked steady state (several polls of TEST_POLL_RESPONSE, 100 calls apart)
+#define TEST_STEADY_ITERATIONS          (5000)
+
+// Topics of the default module (NVM default topic root, default module host name)
+#define TEST_TOPIC_BASE                 "publisher/pub-default/"
+
+// Hawkbit controller path of the default module (NVM default server and tennant)
+#define TEST_POLL_PATH                  "http://svr.max.lan:9090/DEFAULT/controller/v1/pub-default"
+
+// Hawkbit poll response (poll every 10 S, nothing to deploy)
+#define TEST_POLL_RESPONSE              "{\"config\":{\"polling\":{\"sleep\":\"00:00:10\"}},\"_links\":{}}"
+
+// Iterations between the events fed to the modules during the steady state
+#define TEST_PANEL_PERIOD               (300)
+#define TEST_INPUT_PERIOD               (700)
+#define TEST_COMMAND_PERIOD             (900)
+#define TEST_OUTAGE_ITERATION           (2000)
+#define TEST_OUTAGE_ITERATIONS          (50)
+
+
+// Cyclic task of a module
+typedef struct {
+    const char *    name;
+    void            (* task)(void);
+    unsigned int    allocations;
+} testTask;
+
+// Version data of the stubbed version module
+static char testVersionContents[] = "host";
+static const versionData testVersionData[] = {{"firmware", testVersionContents}};
+
+// Cyclic tasks in the order of the scheduler (loop functions first)
+static testTask testTasks[] = {{"wifiPortalLoop",             wifiPortalLoop,              0},
+                               {"alarmBackgroundLoop",        alarmBackgroundLoop,         0},
+                               {"wifiCyclicTask",             wifiCyclicTask,              0},
+                               {"mqttClientLoop",             mqttClientLoop,              0},
+                               {"mqttMessageLoop",            mqttMessageLoop,             0},
+                               {"inputsCyclicTask",           inputsCyclicTask,            0},
+                               {"outputsCyclicTask",          outputsCyclicTask,           0},
+                               {"restCtrlStateMachine",       restCtrlStateMachine,        0},
+                               {"statusCtrlStateMachine",     statusCtrlStateMachine,      0},
+                               {"hawkbitClientStateMachine",  hawkbitClientStateMachine,   0},
+                               {"hawkbitClientDownloadCyclic",hawkbitClientDownloadCyclic, 0},
+                               {"alarmCyclicTask",            alarmCyclicTask,             0},
+                               {"garageDoorCyclicTask",       garageDoorCyclicTask,        0},
+                               {"logSinkCyclicTask",          logSinkCyclicTask,           0},
+                               {"nvmCyclicTask",              nvmCyclicTask,               0}
+};
+
+// Alarm panel frames (PIR, armed and disarmed for the default home address)
+static const char * const testPanelFrames[] = {"\x19" "Open Garage" "\x0A",
+                                               "\x19" "Home Address ON" "\x0A",
+                                               "\x19" "Home Address OFF" "\x0A"
+};
+
+
+/**
+    Apply changed NVM structures (host stub, nothing to re-initialise).
+
+    @param[in]     changedStructures bit mask of the changed NVM structures.
+*/
+void configApply(const uint32_t changedStructures) {
+    (void) changedStructures;
+}
+
+/**
+    Module config command (host stub, the config module is not part of the test).
+
+    @param[in]     docPtr pointer to the JSON document holding the command.
+*/
+void configCommand(JsonDocument * const docPtr) {
+    (void) docPtr;
+}
+
+/**
+    Set-up read pointer to the version data (host stub).
+
+    @param[in]     activeVersionData pointer for the version data.
+    @return        number of version elements.
+*/
+const uint32_t versionGetData(const versionData ** activeVersionData) {
+    *activeVersionData = testVersionData;
+    return(sizeof(testVersionData) / sizeof(testVersionData[0]));
+}
+
+
+/**
+    Set up the modules like main.cpp (module inits, WiFi and MQTT).
+*/
+static void testSetup(void) {
+
+    // Reset switch and alarm sounder released (inverted inputs)
+    hostPinSet(D6, HIGH);
+    hostPinSet(RX, HIGH);
+
+    bootProfileStep("preSetup");
+    wifiIdentifyModule();
+
+    (void) debugSetSerial(&Serial1);
+    logSinkInit();
+    journalInit();
+
+    nvmInit();
+    inputsInit();
+    outputsInit();
+
+    restCtrlInit();
+    statusCtrlInit();
+    (void) alarmInit(&Serial);
+    garageDoorInit();
+
+    hostWiFiManagerConnect(true);
+    setupWifi();
+    mqttSetup();
+}
+
+/**
+    Run one iteration of every cyclic task (counts the allocations of each task).
+
+    @param[in]     count true when the allocations are counted.
+*/
+static void testIteration(const bool count) {
+
+    // Allocations before a task
+    unsigned int allocations;
+
+    for (unsigned int i = 0; i < (sizeof(testTasks) / sizeof(testTasks[0])); i++) {
+        allocations = hostHeapAllocations;
+        testTasks[i].task();
+
+        if (count == true) {
+            testTasks[i].allocations += hostHeapAllocations - allocations;
+        }
+    }
+
+    hostClockAdvance(TEST_ITERATION_US);
+}
+
+/**
+    Feed the events of a steady state iteration (panel frames, input changes, commands and a short WiFi outage).
+
+    @param[in]     iteration the iteration.
+*/
+static void testEvents(const unsigned int iteration) {
+
+    // Panel frame
+    const char * const frame = testPanelFrames[(iteration / TEST_PANEL_PERIOD) % (sizeof(testPanelFrames) / sizeof(testPanelFrames[0]))];
+
+    if ((iteration % TEST_PANEL_PERIOD) == 0) {
+        HOST_TEST_CHECK(hostSerialReceive(Serial, frame, strlen(frame)) == true);
+    }
+
+    // Alarm sounder and garage door ajar input (same pin)
+    if ((iteration % TEST_INPUT_PERIOD) == 0) {
+        hostPinSet(RX, (hostPinGet(RX) == LOW) ? HIGH : LOW);
+    }
+
+    // Module and alarm commands (the requested reset type is none)
+    if ((iteration % TEST_COMMAND_PERIOD) == 0) {
+        hostPubSubReceive(TEST_TOPIC_BASE "module command", "{\"reset\": 0}");
+        hostPubSubReceive(TEST_TOPIC_BASE "alarm command", "{\"armdisarm\": 1}");
+    }
+
+    // Short WiFi outage (the reconnection saves the WiFi cache through the asynchronous NVM commit)
+    if (iteration == TEST_OUTAGE_ITERATION) {
+        hostWiFiStatus(WL_DISCONNECTED);
+        hostWiFiDisconnected();
+    }
+    else if (iteration == (TEST_OUTAGE_ITERATION + TEST_OUTAGE_ITERATIONS)) {
+        hostWiFiStatus(WL_CONNECTED);
+        hostWiFiGotIp();
+    }
+}
+
+/**
+    Run the modules to a steady state, then check that no cyclic task allocates from the heap.
+*/
+static void testSteadyState(void) {
+
+    // Counters at the start of the steady state
+    unsigned int httpRequests;
+    unsigned int published;
+    size_t debugBytes;
+
+    // Text of a failed task
+    char text[128];
+
+    testSetup();
+    hostHttpRespond(HTTP_CODE_OK, TEST_POLL_RESPONSE);
+
+    // Warm-up: the first poll, the first panel frame and the deferred NVM structures
+    for (unsigned int i = 0; (i < TEST_WARM_UP_ITERATIONS) && (hostHttpRequests < 2); i++) {
+        testEvents(i);
+        testIteration(false);
+    }
+
+    nvmValidateDeferred();
+    HOST_TEST_CHECK(hostHttpRequests >= 2);
+    HOST_TEST_CHECK(wifiIsConnected() == true);
+
+    httpRequests = hostHttpRequests;
+    published = hostPubSubPublishedCount;
+    debugBytes = Serial1.hostTxBytes;
+    hostHeapAllocations = 0;
+
+    for (unsigned int i = 0; i < TEST_STEADY_ITERATIONS; i++) {
+        testEvents(i);
+        testIteration(true);
+    }
+
+    // No task allocated
+    for (unsigned int i = 0; i < (sizeof(testTasks) / sizeof(testTasks[0])); i++) {
+        if (testTasks[i].allocations != 0) {
+            snprintf(text, sizeof(text), "%s allocated %u times", testTasks[i].name, testTasks[i].allocations);
+            hostTestCheck(false, text, __FILE__, __LINE__);
+        }
+    }
+
+    HOST_TEST_CHECK(hostHeapAllocations == 0);
+
+    // The steady state did the work (polls, published messages, debug output, the outage and the commands)
+    HOST_TEST_CHECK((hostHttpRequests - httpRequests) >= 3);
+    HOST_TEST_CHECK(strncmp(hostHttpPath, TEST_POLL_PATH, strlen(TEST_POLL_PATH)) == 0);
+    HOST_TEST_CHECK(hostPubSubPublishedCount > published);
+    HOST_TEST_CHECK(Serial1.hostTxBytes > debugBytes);
+    HOST_TEST_CHECK(wifiIsConnected() == true);
+    HOST_TEST_CHECK(restCtrlGetResetRequest() == rstTypeNone);
+    HOST_TEST_CHECK(hawkbitClientGetCurrentState() == stmHawkbitIdle);
+
+    printf("test_steady_state: %u iterations, %u polls, %u published\n", TEST_STEADY_ITERATIONS, hostHttpRequests - httpRequests, hostPubSubPublishedCount - published);
+}
+
+
+int main(void) {
+
+    // Block allocated to check the counter (volatile so the allocation is not optimised out)
+    void * volatile block;
+
+    hostTestFlashOpen("test_steady_state");
+
+    // The allocation counter sees the heap
+    hostHeapAllocations = 0;
+    block = malloc(1);
+    free(block);
+    HOST_TEST_CHECK(hostHeapAllocations == 1);
+
+    testSteadyState();
+
+    return(hostTestResult("test_steady_state"));
+}
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#include "host_test.h"
+#include "wifi.h"
+#include "wifi_supervisor.h"
+#include "reset_ctrl.h"
+#include "messages_tx.h"
+
+
+// Simulated time of one supervisor call (uS)
+#define TEST_CALL_US                    (WIFI_SUPERVISOR_CYCLIC_RATE * 1000UL)
+
+// Supervisor calls per second
+#define TEST_CALLS_PER_S                (1000 / WIFI_SUPERVISOR_CYCLIC_RATE)
+
+// Outage budget of the supervisor (S, the Makefile builds wifi_supervisor.cpp and the test with a shorter budget than the default)
+#define TEST_OUTAGE_BUDGET_S            (WIFI_SUPERVISOR_OUTAGE_BUDGET_S)
+
+// Time the configuration portal stays open (S, longer than the outage budget)
+#define TEST_PORTAL_S                   (2 * TEST_OUTAGE_BUDGET_S)
+
+// Time into an outage before the portal opens (S)
+#define TEST_OUTAGE_BEFORE_PORTAL_S     (TEST_OUTAGE_BUDGET_S / 2)
+
+
+// Configuration portal active (stubbed wifi module)
+static bool testPortalActive = false;
+
+// Reset requested from the stubbed reset controller
+static resetCtrlTypes testResetRequest = rstTypeNone;
+
+// Re-associations requested from the stubbed wifi module
+static unsigned int testReassociations = 0;
+
+
+bool wifiIsConnected(void) {
+    return(WiFi.status() == WL_CONNECTED);
+}
+
+bool wifiIsPortalActive(void) {
+    return(testPortalActive);
+}
+
+void wifiReassociate(void) {
+    testReassociations++;
+}
+
+const char* wifiStatusToString(const wl_status_t status) {
+    return((status == WL_CONNECTED) ? "WL_CONNECTED" : "WL_DISCONNECTED");
+}
+
+resetCtrlStm restCtrlGetResetState(void) {
+    return(stmResetIdle);
+}
+
+resetCtrlTypes restCtrlGetResetRequest(void) {
+    return(testResetRequest);
+}
+
+void restCtrlSetResetRequest(const resetCtrlTypes reqeustedRest) {
+    testResetRequest = reqeustedRest;
+}
+
+void messsagesTxWifiOutageMessage(const wifiSupervisorData * const wifiSupervisorDataStructurePtr) {
+    (void) wifiSupervisorDataStructurePtr;
+}
+
+
+/**
+    Run the supervisor (moves the simulated clock on by the call interval per call).
+
+    @param[in]     seconds time to run in S.
+*/
+static void testRun(const unsigned int seconds) {
+
+    for (unsigned int i = 0; i < (seconds * TEST_CALLS_PER_S); i++) {
+        wifiSupervisorStateMachine();
+        hostClockAdvance(TEST_CALL_US);
+    }
+}
+
+/**
+    The portal opened at boot (no stored network): no recovery and no reboot however long it stays open.
+    The outage starts when the portal closes and the budget is counted from there.
+*/
+static void testPortalAtBoot(void) {
+
+    hostWiFiStatus(WL_DISCONNECTED);
+    testPortalActive = true;
+    wifiSupervisorInit();
+
+    testRun(TEST_PORTAL_S);
+    HOST_TEST_CHECK(wifiSupervisorGetState() == stmWifiSupervisorConnected);
+    HOST_TEST_CHECK(hostWiFiReconnects() == 0);
+    HOST_TEST_CHECK(testReassociations == 0);
+    HOST_TEST_CHECK(testResetRequest == rstTypeNone);
+    HOST_TEST_CHECK(hostTestLogContains("Paused while the configuration portal is active") == true);
+
+    // Portal closed without a network, the supervisor takes over
+    testPortalActive = false;
+    testRun(TEST_OUTAGE_BUDGET_S - 1);
+    HOST_TEST_CHECK(hostWiFiReconnects() > 0);
+    HOST_TEST_CHECK(testResetRequest == rstTypeNone);
+    HOST_TEST_CHECK(hostTestLogContains("Resumed after") == true);
+
+    testRun(2);
+    HOST_TEST_CHECK(testResetRequest == rstTypeReset);
+}
+
+/**
+    The portal opened during an outage: the recovery stops and the portal time is left out of the outage.
+*/
+static void testPortalInOutage(void) {
+
+    // Reconnect attempts when the portal opened
+    unsigned int reconnects;
+
+    // Rebooted and connected
+    testResetRequest = rstTypeNone;
+    hostWiFiStatus(WL_CONNECTED);
+    wifiSupervisorInit();
+    testRun(1);
+    HOST_TEST_CHECK(wifiSupervisorGetState() == stmWifiSupervisorConnected);
+
+    // Outage, then the portal opens part way through the budget
+    hostWiFiStatus(WL_DISCONNECTED);
+    hostWiFiDisconnected();
+    testRun(TEST_OUTAGE_BEFORE_PORTAL_S);
+    HOST_TEST_CHECK(wifiSupervisorGetState() != stmWifiSupervisorConnected);
+
+    testPortalActive = true;
+    testRun(1);
+    reconnects = hostWiFiReconnects();
+    testReassociations = 0;
+
+    testRun(TEST_PORTAL_S);
+    HOST_TEST_CHECK(hostWiFiReconnects() == reconnects);
+    HOST_TEST_CHECK(testReassociations == 0);
+    HOST_TEST_CHECK(testResetRequest == rstTypeNone);
+
+    // Portal closed, the rest of the budget is still there
+    testPortalActive = false;
+    testRun(TEST_OUTAGE_BUDGET_S - TEST_OUTAGE_BEFORE_PORTAL_S - 1);
+    HOST_TEST_CHECK(testResetRequest == rstTypeNone);
+    HOST_TEST_CHECK(testReassociations > 0);
+
+    testRun(2);
+    HOST_TEST_CHECK(testResetRequest == rstTypeReset);
+    HOST_TEST_CHECK(wifiSupervisorGetState() == stmWifiSupervisorReboot);
+}
+
+
+int main(void) {
+
+    testPortalAtBoot();
+    testPortalInOutage();
+
+    return(hostTestResult("test_wifi_supervisor"));
+}
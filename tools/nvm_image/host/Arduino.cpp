@@ -0,0 +1,242 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+
+// Serial ports
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+// Pin levels (inputs set by the test, outputs written by the firmware)
+static int hostPins[HOST_PINS];
+
+// State of the random sequence (repeatable)
+static uint32_t hostRandomState = 1;
+
+
+/**
+    Wait (moves the simulated clock on).
+
+    @param[in]     ms time to wait in mS.
+*/
+void delay(const unsigned long ms) {
+    hostClockAdvance(ms * 1000UL);
+}
+
+/**
+    Random number (the host sequence is repeatable).
+
+    @param[in]     howBig upper bound (exclusive).
+    @return        random number from 0 to howBig - 1.
+*/
+long random(const long howBig) {
+
+    if (howBig <= 0) {
+        return(0);
+    }
+
+    // Linear congruential generator (Numerical Recipes constants)
+    hostRandomState = (hostRandomState * 1664525UL) + 1013904223UL;
+
+    return((long)((hostRandomState >> 8) % (uint32_t)howBig));
+}
+
+/**
+    Set the mode of a pin (the host keeps no modes).
+
+    @param[in]     pin pin number.
+    @param[in]     mode INPUT or OUTPUT.
+*/
+void pinMode(const uint8_t pin, const uint8_t mode) {
+    (void) pin;
+    (void) mode;
+}
+
+/**
+    Read a pin (the level set by hostPinSet).
+
+    @param[in]     pin pin number.
+    @return        level of the pin.
+*/
+int digitalRead(const uint8_t pin) {
+    return((pin < HOST_PINS) ? hostPins[pin] : LOW);
+}
+
+/**
+    Write a pin level.
+
+    @param[in]     pin pin number.
+    @param[in]     value level of the pin.
+*/
+void digitalWrite(const uint8_t pin, const uint8_t value) {
+    hostPinSet(pin, value);
+}
+
+/**
+    Write a pin PWM level.
+
+    @param[in]     pin pin number.
+    @param[in]     value PWM level (0 to PWMRANGE).
+*/
+void analogWrite(const uint8_t pin, const int value) {
+    hostPinSet(pin, value);
+}
+
+/**
+    Drive an input pin (read back by digitalRead).
+
+    @param[in]     pin pin number.
+    @param[in]     value level of the pin.
+*/
+void hostPinSet(const uint8_t pin, const int value) {
+    if (pin < HOST_PINS) {
+        hostPins[pin] = value;
+    }
+}
+
+/**
+    Get the value written to an output pin (digitalWrite or analogWrite).
+
+    @param[in]     pin pin number.
+    @return        value of the pin.
+*/
+int hostPinGet(const uint8_t pin) {
+    return((pin < HOST_PINS) ? hostPins[pin] : LOW);
+}
+
+
+/**
+    Set the baud rate (the host does not simulate it).
+
+    @param[in]     baud baud rate.
+*/
+void HardwareSerial::begin(unsigned long baud) {
+    (void) baud;
+}
+
+/**
+    Swap the pins of the port (the host does not simulate it).
+*/
+void HardwareSerial::swap(void) {
+}
+
+/**
+    Number of received bytes waiting.
+
+    @return        number of bytes.
+*/
+int HardwareSerial::available(void) {
+    return((int)(hostRxTail - hostRxHead));
+}
+
+/**
+    Read a received byte.
+
+    @return        the byte (-1 when there is none).
+*/
+int HardwareSerial::read(void) {
+
+    // Byte read
+    int returnValue = -1;
+
+    if (hostRxHead < hostRxTail) {
+        returnValue = hostRx[hostRxHead++];
+
+        // Empty so start from the front again
+        if (hostRxHead == hostRxTail) {
+            hostRxHead = 0;
+            hostRxTail = 0;
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Write text.
+
+    @param[in]     text pointer to the text.
+    @return        number of bytes written.
+*/
+size_t HardwareSerial::print(const char * text) {
+
+    // Length of the text
+    const size_t length = strlen(text);
+
+    hostTxBytes += length;
+
+    return(length);
+}
+
+/**
+    Write text and an end of line.
+
+    @param[in]     text pointer to the text.
+    @return        number of bytes written.
+*/
+size_t HardwareSerial::println(const char * text) {
+    return(print(text) + print("\r\n"));
+}
+
+/**
+    Write an end of line.
+
+    @return        number of bytes written.
+*/
+size_t HardwareSerial::println(void) {
+    return(print("\r\n"));
+}
+
+/**
+    Write formatted text (only the length is kept, nothing is formatted into a buffer).
+
+    @param[in]     format pointer to the format.
+    @return        number of bytes written.
+*/
+size_t HardwareSerial::printf(const char * format, ...) {
+
+    // Variable arguments
+    va_list arguments;
+
+    // Length of the formatted text
+    int length;
+
+    va_start(arguments, format);
+    length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (length > 0) {
+        hostTxBytes += length;
+    }
+
+    return((length > 0) ? (size_t)length : 0);
+}
+
+/**
+    Queue bytes received by a serial port.
+
+    @param[in]     serial the serial port.
+    @param[in]     data pointer to the bytes.
+    @param[in]     size number of bytes.
+    @return        true when all bytes fit in the receive buffer.
+*/
+bool hostSerialReceive(HardwareSerial & serial, const void * const data, const size_t size) {
+
+    if (size > (sizeof(serial.hostRx) - serial.hostRxTail)) {
+        return(false);
+    }
+
+    memcpy(&serial.hostRx[serial.hostRxTail], data, size);
+    serial.hostRxTail += size;
+
+    return(true);
+}
+
+
+/**
+    String from text (truncated to HOST_STRING_SIZE - 1 characters).
+
+    @param[in]     text pointer to the text.
+*/
+String::String(const char * const text) {
+    snprintf(stringBuffer, sizeof(stringBuffer), "%s", (text != NULL) ? text : "");
+}
@@ -0,0 +1,184 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Minimal host (Linux) replacement for the Arduino core, only what the shared NVM sources and the host tests need
+// The pins, serial ports and String are implemented in Arduino.cpp (only linked by the host tests building the application modules)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include "Esp.h"
+
+// Flash attributes do nothing on the host
+#define PROGMEM
+
+// Flash reads are plain reads on the host
+#define pgm_read_dword(addr)            (*(const uint32_t *)(addr))
+
+// PWM range of the ESP8266 Arduino core (2.7.x)
+#define PWMRANGE                        (1023)
+
+// Interrupts are not simulated on the host
+#define interrupts()
+#define noInterrupts()
+
+// Pin levels and modes of the Arduino core
+#define LOW                             (0)
+#define HIGH                            (1)
+#define INPUT                           (0)
+#define OUTPUT                          (1)
+
+// Pins of the d1_mini (same GPIO numbers as the core)
+#define D1                              (5)
+#define D2                              (4)
+#define D5                              (14)
+#define D6                              (12)
+#define RX                              (3)
+#define TX                              (1)
+
+// Number of simulated pins
+#define HOST_PINS                       (17)
+
+// Receive buffer size of a simulated serial port
+#define HOST_SERIAL_RX_SIZE             (256)
+
+// Capacity of a host String (a fixed buffer, the host String never allocates)
+#define HOST_STRING_SIZE                (64)
+
+// Same type and helpers as the Arduino core
+typedef uint8_t byte;
+using std::min;
+using std::max;
+
+// Serial port (written bytes are counted, received bytes are queued by the test)
+class HardwareSerial {
+public:
+    void begin(unsigned long baud);
+    void swap(void);
+    int available(void);
+    int read(void);
+    size_t print(const char * text);
+    size_t println(const char * text);
+    size_t println(void);
+    size_t printf(const char * format, ...) __attribute__ ((format (printf, 2, 3)));
+
+    uint8_t                 hostRx[HOST_SERIAL_RX_SIZE];        // Received bytes
+    size_t                  hostRxHead;                         // Next byte to read
+    size_t                  hostRxTail;                         // Next byte to queue
+    unsigned long           hostTxBytes;                        // Bytes written
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+// String of the Arduino core (fixed capacity on the host)
+class String {
+public:
+    String(const char * const text = "");
+
+    const char * c_str(void) const {
+        return(stringBuffer);
+    }
+
+private:
+    char stringBuffer[HOST_STRING_SIZE];
+};
+
+/**
+    Time since the start of the process in uS (wraps like the core).
+
+    @return        time in uS.
+*/
+unsigned long micros(void);
+
+/**
+    Time since the start of the process in mS (wraps like the core).
+
+    @return        time in mS.
+*/
+unsigned long millis(void);
+
+/**
+    Move the clock on without waiting (simulated time, e.g. a flash write or a network timeout).
+
+    @param[in]     uS time to add in uS.
+*/
+void hostClockAdvance(const unsigned long uS);
+
+/**
+    Wait (moves the simulated clock on).
+
+    @param[in]     ms time to wait in mS.
+*/
+void delay(const unsigned long ms);
+
+/**
+    Random number (the host sequence is repeatable).
+
+    @param[in]     howBig upper bound (exclusive).
+    @return        random number from 0 to howBig - 1.
+*/
+long random(const long howBig);
+
+/**
+    Set the mode of a pin (the host keeps no modes).
+
+    @param[in]     pin pin number.
+    @param[in]     mode INPUT or OUTPUT.
+*/
+void pinMode(const uint8_t pin, const uint8_t mode);
+
+/**
+    Read a pin (the level set by hostPinSet).
+
+    @param[in]     pin pin number.
+    @return        level of the pin.
+*/
+int digitalRead(const uint8_t pin);
+
+/**
+    Write a pin level.
+
+    @param[in]     pin pin number.
+    @param[in]     value level of the pin.
+*/
+void digitalWrite(const uint8_t pin, const uint8_t value);
+
+/**
+    Write a pin PWM level.
+
+    @param[in]     pin pin number.
+    @param[in]     value PWM level (0 to PWMRANGE).
+*/
+void analogWrite(const uint8_t pin, const int value);
+
+/**
+    Drive an input pin (read back by digitalRead).
+
+    @param[in]     pin pin number.
+    @param[in]     value level of the pin.
+*/
+void hostPinSet(const uint8_t pin, const int value);
+
+/**
+    Get the value written to an output pin (digitalWrite or analogWrite).
+
+    @param[in]     pin pin number.
+    @return        value of the pin.
+*/
+int hostPinGet(const uint8_t pin);
+
+/**
+    Queue bytes received by a serial port.
+
+    @param[in]     serial the serial port.
+    @param[in]     data pointer to the bytes.
+    @param[in]     size number of bytes.
+    @return        true when all bytes fit in the receive buffer.
+*/
+bool hostSerialReceive(HardwareSerial & serial, const void * const data, const size_t size);
+
+#endif
@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+
+
+// EEPROM
+EEPROMClass EEPROM;
+
+
+/**
+    Read the EEPROM sector into the RAM copy.
+
+    @param[in]     size size of the EEPROM in bytes (rounded up to whole words like the core).
+*/
+void EEPROMClass::begin(size_t size) {
+
+    eepromSize = min((size + 3) & ~size_t(3), (size_t)SPI_FLASH_SEC_SIZE);
+    eepromDirty = false;
+
+    (void) ESP.flashRead(HOST_EEPROM_SECTOR * SPI_FLASH_SEC_SIZE, (uint32_t *)eepromData, eepromSize);
+}
+
+/**
+    Erase the EEPROM sector and write the RAM copy (only when it changed).
+
+    @return        true when the RAM copy is in the flash.
+*/
+bool EEPROMClass::commit(void) {
+
+    bool returnValue = true;
+
+    if ((eepromSize > 0) && (eepromDirty == true)) {
+        returnValue = ESP.flashEraseSector(HOST_EEPROM_SECTOR);
+        returnValue &= ESP.flashWrite(HOST_EEPROM_SECTOR * SPI_FLASH_SEC_SIZE, (uint32_t *)eepromData, eepromSize);
+        eepromDirty = !returnValue;
+    }
+
+    return(returnValue);
+}
+
+/**
+    Commit the RAM copy and release it.
+
+    @return        true when the RAM copy is in the flash.
+*/
+bool EEPROMClass::end(void) {
+
+    const bool returnValue = commit();
+
+    eepromSize = 0;
+
+    return(returnValue);
+}
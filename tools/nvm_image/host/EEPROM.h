@@ -0,0 +1,44 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// Host (Linux) replacement for the EEPROM library of the Arduino core
+// Same behaviour as the core: a RAM copy of one flash sector, a commit erases and rewrites the whole sector
+
+#include <Arduino.h>
+
+// Flash sector of the EEPROM (d1_mini, the sector after the file system area)
+#define HOST_EEPROM_SECTOR              (0x3FB)
+
+
+class EEPROMClass {
+public:
+    void begin(size_t size);
+    bool commit(void);
+    bool end(void);
+
+    template <typename T> T & get(int const address, T & data) {
+        if ((address >= 0) && ((address + sizeof(T)) <= eepromSize)) {
+            memcpy(&data, eepromData + address, sizeof(T));
+        }
+        return(data);
+    }
+
+    template <typename T> const T & put(int const address, const T & data) {
+        if ((address >= 0) && ((address + sizeof(T)) <= eepromSize)) {
+            if (memcmp(eepromData + address, &data, sizeof(T)) != 0) {
+                memcpy(eepromData + address, &data, sizeof(T));
+                eepromDirty = true;
+            }
+        }
+        return(data);
+    }
+
+private:
+    uint8_t     eepromData[SPI_FLASH_SEC_SIZE];
+    size_t      eepromSize = 0;
+    bool        eepromDirty = false;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
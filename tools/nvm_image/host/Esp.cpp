@@ -0,0 +1,388 @@
+#include <Arduino.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "user_interface.h"
+
+
+// Contents of erased flash
+#define HOST_FLASH_ERASED               (0xFF)
+
+
+// ESP class
+EspClass ESP;
+
+// Simulated flash (NULL until hostFlashOpen)
+static uint8_t * hostFlash = NULL;
+
+// Flash operation counters
+static hostFlashCounters hostFlashCount = {0, 0, 0, 0};
+
+// Erases and writes left before the power is lost (0 when it is never lost)
+static uint32_t hostFlashLossOperation = 0;
+
+// How much of the interrupted flash operation is applied
+static hostFlashLossMode hostFlashLoss = hostFlashLossBefore;
+
+// Time added to the clock by hostClockAdvance (uS)
+static uint64_t hostClockOffset = 0;
+
+// RTC user memory (kept by the process, a boot in a child process starts from a copy)
+static uint32_t hostRtcUserMemory[HOST_RTC_USER_MEMORY_SIZE / sizeof(uint32_t)];
+
+// Reason of the last reset
+static struct rst_info hostResetInfo = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+
+
+/**
+    Count an erase or write and lose power when requested.
+
+    @return        true when the power is lost at this operation.
+*/
+static bool hostFlashPowerLost(void) {
+
+    bool returnValue = false;
+
+    if (hostFlashLossOperation > 0) {
+        hostFlashLossOperation--;
+        returnValue = (hostFlashLossOperation == 0);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Stop the process like a power loss (no destructors or exit handlers).
+*/
+static void hostFlashPowerOff(void) {
+    _exit(HOST_FLASH_POWER_LOSS_EXIT);
+}
+
+/**
+    Check a flash access is inside the simulated flash.
+
+    @param[in]     offset flash address.
+    @param[in]     size size of the access.
+    @return        true when the access is valid.
+*/
+static bool hostFlashAccessValid(const uint32_t offset, const size_t size) {
+    return((hostFlash != NULL) && ((offset % sizeof(uint32_t)) == 0) && (offset <= HOST_FLASH_SIZE) && (size <= (HOST_FLASH_SIZE - offset)));
+}
+
+
+/**
+    Time of the monotonic clock plus the simulated time.
+
+    @return        time in uS.
+*/
+static uint64_t hostClockNow(void) {
+
+    // Current time
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return((now.tv_sec * 1000000ULL) + (now.tv_nsec / 1000) + hostClockOffset);
+}
+
+/**
+    Time since the start of the process in uS (wraps like the core).
+
+    @return        time in uS.
+*/
+unsigned long micros(void) {
+    return((unsigned long)(uint32_t)hostClockNow());
+}
+
+/**
+    Time since the start of the process in mS (wraps like the core).
+
+    @return        time in mS.
+*/
+unsigned long millis(void) {
+    return((unsigned long)(uint32_t)(hostClockNow() / 1000));
+}
+
+/**
+    Move the clock on without waiting (simulated time, e.g. a flash write or a network timeout).
+
+    @param[in]     uS time to add in uS.
+*/
+void hostClockAdvance(const unsigned long uS) {
+    hostClockOffset += uS;
+}
+
+
+/**
+    Erase a flash sector.
+
+    @param[in]     sector sector to erase.
+    @return        true when the sector was erased.
+*/
+bool EspClass::flashEraseSector(uint32_t sector) {
+
+    // Address of the sector
+    const uint32_t offset = sector * SPI_FLASH_SEC_SIZE;
+
+    if (hostFlashAccessValid(offset, SPI_FLASH_SEC_SIZE) == false) {
+        return(false);
+    }
+
+    if (hostFlashPowerLost() == true) {
+        if (hostFlashLoss == hostFlashLossHalf) {
+            memset(hostFlash + offset + (SPI_FLASH_SEC_SIZE / 2), HOST_FLASH_ERASED, SPI_FLASH_SEC_SIZE / 2);
+        }
+
+        hostFlashPowerOff();
+    }
+
+    memset(hostFlash + offset, HOST_FLASH_ERASED, SPI_FLASH_SEC_SIZE);
+    hostFlashCount.erases++;
+
+    return(true);
+}
+
+/**
+    Write to the flash (can only clear bits).
+
+    @param[in]     offset flash address (32bit aligned).
+    @param[in]     data pointer to the data.
+    @param[in]     size size of the data in bytes (whole words).
+    @return        true when the data was written.
+*/
+bool EspClass::flashWrite(uint32_t offset, uint32_t * data, size_t size) {
+
+    // Words to write
+    size_t words = size / sizeof(uint32_t);
+
+    // Flash words
+    uint32_t * flashWords = (uint32_t *)(hostFlash + offset);
+
+    // Power is lost during this write
+    bool powerLost;
+
+    if ((hostFlashAccessValid(offset, size) == false) || ((size % sizeof(uint32_t)) != 0)) {
+        return(false);
+    }
+
+    powerLost = hostFlashPowerLost();
+
+    if (powerLost == true) {
+        words = (hostFlashLoss == hostFlashLossHalf) ? (words / 2) : 0;
+    }
+
+    for (size_t i = 0; i < words; i++) {
+        flashWords[i] &= data[i];
+    }
+
+    if (powerLost == true) {
+        hostFlashPowerOff();
+    }
+
+    hostFlashCount.writes++;
+    hostFlashCount.bytesWritten += size;
+
+    return(true);
+}
+
+/**
+    Read from the flash.
+
+    @param[in]     offset flash address (32bit aligned).
+    @param[out]    data pointer to the data.
+    @param[in]     size size of the data in bytes.
+    @return        true when the data was read.
+*/
+bool EspClass::flashRead(uint32_t offset, uint32_t * data, size_t size) {
+
+    if (hostFlashAccessValid(offset, size) == false) {
+        return(false);
+    }
+
+    memcpy(data, hostFlash + offset, size);
+    hostFlashCount.reads++;
+
+    return(true);
+}
+
+/**
+    Read from the RTC user memory.
+
+    @param[in]     offset offset in 4 byte blocks.
+    @param[out]    data pointer to the data.
+    @param[in]     size size of the data in bytes.
+    @return        true when the data was read.
+*/
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size) {
+
+    if (((offset * sizeof(uint32_t)) + size) > HOST_RTC_USER_MEMORY_SIZE) {
+        return(false);
+    }
+
+    memcpy(data, &hostRtcUserMemory[offset], size);
+
+    return(true);
+}
+
+/**
+    Write to the RTC user memory.
+
+    @param[in]     offset offset in 4 byte blocks.
+    @param[in]     data pointer to the data.
+    @param[in]     size size of the data in bytes.
+    @return        true when the data was written.
+*/
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size) {
+
+    if (((offset * sizeof(uint32_t)) + size) > HOST_RTC_USER_MEMORY_SIZE) {
+        return(false);
+    }
+
+    memcpy(&hostRtcUserMemory[offset], data, size);
+
+    return(true);
+}
+
+/**
+    Get the reason of the last reset.
+
+    @return        pointer to the reset information.
+*/
+struct rst_info * EspClass::getResetInfoPtr(void) {
+    return(&hostResetInfo);
+}
+
+/**
+    Get the free heap (fixed on the host).
+
+    @return        free heap in bytes.
+*/
+uint32_t EspClass::getFreeHeap(void) {
+    return(HOST_FREE_HEAP);
+}
+
+/**
+    Get the minimum free cont stack (fixed on the host).
+
+    @return        free cont stack in bytes.
+*/
+uint32_t EspClass::getFreeContStack(void) {
+    return(HOST_FREE_CONT_STACK);
+}
+
+/**
+    Restart (the process exits with HOST_RESTART_EXIT, like a boot ending at a power loss).
+*/
+void EspClass::restart(void) {
+    fflush(stdout);
+    _exit(HOST_RESTART_EXIT);
+}
+
+
+/**
+    Map the simulated flash to a file.
+    A new (or short) file is extended with erased flash. The mapping is shared so it survives fork and exit.
+
+    @param[in]     path path of the file.
+    @return        true when the file is mapped.
+*/
+bool hostFlashOpen(const char * const path) {
+
+    // File descriptor
+    const int file = open(path, O_RDWR | O_CREAT, 0644);
+
+    // File details
+    struct stat fileStatus;
+
+    // Mapped file
+    void * mapped;
+
+    // Size of the file before it was mapped
+    off_t fileSize;
+
+    if (file < 0) {
+        return(false);
+    }
+
+    fileSize = (fstat(file, &fileStatus) == 0) ? fileStatus.st_size : 0;
+
+    if ((fileSize < HOST_FLASH_SIZE) && (ftruncate(file, HOST_FLASH_SIZE) != 0)) {
+        (void) close(file);
+        return(false);
+    }
+
+    mapped = mmap(NULL, HOST_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    (void) close(file);
+
+    if (mapped == MAP_FAILED) {
+        return(false);
+    }
+
+    hostFlash = (uint8_t *)mapped;
+
+    if (fileSize < HOST_FLASH_SIZE) {
+        memset(hostFlash + fileSize, HOST_FLASH_ERASED, HOST_FLASH_SIZE - fileSize);
+    }
+
+    return(true);
+}
+
+/**
+    Get the contents of the simulated flash (HOST_FLASH_SIZE bytes).
+
+    @return        pointer to the flash contents.
+*/
+uint8_t * hostFlashImage(void) {
+    return(hostFlash);
+}
+
+/**
+    Erase all of the simulated flash.
+*/
+void hostFlashEraseAll(void) {
+    if (hostFlash != NULL) {
+        memset(hostFlash, HOST_FLASH_ERASED, HOST_FLASH_SIZE);
+    }
+}
+
+/**
+    Lose power at a flash operation.
+    The process exits with HOST_FLASH_POWER_LOSS_EXIT at the requested erase or write.
+
+    @param[in]     operation erase or write to lose power at (1 is the next one, 0 never loses power).
+    @param[in]     mode how much of the operation is applied.
+*/
+void hostFlashPowerLoss(const uint32_t operation, const hostFlashLossMode mode) {
+    hostFlashLossOperation = operation;
+    hostFlashLoss = mode;
+}
+
+/**
+    Get the flash operation counters (since the last reset).
+
+    @return        pointer to the counters.
+*/
+const hostFlashCounters * hostFlashGetCounters(void) {
+    return(&hostFlashCount);
+}
+
+/**
+    Reset the flash operation counters.
+*/
+void hostFlashResetCounters(void) {
+    memset(&hostFlashCount, 0, sizeof(hostFlashCount));
+}
+
+/**
+    Set the reason of the last reset (reported by getResetInfoPtr, power on by default).
+
+    @param[in]     reason reset reason (rst_reason).
+    @param[in]     exccause exception cause.
+*/
+void hostResetReason(const uint32_t reason, const uint32_t exccause) {
+    hostResetInfo.reason = reason;
+    hostResetInfo.exccause = exccause;
+}
@@ -0,0 +1,116 @@
+#ifndef ESP_H
+#define ESP_H
+
+// Host (Linux) replacement for the ESP class of the Arduino core
+// The flash is simulated in a file (NOR behaviour: erase sets the bits, a write can only clear them)
+// Power loss can be injected at any erase or write to test the recovery of the code using the flash
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Flash sector size
+#define SPI_FLASH_SEC_SIZE              (4096)
+
+// Size of the simulated flash (d1_mini, 4MB)
+#define HOST_FLASH_SIZE                 (0x400000)
+
+// Exit code of a process stopped by a simulated power loss
+#define HOST_FLASH_POWER_LOSS_EXIT      (99)
+
+// Exit code of a process stopped by ESP.restart
+#define HOST_RESTART_EXIT               (98)
+
+
+// How much of the interrupted flash operation is applied
+enum hostFlashLossMode {
+    hostFlashLossBefore     = 0,        // Nothing (power lost before the operation started)
+    hostFlashLossHalf       = 1         // Half (erase: the second half of the sector, write: the first half of the words)
+};
+
+// Flash operation counters
+typedef struct {
+    uint32_t                erases;             // Sector erases
+    uint32_t                writes;             // Writes
+    uint32_t                bytesWritten;       // Bytes written
+    uint32_t                reads;              // Reads
+} hostFlashCounters;
+
+// Free heap reported by the ESP class (the host does not simulate the heap)
+#define HOST_FREE_HEAP                  (40000)
+
+// Free cont stack reported by the ESP class (the host does not simulate the cont stack)
+#define HOST_FREE_CONT_STACK            (2048)
+
+// Size of the RTC user memory (bytes)
+#define HOST_RTC_USER_MEMORY_SIZE       (512)
+
+struct rst_info;
+
+// Flash, RTC user memory and reset information of the ESP class (same signatures as the core)
+class EspClass {
+public:
+    bool flashEraseSector(uint32_t sector);
+    bool flashWrite(uint32_t offset, uint32_t * data, size_t size);
+    bool flashRead(uint32_t offset, uint32_t * data, size_t size);
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size);
+    struct rst_info * getResetInfoPtr(void);
+    uint32_t getFreeHeap(void);
+    uint32_t getFreeContStack(void);
+    void restart(void) __attribute__ ((noreturn));
+};
+
+extern EspClass ESP;
+
+
+/**
+    Map the simulated flash to a file.
+    A new (or short) file is extended with erased flash. The mapping is shared so it survives fork and exit.
+
+    @param[in]     path path of the file.
+    @return        true when the file is mapped.
+*/
+bool hostFlashOpen(const char * const path);
+
+/**
+    Get the contents of the simulated flash (HOST_FLASH_SIZE bytes).
+
+    @return        pointer to the flash contents.
+*/
+uint8_t * hostFlashImage(void);
+
+/**
+    Erase all of the simulated flash.
+*/
+void hostFlashEraseAll(void);
+
+/**
+    Lose power at a flash operation.
+    The process exits with HOST_FLASH_POWER_LOSS_EXIT at the requested erase or write.
+
+    @param[in]     operation erase or write to lose power at (1 is the next one, 0 never loses power).
+    @param[in]     mode how much of the operation is applied.
+*/
+void hostFlashPowerLoss(const uint32_t operation, const hostFlashLossMode mode);
+
+/**
+    Get the flash operation counters (since the last reset).
+
+    @return        pointer to the counters.
+*/
+const hostFlashCounters * hostFlashGetCounters(void);
+
+/**
+    Reset the flash operation counters.
+*/
+void hostFlashResetCounters(void);
+
+/**
+    Set the reason of the last reset (reported by getResetInfoPtr, power on by default).
+
+    @param[in]     reason reset reason (rst_reason).
+    @param[in]     exccause exception cause.
+*/
+void hostResetReason(const uint32_t reason, const uint32_t exccause);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef USER_INTERFACE_H
+#define USER_INTERFACE_H
+
+// Host (Linux) replacement for the reset information and the station configuration of the SDK (user_interface.h)
+// The station functions are implemented by the host WiFi library (test/host/ESP8266WiFi.cpp)
+
+#include <stdint.h>
+
+// Reset reasons (same values as the SDK)
+enum rst_reason {
+    REASON_DEFAULT_RST      = 0,
+    REASON_WDT_RST          = 1,
+    REASON_EXCEPTION_RST    = 2,
+    REASON_SOFT_WDT_RST     = 3,
+    REASON_SOFT_RESTART     = 4,
+    REASON_DEEP_SLEEP_AWAKE = 5,
+    REASON_EXT_SYS_RST      = 6
+};
+
+// Reset information (same layout as the SDK)
+struct rst_info {
+    uint32_t                reason;
+    uint32_t                exccause;
+    uint32_t                epc1;
+    uint32_t                epc2;
+    uint32_t                epc3;
+    uint32_t                excvaddr;
+    uint32_t                depc;
+};
+
+// Station configuration (same layout as the SDK)
+struct station_config {
+    uint8_t                 ssid[32];
+    uint8_t                 password[64];
+    uint8_t                 bssid_set;
+    uint8_t                 bssid[6];
+};
+
+bool wifi_station_get_config(struct station_config * config);
+bool wifi_station_get_config_default(struct station_config * config);
+bool wifi_station_set_config_current(struct station_config * config);
+bool wifi_station_disconnect(void);
+
+#endif
@@ -0,0 +1,1210 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include "nvm_cfg.h"
+#include "nvm_log.h"
+#include "nvm_log_format.h"
+#include "config_cfg.h"
+#include "crc.h"
+
+
+// Largest line in a devices CSV file
+#define NVM_IMAGE_LINE_MAX              (1024)
+
+// Largest number of columns in a devices CSV file (device name plus every configuration field)
+#define NVM_IMAGE_COLUMNS_MAX           (CONFIG_FIELDS_MAX + 1)
+
+// Largest output file name
+#define NVM_IMAGE_PATH_MAX              (512)
+
+// Text shown in place of a secret field
+#define NVM_IMAGE_SECRET_TEXT           ("********")
+
+// Image used when "defaults" is given in place of an input image
+#define NVM_IMAGE_DEFAULTS              ("defaults")
+
+// Size of a log dump (the NVM_LOG_SECTORS sectors below _FS_end)
+#define NVM_IMAGE_LOG_SIZE              (NVM_LOG_SECTORS * SPI_FLASH_SEC_SIZE)
+
+
+// NVM structure names (must align with nvmSubConfigIndex)
+static const char * nvmImageStructureNames[] = {
+    "nvm",
+    "network",
+    "mqtt",
+    "io",
+    "alarm",
+    "hawkbit",
+    "ext1",
+    "wifi"
+};
+
+static_assert((sizeof(nvmImageStructureNames) / sizeof(nvmImageStructureNames[0])) == nvmNumberOfTypes, "Mismatch number of elements between <enum nvmSubConfigIndex> and <nvmImageStructureNames>.");
+
+// Local function definitions
+static uint32_t nvmImageStructureOffset(const uint32_t index);
+static void nvmImageLoadDefaults(void);
+static bool nvmImageRead(const char * const path);
+static bool nvmImageWrite(const char * const path);
+static bool nvmImageLoad(const char * const source);
+static bool nvmImageStructureValid(const uint32_t index);
+static int nvmImageFindField(const char * const name);
+static bool nvmImageSetField(const char * const name, const char * const value);
+static void nvmImageFieldToString(const configField * const fieldPtr, const uint8_t * const imagePtr, const bool showSecret, char * const buffer, const size_t bufferSize);
+static unsigned int nvmImageSplitCsv(char * const line, char ** const columns, const unsigned int columnsMax);
+static int nvmImagePrint(const bool showSecrets);
+static int nvmImageDump(const char * const path, const bool showSecrets);
+static bool nvmImageReadLog(const char * const path, uint32_t * const logPtr);
+static bool nvmImageMigrate(const uint32_t index, const nvmLogRecordHeader * const headerPtr, const uint8_t * const oldDataPtr);
+static bool nvmImageReplaySector(const uint8_t * const sectorPtr, uint32_t * const structuresPtr);
+static int nvmImageDumpLog(const char * const path, const bool showSecrets);
+static int nvmImageValidate(const char * const path);
+static int nvmImageDiff(const char * const pathA, const char * const pathB);
+static int nvmImageSet(const char * const source, const char * const path, const int argc, char ** const argv);
+static int nvmImageBatch(const char * const source, const char * const csvPath, const char * const directory);
+static void nvmImageUsage(void);
+
+
+/**
+    Update RAM mirror structure CRC based on the current structure contents.
+    Same calculation as the firmware (the tool has no dirty structures to track).
+
+    @param[in]     index index of the NVM structure the will have the CRC update.
+*/
+void nvmUpdateRamMirrorCrcByIndex(uint32_t index) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Calculated CRC
+    crc_t crcCalculated = 0;
+
+    // Make sure the index is within range
+    if (index < nvmConfigSize) {
+
+        // Calculate the CRC and copy it to the RAM mirror
+        crcCalculated = crcCalculate(nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].length);
+        memcpy(nvmConfigPtr[index].addressCrc, &crcCalculated, NVM_CRC_SIZE_BYTES);
+    }
+}
+
+/**
+    Get the offset of a structure in nvmCompleteStructure.
+
+    @param[in]     index index of the NVM structure.
+    @return        offset of the structure.
+*/
+static uint32_t nvmImageStructureOffset(const uint32_t index) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    return((uint32_t)(nvmConfigPtr[index].addressRamMirror - (const uint8_t *)ramMirrorPtr));
+}
+
+/**
+    Load the ROM defaults of all structures into the RAM mirror (with CRC's).
+*/
+static void nvmImageLoadDefaults(void) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror and get its size
+    const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    memset(ramMirrorPtr, 0, ramMirrorSize);
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        memcpy(nvmConfigPtr[i].addressRamMirror, nvmConfigPtr[i].addressRomDefault, nvmConfigPtr[i].length);
+        nvmUpdateRamMirrorCrcByIndex(i);
+    }
+}
+
+/**
+    Read an image file into the RAM mirror.
+    The file must be exactly the size of the RAM mirror.
+
+    @param[in]     path path of the image file.
+    @return        true when the image was read.
+*/
+static bool nvmImageRead(const char * const path) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror and get its size
+    const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Image file
+    FILE * file = fopen(path, "rb");
+
+    // Bytes read (one more than the image to detect a size mismatch)
+    size_t bytesRead = 0;
+
+    // Spare byte after the image
+    uint8_t spare;
+
+    bool returnValue = false;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    else {
+        bytesRead = fread(ramMirrorPtr, 1, ramMirrorSize, file);
+        bytesRead += fread(&spare, 1, sizeof(spare), file);
+
+        if (bytesRead == ramMirrorSize) {
+            returnValue = true;
+        }
+        else {
+            fprintf(stderr, "%s: not a NVM image (expected %u bytes)\n", path, (unsigned int)ramMirrorSize);
+        }
+
+        fclose(file);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Write the RAM mirror to an image file.
+
+    @param[in]     path path of the image file.
+    @return        true when the image was written.
+*/
+static bool nvmImageWrite(const char * const path) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror and get its size
+    const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Image file
+    FILE * file = fopen(path, "wb");
+
+    bool returnValue = false;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    else {
+        returnValue = (fwrite(ramMirrorPtr, 1, ramMirrorSize, file) == ramMirrorSize);
+        returnValue = (fclose(file) == 0) && returnValue;
+
+        if (returnValue == false) {
+            fprintf(stderr, "%s: write failed\n", path);
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Load the RAM mirror from an image file or the ROM defaults.
+
+    @param[in]     source path of the image file or NVM_IMAGE_DEFAULTS.
+    @return        true when the RAM mirror was loaded.
+*/
+static bool nvmImageLoad(const char * const source) {
+
+    bool returnValue = true;
+
+    if (strcmp(source, NVM_IMAGE_DEFAULTS) == 0) {
+        nvmImageLoadDefaults();
+    }
+    else {
+        returnValue = nvmImageRead(source);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Check the CRC of a structure in the RAM mirror.
+
+    @param[in]     index index of the NVM structure.
+    @return        true when the stored CRC matches the structure.
+*/
+static bool nvmImageStructureValid(const uint32_t index) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Expected CRC
+    const crc_t crcExpected = crcCalculate(nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].length);
+
+    // Read CRC
+    crc_t crcRead = 0;
+
+    memcpy(&crcRead, nvmConfigPtr[index].addressCrc, NVM_CRC_SIZE_BYTES);
+
+    return(crcRead == crcExpected);
+}
+
+/**
+    Find a configuration field by name.
+
+    @param[in]     name pointer to the field name.
+    @return        index of the field (-1 when not found).
+*/
+static int nvmImageFindField(const char * const name) {
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    int returnValue = -1;
+
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+        if (strcmp(name, configFields[i].fieldName) == 0) {
+            returnValue = i;
+            break;
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Write a configuration field into the RAM mirror and update the CRC of its structure.
+    Values are validated the same way as the module config command (length and range).
+
+    @param[in]     name pointer to the field name.
+    @param[in]     value pointer to the value as text.
+    @return        true when the field exists and the value was valid.
+*/
+static bool nvmImageSetField(const char * const name, const char * const value) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields
+    (void) configGetFieldsPointerRO(&configFields);
+
+    // Index of the field
+    const int fieldIndex = nvmImageFindField(name);
+
+    // Pointer to the field
+    const configField * fieldPtr;
+
+    // Address of the field in the RAM mirror
+    uint8_t * fieldAddress;
+
+    // Number for number fields
+    unsigned long number;
+
+    // End of the number text
+    char * numberEnd;
+
+    // Number in the size of the field
+    uint8_t number8;
+    uint16_t number16;
+
+    bool returnValue = false;
+
+    if (fieldIndex < 0) {
+        fprintf(stderr, "Unknown field %s\n", name);
+        return(false);
+    }
+
+    fieldPtr = &configFields[fieldIndex];
+    fieldAddress = ((uint8_t *)ramMirrorPtr) + fieldPtr->fieldOffset;
+
+    switch(fieldPtr->fieldType) {
+
+        case(configTypeString):
+
+            // Must leave room for the end of string
+            if (strlen(value) < fieldPtr->fieldSize) {
+                memset(fieldAddress, 0, fieldPtr->fieldSize);
+                memcpy(fieldAddress, value, strlen(value));
+                returnValue = true;
+            }
+            break;
+
+        case(configTypeUint8):
+        case(configTypeUint16):
+            errno = 0;
+            number = strtoul(value, &numberEnd, 0);
+
+            if ((errno == 0) && (numberEnd != value) && (*numberEnd == '\0') && (number <= fieldPtr->fieldMaximum)) {
+                number8 = (uint8_t) number;
+                number16 = (uint16_t) number;
+                memcpy(fieldAddress, (fieldPtr->fieldType == configTypeUint8) ? (const void *)&number8 : (const void *)&number16, fieldPtr->fieldSize);
+                returnValue = true;
+            }
+            break;
+    }
+
+    if (returnValue == true) {
+        nvmUpdateRamMirrorCrcByIndex(fieldPtr->fieldStructure);
+    }
+    else {
+        fprintf(stderr, "Invalid value for field %s\n", name);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Convert a configuration field of an image to text.
+
+    @param[in]     fieldPtr pointer to the field.
+    @param[in]     imagePtr pointer to the image (nvmCompleteStructure).
+    @param[in]     showSecret show secret fields (otherwise NVM_IMAGE_SECRET_TEXT).
+    @param[out]    buffer pointer to the text buffer.
+    @param[in]     bufferSize size of the text buffer.
+*/
+static void nvmImageFieldToString(const configField * const fieldPtr, const uint8_t * const imagePtr, const bool showSecret, char * const buffer, const size_t bufferSize) {
+
+    // Address of the field in the image
+    const uint8_t * const fieldAddress = imagePtr + fieldPtr->fieldOffset;
+
+    // Number in the size of the field
+    uint8_t number8;
+    uint16_t number16;
+
+    if ((fieldPtr->fieldSecret == true) && (showSecret == false)) {
+        snprintf(buffer, bufferSize, "%s", NVM_IMAGE_SECRET_TEXT);
+    }
+    else if (fieldPtr->fieldType == configTypeString) {
+        snprintf(buffer, bufferSize, "\"%.*s\"", (int)strnlen((const char *)fieldAddress, fieldPtr->fieldSize), (const char *)fieldAddress);
+    }
+    else if (fieldPtr->fieldType == configTypeUint8) {
+        memcpy(&number8, fieldAddress, sizeof(number8));
+        snprintf(buffer, bufferSize, "%u", number8);
+    }
+    else {
+        memcpy(&number16, fieldAddress, sizeof(number16));
+        snprintf(buffer, bufferSize, "%u", number16);
+    }
+}
+
+/**
+    Split a CSV line into columns (in place).
+    Columns can be quoted ("" is a quote inside a quoted column), the end of line is removed.
+
+    @param[in,out] line pointer to the line (modified).
+    @param[out]    columns pointer to the column pointers.
+    @param[in]     columnsMax size of columns.
+    @return        number of columns (columnsMax + 1 when there are too many).
+*/
+static unsigned int nvmImageSplitCsv(char * const line, char ** const columns, const unsigned int columnsMax) {
+
+    // Read position
+    char * readPtr = line;
+
+    // Write position (quotes are removed in place)
+    char * writePtr = line;
+
+    // Inside a quoted column
+    bool quoted = false;
+
+    // Number of columns
+    unsigned int columnCount = 0;
+
+    line[strcspn(line, "\r\n")] = '\0';
+
+    columns[columnCount++] = writePtr;
+
+    while (*readPtr != '\0') {
+        if ((quoted == true) && (readPtr[0] == '"') && (readPtr[1] == '"')) {
+            *writePtr++ = '"';
+            readPtr += 2;
+        }
+        else if (*readPtr == '"') {
+            quoted = !quoted;
+            readPtr++;
+        }
+        else if ((quoted == false) && (*readPtr == ',')) {
+            *writePtr++ = '\0';
+            readPtr++;
+
+            if (columnCount == columnsMax) {
+                return(columnsMax + 1);
+            }
+
+            columns[columnCount++] = writePtr;
+        }
+        else {
+            *writePtr++ = *readPtr++;
+        }
+    }
+
+    *writePtr = '\0';
+
+    return(columnCount);
+}
+
+/**
+    Print the state of every structure and the configuration fields of the RAM mirror.
+
+    @param[in]     showSecrets show the secret fields.
+    @return        exit code (0 when every structure is valid).
+*/
+static int nvmImagePrint(const bool showSecrets) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    // Read CRC
+    crc_t crcRead = 0;
+
+    // Field value text
+    char valueText[NVM_IMAGE_LINE_MAX];
+
+    // Corrupt structures
+    unsigned int corrupt = 0;
+
+    printf("%-10s %6s %6s %7s %10s %s\n", "structure", "offset", "length", "schema", "crc", "state");
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        memcpy(&crcRead, nvmConfigPtr[i].addressCrc, NVM_CRC_SIZE_BYTES);
+
+        if (nvmImageStructureValid(i) == false) {
+            corrupt++;
+        }
+
+        printf("%-10s %6u %6u %7u 0x%08x %s\n", nvmImageStructureNames[i], (unsigned int)nvmImageStructureOffset(i), (unsigned int)nvmConfigPtr[i].length, (unsigned int)nvmConfigPtr[i].schemaVersion, (unsigned int)crcRead, (nvmImageStructureValid(i) == true) ? "ok" : "CORRUPT");
+    }
+
+    printf("\nversion %u, errorCounter %u, wifi cache %s\n\n", (unsigned int)ramMirrorPtr->nvm.core.version, (unsigned int)ramMirrorPtr->nvm.core.errorCounter, (ramMirrorPtr->wifi.valid != 0) ? "valid" : "empty");
+
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+        nvmImageFieldToString(&configFields[i], (const uint8_t *)ramMirrorPtr, showSecrets, valueText, sizeof(valueText));
+        printf("%-24s %s\n", configFields[i].fieldName, valueText);
+    }
+
+    return((corrupt == 0) ? 0 : 1);
+}
+
+/**
+    Dump an image: the state of every structure and the configuration fields.
+
+    @param[in]     path path of the image file.
+    @param[in]     showSecrets show the secret fields.
+    @return        exit code (0 when every structure is valid).
+*/
+static int nvmImageDump(const char * const path, const bool showSecrets) {
+
+    if (nvmImageRead(path) == false) {
+        return(2);
+    }
+
+    return(nvmImagePrint(showSecrets));
+}
+
+/**
+    Read a dump of the log sectors.
+    The file must be exactly NVM_IMAGE_LOG_SIZE bytes.
+
+    @param[in]     path path of the dump file.
+    @param[out]    logPtr pointer to the log buffer (NVM_IMAGE_LOG_SIZE bytes).
+    @return        true when the dump was read.
+*/
+static bool nvmImageReadLog(const char * const path, uint32_t * const logPtr) {
+
+    // Dump file
+    FILE * file = fopen(path, "rb");
+
+    // Bytes read (one more than the log to detect a size mismatch)
+    size_t bytesRead = 0;
+
+    // Spare byte after the log
+    uint8_t spare;
+
+    bool returnValue = false;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    else {
+        bytesRead = fread(logPtr, 1, NVM_IMAGE_LOG_SIZE, file);
+        bytesRead += fread(&spare, 1, sizeof(spare), file);
+
+        if (bytesRead == NVM_IMAGE_LOG_SIZE) {
+            returnValue = true;
+        }
+        else {
+            fprintf(stderr, "%s: not a NVM log dump (expected %u bytes)\n", path, (unsigned int)NVM_IMAGE_LOG_SIZE);
+        }
+
+        fclose(file);
+    }
+
+    return(returnValue);
+}
+
+/**
+    Migrate a record from an older schema version into the RAM mirror.
+    Same as the firmware: only a valid structure is migrated, the migrated structure gets a new CRC.
+
+    @param[in]     index index of the NVM structure.
+    @param[in]     headerPtr pointer to the record header.
+    @param[in]     oldDataPtr pointer to the old structure (including its CRC).
+    @return        true when the record was migrated.
+*/
+static bool nvmImageMigrate(const uint32_t index, const nvmLogRecordHeader * const headerPtr, const uint8_t * const oldDataPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Pointer to the NVM migrations
+    const nvmMigrationConfig * nvmMigrationPtr;
+
+    // Set-up pointer to NVM migrations and get its size
+    const uint32_t nvmMigrationSize = nvmGetMigrationPointerRO(&nvmMigrationPtr);
+
+    // Length of the old structure excluding its CRC
+    const uint32_t oldLength = headerPtr->length - NVM_CRC_SIZE_BYTES;
+
+    // CRC of the old structure
+    crc_t crc;
+
+    bool returnValue = false;
+
+    memcpy(&crc, oldDataPtr + oldLength, NVM_CRC_SIZE_BYTES);
+
+    for (unsigned int i = 0; (i < nvmMigrationSize) && (nvmMigrationPtr[i].index < nvmNumberOfTypes); i++) {
+        if ((nvmMigrationPtr[i].index == index) && (nvmMigrationPtr[i].fromVersion == headerPtr->version) && (crc == crcCalculate(oldDataPtr, oldLength))) {
+
+            memcpy(nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].addressRomDefault, nvmConfigPtr[index].length);
+            nvmMigrationPtr[i].migrationFunction(oldDataPtr, oldLength, nvmConfigPtr[index].addressRamMirror, nvmConfigPtr[index].length);
+            nvmUpdateRamMirrorCrcByIndex(index);
+
+            returnValue = true;
+            break;
+        }
+    }
+
+    return(returnValue);
+}
+
+/**
+    Replay and list the records of a log sector into the RAM mirror.
+    Same rules as the firmware replay: records with an invalid CRC are skipped, an invalid record header ends the sector,
+    previous generations are listed but never become the stored generation.
+
+    @param[in]     sectorPtr pointer to the sector in the log dump.
+    @param[out]    structuresPtr pointer to the mask of the structures found in the sector (NVM_STRUCTURE_BIT).
+    @return        true when the sector has no invalid records.
+*/
+static bool nvmImageReplaySector(const uint8_t * const sectorPtr, uint32_t * const structuresPtr) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration
+    (void) nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Record buffer (the CRC field is cleared to check the record CRC)
+    static uint32_t recordBuffer[(sizeof(nvmLogRecordHeader) + NVM_LOG_PAYLOAD_MAX) / sizeof(uint32_t)];
+
+    // Record header in the record buffer
+    nvmLogRecordHeader * const headerPtr = (nvmLogRecordHeader *)recordBuffer;
+
+    // Structure in the record buffer
+    const uint8_t * const dataPtr = ((const uint8_t *)recordBuffer) + sizeof(nvmLogRecordHeader);
+
+    // Offset of the record in the sector
+    uint32_t offset = sizeof(nvmLogSectorHeader);
+
+    // CRC read from the record
+    crc_t crcRead;
+
+    // Size of the record in flash
+    uint32_t recordSize;
+
+    // Structure index of the record
+    uint32_t index;
+
+    // Record holds a previous generation
+    bool previous;
+
+    // Record holds the current schema version and length
+    bool current;
+
+    // State of the record
+    const char * state;
+
+    bool returnValue = true;
+
+    *structuresPtr = 0;
+
+    printf("  %6s %10s %-10s %-8s %6s %6s %s\n", "offset", "sequence", "structure", "gen", "schema", "length", "state");
+
+    while ((offset + sizeof(nvmLogRecordHeader)) <= SPI_FLASH_SEC_SIZE) {
+
+        memcpy(recordBuffer, sectorPtr + offset, sizeof(nvmLogRecordHeader));
+
+        // End of the log
+        if (recordBuffer[0] == NVM_LOG_ERASED) {
+            break;
+        }
+
+        recordSize = NVM_LOG_ALIGN(sizeof(nvmLogRecordHeader) + headerPtr->length);
+        index = headerPtr->index & ~NVM_LOG_RECORD_PREVIOUS;
+        previous = ((headerPtr->index & NVM_LOG_RECORD_PREVIOUS) != 0);
+
+        // Header must describe a known structure (of any schema version) that fits into the sector
+        if ((index >= nvmNumberOfTypes) || (headerPtr->length <= NVM_CRC_SIZE_BYTES) || (headerPtr->length > NVM_LOG_PAYLOAD_MAX) || ((offset + recordSize) > SPI_FLASH_SEC_SIZE)) {
+            printf("  %6u INVALID record header (index 0x%02x, length %u), rest of the sector ignored\n", (unsigned int)offset, (unsigned int)headerPtr->index, (unsigned int)headerPtr->length);
+            returnValue = false;
+            break;
+        }
+
+        memcpy(recordBuffer, sectorPtr + offset, recordSize);
+
+        crcRead = headerPtr->crc;
+        headerPtr->crc = 0;
+        current = (headerPtr->version == nvmConfigPtr[index].schemaVersion) && (headerPtr->length == (nvmConfigPtr[index].length + NVM_CRC_SIZE_BYTES));
+
+        // Invalid record
+        if (crcRead != crcCalculate(recordBuffer, sizeof(nvmLogRecordHeader) + headerPtr->length)) {
+            state = "BAD CRC (skipped)";
+            returnValue = false;
+        }
+
+        // Previous generation of a snapshot
+        else if (previous == true) {
+            state = (current == true) ? "ok" : "older schema";
+        }
+
+        // Newer records become the stored generation
+        else if (current == true) {
+            memcpy(nvmConfigPtr[index].addressRamMirror, dataPtr, headerPtr->length);
+            *structuresPtr |= NVM_STRUCTURE_BIT(index);
+            state = (nvmImageStructureValid(index) == true) ? "ok" : "CORRUPT structure";
+        }
+
+        // Older schema version, migrate to the current layout
+        else if (nvmImageMigrate(index, headerPtr, dataPtr) == true) {
+            state = "migrated";
+        }
+
+        else {
+            state = "NO MIGRATION (skipped)";
+        }
+
+        printf("  %6u %10u %-10s %-8s %6u %6u %s\n", (unsigned int)offset, (unsigned int)headerPtr->sequence, nvmImageStructureNames[index], (previous == true) ? "previous" : "stored", (unsigned int)headerPtr->version, (unsigned int)headerPtr->length, state);
+
+        offset += recordSize;
+    }
+
+    printf("  %u bytes used\n", (unsigned int)offset);
+
+    return(returnValue);
+}
+
+/**
+    Dump the NVM log read from a unit: the sectors, every record and the structures after the replay.
+    The replay follows the firmware (valid sectors oldest first, a reset sector discards the older sectors), so the result
+    is the RAM mirror the unit loads at the next boot.
+
+    @param[in]     path path of the log dump file.
+    @param[in]     showSecrets show the secret fields.
+    @return        exit code (0 when the log holds every structure and each is valid).
+*/
+static int nvmImageDumpLog(const char * const path, const bool showSecrets) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror and get its size
+    const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Mask of all structures
+    const uint32_t allStructures = NVM_STRUCTURE_BIT(nvmConfigSize) - 1;
+
+    // Log sectors (flash access is 32bit aligned)
+    static uint32_t logData[NVM_IMAGE_LOG_SIZE / sizeof(uint32_t)];
+
+    // Sector header
+    nvmLogSectorHeader sectorHeader;
+
+    // Sector sequences (0 when the sector is not valid)
+    uint32_t sectorSequences[NVM_LOG_SECTORS];
+
+    // Sector flags
+    uint32_t sectorFlags[NVM_LOG_SECTORS];
+
+    // Sector to replay next and the sequence of the last sector replayed
+    uint32_t replaySector;
+    uint32_t replaySequence = 0;
+
+    // Structures found in the active sector
+    uint32_t structures = 0;
+
+    // No invalid records in the active sector
+    bool tailValid = true;
+
+    // Exit code of the structures
+    int returnValue;
+
+    if (nvmImageReadLog(path, logData) == false) {
+        return(2);
+    }
+
+    // Find the valid sectors
+    printf("%-6s %10s %-6s %s\n", "sector", "sequence", "flags", "state");
+
+    for (unsigned int i = 0; i < NVM_LOG_SECTORS; i++) {
+        memcpy(&sectorHeader, ((const uint8_t *)logData) + (i * SPI_FLASH_SEC_SIZE), sizeof(sectorHeader));
+
+        if ((sectorHeader.magic == NVM_LOG_MAGIC) && (sectorHeader.sequence != 0) && (sectorHeader.crc == crcCalculate(&sectorHeader, offsetof(nvmLogSectorHeader, crc)))) {
+            sectorSequences[i] = sectorHeader.sequence;
+            sectorFlags[i] = sectorHeader.flags;
+        }
+        else {
+            sectorSequences[i] = 0;
+            sectorFlags[i] = 0;
+        }
+
+        printf("%-6u %10u %-6s %s\n", i, (unsigned int)sectorSequences[i], ((sectorFlags[i] & NVM_LOG_SECTOR_RESET) != 0) ? "reset" : "-", (sectorSequences[i] != 0) ? "valid" : ((sectorHeader.magic == NVM_LOG_ERASED) ? "erased" : "INVALID"));
+    }
+
+    memset(ramMirrorPtr, 0, ramMirrorSize);
+
+    // Replay the valid sectors oldest first (the last one replayed is the active sector)
+    do {
+        replaySector = NVM_LOG_SECTORS;
+
+        for (unsigned int i = 0; i < NVM_LOG_SECTORS; i++) {
+            if ((sectorSequences[i] > replaySequence) && ((replaySector == NVM_LOG_SECTORS) || (sectorSequences[i] < sectorSequences[replaySector]))) {
+                replaySector = i;
+            }
+        }
+
+        if (replaySector < NVM_LOG_SECTORS) {
+
+            // A reset discards everything replayed so far
+            if ((sectorFlags[replaySector] & NVM_LOG_SECTOR_RESET) != 0) {
+                memset(ramMirrorPtr, 0, ramMirrorSize);
+            }
+
+            printf("\nsector %u (sequence %u%s)\n", (unsigned int)replaySector, (unsigned int)sectorSequences[replaySector], ((sectorFlags[replaySector] & NVM_LOG_SECTOR_RESET) != 0) ? ", reset" : "");
+
+            tailValid = nvmImageReplaySector(((const uint8_t *)logData) + (replaySector * SPI_FLASH_SEC_SIZE), &structures);
+            replaySequence = sectorSequences[replaySector];
+        }
+    } while (replaySector < NVM_LOG_SECTORS);
+
+    // Nothing stored yet
+    if (replaySequence == 0) {
+        printf("\nNo valid log sectors, the firmware imports the EEPROM image at the next boot\n");
+        return(1);
+    }
+
+    // Power was lost writing the active sector
+    if ((tailValid == false) || (structures != allStructures)) {
+        printf("\nThe active sector is incomplete, the firmware opens a new sector at the next boot\n");
+    }
+
+    printf("\n");
+    returnValue = nvmImagePrint(showSecrets);
+
+    return(((returnValue == 0) && (tailValid == true) && (structures == allStructures)) ? 0 : 1);
+}
+
+/**
+    Validate an image (size and the CRC of every structure).
+
+    @param[in]     path path of the image file.
+    @return        exit code (0 when every structure is valid).
+*/
+static int nvmImageValidate(const char * const path) {
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Corrupt structures
+    unsigned int corrupt = 0;
+
+    if (nvmImageRead(path) == false) {
+        return(2);
+    }
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        if (nvmImageStructureValid(i) == false) {
+            printf("%s: %s CORRUPT (%s)\n", path, nvmImageStructureNames[i], (nvmConfigPtr[i].rewriteWhenCorrupt == true) ? "defaults restored at boot" : "not restored");
+            corrupt++;
+        }
+    }
+
+    if (corrupt == 0) {
+        printf("%s: ok\n", path);
+    }
+
+    return((corrupt == 0) ? 0 : 1);
+}
+
+/**
+    Compare two images, per structure and per configuration field.
+
+    @param[in]     pathA path of the first image file.
+    @param[in]     pathB path of the second image file.
+    @return        exit code (0 when the images are identical).
+*/
+static int nvmImageDiff(const char * const pathA, const char * const pathB) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Pointer to the NVM configuration
+    const nvmStructureConfig * nvmConfigPtr;
+
+    // Set-up pointer to NVM configuration and get its size
+    const uint32_t nvmConfigSize = nvmGetConfigPointerRO(&nvmConfigPtr);
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    // Copy of the first image
+    static nvmCompleteStructure imageA;
+
+    // Copy of the second image
+    static nvmCompleteStructure imageB;
+
+    // Structure validity in the first and second image
+    bool validA[nvmNumberOfTypes];
+    bool validB[nvmNumberOfTypes];
+
+    // Field value texts
+    char valueTextA[NVM_IMAGE_LINE_MAX];
+    char valueTextB[NVM_IMAGE_LINE_MAX];
+
+    // Differences found
+    unsigned int differences = 0;
+
+    if (nvmImageRead(pathA) == false) {
+        return(2);
+    }
+
+    memcpy(&imageA, ramMirrorPtr, sizeof(imageA));
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        validA[i] = nvmImageStructureValid(i);
+    }
+
+    if (nvmImageRead(pathB) == false) {
+        return(2);
+    }
+
+    memcpy(&imageB, ramMirrorPtr, sizeof(imageB));
+
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        validB[i] = nvmImageStructureValid(i);
+    }
+
+    // Structures (including the CRC)
+    for (unsigned int i = 0; i < nvmConfigSize; i++) {
+        if (memcmp(((const uint8_t *)&imageA) + nvmImageStructureOffset(i), ((const uint8_t *)&imageB) + nvmImageStructureOffset(i), nvmConfigPtr[i].length + NVM_CRC_SIZE_BYTES) != 0) {
+            printf("structure %-18s %s -> %s\n", nvmImageStructureNames[i], (validA[i] == true) ? "ok" : "CORRUPT", (validB[i] == true) ? "ok" : "CORRUPT");
+            differences++;
+        }
+    }
+
+    // Configuration fields
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+        if (memcmp(((const uint8_t *)&imageA) + configFields[i].fieldOffset, ((const uint8_t *)&imageB) + configFields[i].fieldOffset, configFields[i].fieldSize) != 0) {
+            nvmImageFieldToString(&configFields[i], (const uint8_t *)&imageA, false, valueTextA, sizeof(valueTextA));
+            nvmImageFieldToString(&configFields[i], (const uint8_t *)&imageB, false, valueTextB, sizeof(valueTextB));
+            printf("field     %-24s %s -> %s\n", configFields[i].fieldName, valueTextA, valueTextB);
+        }
+    }
+
+    return((differences == 0) ? 0 : 1);
+}
+
+/**
+    Build one image from an image (or the defaults) and field=value arguments.
+
+    @param[in]     source path of the source image file or NVM_IMAGE_DEFAULTS.
+    @param[in]     path path of the output image file.
+    @param[in]     argc number of field=value arguments.
+    @param[in]     argv pointer to the field=value arguments.
+    @return        exit code (0 when the image was written).
+*/
+static int nvmImageSet(const char * const source, const char * const path, const int argc, char ** const argv) {
+
+    // Separator in a field=value argument
+    char * separator;
+
+    if (nvmImageLoad(source) == false) {
+        return(2);
+    }
+
+    for (int i = 0; i < argc; i++) {
+        separator = strchr(argv[i], '=');
+
+        if (separator == NULL) {
+            fprintf(stderr, "Expected field=value, got %s\n", argv[i]);
+            return(2);
+        }
+
+        *separator = '\0';
+
+        if (nvmImageSetField(argv[i], separator + 1) == false) {
+            return(2);
+        }
+    }
+
+    return((nvmImageWrite(path) == true) ? 0 : 2);
+}
+
+/**
+    Build one image per device from a CSV file.
+    The header row is "name" followed by field names, every other row is a device (the name is the output file name).
+
+    @param[in]     source path of the base image file or NVM_IMAGE_DEFAULTS.
+    @param[in]     csvPath path of the devices CSV file.
+    @param[in]     directory output directory.
+    @return        exit code (0 when every image was written).
+*/
+static int nvmImageBatch(const char * const source, const char * const csvPath, const char * const directory) {
+
+    // Pointer to the RAM mirror
+    nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror
+    (void) nvmGetRamMirrorPointerRW(&ramMirrorPtr);
+
+    // Base image (every device starts from it)
+    static nvmCompleteStructure baseImage;
+
+    // Devices file
+    FILE * file;
+
+    // Header line and columns (kept for the field names)
+    static char headerLine[NVM_IMAGE_LINE_MAX];
+    char * headerColumns[NVM_IMAGE_COLUMNS_MAX];
+    unsigned int headerCount;
+
+    // Device line and columns
+    char line[NVM_IMAGE_LINE_MAX];
+    char * columns[NVM_IMAGE_COLUMNS_MAX];
+    unsigned int columnCount;
+
+    // Line number (for errors)
+    unsigned int lineNumber = 1;
+
+    // Output image path
+    char imagePath[NVM_IMAGE_PATH_MAX];
+
+    // Images written
+    unsigned int images = 0;
+
+    if (nvmImageLoad(source) == false) {
+        return(2);
+    }
+
+    memcpy(&baseImage, ramMirrorPtr, sizeof(baseImage));
+
+    file = fopen(csvPath, "r");
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", csvPath, strerror(errno));
+        return(2);
+    }
+
+    // Header must name the device column first, then known fields
+    if (fgets(headerLine, sizeof(headerLine), file) == NULL) {
+        fprintf(stderr, "%s: empty file\n", csvPath);
+        fclose(file);
+        return(2);
+    }
+
+    headerCount = nvmImageSplitCsv(headerLine, headerColumns, NVM_IMAGE_COLUMNS_MAX);
+
+    if ((headerCount > NVM_IMAGE_COLUMNS_MAX) || (strcmp(headerColumns[0], "name") != 0)) {
+        fprintf(stderr, "%s:1: header must be name followed by up to %u field names\n", csvPath, CONFIG_FIELDS_MAX);
+        fclose(file);
+        return(2);
+    }
+
+    for (unsigned int i = 1; i < headerCount; i++) {
+        if (nvmImageFindField(headerColumns[i]) < 0) {
+            fprintf(stderr, "%s:1: unknown field %s\n", csvPath, headerColumns[i]);
+            fclose(file);
+            return(2);
+        }
+    }
+
+    // One image per device
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        columnCount = nvmImageSplitCsv(line, columns, NVM_IMAGE_COLUMNS_MAX);
+
+        // Blank line
+        if ((columnCount == 1) && (columns[0][0] == '\0')) {
+            continue;
+        }
+
+        if ((columnCount != headerCount) || (columns[0][0] == '\0') || (strchr(columns[0], '/') != NULL)) {
+            fprintf(stderr, "%s:%u: expected %u columns and a device name\n", csvPath, lineNumber, headerCount);
+            fclose(file);
+            return(2);
+        }
+
+        memcpy(ramMirrorPtr, &baseImage, sizeof(baseImage));
+
+        for (unsigned int i = 1; i < columnCount; i++) {
+            if (nvmImageSetField(headerColumns[i], columns[i]) == false) {
+                fprintf(stderr, "%s:%u: device %s not written\n", csvPath, lineNumber, columns[0]);
+                fclose(file);
+                return(2);
+            }
+        }
+
+        snprintf(imagePath, sizeof(imagePath), "%s/%s.bin", directory, columns[0]);
+
+        if (nvmImageWrite(imagePath) == false) {
+            fclose(file);
+            return(2);
+        }
+
+        images++;
+    }
+
+    fclose(file);
+
+    printf("%u images written to %s\n", images, directory);
+
+    return(0);
+}
+
+/**
+    Print the usage and the configuration fields.
+*/
+static void nvmImageUsage(void) {
+
+    // Pointer to the RAM mirror
+    const nvmCompleteStructure * ramMirrorPtr;
+
+    // Set-up pointer to RAM mirror and get its size
+    const uint32_t ramMirrorSize = nvmGetRamMirrorPointerRO(&ramMirrorPtr);
+
+    // Pointer to the configuration fields
+    const configField * configFields;
+
+    // Set-up pointer to the configuration fields and get their number
+    const uint32_t configFieldCount = configGetFieldsPointerRO(&configFields);
+
+    fprintf(stderr, "Usage:\n"
+                    "  nvm_image dump <image> [--secrets]\n"
+                    "  nvm_image dump-log <log-dump> [--secrets]\n"
+                    "  nvm_image validate <image>...\n"
+                    "  nvm_image diff <image> <image>\n"
+                    "  nvm_image set <image|defaults> <output> [field=value]...\n"
+                    "  nvm_image batch <image|defaults> <devices.csv> <directory>\n"
+                    "\n"
+                    "Images are %u bytes, log dumps %u bytes. Fields:\n", (unsigned int)ramMirrorSize, (unsigned int)NVM_IMAGE_LOG_SIZE);
+
+    for (unsigned int i = 0; i < configFieldCount; i++) {
+        fprintf(stderr, "  %-24s %-8s %s\n", configFields[i].fieldName, nvmImageStructureNames[configFields[i].fieldStructure], (configFields[i].fieldType == configTypeString) ? "string" : "number");
+    }
+}
+
+int main(int argc, char ** argv) {
+
+    // Exit code
+    int returnValue = 2;
+
+    // Exit code of one image
+    int imageReturnValue;
+
+    if ((argc >= 3) && (strcmp(argv[1], "dump") == 0)) {
+        returnValue = nvmImageDump(argv[2], (argc == 4) && (strcmp(argv[3], "--secrets") == 0));
+    }
+    else if ((argc >= 3) && (strcmp(argv[1], "dump-log") == 0)) {
+        returnValue = nvmImageDumpLog(argv[2], (argc == 4) && (strcmp(argv[3], "--secrets") == 0));
+    }
+    else if ((argc >= 3) && (strcmp(argv[1], "validate") == 0)) {
+        returnValue = 0;
+
+        for (int i = 2; i < argc; i++) {
+            imageReturnValue = nvmImageValidate(argv[i]);
+            returnValue = (imageReturnValue > returnValue) ? imageReturnValue : returnValue;
+        }
+    }
+    else if ((argc == 4) && (strcmp(argv[1], "diff") == 0)) {
+        returnValue = nvmImageDiff(argv[2], argv[3]);
+    }
+    else if ((argc >= 4) && (strcmp(argv[1], "set") == 0)) {
+        returnValue = nvmImageSet(argv[2], argv[3], argc - 4, &argv[4]);
+    }
+    else if ((argc == 5) && (strcmp(argv[1], "batch") == 0)) {
+        returnValue = nvmImageBatch(argv[2], argv[3], argv[4]);
+    }
+    else {
+        nvmImageUsage();
+    }
+
+    return(returnValue);
+}